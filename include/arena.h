@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+
+// Bump allocator for memory that lives exactly as long as its owner (a scene).
+// Allocations are carved out of large blocks and never freed one at a time:
+// arena_free releases every block at once, so whatever was built out of the arena
+// doesn't need walking to tear it down.
+// Blocks never move, so pointers into an arena stay good until it's freed.
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+struct ArenaBlock {
+  struct ArenaBlock *next;
+  size_t size;
+  size_t used;
+  _Alignas(max_align_t) unsigned char data[];
+};
+
+struct Arena {
+  // Most recent block first, allocations only come from the head
+  struct ArenaBlock *blocks;
+  size_t block_size;
+};
+
+void arena_init(struct Arena *arena, size_t block_size);
+// Zeroed and aligned for any type, or NULL if a new block couldn't be allocated
+void *arena_alloc(struct Arena *arena, size_t size);
+void *arena_alloc_array(struct Arena *arena, size_t count, size_t size);
+void arena_free(struct Arena *arena);
@@ -10,6 +10,7 @@
 #include <uuid/uuid.h>
 #include "tinycthread/tinycthread.h"
 #include "game_state_observer.h"
+#include "entity.h"
 
 #define NUM_BUFFERS 4
 #define BUFFER_FRAMES 8192
@@ -35,7 +36,7 @@ struct SoundEffect {
 };
 
 struct AudioComponent {
-  uuid_t entity_id;
+  EntityIndex entity;
   ALuint source_id;
   int sound_effect_index;
   bool is_playing;
@@ -86,12 +87,12 @@ void audio_sound_effect_create(struct AudioManager *audio_manager, char *path, c
 void audio_sound_effect_play(struct SoundEffect *sound_effect);
 
 // AudioComponent
-void audio_component_create(struct Scene *scene, uuid_t entity_id, struct AudioManager *audio_manager, int sound_effect_index);
+void audio_component_create(struct Scene *scene, EntityIndex entity, struct AudioManager *audio_manager, int sound_effect_index);
 void audio_component_destroy(struct AudioManager *audio_manager, struct AudioComponent *audio_component);
 void audio_component_play(struct AudioManager *audio_manager, struct AudioComponent *audio_component);
 
 // Listener
-void audio_listener_update(struct Scene *scene, uuid_t entity_id);
+void audio_listener_update(struct Scene *scene, EntityIndex entity);
 
 // Observing game state
 struct GameStateObserver *audio_game_state_observer_create(struct AudioManager *audio_manager);
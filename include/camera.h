@@ -2,8 +2,8 @@
 
 #include <GLFW/glfw3.h>
 #include <cglm/cglm.h>
-#include <uuid/uuid.h>
 #include "types.h"
+#include "entity.h"
 
 // Default camera values
 //const vec3 POSITION = {0.0f, 0.0f, 0.0f};
@@ -17,7 +17,7 @@
 //const float SPEED       =  2.5f;
 
 struct CameraComponent {
-  uuid_t entity_id;
+  EntityIndex entity;
   vec3 position;
   vec3 front;
   vec3 up;
@@ -31,7 +31,7 @@ struct CameraComponent {
 };
 
 // Create camera with default values
-void camera_create(struct Scene *scene, uuid_t entity_id, vec3 position, vec3 up, float yaw, float pitch, float fov, float sensitivity, float speed);
+void camera_create(struct Scene *scene, EntityIndex entity, vec3 position, vec3 up, float yaw, float pitch, float fov, float sensitivity, float speed);
 
 // Get view matrix
 void camera_get_view_matrix(struct CameraComponent *camera, mat4 view);
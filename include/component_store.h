@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "entity.h"
+
+// Sparse set of one component type, keyed by EntityIndex.
+// Components are packed in dense, with dense_entities[i] the entity that owns components[i],
+// so iterating a type touches only entities that have it. sparse maps an entity index
+// to its component's position in dense (COMPONENT_STORE_NULL if it has none),
+// so getting, adding and removing are all O(1).
+// Removing swaps the last component into the hole, so pointers into a store
+// (and the dense order) are only good until the next add or remove.
+
+#define COMPONENT_STORE_NULL UINT32_MAX
+
+struct ComponentStore {
+  size_t component_size;
+  // Dense
+  void *components;
+  EntityIndex *dense_entities;
+  unsigned int num_components;
+  unsigned int max_components;
+  // Sparse, indexed by EntityIndex
+  uint32_t *sparse;
+  unsigned int num_sparse;
+};
+
+bool component_store_init(struct ComponentStore *store, size_t component_size, unsigned int capacity);
+void component_store_free(struct ComponentStore *store);
+
+// Zeroed component for entity, or NULL if it already has one or allocation failed
+void *component_store_add(struct ComponentStore *store, EntityIndex entity);
+void *component_store_get(struct ComponentStore *store, EntityIndex entity);
+bool component_store_remove(struct ComponentStore *store, EntityIndex entity);
+
+// Dense iteration, i from 0 to num_components
+void *component_store_at(struct ComponentStore *store, unsigned int i);
+EntityIndex component_store_entity_at(struct ComponentStore *store, unsigned int i);
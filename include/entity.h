@@ -2,25 +2,38 @@
 
 // #include <glad/glad.h>
 #include <cglm/cglm.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <uuid/uuid.h>
 // #include "physics/world.h"
 // #include "model.h"
 #include "shader.h"
 #include "types.h"
+#include "physics/body_handle.h"
+
+// Dense 32-bit index the scene keys components by (see component_store.h).
+// Indices of removed entities are reused, so hold on to id instead for anything
+// that has to outlive the entity or leave the scene (saves, the network)
+typedef uint32_t EntityIndex;
+
+#define ENTITY_NULL_INDEX UINT32_MAX
 
 struct Entity {
   uuid_t id;
+  EntityIndex index;
   EntityType type;
   vec3 position;
-  vec3 rotation;
+  versor rotation;
   vec3 scale;
   vec3 velocity;
-  struct PhysicsBody *physics_body;
+  PhysicsBodyHandle physics_body;
   struct Model *model;
   Shader *shader;
   // Audio
   // struct AudioComponent *audio_component;
   struct ItemComponent *item;
+  // Only used while removing a batch of entities, see scene_remove_entities
+  bool pending_removal;
 };
 
 // void entity_play_sound_effect(struct Entity *entity);
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cglm/cglm.h>
+#include <stdbool.h>
+#include "tinycthread/tinycthread.h"
+#include "physics/collider.h"
+#include "shader.h"
+#include "entity.h"
+
+// Deferred structural changes to a scene: spawning and destroying entities, and adding and removing components.
+// Anything that runs while the scene is being iterated (event handlers, physics callbacks, worker threads)
+// records commands here instead of changing the scene directly, and the scene applies all of them at once
+// in entity_command_buffer_apply, at a single sync point after physics and events each frame.
+//
+// Recording takes the buffer's mutex, so any thread can record. Applying swaps the recorded commands out
+// first, so commands recorded while applying go to the next frame.
+//
+// A spawned entity doesn't have an index until it's applied, so entity_commands_spawn returns a deferred
+// index (ENTITY_DEFERRED_INDEX_BIT set) that later commands in the same frame can use to refer to it.
+//
+// Destroys are applied last, all together, so the flat node array is compacted once however many
+// entities go. Destroying an entity also destroys the entities below it in the scene graph.
+
+#define ENTITY_DEFERRED_INDEX_BIT 0x80000000u
+#define ENTITY_IS_DEFERRED_INDEX(index) ((index) != ENTITY_NULL_INDEX && ((index) & ENTITY_DEFERRED_INDEX_BIT))
+
+struct Model;
+struct Scene;
+struct SceneNode;
+
+typedef enum {
+  ENTITY_COMMAND_SPAWN = 0,
+  ENTITY_COMMAND_DESTROY,
+  ENTITY_COMMAND_ADD_COMPONENT,
+  ENTITY_COMMAND_REMOVE_COMPONENT
+} EntityCommandType;
+
+typedef enum {
+  ENTITY_COMPONENT_RENDER = 0,
+  ENTITY_COMPONENT_AUDIO,
+  ENTITY_COMPONENT_ITEM,
+  ENTITY_COMPONENT_PHYSICS_BODY
+} EntityComponentType;
+
+// Spawned entities are added under the scene's root node
+struct EntitySpawnDesc {
+  EntityType type;
+  vec3 position;
+  versor rotation;
+  vec3 scale;
+  vec3 velocity;
+};
+
+struct EntityComponentDesc {
+  EntityComponentType type;
+  union {
+    struct {
+      struct Model *model;
+      Shader *shader;
+    } render;
+    struct {
+      int sound_effect_index;
+    } audio;
+    struct {
+      int id;
+      int count;
+    } item;
+    // A trigger body if trigger, otherwise a static or dynamic one
+    struct {
+      struct Collider collider;
+      float restitution;
+      bool dynamic;
+      bool trigger;
+    } physics_body;
+  } data;
+};
+
+struct EntityCommand {
+  EntityCommandType type;
+  EntityIndex entity;
+  union {
+    struct EntitySpawnDesc spawn;
+    struct EntityComponentDesc add_component;
+    EntityComponentType remove_component;
+  } data;
+};
+
+// An entity spawned while applying, by deferred index
+struct EntityCommandSpawn {
+  EntityIndex entity;
+  struct SceneNode *scene_node;
+};
+
+struct EntityCommandBuffer {
+  mtx_t mutex;
+  // Recorded since the last apply
+  struct EntityCommand *commands;
+  unsigned int num_commands;
+  unsigned int max_commands;
+  unsigned int num_spawns;
+
+  // Being applied, swapped with commands at the start of entity_command_buffer_apply
+  struct EntityCommand *applying;
+  unsigned int max_applying;
+  struct EntityCommandSpawn *spawns;
+  unsigned int max_spawns;
+  EntityIndex *destroys;
+  unsigned int num_destroys;
+  unsigned int max_destroys;
+};
+
+bool entity_command_buffer_init(struct EntityCommandBuffer *buffer, unsigned int capacity);
+void entity_command_buffer_free(struct EntityCommandBuffer *buffer);
+
+// Recording. Returns the deferred index of the entity to be spawned, or ENTITY_NULL_INDEX on failure
+EntityIndex entity_commands_spawn(struct EntityCommandBuffer *buffer, struct EntitySpawnDesc *desc);
+bool entity_commands_destroy(struct EntityCommandBuffer *buffer, EntityIndex entity);
+bool entity_commands_add_component(struct EntityCommandBuffer *buffer, EntityIndex entity, struct EntityComponentDesc *desc);
+bool entity_commands_remove_component(struct EntityCommandBuffer *buffer, EntityIndex entity, EntityComponentType type);
+// Whether a destroy has been recorded for entity since the last apply
+bool entity_commands_is_destroy_pending(struct EntityCommandBuffer *buffer, EntityIndex entity);
+
+void entity_command_buffer_apply(struct EntityCommandBuffer *buffer, struct Scene *scene);
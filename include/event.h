@@ -1,29 +1,42 @@
 #pragma once
 
 #include <stdint.h>
-#include <uuid/uuid.h>
 #include "time.h"
 #include "types.h"
+#include "entity.h"
 
+// Collision events follow contacts between bodies, see physics/contact_table.h
 typedef enum {
-  EVENT_COLLISION = 0,
+  EVENT_COLLISION_BEGIN = 0,
+  EVENT_COLLISION_PERSIST,
+  EVENT_COLLISION_END,
   EVENT_PLAYER_ITEM_PICKUP,
+  EVENT_TRIGGER_ENTER,
+  EVENT_TRIGGER_EXIT,
 } EventType;
 
+// Events name entities by index, and are processed the frame they're raised,
+// before any removed entity's index can be reused
 struct GameEvent {
   EventType type;
-  struct timespec timestamp;
+  // Physics step the event was raised on
+  uint64_t tick;
   union {
     struct {
-      uuid_t entity_A_id;
-      uuid_t entity_B_id;
+      EntityIndex entity_A;
+      EntityIndex entity_B;
     } collision;
     struct {
-      uuid_t player_entity_id;
+      EntityIndex player_entity;
       int item_id;
       int item_count;
-      uuid_t item_entity_id;
+      EntityIndex item_entity;
     } item_pickup;
+    // A body (so far always a player) starting or stopping overlapping a trigger volume
+    struct {
+      EntityIndex trigger_entity;
+      EntityIndex other_entity;
+    } trigger;
   } data;
 };
 
@@ -1,11 +1,11 @@
 #pragma once
 
 #include <stdbool.h>
-#include <uuid/uuid.h>
 #include "item.h"
+#include "entity.h"
 
 struct InventoryComponent {
-  uuid_t entity_id;
+  EntityIndex entity;
   struct ItemComponent *items;
   int size;
   int capacity;
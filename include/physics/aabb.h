@@ -26,6 +26,12 @@ void AABB_merge(struct AABB *a, struct AABB *b);
 void AABB_update(struct AABB *src, mat3 rotation, vec3 translation, vec3 scale, struct AABB *dest);
 void AABB_update_by_vertex(struct AABB *aabb, vec3 vertex);
 
+// Broad phase helpers
+void AABB_union(struct AABB *a, struct AABB *b, struct AABB *dest);
+bool AABB_contains(struct AABB *a, struct AABB *b);
+float AABB_surface_area(struct AABB *aabb);
+
 // Collision tests
 bool AABB_intersect_AABB(struct AABB *a, struct AABB *b);
 bool AABB_intersect_plane(struct AABB *box, struct Plane *plane);
+bool AABB_intersect_segment(struct AABB *aabb, vec3 extents, vec3 origin, vec3 translation, float max_fraction, float *entry);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include "aabb.h"
+
+// Batch versions of the primitive tests: one query shape against a set of candidates.
+// Candidates are stored SoA, one array per component, so a SIMD register holds the same
+// component of PHYSICS_BATCH_WIDTH candidates and each test runs on all of them at once.
+// With SSE that's 4 candidates per instruction, without it every candidate goes through
+// the scalar function.
+//
+// Results match the scalar functions bit for bit: the SIMD path does the same single precision
+// operations in the same order, and candidates left over after the last full group of
+// PHYSICS_BATCH_WIDTH go through the scalar function itself.
+
+#if defined(__SSE__)
+#define PHYSICS_BATCH_WIDTH 4
+#else
+#define PHYSICS_BATCH_WIDTH 1
+#endif
+
+struct AABBBatch {
+  float *center[3];
+  float *extents[3];
+  unsigned int count;
+  unsigned int capacity;
+};
+
+// Positions and velocities of the bodies being integrated, gathered out of the body array
+// and scattered back after the kernel
+struct MotionBatch {
+  float *position[3];
+  float *velocity[3];
+  unsigned int count;
+  unsigned int capacity;
+};
+
+// Candidate storage, grows by doubling
+bool AABB_batch_push(struct AABBBatch *batch, struct AABB *aabb);
+void AABB_batch_get(struct AABBBatch *batch, unsigned int index, struct AABB *dest);
+void AABB_batch_clear(struct AABBBatch *batch);
+void AABB_batch_free(struct AABBBatch *batch);
+
+// Batch tests, results[i] is for candidate i
+void AABB_intersect_AABB_batch(struct AABB *query, struct AABBBatch *batch, bool *results);
+
+// Motion storage, grows by doubling
+bool motion_batch_push(struct MotionBatch *batch, vec3 position, vec3 velocity);
+void motion_batch_get(struct MotionBatch *batch, unsigned int index, vec3 position, vec3 velocity);
+void motion_batch_clear(struct MotionBatch *batch);
+void motion_batch_free(struct MotionBatch *batch);
+
+// Subtract gravity_step from every y velocity, then move every position by velocity * delta_time
+void motion_batch_integrate(struct MotionBatch *batch, float gravity_step, float delta_time);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+// Stable reference to a PhysicsBody.
+// Bodies are stored densely in growable per-category arrays and move whenever
+// a body is removed, an array grows, or a body switches between static and dynamic,
+// so anything outside the physics world holds a handle instead of a pointer
+// and resolves it with physics_get_body.
+//
+// The low PHYSICS_HANDLE_INDEX_BITS bits index the world's slot table, the rest are
+// the slot's generation. Removing a body bumps its slot's generation, so old handles
+// to it resolve to NULL instead of whatever body reuses the slot.
+// Generations start at 1, so 0 is never a valid handle.
+typedef uint32_t PhysicsBodyHandle;
+
+#define PHYSICS_NULL_HANDLE 0
+#define PHYSICS_HANDLE_INDEX_BITS 20
+#define PHYSICS_HANDLE_INDEX_MASK ((1u << PHYSICS_HANDLE_INDEX_BITS) - 1)
+#define PHYSICS_HANDLE_MAX_GENERATION ((1u << (32 - PHYSICS_HANDLE_INDEX_BITS)) - 1)
+
+#define PHYSICS_HANDLE_INDEX(handle) ((handle) & PHYSICS_HANDLE_INDEX_MASK)
+#define PHYSICS_HANDLE_GENERATION(handle) ((handle) >> PHYSICS_HANDLE_INDEX_BITS)
+#define PHYSICS_MAKE_HANDLE(index, generation) (((uint32_t)(generation) << PHYSICS_HANDLE_INDEX_BITS) | ((uint32_t)(index) & PHYSICS_HANDLE_INDEX_MASK))
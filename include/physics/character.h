@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cglm/cglm.h>
+#include <stdbool.h>
+#include "body_handle.h"
+
+// Kinematic character controller for capsule bodies (the player).
+// Game code adds up the frame's movement intent with physics_character_add_displacement,
+// then physics_character_move resolves all of it at once with capsule casts (see physics/query.h),
+// so a fast character can't tunnel through thin walls the way writing positions directly could.
+//
+// The move is collide and slide: cast the capsule along what's left of the displacement,
+// stop CHARACTER_SKIN short of whatever it hits, and keep the part of the rest that runs
+// along the surface, up to CHARACTER_MAX_SLIDES times.
+// - Surfaces flatter than min_ground_normal_y are ground. Anything steeper is a wall, and a
+//   grounded character that walks into one tries to step up over it: cast up by step_height,
+//   forward, then back down, and keep that if it landed on ground.
+// - After moving, a character that was on the ground and isn't moving up is snapped down
+//   onto ground within snap_distance, so it stays on slopes and stairs instead of skipping off them.
+//
+// Gravity and jumping are still up to the physics step, the controller only moves the body.
+
+#define CHARACTER_MAX_SLIDES 4
+#define CHARACTER_SKIN 0.01f
+// Displacements shorter than this aren't worth a cast
+#define CHARACTER_MIN_MOVE 0.0001f
+#define CHARACTER_DEFAULT_STEP_HEIGHT 0.3f
+#define CHARACTER_DEFAULT_SNAP_DISTANCE 0.3f
+// cos(45 degrees)
+#define CHARACTER_DEFAULT_MIN_GROUND_NORMAL_Y 0.7071f
+
+struct PhysicsWorld;
+
+struct PhysicsCharacter {
+  PhysicsBodyHandle body;
+  // Movement requested since the last physics_character_move
+  vec3 displacement;
+  float step_height;
+  float snap_distance;
+  float min_ground_normal_y;
+  // Ground under the character after its last move
+  bool grounded;
+  vec3 ground_normal;
+};
+
+void physics_character_init(struct PhysicsCharacter *character, PhysicsBodyHandle body);
+void physics_character_add_displacement(struct PhysicsCharacter *character, vec3 displacement);
+bool physics_character_move(struct PhysicsWorld *physics_world, struct PhysicsCharacter *character);
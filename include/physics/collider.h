@@ -5,6 +5,8 @@
 #include "sphere.h"
 #include "capsule.h"
 #include "plane.h"
+#include "obb.h"
+#include "triangle_mesh.h"
 #include "types.h"
 
 // Enum for resolution strategy for colliding PhysicsBodies
@@ -20,6 +22,8 @@ typedef enum {
   COLLIDER_SPHERE,
   COLLIDER_CAPSULE,
   COLLIDER_PLANE,
+  COLLIDER_OBB,
+  COLLIDER_MESH,
   COLLIDER_COUNT
 } ColliderType;
 
@@ -28,6 +32,8 @@ union ColliderData {
   struct Sphere sphere;
   struct Capsule capsule;
   struct Plane plane;
+  struct OBB obb;
+  struct MeshCollider mesh;
 };
 
 struct Collider{
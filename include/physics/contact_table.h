@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cglm/cglm.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Persistent contacts between body pairs, so collision events report changes in contact
+// instead of every step two bodies stay touching:
+// - EVENT_COLLISION_BEGIN the first step a pair collides
+// - EVENT_COLLISION_PERSIST every persist_interval steps while it keeps colliding (0 turns these off)
+// - EVENT_COLLISION_END once it hasn't collided for PHYSICS_CONTACT_END_STEPS steps
+// The grace period keeps a body settling onto the floor, which only reports a contact
+// on some steps, from beginning and ending over and over.
+// Pairs with a sleeping body keep their contact, since they aren't tested while it sleeps.
+//
+// Resolution records each step's colliding pairs, then the table merges them against
+// the contacts it already has. Both are sorted by key, the pair's handles with the lower one first.
+
+#define PHYSICS_CONTACT_END_STEPS 3
+
+struct PhysicsWorld;
+struct PhysicsBody;
+
+struct PhysicsContact {
+  uint64_t key;
+  // Steps the contact began on, last collided on, and last sent PERSIST on
+  uint64_t begin_step;
+  uint64_t last_step;
+  uint64_t persist_step;
+  // Impulses the solver accumulated on the last step the contact collided, for warm starting.
+  // tangent_impulse is relative to the body with the lower handle
+  float normal_impulse;
+  vec3 tangent_impulse;
+};
+
+struct PhysicsContactList {
+  struct PhysicsContact *contacts;
+  unsigned int num_contacts;
+  unsigned int max_contacts;
+};
+
+struct PhysicsContactTable {
+  // Pairs that collided this step, the persistent contacts, and scratch for merging them
+  struct PhysicsContactList step;
+  struct PhysicsContactList contacts;
+  struct PhysicsContactList merged;
+  unsigned int persist_interval;
+};
+
+void physics_contact_table_free(struct PhysicsContactTable *table);
+struct PhysicsContact *physics_contact_table_record(struct PhysicsContactTable *table, struct PhysicsBody *body_A, struct PhysicsBody *body_B, uint64_t step);
+struct PhysicsContact *physics_contact_table_find(struct PhysicsContactTable *table, uint64_t key);
+void physics_contact_table_update(struct PhysicsWorld *physics_world);
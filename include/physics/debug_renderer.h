@@ -8,13 +8,15 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
 
 // Init functions
 void physics_debug_renderer_init(struct PhysicsWorld *physics_world);
-void physics_debug_AABB_init(struct PhysicsBody *body);
-void physics_debug_sphere_init(struct PhysicsBody *body);
-void physics_debug_capsule_init(struct PhysicsBody *body);
-void physics_debug_plane_init(struct PhysicsBody *body);
+void physics_debug_AABB_init(struct PhysicsBody *body, struct PhysicsBodyCold *cold);
+void physics_debug_sphere_init(struct PhysicsBody *body, struct PhysicsBodyCold *cold);
+void physics_debug_capsule_init(struct PhysicsBody *body, struct PhysicsBodyCold *cold);
+void physics_debug_plane_init(struct PhysicsBody *body, struct PhysicsBodyCold *cold);
+void physics_debug_OBB_init(struct PhysicsBody *body, struct PhysicsBodyCold *cold);
 
 // Render functions
 void physics_debug_AABB_render(struct AABB *aabb, struct RenderContext *context, mat4 model);
 void physics_debug_sphere_render(struct Sphere *sphere, struct RenderContext *context, mat4 model);
 void physics_debug_capsule_render(struct Capsule *capsule, struct RenderContext *context, mat4 model);
 void physics_debug_plane_render(struct Plane *plane, struct RenderContext *context, mat4 model);
+void physics_debug_OBB_render(struct OBB *obb, struct RenderContext *context);
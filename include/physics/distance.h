@@ -8,12 +8,13 @@
 // different types of volumes. I didn't want a huge switch statement, and it turns out
 // you can do this in C!
 
-#define NUM_COLLIDER_TYPES 4
+#define NUM_COLLIDER_TYPES COLLIDER_COUNT
 
 typedef float (*DistanceFunction)(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
 
 // Move table definition to distance.c, but put an extern here.
-// Do this for static things in other files too
+// Do this for static things in other files too.
+// Pairs without an entry use gjk_body_distance
 extern DistanceFunction distance_functions[NUM_COLLIDER_TYPES][NUM_COLLIDER_TYPES];
 
 // Minimum distance functions
@@ -22,7 +23,10 @@ float min_dist_at_time_AABB_sphere(struct PhysicsBody *body_A, struct PhysicsBod
 float min_dist_at_time_AABB_capsule(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
 float min_dist_at_time_AABB_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
 float min_dist_at_time_sphere_sphere(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
-float min_dist_at_time_sphere_capsule(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
 float min_dist_at_time_sphere_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
-float min_dist_at_time_capsule_capsule(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
 float min_dist_at_time_capsule_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
+float min_dist_at_time_AABB_OBB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
+float min_dist_at_time_sphere_OBB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
+float min_dist_at_time_plane_OBB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
+float min_dist_at_time_OBB_OBB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
+float min_dist_at_time_convex_mesh(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
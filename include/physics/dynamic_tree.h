@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cglm/cglm.h>
+#include <stdbool.h>
+#include "aabb.h"
+
+// Dynamic bounding volume tree for the broad phase.
+// Leaves hold "fat" AABBs (the body's bounds grown by a margin), so a body
+// only needs to be reinserted once it moves outside of its fat AABB.
+// Internal nodes always bound their two children.
+// Nodes live in a single growable array and are referenced by index,
+// so reallocating the pool never invalidates proxy ids.
+
+#define DYNAMIC_TREE_NULL_NODE -1
+
+// Margin added to every leaf AABB on each axis
+#define DYNAMIC_TREE_AABB_MARGIN 0.1f
+
+// Multiplier for the displacement a body is predicted to move over a step
+#define DYNAMIC_TREE_DISPLACEMENT_MULTIPLIER 2.0f
+
+struct DynamicTreeNode {
+  struct AABB aabb;
+
+  // Leaf payload (a PhysicsBody, for the PhysicsWorld)
+  void *user_data;
+
+  // parent doubles as the next pointer for the free list
+  int parent;
+  int left;
+  int right;
+
+  // Leaves have height 0, free nodes have height -1
+  int height;
+};
+
+struct DynamicTree {
+  struct DynamicTreeNode *nodes;
+  int root;
+  int num_nodes;
+  int max_nodes;
+  int free_list;
+};
+
+// Called for every leaf whose fat AABB overlaps the query AABB.
+// Return false to stop the query early.
+typedef bool (*DynamicTreeQueryCallback)(int proxy_id, void *user_data, void *context);
+
+// Called for every leaf whose fat AABB the cast reaches before max_fraction.
+// Return the fraction to clip the cast to (the hit's, for a closest hit query),
+// max_fraction to carry on as before, or 0 to stop
+typedef float (*DynamicTreeRayCastCallback)(int proxy_id, void *user_data, float max_fraction, void *context);
+
+bool dynamic_tree_init(struct DynamicTree *tree);
+void dynamic_tree_free(struct DynamicTree *tree);
+
+int dynamic_tree_create_proxy(struct DynamicTree *tree, struct AABB *aabb, void *user_data);
+void dynamic_tree_destroy_proxy(struct DynamicTree *tree, int proxy_id);
+bool dynamic_tree_move_proxy(struct DynamicTree *tree, int proxy_id, struct AABB *aabb, vec3 displacement);
+
+void *dynamic_tree_get_user_data(struct DynamicTree *tree, int proxy_id);
+void dynamic_tree_set_user_data(struct DynamicTree *tree, int proxy_id, void *user_data);
+struct AABB *dynamic_tree_get_fat_AABB(struct DynamicTree *tree, int proxy_id);
+
+void dynamic_tree_query(struct DynamicTree *tree, struct AABB *aabb, DynamicTreeQueryCallback callback, void *context);
+// Cast a box with half size extents (zero for a ray) from origin to origin + translation,
+// visiting the leaves it passes through in roughly near to far order
+void dynamic_tree_ray_cast(struct DynamicTree *tree, vec3 origin, vec3 translation, vec3 extents, float max_fraction, DynamicTreeRayCastCallback callback, void *context);
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cglm/cglm.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "collider.h"
+#include "body_handle.h"
+
+// Generic convex collision with GJK and EPA.
+// Colliders are described to GJK by a support function over a convex core, plus a radius
+// around that core: spheres are a point, capsules a segment, AABBs and OBBs a box with no radius.
+// GJK finds the distance between the two cores and the radii are taken off afterwards,
+// so rounded shapes converge fast and only pairs whose cores overlap need EPA
+// for their penetration depth. Planes are unbounded, so they're tested as half spaces.
+//
+// Any pair without an entry in the narrow phase, distance or resolution tables
+// goes through here, so a new collider type only needs a support function.
+//
+// Each pair keeps the simplex GJK ended on last step, as the search directions that
+// produced its vertices. Re-evaluating those directions rebuilds the same features
+// wherever the shapes have moved to, so a pair that has barely moved usually
+// terminates in one or two iterations.
+
+#define GJK_MAX_ITERATIONS 32
+#define GJK_TOLERANCE 0.0001f
+#define EPA_MAX_ITERATIONS 32
+#define EPA_TOLERANCE 0.0001f
+#define EPA_MAX_VERTICES (EPA_MAX_ITERATIONS + 4)
+#define EPA_MAX_FACES (2 * EPA_MAX_VERTICES)
+
+struct PhysicsBody;
+
+// A collider as GJK sees it, in world space
+struct ConvexShape {
+  ColliderType type;
+  union ColliderData data;
+  float radius;
+};
+
+// Furthest point of the shape's core in a direction
+typedef void (*SupportFunction)(struct ConvexShape *shape, vec3 direction, vec3 dest);
+
+extern SupportFunction support_functions[COLLIDER_COUNT];
+
+// State from a pair's last GJK run. axis is the closest point of the
+// Minkowski difference A - B to the origin, so it points from B towards A.
+// directions are the searches that found the final simplex's vertices
+struct GJKCache {
+  vec3 axis;
+  vec3 directions[3];
+  unsigned int num_directions;
+  bool valid;
+};
+
+struct GJKResult {
+  // Between the full shapes, radii included. Negative when they overlap
+  float distance;
+  // Unit contact normal from A to B
+  vec3 normal;
+  // Closest points on each shape, or the deepest points when they overlap
+  vec3 point_A;
+  vec3 point_B;
+  unsigned int iterations;
+};
+
+// Caches carried between steps, keyed by the pair's body handles.
+// Open addressing, key 0 marks an empty entry (handles are never 0)
+struct GJKCacheEntry {
+  uint64_t key;
+  struct GJKCache cache;
+};
+
+struct GJKCacheTable {
+  struct GJKCacheEntry *entries;
+  unsigned int capacity;
+  unsigned int num_entries;
+};
+
+void support_AABB(struct ConvexShape *shape, vec3 direction, vec3 dest);
+void support_sphere(struct ConvexShape *shape, vec3 direction, vec3 dest);
+void support_capsule(struct ConvexShape *shape, vec3 direction, vec3 dest);
+void support_OBB(struct ConvexShape *shape, vec3 direction, vec3 dest);
+
+void convex_shape_from_body(struct PhysicsBody *body, float time, struct ConvexShape *dest);
+struct GJKResult gjk_distance(struct ConvexShape *shape_A, struct ConvexShape *shape_B, struct GJKCache *cache);
+float gjk_body_distance(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
+
+// Cache table. Caches are stored relative to the body with the lower handle as A
+void gjk_cache_flip(struct GJKCache *cache);
+uint64_t gjk_cache_key(PhysicsBodyHandle handle_A, PhysicsBodyHandle handle_B);
+bool gjk_cache_table_find(struct GJKCacheTable *table, uint64_t key, struct GJKCache *dest);
+bool gjk_cache_table_insert(struct GJKCacheTable *table, uint64_t key, struct GJKCache *cache);
+void gjk_cache_table_clear(struct GJKCacheTable *table);
+void gjk_cache_table_free(struct GJKCacheTable *table);
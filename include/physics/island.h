@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+
+// Sleep management.
+// Dynamic bodies whose speed stays under SLEEP_VELOCITY_THRESHOLD for SLEEP_STEPS steps
+// go to sleep: they stop integrating, stop refitting their broad phase proxies,
+// and stop generating pairs of their own. Awake bodies still find them in the broad phase,
+// and a contact with one wakes it.
+//
+// Each step, dynamic bodies are grouped into islands with union-find over this step's contacts,
+// starting from the sleeping islands kept from earlier steps. An island only sleeps when every
+// member is ready to, and a contact with any member wakes all of them.
+// A step with nothing awake and no contacts skips the stage entirely.
+
+#define SLEEP_VELOCITY_THRESHOLD 0.05f
+#define SLEEP_STEPS 30
+
+struct PhysicsWorld;
+struct PhysicsBody;
+
+struct IslandSleeper {
+  unsigned int island_id;
+  unsigned int body_index;
+};
+
+// Arrays indexed by dynamic body, grown to fit. parent holds the sleeping islands between steps,
+// the rest is scratch
+struct PhysicsIslands {
+  int *parent;
+  unsigned int *min_sleep_counter;
+  unsigned char *flags;
+  struct IslandSleeper *sleepers;
+  unsigned int capacity;
+  unsigned int next_island_id;
+  // Dynamic bodies were added or removed, so parent no longer lines up with dynamic_bodies
+  bool dirty;
+};
+
+void physics_islands_free(struct PhysicsIslands *islands);
+
+// Pipeline stage, runs after resolution so sleep counters see the resolved velocities
+void physics_update_islands(struct PhysicsWorld *physics_world, float delta_time);
+
+bool physics_body_is_awake(struct PhysicsBody *body);
+void physics_body_wake(struct PhysicsBody *body);
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Collision filtering by layer.
+// Every body has a layer bitmask, and a collision mask of the layers it collides with.
+// The world keeps a symmetric layer matrix, one row of bits per layer, and a body's collision
+// mask is the rows of its layers OR'd together. Since the matrix is symmetric,
+// A collides with B exactly when (A's layer & B's mask) is nonzero, so pairs are
+// filtered with a single AND when they're pushed, before time of impact or any distance math.
+//
+// The first layers are the entity types ("grouping", "world", "item", "player"),
+// and bodies start out on their entity type's layer. Every layer collides with every other
+// until a scene turns pairs off (see scene_process_collision_layers_json).
+
+#define PHYSICS_MAX_LAYERS 32
+#define PHYSICS_LAYER_NAME_LENGTH 32
+#define PHYSICS_NULL_LAYER -1
+
+struct PhysicsLayers {
+  char names[PHYSICS_MAX_LAYERS][PHYSICS_LAYER_NAME_LENGTH];
+  // Bit j of row i is set when layer i collides with layer j
+  uint32_t matrix[PHYSICS_MAX_LAYERS];
+  unsigned int num_layers;
+};
+
+void physics_layers_init(struct PhysicsLayers *layers);
+int physics_layers_add(struct PhysicsLayers *layers, const char *name);
+int physics_layers_find(struct PhysicsLayers *layers, const char *name);
+void physics_layers_set_collision(struct PhysicsLayers *layers, int layer_A, int layer_B, bool collides);
+uint32_t physics_layers_mask(struct PhysicsLayers *layers, uint32_t layer_bits);
@@ -4,19 +4,22 @@
 #include <stdbool.h>
 #include "physics/world.h"
 
-#define NUM_COLLIDER_TYPES 4
+#define NUM_COLLIDER_TYPES COLLIDER_COUNT
 
 struct CollisionResult {
   float hit_time;
   float penetration;
   vec3 point_of_contact;
+  // Contact normal from A to B, only filled in by narrow_phase_gjk and the OBB and mesh tests
+  vec3 normal;
   bool colliding;
 };
 
 typedef struct CollisionResult (*NarrowPhaseFunction)(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float delta_time);
 
 // Move table definition to distance.c, but put an extern here.
-// Do this for static things in other files too
+// Do this for static things in other files too.
+// Pairs against a mesh use narrow_phase_convex_mesh, and pairs without an entry use narrow_phase_gjk
 extern NarrowPhaseFunction narrow_phase_functions[NUM_COLLIDER_TYPES][NUM_COLLIDER_TYPES];
 
 struct CollisionResult narrow_phase_AABB_AABB(struct PhysicsBody *body_AABB_A, struct PhysicsBody *body_AABB_B, float delta_time);
@@ -24,10 +27,15 @@ struct CollisionResult narrow_phase_AABB_sphere(struct PhysicsBody *body_AABB, s
 struct CollisionResult narrow_phase_AABB_capsule(struct PhysicsBody *body_AABB, struct PhysicsBody *body_capsule, float delta_time);
 struct CollisionResult narrow_phase_AABB_plane(struct PhysicsBody *body_AABB, struct PhysicsBody *body_plane, float delta_time);
 struct CollisionResult narrow_phase_sphere_sphere(struct PhysicsBody *body_sphere_A, struct PhysicsBody *body_sphere_B, float delta_time);
-struct CollisionResult narrow_phase_sphere_capsule(struct PhysicsBody *body_sphere, struct PhysicsBody *body_capsule, float delta_time);
 struct CollisionResult narrow_phase_sphere_plane(struct PhysicsBody *body_sphere, struct PhysicsBody *body_plane, float delta_time);
-struct CollisionResult narrow_phase_capsule_capsule(struct PhysicsBody *body_capsule_A, struct PhysicsBody *body_capsule_B, float delta_time);
 struct CollisionResult narrow_phase_capsule_plane(struct PhysicsBody *body_capsule, struct PhysicsBody *body_plane, float delta_time);
+struct CollisionResult narrow_phase_AABB_OBB(struct PhysicsBody *body_AABB, struct PhysicsBody *body_OBB, float delta_time);
+struct CollisionResult narrow_phase_sphere_OBB(struct PhysicsBody *body_sphere, struct PhysicsBody *body_OBB, float delta_time);
+struct CollisionResult narrow_phase_plane_OBB(struct PhysicsBody *body_plane, struct PhysicsBody *body_OBB, float delta_time);
+struct CollisionResult narrow_phase_OBB_OBB(struct PhysicsBody *body_OBB_A, struct PhysicsBody *body_OBB_B, float delta_time);
+struct CollisionResult narrow_phase_convex_mesh(struct PhysicsBody *body_convex, struct PhysicsBody *body_mesh, float hit_time, float delta_time);
+struct CollisionResult narrow_phase_gjk(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct GJKCache *cache, float hit_time, float delta_time);
 
 // Helper tests
 bool ray_intersect_AABB(vec3 p, vec3 d, struct AABB *e, float *hit_time, float end_time);
+bool sweep_OBB_OBB(struct OBB *a, struct OBB *b, vec3 rel_v, float end_time, float *hit_time, vec3 normal);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cglm/cglm.h>
+#include <stdbool.h>
+#include "aabb.h"
+#include "sphere.h"
+#include "plane.h"
+
+// Oriented bounding box: a center, three orthonormal axes and the half extents along them.
+// Rotating an AABB's extents into world space (AABB_update) gives a box that grows
+// with the rotation and reports contacts in its empty corners; an OBB keeps the
+// rotation instead, so narrow phase tests are exact.
+// The broad phase still works on the AABB fitted around it (OBB_to_AABB).
+struct OBB {
+  vec3 center;
+  vec3 axes[3];
+  vec3 extents;
+};
+
+// 3 face normals per box and the cross products of their edges
+#define OBB_MAX_SEPARATING_AXES 15
+
+// Result of a separating axis test between two boxes.
+// normal is the axis of least penetration (or greatest separation), pointing from A to B
+struct OBBSeparation {
+  float separation;
+  vec3 normal;
+};
+
+void OBB_from_AABB(struct AABB *aabb, struct OBB *dest);
+void OBB_update(struct OBB *src, mat3 rotation, vec3 translation, vec3 scale, struct OBB *dest);
+void OBB_to_AABB(struct OBB *obb, struct AABB *dest);
+void OBB_corner(struct OBB *obb, float sign_x, float sign_y, float sign_z, vec3 dest);
+
+// Helpers
+float OBB_projection_radius(struct OBB *obb, vec3 axis);
+void OBB_closest_point(struct OBB *obb, vec3 point, vec3 dest);
+float OBB_distance_squared_point(struct OBB *obb, vec3 point);
+
+// Collision tests
+int OBB_separating_axes(struct OBB *a, struct OBB *b, vec3 *dest);
+bool OBB_separating_axis(struct OBB *a, struct OBB *b, struct OBBSeparation *dest);
+bool OBB_intersect_OBB(struct OBB *a, struct OBB *b);
+bool OBB_intersect_sphere(struct OBB *obb, struct Sphere *sphere);
+bool OBB_intersect_plane(struct OBB *obb, struct Plane *plane);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include "physics/world.h"
+#include "physics/narrow_phase.h"
+#include "physics/toi.h"
+#include "physics/gjk.h"
+
+// physics_step runs as a sequence of stages over a shared pair buffer:
+// 1. generate_pairs: broad phase writes candidate pairs into physics_world->pairs,
+//    each unordered pair once, skipping pairs filtered out by their collision layers
+// 2. narrow_phase: time of impact rejects pairs that can't touch this step,
+//    then narrow phase tests fill each pair's result. Runs split across
+//    physics_world->worker_pool, and colliding pairs are collected into
+//    physics_world->contacts in pair buffer order
+// 3. resolve: colliding pairs are solved together as contact constraints (see physics/solver.h)
+//    and recorded in the contact table, which emits game events as contacts begin
+//    and end (see physics/contact_table.h)
+// 4. islands: contacts group dynamic bodies into islands that sleep and wake together
+// 5. integrate: velocity is applied to player and awake dynamic bodies. The solver applies
+//    gravity itself, physics_integrate_bodies also applies it for physics_resolve_pairs
+// 6. triggers: player bodies are tested against trigger volumes where they ended up,
+//    emitting enter/exit events (see physics/trigger.h)
+// Each stage is a function pointer in physics_world->pipeline, so any one of them
+// can be swapped out, and physics_step times each one into physics_world->step_stats.
+
+struct CollisionPair {
+  // Ordered by collider type for the function tables
+  struct PhysicsBody *body_A;
+  struct PhysicsBody *body_B;
+  struct CollisionResult result;
+  // Time of impact and the iterations it took, for profiling
+  struct TOIResult toi;
+  // Simplex and axis carried over from last step, for pairs that go through GJK
+  struct GJKCache gjk_cache;
+};
+
+// Pair buffer
+bool physics_push_pair(struct PhysicsWorld *physics_world, struct PhysicsBody *body_A, struct PhysicsBody *body_B);
+bool physics_body_is_player(struct PhysicsWorld *physics_world, struct PhysicsBody *body);
+bool physics_contact_buffer_push(struct PhysicsContactBuffer *buffer, unsigned int pair_index);
+
+// Pair generation stages, one per broad phase
+void physics_generate_pairs_brute_force(struct PhysicsWorld *physics_world, float delta_time);
+void physics_generate_pairs_dynamic_tree(struct PhysicsWorld *physics_world, float delta_time);
+void physics_generate_pairs_sweep_and_prune(struct PhysicsWorld *physics_world, float delta_time);
+
+// Default stages
+void physics_narrow_phase_pairs(struct PhysicsWorld *physics_world, float delta_time);
+void physics_resolve_pairs(struct PhysicsWorld *physics_world, float delta_time);
+void physics_integrate_bodies(struct PhysicsWorld *physics_world, float delta_time);
+void physics_integrate_positions(struct PhysicsWorld *physics_world, float delta_time);
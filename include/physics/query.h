@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cglm/cglm.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "body_handle.h"
+#include "aabb.h"
+#include "sphere.h"
+#include "capsule.h"
+
+// Scene queries for game code: what a ray or a moving shape hits, and what overlaps a shape,
+// e.g. a third person camera sphere casting back from the player, or hitscan weapons.
+//
+// Casts go from where the shape starts along direction for max_distance. Hits report the body's
+// handle, the point of contact, the surface normal there (facing back against the cast), and
+// how far along the cast they are as a fraction of max_distance.
+//
+// Candidates come from the broad phase tree when the world uses BROAD_PHASE_DYNAMIC_TREE:
+// the cast walks the tree near to far and clips itself at every hit it keeps, so a closest hit
+// query only tests bodies in front of the best hit so far. Tree proxies are updated by physics_step,
+// so a body added since the last step isn't found until the next one. Other broad phases
+// have no structure to walk, so every body's AABB is tested instead.
+//
+// Rays against AABBs, spheres and planes are solved directly and meshes walk their BVH.
+// Everything else, and every shape cast, advances conservatively with GJK like time of impact.
+// A shape that starts out touching a body only hits it if it's moving further in, at fraction 0,
+// so a character standing on the floor can cast along it. A ray that starts inside a body never hits it.
+// Trigger volumes are never hit.
+
+#define PHYSICS_QUERY_ALL_LAYERS 0xFFFFFFFFu
+
+struct PhysicsWorld;
+
+// Bodies on none of layer_mask's layers are skipped, and so is ignore
+// (e.g. the player's own body for its camera). A NULL filter skips nothing
+struct PhysicsQueryFilter {
+  uint32_t layer_mask;
+  PhysicsBodyHandle ignore;
+};
+
+struct PhysicsQueryHit {
+  PhysicsBodyHandle handle;
+  vec3 point;
+  vec3 normal;
+  float fraction;
+};
+
+// Closest hit, false if the cast hit nothing
+bool physics_raycast(struct PhysicsWorld *physics_world, vec3 origin, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hit);
+bool physics_sphere_cast(struct PhysicsWorld *physics_world, struct Sphere *sphere, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hit);
+bool physics_capsule_cast(struct PhysicsWorld *physics_world, struct Capsule *capsule, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hit);
+
+// Every body hit along the cast, closest first. Returns the number of hits written,
+// which are the closest max_hits if there were more
+unsigned int physics_raycast_all(struct PhysicsWorld *physics_world, vec3 origin, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hits, unsigned int max_hits);
+unsigned int physics_sphere_cast_all(struct PhysicsWorld *physics_world, struct Sphere *sphere, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hits, unsigned int max_hits);
+unsigned int physics_capsule_cast_all(struct PhysicsWorld *physics_world, struct Capsule *capsule, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hits, unsigned int max_hits);
+
+// Bodies overlapping a shape, in no particular order. Returns the number of handles written,
+// at most max_handles
+unsigned int physics_overlap_sphere(struct PhysicsWorld *physics_world, struct Sphere *sphere, struct PhysicsQueryFilter *filter, PhysicsBodyHandle *handles, unsigned int max_handles);
+unsigned int physics_overlap_capsule(struct PhysicsWorld *physics_world, struct Capsule *capsule, struct PhysicsQueryFilter *filter, PhysicsBodyHandle *handles, unsigned int max_handles);
+unsigned int physics_overlap_AABB(struct PhysicsWorld *physics_world, struct AABB *aabb, struct PhysicsQueryFilter *filter, PhysicsBodyHandle *handles, unsigned int max_handles);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cglm/cglm.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sequential impulse contact solver, the default resolve stage.
+// Instead of resolving each pair on its own, every colliding pair becomes a contact constraint
+// and the whole set is solved together over a number of iterations, so a body in a stack
+// sees the push from the bodies above and below it in the same step.
+//
+// Bodies only have linear velocity and no mass, so a pair's manifold is a single point
+// with a normal and separation, and every moving body has an inverse mass of 1.
+// Each constraint keeps the impulse it has accumulated, clamped so it only ever pushes,
+// plus friction clamped to SOLVER_FRICTION times that. Accumulated impulses are stored
+// in the contact table at the end of the step and applied up front the next step (warm starting),
+// so a resting stack starts out already balanced and settles in a few steps.
+//
+// Contacts are built at the start of the step. Pairs still apart get a speculative contact
+// that lets them close the gap within the step but no further. Overlapping pairs are pushed apart
+// by SOLVER_BAUMGARTE of their penetration past SOLVER_SLOP per step. Only velocities change,
+// integration moves the bodies as usual.
+//
+// Gravity goes into velocities before solving, so a resting body ends the step with no velocity
+// and the island stage can put it to sleep. That makes the solver pair with
+// physics_integrate_positions. The old per-pair resolution is still there as physics_resolve_pairs,
+// which goes with physics_integrate_bodies.
+
+#define SOLVER_DEFAULT_ITERATIONS 8
+#define SOLVER_BAUMGARTE 0.2f
+#define SOLVER_SLOP 0.005f
+#define SOLVER_FRICTION 0.5f
+// Approach speeds under this don't bounce, so resting contacts don't jitter
+#define SOLVER_RESTITUTION_THRESHOLD 1.0f
+
+struct PhysicsWorld;
+struct PhysicsBody;
+
+struct SolverContact {
+  struct PhysicsBody *body_A;
+  struct PhysicsBody *body_B;
+  // 0 for bodies that don't move this step
+  float inverse_mass_A;
+  float inverse_mass_B;
+  // Unit normal from A to B, and the separation along it (negative when overlapping)
+  vec3 normal;
+  float separation;
+  float normal_mass;
+  // Normal velocity the constraint solves for: the speculative gap, penetration recovery or bounce
+  float velocity_bias;
+  float friction;
+  // Accumulated impulses, carried between steps through the contact table
+  float normal_impulse;
+  vec3 tangent_impulse;
+  uint64_t key;
+};
+
+struct PhysicsSolver {
+  struct SolverContact *contacts;
+  unsigned int num_contacts;
+  unsigned int max_contacts;
+  unsigned int iterations;
+};
+
+void physics_solver_free(struct PhysicsSolver *solver);
+
+// Pipeline stage, replaces physics_resolve_pairs
+void physics_solve_contacts(struct PhysicsWorld *physics_world, float delta_time);
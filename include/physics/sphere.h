@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cglm/cglm.h>
+#include "plane.h"
 
 struct Sphere {
   vec3 center;
@@ -10,3 +11,7 @@ struct Sphere {
 bool sphere_intersect_aabb();
 bool sphere_intersect_sphere(struct Sphere *sphere_A, struct Sphere *sphere_B);
 bool sphere_intersect_plane();
+
+// Distance between surfaces, 0 when overlapping
+float sphere_distance_sphere(struct Sphere *sphere_A, struct Sphere *sphere_B);
+float sphere_distance_plane(struct Sphere *sphere, struct Plane *plane);
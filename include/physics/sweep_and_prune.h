@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdbool.h>
+#include "aabb.h"
+
+// Sweep and prune broad phase.
+// Keeps the min and max endpoints of every proxy's AABB sorted on all 3 axes across steps.
+// Bodies rarely move far between steps, so re-sorting with insertion sort is close to linear,
+// and every swap between a min and a max endpoint is exactly where a pair starts or stops overlapping.
+// Overlapping pairs are kept in a persistent set that is updated from those swaps,
+// instead of being rediscovered every step.
+
+#define SAP_NULL_PROXY -1
+
+struct SAPEndpoint {
+  float value;
+  int proxy_id;
+  bool is_max;
+};
+
+struct SAPProxy {
+  struct AABB aabb;
+  void *user_data;
+
+  // Positions of this proxy's endpoints in each axis array
+  unsigned int min_index[3];
+  unsigned int max_index[3];
+
+  // Free proxies are chained through next_free
+  int next_free;
+  bool active;
+};
+
+// An overlapping pair, with proxy_A < proxy_B
+struct SAPPair {
+  int proxy_A;
+  int proxy_B;
+};
+
+struct SweepAndPrune {
+  struct SAPProxy *proxies;
+  int num_proxies;
+  int max_proxies;
+  int free_list;
+
+  struct SAPEndpoint *endpoints[3];
+  unsigned int num_endpoints;
+  unsigned int max_endpoints;
+
+  // Dense pair array for iteration, plus an open addressing table
+  // mapping a pair key to its index in the dense array
+  struct SAPPair *pairs;
+  unsigned int num_pairs;
+  unsigned int max_pairs;
+  int *pair_table;
+  unsigned int pair_table_capacity;
+};
+
+bool sap_init(struct SweepAndPrune *sap);
+void sap_free(struct SweepAndPrune *sap);
+
+int sap_create_proxy(struct SweepAndPrune *sap, struct AABB *aabb, void *user_data);
+void sap_destroy_proxy(struct SweepAndPrune *sap, int proxy_id);
+void sap_move_proxy(struct SweepAndPrune *sap, int proxy_id, struct AABB *aabb);
+void sap_update_pairs(struct SweepAndPrune *sap);
+bool sap_has_pair(struct SweepAndPrune *sap, int proxy_A, int proxy_B);
+
+void *sap_get_user_data(struct SweepAndPrune *sap, int proxy_id);
+void sap_set_user_data(struct SweepAndPrune *sap, int proxy_id, void *user_data);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdbool.h>
+#include "physics/world.h"
+#include "distance.h"
+
+// Time of impact between two bodies over [start_time, end_time].
+// Sphere-sphere and sphere, AABB and OBB against planes are solved in closed form.
+// Every other pair uses conservative advancement: step forward by
+// distance / (upper bound on closing speed), which can never step past first contact,
+// and stop once the bodies are within TOI_TOLERANCE of each other.
+// Advancement is capped at TOI_MAX_ITERATIONS, so the worst case per pair is
+// TOI_MAX_ITERATIONS distance calls no matter how close the bodies rest.
+
+#define TOI_MAX_ITERATIONS 16
+#define TOI_TOLERANCE 0.001f
+
+struct TOIResult {
+  float time;
+  float distance;
+  unsigned int iterations;
+  bool hit;
+};
+
+typedef struct TOIResult (*TOIFunction)(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time);
+
+// Closed form solvers. Pairs without one fall back to toi_conservative_advancement
+extern TOIFunction toi_functions[NUM_COLLIDER_TYPES][NUM_COLLIDER_TYPES];
+
+struct TOIResult time_of_impact(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time);
+struct TOIResult toi_conservative_advancement(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time);
+
+struct TOIResult toi_sphere_sphere(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time);
+struct TOIResult toi_sphere_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time);
+struct TOIResult toi_AABB_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time);
+struct TOIResult toi_plane_OBB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time);
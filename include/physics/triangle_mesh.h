@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cglm/cglm.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "aabb.h"
+
+// Static triangle mesh collider, for level geometry.
+// Triangles come from the same Assimp import as model_load, flattened through the
+// node hierarchy into model space. They're stored once per model file and shared
+// by every body that uses it, with a BVH over them:
+// - nodes are 32 bytes, so two fit in a cache line, and siblings are stored next to each other
+// - triangles are reordered so each leaf covers a contiguous range of them
+// The BVH is written to a cache file next to the model and read back on later loads,
+// as long as the model file's size and modification time haven't changed.
+//
+// Queries take a sphere, capsule or box in world space, move it into the mesh's space
+// and walk the BVH nearest node first, skipping nodes further away than the closest
+// triangle found so far. Casts walk it nearest node first along the cast, clipping it
+// at each triangle it hits: rays against each triangle directly, shapes by advancing
+// conservatively against each triangle on its own.
+
+#define MESH_BVH_MAX_LEAF_TRIANGLES 4
+#define MESH_BVH_STACK_SIZE 64
+#define MESH_BVH_CACHE_EXTENSION ".bvh"
+#define MESH_BVH_CACHE_MAGIC 0x48564258u // "XBVH"
+#define MESH_BVH_CACHE_VERSION 1
+#define MESH_CAST_MAX_ITERATIONS 16
+
+struct ConvexShape;
+
+struct MeshBVHNode {
+  vec3 min;
+  // Leaf: index of its first triangle. Internal: index of its left child,
+  // the right child is first + 1
+  uint32_t first;
+  vec3 max;
+  // Triangles in a leaf, 0 for internal nodes
+  uint32_t count;
+};
+
+struct TriangleMesh {
+  char *path;
+  vec3 *vertices;
+  // 3 vertex indices per triangle, in BVH leaf order
+  uint32_t *indices;
+  struct MeshBVHNode *nodes;
+  unsigned int num_vertices;
+  unsigned int num_triangles;
+  unsigned int num_nodes;
+};
+
+// Collider data: the shared mesh, and in the world collider the transform
+// from the mesh's space to world space. Scale is uniform
+struct MeshCollider {
+  struct TriangleMesh *mesh;
+  mat3 rotation;
+  vec3 translation;
+  float scale;
+};
+
+// Closest (or deepest) contact between a shape and a mesh.
+// distance is negative when they overlap, normal points from the shape to the mesh
+struct MeshContact {
+  float distance;
+  vec3 normal;
+  vec3 point;
+  unsigned int triangle;
+  bool found;
+};
+
+// First triangle a cast hits, fraction is along the cast's translation
+struct MeshCastHit {
+  float fraction;
+  vec3 normal;
+  vec3 point;
+  unsigned int triangle;
+  bool found;
+};
+
+// Loading and building
+struct TriangleMesh *triangle_mesh_load(const char *path);
+bool triangle_mesh_build(struct TriangleMesh *mesh);
+bool triangle_mesh_read_cache(struct TriangleMesh *mesh, const char *cache_path, uint64_t source_size, int64_t source_mtime);
+bool triangle_mesh_write_cache(struct TriangleMesh *mesh, const char *cache_path, uint64_t source_size, int64_t source_mtime);
+void triangle_mesh_free(struct TriangleMesh *mesh);
+void triangle_mesh_bounds(struct TriangleMesh *mesh, struct AABB *dest);
+
+// Queries
+void mesh_collider_identity(struct TriangleMesh *mesh, struct MeshCollider *dest);
+void mesh_collider_bounds(struct MeshCollider *collider, struct AABB *dest);
+bool mesh_collider_contact(struct MeshCollider *collider, struct ConvexShape *shape, struct MeshContact *dest);
+bool mesh_collider_ray_cast(struct MeshCollider *collider, vec3 origin, vec3 translation, float max_fraction, struct MeshCastHit *dest);
+bool mesh_collider_shape_cast(struct MeshCollider *collider, struct ConvexShape *shape, vec3 translation, float max_fraction, float tolerance, struct MeshCastHit *dest);
+
+// Triangle helpers
+void closest_point_on_triangle(vec3 p, vec3 a, vec3 b, vec3 c, vec3 dest);
+float closest_points_segment_segment(vec3 p1, vec3 q1, vec3 p2, vec3 q2, vec3 c1, vec3 c2);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dynamic_tree.h"
+
+// Trigger volumes, e.g. item pickups.
+// Trigger bodies live in their own array and their own dynamic tree, outside the pair buffer,
+// so they never go through time of impact, the narrow phase or resolution.
+// Once per step, after integration, each player body queries the trigger tree with its AABB,
+// and only the triggers it returns get a discrete overlap test. Triggers a player's bounds
+// don't reach cost nothing, however many there are.
+//
+// This step's overlaps are compared against last step's to emit
+// EVENT_TRIGGER_ENTER when a player starts overlapping a trigger and EVENT_TRIGGER_EXIT
+// when it stops. Nothing is emitted while an overlap just continues.
+//
+// Triggers don't move: their world collider and proxy are built on the first step after they're added.
+
+struct PhysicsWorld;
+
+// Sorted overlap keys, the trigger's handle in the high 32 bits and the player's in the low 32
+struct PhysicsTriggerOverlaps {
+  uint64_t *keys;
+  unsigned int num_keys;
+  unsigned int max_keys;
+};
+
+struct PhysicsTriggers {
+  struct DynamicTree tree;
+  struct PhysicsTriggerOverlaps overlaps;
+  struct PhysicsTriggerOverlaps previous_overlaps;
+  // Set when a trigger is added, so the step knows to look for triggers without a proxy
+  bool pending;
+};
+
+bool physics_triggers_init(struct PhysicsTriggers *triggers);
+void physics_triggers_free(struct PhysicsTriggers *triggers);
+
+// Pipeline stage, runs after integration so overlaps are tested where bodies end the step
+void physics_update_triggers(struct PhysicsWorld *physics_world, float delta_time);
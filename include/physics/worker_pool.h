@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdbool.h>
+#include "tinycthread/tinycthread.h"
+
+// A fixed pool of worker threads for splitting physics work across cores.
+// physics_worker_pool_run splits [0, num_items) into one contiguous range per worker,
+// in worker order, with the calling thread taking worker index 0.
+// It blocks until every range is done, so a job can write per-worker output
+// and the caller can merge it in worker order without depending on thread timing.
+
+#define PHYSICS_MAX_WORKER_THREADS 15
+
+typedef void (*PhysicsJobFunction)(void *context, int worker_index, unsigned int begin, unsigned int end);
+
+struct PhysicsWorkerPool;
+
+struct PhysicsWorker {
+  struct PhysicsWorkerPool *pool;
+  int index;
+  unsigned int begin;
+  unsigned int end;
+  // Last job generation this worker picked up. Set before the thread starts,
+  // so a job posted before the thread first takes the mutex isn't missed
+  unsigned int seen_generation;
+};
+
+struct PhysicsWorkerPool {
+  thrd_t threads[PHYSICS_MAX_WORKER_THREADS];
+  struct PhysicsWorker workers[PHYSICS_MAX_WORKER_THREADS];
+  int num_threads;
+
+  mtx_t mutex;
+  cnd_t work_ready;
+  cnd_t work_done;
+
+  // Current job. generation is bumped once per job so workers can tell a new one apart
+  PhysicsJobFunction function;
+  void *context;
+  unsigned int generation;
+  int pending;
+  bool shutdown;
+};
+
+int physics_worker_pool_default_threads();
+struct PhysicsWorkerPool *physics_worker_pool_create(int num_threads);
+void physics_worker_pool_destroy(struct PhysicsWorkerPool *pool);
+
+// Worker threads plus the calling thread
+int physics_worker_pool_num_workers(struct PhysicsWorkerPool *pool);
+void physics_worker_pool_run(struct PhysicsWorkerPool *pool, PhysicsJobFunction function, void *context, unsigned int num_items);
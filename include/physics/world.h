@@ -4,19 +4,146 @@
 #include <cglm/cglm.h>
 #include <stdbool.h>
 #include "collider.h"
+#include "dynamic_tree.h"
+#include "sweep_and_prune.h"
+#include "worker_pool.h"
+#include "island.h"
+#include "body_handle.h"
+#include "gjk.h"
+#include "layers.h"
+#include "trigger.h"
+#include "contact_table.h"
+#include "solver.h"
+#include "batch.h"
+#include "types.h"
+
+// Broad phase strategy used by physics_step.
+// - BROAD_PHASE_BRUTE_FORCE: test every player/dynamic body's swept AABB against every other body's,
+//   a batch of candidates at a time (see physics/batch.h)
+// - BROAD_PHASE_DYNAMIC_TREE: only test bodies whose fat swept AABBs overlap in the world's tree
+// - BROAD_PHASE_SWEEP_AND_PRUNE: test the persistent overlap pairs kept by sorted endpoint lists,
+//   best for wide, flat levels with lots of bodies spread across the floor
+typedef enum {
+  BROAD_PHASE_BRUTE_FORCE = 0,
+  BROAD_PHASE_DYNAMIC_TREE,
+  BROAD_PHASE_SWEEP_AND_PRUNE,
+  BROAD_PHASE_COUNT
+} BroadPhaseType;
+
+struct PhysicsWorld;
+struct CollisionPair;
+
+// A stage of physics_step, see physics/pipeline.h
+typedef void (*PhysicsStage)(struct PhysicsWorld *physics_world, float delta_time);
+
+struct PhysicsPipeline {
+  PhysicsStage generate_pairs;
+  PhysicsStage narrow_phase;
+  PhysicsStage resolve;
+  PhysicsStage islands;
+  PhysicsStage integrate;
+  PhysicsStage triggers;
+};
+
+// Timings (milliseconds) and counts from the last physics_step
+struct PhysicsStepStats {
+  double generate_pairs_ms;
+  double narrow_phase_ms;
+  double resolve_ms;
+  double islands_ms;
+  double integrate_ms;
+  double triggers_ms;
+  unsigned int num_pairs;
+  unsigned int num_collisions;
+  // Time of impact iterations summed over all pairs, and the most any one pair took
+  unsigned int toi_iterations;
+  unsigned int max_toi_iterations;
+  // Islands with an awake member, and dynamic bodies asleep after the step
+  unsigned int num_islands;
+  unsigned int num_sleeping_bodies;
+  // Player-trigger pairs overlapping after the step
+  unsigned int num_trigger_overlaps;
+};
+
+// Indices into the pair buffer of pairs that collided this step.
+// Each narrow phase worker fills its own, and they're merged in worker order
+struct PhysicsContactBuffer {
+  unsigned int *pair_indices;
+  unsigned int num_contacts;
+  unsigned int max_contacts;
+  unsigned int toi_iterations;
+  unsigned int max_toi_iterations;
+};
+
+// World space collider, rebuilt once per step.
+// origin is the body's position when it was built, so the shape can follow
+// the body through the step without re-deriving it from transforms.
+struct WorldCollider {
+  union ColliderData data;
+  vec3 origin;
+};
+
+// Which array a body lives in
+typedef enum {
+  PHYSICS_BODY_STATIC = 0,
+  PHYSICS_BODY_DYNAMIC,
+  PHYSICS_BODY_PLAYER,
+  PHYSICS_BODY_TRIGGER,
+  PHYSICS_BODY_CATEGORY_COUNT
+} PhysicsBodyCategory;
+
+// Handle slot, maps a handle to where its body currently lives.
+// Free slots are chained through next_free
+struct PhysicsBodySlot {
+  unsigned int index;
+  unsigned int generation;
+  PhysicsBodyCategory category;
+  int next_free;
+  bool active;
+};
 
 struct PhysicsBody {
-  // Collision
-  struct Collider collider;
+  // Hot simulation state, kept at the front so integration touches one cache line per body
   vec3 position;
-  vec3 rotation;
-  vec3 scale;
   vec3 velocity;
   float restitution;
-
   bool dynamic;
   bool at_rest;
+  bool sleeping;
+  // Steps spent under the sleep threshold, and the island the body fell asleep in
+  unsigned int sleep_counter;
+  unsigned int island_id;
+
+  // Collision
+  // Layer bits and the layers they collide with, see physics/layers.h
+  uint32_t collision_layer;
+  uint32_t collision_mask;
+  struct Collider collider;
+  struct WorldCollider world_collider;
+  versor rotation;
+  vec3 scale;
+
+  // State before the last step, for render interpolation
+  vec3 previous_position;
+  versor previous_rotation;
+
+  // Broad phase, proxies store the body's handle as their user data.
+  // A trigger's proxy_id is in the trigger tree instead of the broad phase tree
+  int proxy_id;
+  int sap_proxy_id;
+
+  // This body's own handle, so a body found by array index can be referred to stably
+  PhysicsBodyHandle handle;
+
+  // Type of the associated entity, copied when the body is added so resolution
+  // can pick a collision behavior without following the entity pointer
+  EntityType entity_type;
+};
 
+// Cold per-body data, only touched by events, world collider rebuilds and the debug renderer.
+// Kept in arrays parallel to the body arrays (same index, moved alongside the body)
+// so the bodies the stages iterate stay small
+struct PhysicsBodyCold {
   // Associated entity
   struct Entity *entity;
   struct SceneNode *scene_node;
@@ -29,22 +156,121 @@ struct PhysicsWorld {
   struct PhysicsBody *static_bodies;
   struct PhysicsBody *dynamic_bodies;
   struct PhysicsBody *player_bodies;
+  struct PhysicsBody *trigger_bodies;
+  // Cold data for each body array, see struct PhysicsBodyCold
+  struct PhysicsBodyCold *static_cold;
+  struct PhysicsBodyCold *dynamic_cold;
+  struct PhysicsBodyCold *player_cold;
+  struct PhysicsBodyCold *trigger_cold;
   unsigned int num_static_bodies;
   unsigned int num_dynamic_bodies;
   unsigned int num_player_bodies;
+  unsigned int num_trigger_bodies;
+  // Each array grows by doubling, so memory scales with the number of bodies
+  unsigned int max_static_bodies;
+  unsigned int max_dynamic_bodies;
+  unsigned int max_player_bodies;
+  unsigned int max_trigger_bodies;
+
+  // Handle slots
+  struct PhysicsBodySlot *body_slots;
+  unsigned int num_body_slots;
+  unsigned int max_body_slots;
+  int free_body_slot;
+
+  // Broad phase
+  BroadPhaseType broad_phase_type;
+  struct DynamicTree tree;
+  struct SweepAndPrune sap;
+  // Swept AABBs for the brute force broad phase, and scratch for batch test results
+  struct AABBBatch static_AABBs;
+  struct AABBBatch dynamic_AABBs;
+  bool *batch_results;
+  unsigned int max_batch_results;
+  // Awake bodies' motion, gathered for integration
+  struct MotionBatch motion_batch;
+
+  // Step pipeline and the pair buffer shared by its stages
+  struct PhysicsPipeline pipeline;
+  struct PhysicsStepStats step_stats;
+  struct CollisionPair *pairs;
+  unsigned int num_pairs;
+  unsigned int max_pairs;
+
+  // Narrow phase workers, their contact buffers, and the merged contacts resolution reads
+  struct PhysicsWorkerPool *worker_pool;
+  struct PhysicsContactBuffer *worker_contacts;
+  int num_worker_contacts;
+  struct PhysicsContactBuffer contacts;
+
+  // Sleep islands
+  struct PhysicsIslands islands;
+
+  // GJK caches from the last step, and the table this step's are written to
+  struct GJKCacheTable gjk_cache;
+  struct GJKCacheTable next_gjk_cache;
+
+  // Triangle meshes loaded for mesh colliders, shared by every body using the same file
+  struct TriangleMesh **meshes;
+  unsigned int num_meshes;
+  unsigned int max_meshes;
+
+  // Collision layer matrix
+  struct PhysicsLayers layers;
+
+  // Trigger volumes, tested against players once per step
+  struct PhysicsTriggers triggers;
+
+  // Contacts carried between steps, so events only go out when they change
+  struct PhysicsContactTable contact_table;
+
+  // Contact constraints for the resolve stage
+  struct PhysicsSolver solver;
+
+  // Steps taken so far, game events are stamped with it
+  uint64_t step_count;
 };
 
 
 // World, bodies
 struct PhysicsWorld *physics_world_create();
-struct PhysicsBody *physics_add_body(struct PhysicsWorld *physics_world, struct SceneNode *scene_node, struct Entity *entity, struct Collider collider, float restitution, bool dynamic);
-struct PhysicsBody *physics_add_player(struct PhysicsWorld *physics_world, struct SceneNode *scene_node, struct Entity *entity, struct Collider collider);
-void physics_remove_body(struct PhysicsWorld *physics_world, struct PhysicsBody *physics_body);
+void physics_world_destroy(struct PhysicsWorld *physics_world);
+PhysicsBodyHandle physics_add_body(struct PhysicsWorld *physics_world, struct SceneNode *scene_node, struct Entity *entity, struct Collider collider, float restitution, bool dynamic);
+PhysicsBodyHandle physics_add_player(struct PhysicsWorld *physics_world, struct SceneNode *scene_node, struct Entity *entity, struct Collider collider);
+PhysicsBodyHandle physics_add_trigger(struct PhysicsWorld *physics_world, struct SceneNode *scene_node, struct Entity *entity, struct Collider collider);
+void physics_remove_body(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle);
+struct PhysicsBody *physics_get_body(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle);
+struct PhysicsBodyCold *physics_get_body_cold(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle);
+bool physics_body_set_dynamic(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle, bool dynamic);
+struct TriangleMesh *physics_load_mesh(struct PhysicsWorld *physics_world, const char *path);
+
+// Collision layers
+bool physics_body_set_layer(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle, int layer);
+void physics_set_layer_collision(struct PhysicsWorld *physics_world, int layer_A, int layer_B, bool collides);
+bool physics_bodies_can_collide(struct PhysicsBody *body_A, struct PhysicsBody *body_B);
 
 void physics_step(struct PhysicsWorld *physics_world, float delta_time);
 void physics_sync_entities(struct PhysicsWorld *physics_world);
+void physics_body_interpolate(struct PhysicsBody *body, float alpha, vec3 position, versor rotation);
+
+// World collider cache
+void physics_update_world_colliders(struct PhysicsWorld *physics_world);
+void physics_body_update_world_collider(struct PhysicsBody *body, struct SceneNode *scene_node);
+void physics_body_world_offset(struct PhysicsBody *body, float time, vec3 dest);
+void physics_body_get_world_AABB(struct PhysicsBody *body, float time, struct AABB *dest);
+void physics_body_get_world_sphere(struct PhysicsBody *body, float time, struct Sphere *dest);
+void physics_body_get_world_capsule(struct PhysicsBody *body, float time, struct Capsule *dest);
+void physics_body_get_world_plane(struct PhysicsBody *body, float time, struct Plane *dest);
+void physics_body_get_world_OBB(struct PhysicsBody *body, float time, struct OBB *dest);
+void physics_body_get_world_mesh(struct PhysicsBody *body, float time, struct MeshCollider *dest);
+
+// Broad phase
+void physics_set_broad_phase(struct PhysicsWorld *physics_world, BroadPhaseType broad_phase_type);
+const char *physics_broad_phase_name(BroadPhaseType broad_phase_type);
+void physics_body_compute_AABB(struct PhysicsBody *body, float time, struct AABB *dest);
+void physics_body_compute_swept_AABB(struct PhysicsBody *body, float delta_time, struct AABB *dest);
 
-bool interval_collision(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time, float *hit_time);
+// Solver, more iterations settle stacks faster at more cost per contact
+void physics_set_solver_iterations(struct PhysicsWorld *physics_world, unsigned int iterations);
 
-float maximum_object_movement_over_time(struct PhysicsBody *body, float start_time, float end_time);
 float minimum_object_distance_at_time(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time);
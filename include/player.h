@@ -9,9 +9,11 @@
 // #include "model.h"
 #include "shader.h"
 #include "types.h"
+#include "entity.h"
+#include "physics/character.h"
 
 struct PlayerComponent {
-  uuid_t entity_id;
+  EntityIndex entity;
   // struct Camera *camera;
   // struct InventoryComponent inventory;
   //
@@ -25,11 +27,13 @@ struct PlayerComponent {
   vec3 rotated_offset;
   bool render_entity;
   bool is_local;
+  // Moves the player's body, once per frame in player_update
+  struct PhysicsCharacter character;
 };
 
 
 struct PlayerComponent *player_create(struct Model *model, Shader *shader, vec3 position, vec3 rotation, vec3 scale, vec3 velocity, vec3 camera_offset, float camera_height, bool render_entity, int inventory_capacity);
-void player_process_keyboard_input(struct Scene *scene, uuid_t entity_id, CameraDirection camera_direction, float delta_time);
-void player_process_mouse_input(struct Scene *scene, uuid_t entity_id, float xoffset, float yoffset);
-void player_jump(struct Scene *scene, uuid_t entity_id);
-void player_update(struct Scene *scene, uuid_t entity_id, float delta_time);
+void player_process_movement_input(struct Scene *scene, EntityIndex entity, float forward, float right, float delta_time);
+void player_process_mouse_input(struct Scene *scene, EntityIndex entity, float xoffset, float yoffset);
+void player_jump(struct Scene *scene, EntityIndex entity);
+void player_update(struct Scene *scene, EntityIndex entity, float delta_time);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+#include "arena.h"
+
+// Fixed-size items with a free list, for things spawned and despawned at runtime (scene nodes, entities).
+// Items come out of blocks of items_per_block carved from an arena, and freed items are threaded
+// onto the free list through their own memory, so once a pool has grown to its working set
+// allocating and freeing are a pointer swap with no malloc.
+// Blocks belong to the arena, so the pool is released along with it.
+
+struct Pool {
+  struct Arena *arena;
+  size_t item_size;
+  unsigned int items_per_block;
+  void *free_list;
+  // Items currently handed out
+  unsigned int num_items;
+};
+
+void pool_init(struct Pool *pool, struct Arena *arena, size_t item_size, unsigned int items_per_block);
+// Zeroed item, or NULL if the arena couldn't grow
+void *pool_alloc(struct Pool *pool);
+void pool_free(struct Pool *pool, void *item);
@@ -5,6 +5,7 @@
 // #include "skybox.h"
 // #include "model.h"
 #include "shader.h"
+#include "entity.h"
 
 // For sorting meshes for multiple rendering passes
 struct RenderItem {
@@ -16,7 +17,7 @@ struct RenderItem {
 };
 
 struct RenderComponent {
-  uuid_t entity_id;
+  EntityIndex entity;
   struct Model *model;
   Shader *shader;
   mat4 world_transform;
@@ -46,4 +47,4 @@ void scene_get_render_items(
 int compare_render_item_depth(const void *a, const void *b);
 
 // RenderComponent
-void render_component_create(struct Scene *scene, uuid_t entity_id, struct Model *model, Shader *shader);
+void render_component_create(struct Scene *scene, EntityIndex entity, struct Model *model, Shader *shader);
@@ -11,6 +11,15 @@
 // #include "camera.h"
 #include "item_registry.h"
 #include "shader.h"
+#include "entity.h"
+#include "component_store.h"
+#include "arena.h"
+#include "pool.h"
+#include "entity_commands.h"
+
+// Fixed timestep physics clock defaults
+#define PHYSICS_DEFAULT_HZ 60.0f
+#define PHYSICS_DEFAULT_MAX_SUBSTEPS 4
 
 typedef enum {
   COMPONENT_RENDER = 0,
@@ -27,17 +36,35 @@ struct Light {
 };
 
 struct SceneNode {
-  uuid_t entity_id;
   unsigned int ID;
   mat4 local_transform;
   mat4 world_transform;
+  // world_transform with physics state interpolated between the last two steps, for rendering.
+  // Physics reads world_transform, never this
+  mat4 render_transform;
   vec3 position;
-  vec3 rotation;
+  versor rotation;
   vec3 scale;
+  // World position, rotation and scale, kept alongside world_transform so physics can read them
+  // without decomposing the matrix. Assumes no shear, i.e. only uniformly scaled nodes have rotated children
+  vec3 world_position;
+  versor world_rotation;
+  vec3 world_scale;
+  // position, rotation or scale changed since the last transform pass, so local_transform is stale
+  bool dirty;
+  // Set by the transform pass when this node's world/render transform was rebuilt, so its children rebuild theirs
+  bool world_changed;
+  bool render_changed;
+  // The node's body moved on the last physics step, so its render transform changes with physics_alpha every frame.
+  // Set by physics_step, along with dirty
+  bool interpolating;
+  // Only used while removing a subtree from the flat array
+  bool removed;
   struct Entity *entity;
   struct SceneNode *parent_node;
   struct SceneNode **children;
   unsigned int num_children;
+  unsigned int max_children;
 };
 
 struct SceneManager {
@@ -45,44 +72,58 @@ struct SceneManager {
 };
 
 struct Scene {
+  // Memory. Load-time data (children arrays, lights) is allocated from the arena,
+  // and nodes, entities and their items from pools in it, so spawning and despawning reuse
+  // pool slots and unloading the scene frees all of it at once
+  struct Arena arena;
+  struct Pool node_pool;
+  struct Pool entity_pool;
+  struct Pool item_pool;
   struct Model **models;
   Shader **shaders;
   int num_models;
   int num_shaders;
   struct SceneNode *root_node;
-  struct Entity *player_entities;
-  struct Entity **entities;
-  unsigned int num_entities;
-  int num_player_entities;
-  int max_entities;
+  // Every node in the graph, each after its parent, so transforms update in one pass over it
+  struct SceneNode **nodes;
+  unsigned int num_nodes;
+  unsigned int max_nodes;
+  // struct Entity *, keyed by the entity's own index
+  struct ComponentStore entities;
+  // Indices of removed entities, reused before new ones
+  EntityIndex *free_entity_indices;
+  unsigned int num_free_entity_indices;
+  unsigned int max_free_entity_indices;
+  EntityIndex next_entity_index;
+  // Structural changes recorded during the frame, applied in scene_update after physics and events
+  struct EntityCommandBuffer commands;
+  // Scratch for scene_remove_entities
+  struct SceneNode **removed_nodes;
+  unsigned int max_removed_nodes;
   struct Skybox *skybox;
   struct Light *lights;
   // UBOs
   unsigned int ubo_matrices;
   // Physics
   struct PhysicsWorld *physics_world;
+  // Fixed timestep clock: physics steps at physics_timestep, up to max_physics_substeps per frame,
+  // and physics_alpha is how far the frame is between the previous and current steps
+  float physics_timestep;
+  unsigned int max_physics_substeps;
+  float physics_accumulator;
+  float physics_alpha;
   // Options
   bool physics_debug_mode;
 
-  // Components
-  struct RenderComponent *render_components;
-  unsigned int num_render_components;
-  unsigned int max_render_components;
-  struct AudioComponent *audio_components;
-  unsigned int num_audio_components;
-  unsigned int max_audio_components;
-  struct CameraComponent *camera_components;
-  unsigned int num_camera_components;
-  unsigned int max_camera_components;
-  struct PlayerComponent *player_components;
-  unsigned int num_player_components;
-  unsigned int max_player_components;
-  struct InventoryComponent *inventory_components;
-  unsigned int num_inventory_components;
-  unsigned int max_inventory_components;
+  // Components, one sparse set per type keyed by EntityIndex
+  struct ComponentStore render_components;
+  struct ComponentStore audio_components;
+  struct ComponentStore camera_components;
+  struct ComponentStore player_components;
+  struct ComponentStore inventory_components;
 
   struct ItemRegistry item_registry;
-  uuid_t local_player_entity_id;
+  EntityIndex local_player_entity;
 };
 
 // SceneManager
@@ -94,13 +135,17 @@ struct Scene *scene_load(const char *scene_path);
 struct Scene *scene_create(bool physics_view_mode);
 
 void scene_update(struct Scene *scene, float deltaTime);
+void scene_set_physics_rate(struct Scene *scene, float hz, unsigned int max_substeps);
 void scene_render(struct Scene *scene);
 void scene_free(struct Scene *scene);
 
 // JSON processing helpers
 void scene_process_light_json(cJSON *light_json, struct Light *light);
+void scene_process_collision_layers_json(cJSON *collision_layers_json, struct PhysicsWorld *physics_world);
 void scene_process_vec3_json(cJSON *vec3_json, vec3 dest);
-void scene_process_node_json(struct Scene *scene, const cJSON *node_json, struct SceneNode *current_node, struct SceneNode *parent_node, struct Model **models, Shader **shaders, struct PhysicsWorld *physics_world);
+void scene_process_rotation_json(cJSON *rotation_json, versor dest);
+void scene_euler_to_quat(vec3 euler_degrees, versor dest);
+void scene_process_node_json(struct Scene *scene, const cJSON *node_json, struct SceneNode *current_node, struct Model **models, Shader **shaders, struct PhysicsWorld *physics_world);
 void scene_process_items_json(struct Scene *scene, const cJSON *items_json);
 
 void scene_player_create(
@@ -118,19 +163,31 @@ void scene_player_create(
   bool is_local);
 
 // SceneNode
-void scene_node_update(struct Scene *scene, struct SceneNode *current_node);
-void scene_node_create(struct Scene *scene, struct Entity *entity, struct SceneNode *parent_node);
-void scene_get_node_by_entity_id(struct SceneNode *current_node, uuid_t entity_id, int *child_index, int *final_child_index, struct SceneNode **dest);
-void scene_remove_scene_node(struct SceneNode *scene_node);
-void scene_remove_entity(struct Scene *scene, uuid_t id);
-struct Entity *scene_get_entity_by_entity_id(struct Scene *scene, uuid_t entity_id);
+void scene_update_transforms(struct Scene *scene);
+void scene_node_set_position(struct SceneNode *scene_node, vec3 position);
+void scene_node_set_rotation(struct SceneNode *scene_node, versor rotation);
+void scene_node_set_rotation_euler(struct SceneNode *scene_node, vec3 euler_degrees);
+void scene_node_set_scale(struct SceneNode *scene_node, vec3 scale);
+struct SceneNode *scene_node_create(struct Scene *scene, struct Entity *entity, struct SceneNode *parent_node);
+void scene_get_node_by_entity(struct SceneNode *current_node, EntityIndex entity, int *child_index, int *final_child_index, struct SceneNode **dest);
+
+// Entities
+struct Entity *scene_entity_create(struct Scene *scene);
+void scene_remove_entity(struct Scene *scene, EntityIndex entity);
+void scene_remove_entities(struct Scene *scene, EntityIndex *entities, unsigned int num_entities);
+struct Entity *scene_get_entity(struct Scene *scene, EntityIndex entity);
+// Linear search, for ids from outside the scene. Use the entity's index for anything else
+struct Entity *scene_find_entity_by_id(struct Scene *scene, uuid_t entity_id);
 
 // Components
-struct RenderComponent *scene_get_render_component_by_entity_id(struct Scene *scene, uuid_t entity_id);
-struct PlayerComponent *scene_get_player_by_entity_id(struct Scene *scene, uuid_t entity_id);
-struct InventoryComponent *scene_get_inventory_by_entity_id(struct Scene *scene, uuid_t entity_id);
-struct CameraComponent *scene_get_camera_by_entity_id(struct Scene *scene, uuid_t entity_id);
-struct AudioComponent *scene_get_audio_component_by_entity_id(struct Scene *scene, uuid_t entity_id);
-
-bool scene_remove_render_component_by_entity_id(struct Scene *scene, uuid_t entity_id);
-bool scene_remove_audio_component_by_entity_id(struct Scene *scene, uuid_t entity_id);
+struct RenderComponent *scene_get_render_component(struct Scene *scene, EntityIndex entity);
+struct PlayerComponent *scene_get_player(struct Scene *scene, EntityIndex entity);
+struct InventoryComponent *scene_get_inventory(struct Scene *scene, EntityIndex entity);
+struct CameraComponent *scene_get_camera(struct Scene *scene, EntityIndex entity);
+struct AudioComponent *scene_get_audio_component(struct Scene *scene, EntityIndex entity);
+
+bool scene_remove_render_component(struct Scene *scene, EntityIndex entity);
+bool scene_remove_camera_component(struct Scene *scene, EntityIndex entity);
+bool scene_remove_player_component(struct Scene *scene, EntityIndex entity);
+bool scene_remove_inventory_component(struct Scene *scene, EntityIndex entity);
+bool scene_remove_audio_component(struct Scene *scene, EntityIndex entity);
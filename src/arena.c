@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_ALIGNMENT _Alignof(max_align_t)
+
+void arena_init(struct Arena *arena, size_t block_size){
+  arena->blocks = NULL;
+  arena->block_size = block_size ? block_size : ARENA_DEFAULT_BLOCK_SIZE;
+}
+
+// Allocations bigger than block_size get a block of their own
+static struct ArenaBlock *arena_add_block(struct Arena *arena, size_t size){
+  size_t block_size = size > arena->block_size ? size : arena->block_size;
+  struct ArenaBlock *block = (struct ArenaBlock *)malloc(sizeof(struct ArenaBlock) + block_size);
+  if (!block){
+    fprintf(stderr, "Error: failed to allocate block in arena_add_block\n");
+    return NULL;
+  }
+  block->size = block_size;
+  block->used = 0;
+
+  // An oversized block goes behind the head, so the rest of the head's space still gets used
+  if (block_size > arena->block_size && arena->blocks){
+    block->next = arena->blocks->next;
+    arena->blocks->next = block;
+  }
+  else{
+    block->next = arena->blocks;
+    arena->blocks = block;
+  }
+  return block;
+}
+
+void *arena_alloc(struct Arena *arena, size_t size){
+  if (size == 0) size = 1;
+  if (size > SIZE_MAX - ARENA_ALIGNMENT){
+    fprintf(stderr, "Error: allocation of %zu bytes is too large in arena_alloc\n", size);
+    return NULL;
+  }
+  size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+
+  struct ArenaBlock *block = arena->blocks;
+  if (!block || block->size - block->used < size){
+    block = arena_add_block(arena, size);
+    if (!block) return NULL;
+  }
+
+  void *memory = block->data + block->used;
+  block->used += size;
+  memset(memory, 0, size);
+  return memory;
+}
+
+void *arena_alloc_array(struct Arena *arena, size_t count, size_t size){
+  if (size != 0 && count > SIZE_MAX / size){
+    fprintf(stderr, "Error: array of %zu elements of %zu bytes is too large in arena_alloc_array\n", count, size);
+    return NULL;
+  }
+  return arena_alloc(arena, count * size);
+}
+
+void arena_free(struct Arena *arena){
+  struct ArenaBlock *block = arena->blocks;
+  while (block){
+    struct ArenaBlock *next = block->next;
+    free(block);
+    block = next;
+  }
+  arena->blocks = NULL;
+}
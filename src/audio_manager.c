@@ -392,18 +392,14 @@ void audio_sound_effect_play(struct SoundEffect *sound_effect){
   alSourcePlay(source);
 }
 
-void audio_component_create(struct Scene *scene, uuid_t entity_id, struct AudioManager *audio_manager, int sound_effect_index){
-  // Reallocate AudioComponent array if full
-  if (scene->num_audio_components >= scene->max_audio_components){
-    printf("audio component realloc time\n");
-    // printf("scene->num_audio_components: %d\n", scene->num_audio_components);
-    scene->max_audio_components *= 2;
-    scene->audio_components = realloc(scene->audio_components, scene->max_audio_components * sizeof(struct AudioComponent));
-  }
-
+void audio_component_create(struct Scene *scene, EntityIndex entity, struct AudioManager *audio_manager, int sound_effect_index){
   // Initialize AudioComponent
-  struct AudioComponent *audio_component = &scene->audio_components[scene->num_audio_components++];
-  memcpy(audio_component->entity_id, entity_id, 16);
+  struct AudioComponent *audio_component = component_store_add(&scene->audio_components, entity);
+  if (!audio_component){
+    fprintf(stderr, "Error: failed to add AudioComponent in audio_component_create\n");
+    return;
+  }
+  audio_component->entity = entity;
   
   alGenSources(1, &audio_component->source_id);
   ALenum audio_component_error = alGetError();
@@ -418,12 +414,12 @@ void audio_component_create(struct Scene *scene, uuid_t entity_id, struct AudioM
   }
 
   // Set source position and options for spatial audio
-  struct Entity *entity = scene_get_entity_by_entity_id(scene, entity_id);
-  if (!entity){
+  struct Entity *owner = scene_get_entity(scene, entity);
+  if (!owner){
     fprintf(stderr, "Error: failed to fetch entity in audio_component_create\n");
     return;
   }
-  alSource3f(audio_component->source_id, AL_POSITION, entity->position[0], entity->position[1], entity->position[2]);
+  alSource3f(audio_component->source_id, AL_POSITION, owner->position[0], owner->position[1], owner->position[2]);
   audio_component_error = alGetError();
   if (audio_component_error != AL_NO_ERROR){
     fprintf(stderr, "Error setting AudioComponent source position in audio_component_create: %d\n", audio_component_error);
@@ -502,8 +498,8 @@ void audio_component_play(struct AudioManager *audio_manager, struct AudioCompon
   }
 }
 
-void audio_listener_update(struct Scene *scene, uuid_t entity_id){
-  struct CameraComponent *camera = scene_get_camera_by_entity_id(scene, entity_id);
+void audio_listener_update(struct Scene *scene, EntityIndex entity){
+  struct CameraComponent *camera = scene_get_camera(scene, entity);
 
   // Set context
   // alcMakeContextCurrent(audio_manager->context);
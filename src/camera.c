@@ -1,18 +1,16 @@
+#include <stdio.h>
 #include <string.h>
 #include "scene.h"
 #include "camera.h"
 
-void camera_create(struct Scene *scene, uuid_t entity_id, vec3 position, vec3 up, float yaw, float pitch, float fov, float sensitivity, float speed){
-
-  // Reallocate CameraComponent array if full
-  if (scene->num_camera_components >= scene->max_camera_components){
-    scene->max_camera_components *= 2;
-    scene->camera_components = realloc(scene->camera_components, scene->max_camera_components * sizeof(struct CameraComponent));
-  }
-
+void camera_create(struct Scene *scene, EntityIndex entity, vec3 position, vec3 up, float yaw, float pitch, float fov, float sensitivity, float speed){
   // Initialize CameraComponent
-  struct CameraComponent *camera = &scene->camera_components[scene->num_camera_components++];
-  memcpy(camera->entity_id, entity_id, 16);
+  struct CameraComponent *camera = component_store_add(&scene->camera_components, entity);
+  if (!camera){
+    fprintf(stderr, "Error: failed to add CameraComponent in camera_create\n");
+    return;
+  }
+  camera->entity = entity;
   glm_vec3_copy(position, camera->position);
   glm_vec3_copy(up, camera->up);
   camera->yaw = yaw;
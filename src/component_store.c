@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "component_store.h"
+
+bool component_store_init(struct ComponentStore *store, size_t component_size, unsigned int capacity){
+  if (capacity == 0) capacity = 1;
+  store->component_size = component_size;
+  store->components = calloc(capacity, component_size);
+  store->dense_entities = (EntityIndex *)calloc(capacity, sizeof(EntityIndex));
+  if (!store->components || !store->dense_entities){
+    fprintf(stderr, "Error: failed to allocate dense arrays in component_store_init\n");
+    free(store->components);
+    free(store->dense_entities);
+    return false;
+  }
+  store->num_components = 0;
+  store->max_components = capacity;
+  store->sparse = NULL;
+  store->num_sparse = 0;
+  return true;
+}
+
+void component_store_free(struct ComponentStore *store){
+  free(store->components);
+  free(store->dense_entities);
+  free(store->sparse);
+  memset(store, 0, sizeof(struct ComponentStore));
+}
+
+// Grow sparse to cover entity, filling new entries with COMPONENT_STORE_NULL
+static bool component_store_reserve_sparse(struct ComponentStore *store, EntityIndex entity){
+  if (entity < store->num_sparse) return true;
+
+  unsigned int num_sparse = store->num_sparse ? store->num_sparse : 16;
+  while (num_sparse <= entity) num_sparse *= 2;
+  uint32_t *sparse = (uint32_t *)realloc(store->sparse, num_sparse * sizeof(uint32_t));
+  if (!sparse){
+    fprintf(stderr, "Error: failed to reallocate sparse array in component_store_reserve_sparse\n");
+    return false;
+  }
+  for (unsigned int i = store->num_sparse; i < num_sparse; i++){
+    sparse[i] = COMPONENT_STORE_NULL;
+  }
+  store->sparse = sparse;
+  store->num_sparse = num_sparse;
+  return true;
+}
+
+void *component_store_add(struct ComponentStore *store, EntityIndex entity){
+  if (entity == ENTITY_NULL_INDEX) return NULL;
+  if (!component_store_reserve_sparse(store, entity)) return NULL;
+  if (store->sparse[entity] != COMPONENT_STORE_NULL){
+    fprintf(stderr, "Error: entity %u already has a component in component_store_add\n", entity);
+    return NULL;
+  }
+
+  // Reallocate dense arrays if full
+  if (store->num_components >= store->max_components){
+    unsigned int max_components = store->max_components * 2;
+    void *components = realloc(store->components, max_components * store->component_size);
+    if (!components){
+      fprintf(stderr, "Error: failed to reallocate components in component_store_add\n");
+      return NULL;
+    }
+    store->components = components;
+    EntityIndex *dense_entities = (EntityIndex *)realloc(store->dense_entities, max_components * sizeof(EntityIndex));
+    if (!dense_entities){
+      fprintf(stderr, "Error: failed to reallocate dense entities in component_store_add\n");
+      return NULL;
+    }
+    store->dense_entities = dense_entities;
+    store->max_components = max_components;
+  }
+
+  unsigned int dense_index = store->num_components++;
+  store->sparse[entity] = dense_index;
+  store->dense_entities[dense_index] = entity;
+  void *component = component_store_at(store, dense_index);
+  memset(component, 0, store->component_size);
+  return component;
+}
+
+void *component_store_get(struct ComponentStore *store, EntityIndex entity){
+  if (entity >= store->num_sparse) return NULL;
+  uint32_t dense_index = store->sparse[entity];
+  if (dense_index == COMPONENT_STORE_NULL) return NULL;
+  return component_store_at(store, dense_index);
+}
+
+bool component_store_remove(struct ComponentStore *store, EntityIndex entity){
+  if (entity >= store->num_sparse) return false;
+  uint32_t dense_index = store->sparse[entity];
+  if (dense_index == COMPONENT_STORE_NULL) return false;
+
+  // Swap and pop the last component into the hole
+  unsigned int last = store->num_components - 1;
+  if (dense_index != last){
+    memcpy(component_store_at(store, dense_index), component_store_at(store, last), store->component_size);
+    EntityIndex moved = store->dense_entities[last];
+    store->dense_entities[dense_index] = moved;
+    store->sparse[moved] = dense_index;
+  }
+  store->sparse[entity] = COMPONENT_STORE_NULL;
+  store->num_components--;
+  return true;
+}
+
+void *component_store_at(struct ComponentStore *store, unsigned int i){
+  return (char *)store->components + (size_t)i * store->component_size;
+}
+
+EntityIndex component_store_entity_at(struct ComponentStore *store, unsigned int i){
+  return store->dense_entities[i];
+}
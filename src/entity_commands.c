@@ -0,0 +1,318 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "entity_commands.h"
+#include "scene.h"
+#include "render_context.h"
+#include "audio_manager.h"
+#include "engine.h"
+#include "item.h"
+#include "physics/world.h"
+
+bool entity_command_buffer_init(struct EntityCommandBuffer *buffer, unsigned int capacity){
+  memset(buffer, 0, sizeof(struct EntityCommandBuffer));
+  if (capacity == 0) capacity = 1;
+  if (mtx_init(&buffer->mutex, mtx_plain) != thrd_success){
+    fprintf(stderr, "Error: failed to initialize mutex in entity_command_buffer_init\n");
+    return false;
+  }
+  buffer->commands = (struct EntityCommand *)calloc(capacity, sizeof(struct EntityCommand));
+  buffer->applying = (struct EntityCommand *)calloc(capacity, sizeof(struct EntityCommand));
+  if (!buffer->commands || !buffer->applying){
+    fprintf(stderr, "Error: failed to allocate commands in entity_command_buffer_init\n");
+    free(buffer->commands);
+    free(buffer->applying);
+    mtx_destroy(&buffer->mutex);
+    return false;
+  }
+  buffer->max_commands = capacity;
+  buffer->max_applying = capacity;
+  return true;
+}
+
+void entity_command_buffer_free(struct EntityCommandBuffer *buffer){
+  free(buffer->commands);
+  free(buffer->applying);
+  free(buffer->spawns);
+  free(buffer->destroys);
+  mtx_destroy(&buffer->mutex);
+  memset(buffer, 0, sizeof(struct EntityCommandBuffer));
+}
+
+// RECORDING
+//
+// Append a command, the caller holds the mutex
+static struct EntityCommand *entity_commands_push(struct EntityCommandBuffer *buffer, EntityCommandType type, EntityIndex entity){
+  if (buffer->num_commands >= buffer->max_commands){
+    unsigned int max_commands = buffer->max_commands * 2;
+    struct EntityCommand *commands = (struct EntityCommand *)realloc(buffer->commands, max_commands * sizeof(struct EntityCommand));
+    if (!commands){
+      fprintf(stderr, "Error: failed to reallocate commands in entity_commands_push\n");
+      return NULL;
+    }
+    buffer->commands = commands;
+    buffer->max_commands = max_commands;
+  }
+  struct EntityCommand *command = &buffer->commands[buffer->num_commands++];
+  memset(command, 0, sizeof(struct EntityCommand));
+  command->type = type;
+  command->entity = entity;
+  return command;
+}
+
+EntityIndex entity_commands_spawn(struct EntityCommandBuffer *buffer, struct EntitySpawnDesc *desc){
+  mtx_lock(&buffer->mutex);
+  EntityIndex entity = ENTITY_DEFERRED_INDEX_BIT | buffer->num_spawns;
+  struct EntityCommand *command = entity_commands_push(buffer, ENTITY_COMMAND_SPAWN, entity);
+  if (command){
+    command->data.spawn = *desc;
+    buffer->num_spawns++;
+  }
+  mtx_unlock(&buffer->mutex);
+  return command ? entity : ENTITY_NULL_INDEX;
+}
+
+bool entity_commands_destroy(struct EntityCommandBuffer *buffer, EntityIndex entity){
+  if (entity == ENTITY_NULL_INDEX) return false;
+  mtx_lock(&buffer->mutex);
+  struct EntityCommand *command = entity_commands_push(buffer, ENTITY_COMMAND_DESTROY, entity);
+  mtx_unlock(&buffer->mutex);
+  return command != NULL;
+}
+
+bool entity_commands_add_component(struct EntityCommandBuffer *buffer, EntityIndex entity, struct EntityComponentDesc *desc){
+  if (entity == ENTITY_NULL_INDEX) return false;
+  mtx_lock(&buffer->mutex);
+  struct EntityCommand *command = entity_commands_push(buffer, ENTITY_COMMAND_ADD_COMPONENT, entity);
+  if (command){
+    command->data.add_component = *desc;
+  }
+  mtx_unlock(&buffer->mutex);
+  return command != NULL;
+}
+
+bool entity_commands_remove_component(struct EntityCommandBuffer *buffer, EntityIndex entity, EntityComponentType type){
+  if (entity == ENTITY_NULL_INDEX) return false;
+  mtx_lock(&buffer->mutex);
+  struct EntityCommand *command = entity_commands_push(buffer, ENTITY_COMMAND_REMOVE_COMPONENT, entity);
+  if (command){
+    command->data.remove_component = type;
+  }
+  mtx_unlock(&buffer->mutex);
+  return command != NULL;
+}
+
+bool entity_commands_is_destroy_pending(struct EntityCommandBuffer *buffer, EntityIndex entity){
+  bool pending = false;
+  mtx_lock(&buffer->mutex);
+  for (unsigned int i = 0; i < buffer->num_commands; i++){
+    if (buffer->commands[i].type == ENTITY_COMMAND_DESTROY && buffer->commands[i].entity == entity){
+      pending = true;
+      break;
+    }
+  }
+  mtx_unlock(&buffer->mutex);
+  return pending;
+}
+
+// APPLYING
+//
+// Deferred indices refer to entities spawned earlier in the same apply
+static EntityIndex entity_commands_resolve(struct EntityCommandBuffer *buffer, EntityIndex entity, unsigned int num_spawns, struct SceneNode **scene_node){
+  if (scene_node) *scene_node = NULL;
+  if (!ENTITY_IS_DEFERRED_INDEX(entity)) return entity;
+
+  unsigned int spawn = entity & ~ENTITY_DEFERRED_INDEX_BIT;
+  if (spawn >= num_spawns) return ENTITY_NULL_INDEX;
+  if (scene_node) *scene_node = buffer->spawns[spawn].scene_node;
+  return buffer->spawns[spawn].entity;
+}
+
+static void entity_commands_apply_spawn(struct EntityCommandBuffer *buffer, struct Scene *scene, struct EntityCommand *command, unsigned int spawn){
+  struct EntityCommandSpawn *result = &buffer->spawns[spawn];
+  result->entity = ENTITY_NULL_INDEX;
+  result->scene_node = NULL;
+
+  struct Entity *entity = scene_entity_create(scene);
+  if (!entity){
+    fprintf(stderr, "Error: failed to create entity in entity_commands_apply_spawn\n");
+    return;
+  }
+  struct EntitySpawnDesc *desc = &command->data.spawn;
+  entity->type = desc->type;
+  glm_vec3_copy(desc->position, entity->position);
+  glm_quat_copy(desc->rotation, entity->rotation);
+  glm_vec3_copy(desc->scale, entity->scale);
+  glm_vec3_copy(desc->velocity, entity->velocity);
+
+  result->entity = entity->index;
+  result->scene_node = scene_node_create(scene, entity, scene->root_node);
+}
+
+static void entity_commands_apply_add_component(struct Scene *scene, struct Entity *entity, struct SceneNode *scene_node, struct EntityComponentDesc *desc){
+  switch (desc->type){
+    case ENTITY_COMPONENT_RENDER: {
+      render_component_create(scene, entity->index, desc->data.render.model, desc->data.render.shader);
+      break;
+    }
+    case ENTITY_COMPONENT_AUDIO: {
+      struct AudioManager *audio_manager = engine_get_audio_manager();
+      if (!audio_manager){
+        fprintf(stderr, "Error: failed to get AudioManager in entity_commands_apply_add_component\n");
+        break;
+      }
+      audio_component_create(scene, entity->index, audio_manager, desc->data.audio.sound_effect_index);
+      break;
+    }
+    case ENTITY_COMPONENT_ITEM: {
+      if (entity->item){
+        fprintf(stderr, "Error: entity %u already has an item in entity_commands_apply_add_component\n", entity->index);
+        break;
+      }
+      entity->item = (struct ItemComponent *)pool_alloc(&scene->item_pool);
+      if (!entity->item){
+        fprintf(stderr, "Error: failed to allocate Item in entity_commands_apply_add_component\n");
+        break;
+      }
+      entity->item->id = desc->data.item.id;
+      entity->item->count = desc->data.item.count;
+      break;
+    }
+    case ENTITY_COMPONENT_PHYSICS_BODY: {
+      if (physics_get_body(scene->physics_world, entity->physics_body)){
+        fprintf(stderr, "Error: entity %u already has a PhysicsBody in entity_commands_apply_add_component\n", entity->index);
+        break;
+      }
+      // Bodies follow their node, so look it up if the entity wasn't spawned this apply
+      if (!scene_node){
+        int child_index, final_child_index;
+        scene_get_node_by_entity(scene->root_node, entity->index, &child_index, &final_child_index, &scene_node);
+      }
+      if (desc->data.physics_body.trigger){
+        entity->physics_body = physics_add_trigger(scene->physics_world, scene_node, entity, desc->data.physics_body.collider);
+      }
+      else{
+        entity->physics_body = physics_add_body(scene->physics_world, scene_node, entity, desc->data.physics_body.collider, desc->data.physics_body.restitution, desc->data.physics_body.dynamic);
+      }
+      break;
+    }
+    default: {
+      fprintf(stderr, "Error: unknown component type %d in entity_commands_apply_add_component\n", desc->type);
+      break;
+    }
+  }
+}
+
+static void entity_commands_apply_remove_component(struct Scene *scene, struct Entity *entity, EntityComponentType type){
+  switch (type){
+    case ENTITY_COMPONENT_RENDER: {
+      scene_remove_render_component(scene, entity->index);
+      break;
+    }
+    case ENTITY_COMPONENT_AUDIO: {
+      scene_remove_audio_component(scene, entity->index);
+      break;
+    }
+    case ENTITY_COMPONENT_ITEM: {
+      pool_free(&scene->item_pool, entity->item);
+      entity->item = NULL;
+      break;
+    }
+    case ENTITY_COMPONENT_PHYSICS_BODY: {
+      physics_remove_body(scene->physics_world, entity->physics_body);
+      entity->physics_body = PHYSICS_NULL_HANDLE;
+      break;
+    }
+    default: {
+      fprintf(stderr, "Error: unknown component type %d in entity_commands_apply_remove_component\n", type);
+      break;
+    }
+  }
+}
+
+static bool entity_commands_push_destroy(struct EntityCommandBuffer *buffer, EntityIndex entity){
+  if (buffer->num_destroys >= buffer->max_destroys){
+    unsigned int max_destroys = buffer->max_destroys ? buffer->max_destroys * 2 : 16;
+    EntityIndex *destroys = (EntityIndex *)realloc(buffer->destroys, max_destroys * sizeof(EntityIndex));
+    if (!destroys){
+      fprintf(stderr, "Error: failed to reallocate destroys in entity_commands_push_destroy\n");
+      return false;
+    }
+    buffer->destroys = destroys;
+    buffer->max_destroys = max_destroys;
+  }
+  buffer->destroys[buffer->num_destroys++] = entity;
+  return true;
+}
+
+// Spawns, component changes, then every destroy at once.
+// Commands for entities that don't exist (anymore) are dropped
+void entity_command_buffer_apply(struct EntityCommandBuffer *buffer, struct Scene *scene){
+  // Swap the recorded commands out, so anything recorded from here on waits for the next apply
+  mtx_lock(&buffer->mutex);
+  struct EntityCommand *commands = buffer->commands;
+  unsigned int max_commands = buffer->max_commands;
+  unsigned int num_commands = buffer->num_commands;
+  unsigned int num_spawns = buffer->num_spawns;
+  buffer->commands = buffer->applying;
+  buffer->max_commands = buffer->max_applying;
+  buffer->num_commands = 0;
+  buffer->num_spawns = 0;
+  buffer->applying = commands;
+  buffer->max_applying = max_commands;
+  mtx_unlock(&buffer->mutex);
+
+  if (num_commands == 0) return;
+
+  // Results of this apply's spawns, by deferred index
+  if (num_spawns > buffer->max_spawns){
+    struct EntityCommandSpawn *spawns = (struct EntityCommandSpawn *)realloc(buffer->spawns, num_spawns * sizeof(struct EntityCommandSpawn));
+    if (!spawns){
+      fprintf(stderr, "Error: failed to reallocate spawns in entity_command_buffer_apply\n");
+      num_spawns = buffer->max_spawns;
+    }
+    else{
+      buffer->spawns = spawns;
+      buffer->max_spawns = num_spawns;
+    }
+  }
+
+  unsigned int spawn = 0;
+  buffer->num_destroys = 0;
+  for (unsigned int i = 0; i < num_commands; i++){
+    struct EntityCommand *command = &commands[i];
+    if (command->type == ENTITY_COMMAND_SPAWN){
+      if (spawn < num_spawns){
+        entity_commands_apply_spawn(buffer, scene, command, spawn);
+      }
+      spawn++;
+      continue;
+    }
+
+    struct SceneNode *scene_node;
+    EntityIndex entity_index = entity_commands_resolve(buffer, command->entity, spawn < num_spawns ? spawn : num_spawns, &scene_node);
+    struct Entity *entity = scene_get_entity(scene, entity_index);
+    if (!entity) continue;
+
+    switch (command->type){
+      case ENTITY_COMMAND_DESTROY: {
+        entity_commands_push_destroy(buffer, entity_index);
+        break;
+      }
+      case ENTITY_COMMAND_ADD_COMPONENT: {
+        entity_commands_apply_add_component(scene, entity, scene_node, &command->data.add_component);
+        break;
+      }
+      case ENTITY_COMMAND_REMOVE_COMPONENT: {
+        entity_commands_apply_remove_component(scene, entity, command->data.remove_component);
+        break;
+      }
+      default: {
+        fprintf(stderr, "Error: unknown command type %d in entity_command_buffer_apply\n", command->type);
+        break;
+      }
+    }
+  }
+
+  scene_remove_entities(scene, buffer->destroys, buffer->num_destroys);
+}
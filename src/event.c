@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "event.h"
+#include "entity.h"
+#include "item.h"
 #include "scene.h"
 #include "player.h"
 #include "inventory.h"
@@ -13,10 +15,10 @@ static bool game_event_queue_initialized;
 
 static EventType event_types[ENTITY_TYPE_COUNT][ENTITY_TYPE_COUNT] = {
   //              GROUPING        WORLD             ITEM                      PLAYER
-  /* GROUPING */{EVENT_COLLISION, EVENT_COLLISION,  EVENT_COLLISION,          EVENT_COLLISION},
-  /* WORLD */   {EVENT_COLLISION, EVENT_COLLISION,  EVENT_COLLISION,          EVENT_COLLISION},
-  /* ITEM */    {EVENT_COLLISION, EVENT_COLLISION,  EVENT_COLLISION,          EVENT_PLAYER_ITEM_PICKUP},
-  /* PLAYER */  {EVENT_COLLISION, EVENT_COLLISION,  EVENT_PLAYER_ITEM_PICKUP, EVENT_COLLISION}
+  /* GROUPING */{EVENT_COLLISION_BEGIN, EVENT_COLLISION_BEGIN,  EVENT_COLLISION_BEGIN,          EVENT_COLLISION_BEGIN},
+  /* WORLD */   {EVENT_COLLISION_BEGIN, EVENT_COLLISION_BEGIN,  EVENT_COLLISION_BEGIN,          EVENT_COLLISION_BEGIN},
+  /* ITEM */    {EVENT_COLLISION_BEGIN, EVENT_COLLISION_BEGIN,  EVENT_COLLISION_BEGIN,          EVENT_PLAYER_ITEM_PICKUP},
+  /* PLAYER */  {EVENT_COLLISION_BEGIN, EVENT_COLLISION_BEGIN,  EVENT_PLAYER_ITEM_PICKUP, EVENT_COLLISION_BEGIN}
 };
 
 
@@ -100,14 +102,31 @@ bool game_event_queue_is_empty(){
   return game_event_queue.size == 0;
 }
 
+// The item is only destroyed at the end of the frame (see entity_command_buffer_apply),
+// so later events this frame can still see it and mustn't pick it up again
+static void game_event_player_item_pickup(EntityIndex player_entity, int item_id, int item_count, EntityIndex item_entity){
+  struct Scene *scene = game_event_queue.scene;
+  if (entity_commands_is_destroy_pending(&scene->commands, item_entity)) return;
+
+  struct InventoryComponent *inventory_component = scene_get_inventory(scene, player_entity);
+
+  if (inventory_add_item(inventory_component, &game_event_queue.scene->item_registry, item_id, item_count)){
+    entity_commands_destroy(&scene->commands, item_entity);
+    inventory_print(&game_event_queue.scene->item_registry, inventory_component);
+  }
+  else{
+    // printf("Failed to add %d item(s) to the player's inventory\n", item_count);
+  }
+}
+
 void game_event_queue_process(){
   struct GameEvent game_event;
   while (game_event_queue_dequeue(&game_event)){
     switch (game_event.type){
-      case EVENT_COLLISION: {
+      case EVENT_COLLISION_BEGIN: {
         // Get colliding entities' AudioComponents
-        struct AudioComponent *audio_component_A = scene_get_audio_component_by_entity_id(game_event_queue.scene, game_event.data.collision.entity_A_id);
-        struct AudioComponent *audio_component_B = scene_get_audio_component_by_entity_id(game_event_queue.scene, game_event.data.collision.entity_B_id);
+        struct AudioComponent *audio_component_A = scene_get_audio_component(game_event_queue.scene, game_event.data.collision.entity_A);
+        struct AudioComponent *audio_component_B = scene_get_audio_component(game_event_queue.scene, game_event.data.collision.entity_B);
 
         struct AudioManager *audio_manager = engine_get_audio_manager();
 
@@ -115,19 +134,29 @@ void game_event_queue_process(){
         if (audio_component_B) audio_component_play(audio_manager, audio_component_B);
         break;
       }
+      case EVENT_COLLISION_PERSIST:
+      case EVENT_COLLISION_END: {
+        // Nothing listens for these yet
+        break;
+      }
       case EVENT_PLAYER_ITEM_PICKUP: {
-        struct PlayerComponent *player = scene_get_player_by_entity_id(game_event_queue.scene, game_event.data.item_pickup.player_entity_id);
-        struct InventoryComponent *inventory_component = scene_get_inventory_by_entity_id(game_event_queue.scene, game_event.data.item_pickup.player_entity_id);
-
-        if (inventory_add_item(inventory_component, &game_event_queue.scene->item_registry, game_event.data.item_pickup.item_id, game_event.data.item_pickup.item_count)){
-          scene_remove_entity(game_event_queue.scene, game_event.data.item_pickup.item_entity_id);
-          inventory_print(&game_event_queue.scene->item_registry, inventory_component);
-        }
-        else{
-          // printf("Failed to add %d item(s) to the player's inventory\n", game_event.data.item_pickup.item_count);
+        game_event_player_item_pickup(game_event.data.item_pickup.player_entity, game_event.data.item_pickup.item_id, game_event.data.item_pickup.item_count, game_event.data.item_pickup.item_entity);
+        break;
+      }
+      case EVENT_TRIGGER_ENTER: {
+        // Players walking into an item's trigger pick it up
+        struct Entity *trigger_entity = scene_get_entity(game_event_queue.scene, game_event.data.trigger.trigger_entity);
+        struct Entity *other_entity = scene_get_entity(game_event_queue.scene, game_event.data.trigger.other_entity);
+        if (!trigger_entity || !other_entity) break;
+        if (trigger_entity->type == ENTITY_ITEM && trigger_entity->item && other_entity->type == ENTITY_PLAYER){
+          game_event_player_item_pickup(other_entity->index, trigger_entity->item->id, trigger_entity->item->count, trigger_entity->index);
         }
         break;
       }
+      case EVENT_TRIGGER_EXIT: {
+        // Nothing listens for these yet
+        break;
+      }
       default: {
         fprintf(stderr, "Error: unknown event type in game_event_queue_process\n");
         break;
@@ -142,14 +171,34 @@ EventType get_event_type(EntityType type_A, EntityType type_B){
 
 void game_event_print(struct GameEvent *game_event){
   switch(game_event->type){
-    case EVENT_COLLISION: {
-      printf("Event type: EVENT_COLLISION\n");
-      printf("Timestamp seconds: %ld, timestamp nanoseconds: %ld\n\n", game_event->timestamp.tv_sec, game_event->timestamp.tv_nsec);
+    case EVENT_COLLISION_BEGIN: {
+      printf("Event type: EVENT_COLLISION_BEGIN\n");
+      printf("Tick: %llu\n\n", (unsigned long long)game_event->tick);
+      break;
+    }
+    case EVENT_COLLISION_PERSIST: {
+      printf("Event type: EVENT_COLLISION_PERSIST\n");
+      printf("Tick: %llu\n\n", (unsigned long long)game_event->tick);
+      break;
+    }
+    case EVENT_COLLISION_END: {
+      printf("Event type: EVENT_COLLISION_END\n");
+      printf("Tick: %llu\n\n", (unsigned long long)game_event->tick);
       break;
     }
     case EVENT_PLAYER_ITEM_PICKUP: {
       printf("Event type: EVENT_PLAYER_ITEM_PICKUP\n");
-      printf("Timestamp seconds: %ld, timestamp nanoseconds: %ld\n\n", game_event->timestamp.tv_sec, game_event->timestamp.tv_nsec);
+      printf("Tick: %llu\n\n", (unsigned long long)game_event->tick);
+      break;
+    }
+    case EVENT_TRIGGER_ENTER: {
+      printf("Event type: EVENT_TRIGGER_ENTER\n");
+      printf("Tick: %llu\n\n", (unsigned long long)game_event->tick);
+      break;
+    }
+    case EVENT_TRIGGER_EXIT: {
+      printf("Event type: EVENT_TRIGGER_EXIT\n");
+      printf("Tick: %llu\n\n", (unsigned long long)game_event->tick);
       break;
     }
     default: {
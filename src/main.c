@@ -18,6 +18,7 @@
 #include "game_state.h"
 #include "window_manager.h"
 #include "event.h"
+#include "physics/world.h"
 #include <uuid/uuid.h>
 #include "engine.h"
 
@@ -63,28 +64,19 @@ void processInput(GLFWwindow *window){
   struct Scene *scene = engine->scene_manager.active_scene;
 
   if (!game_state_is_paused()){
-    // Camera movement
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS){
-      player_process_keyboard_input(scene, scene->local_player_entity_id, CAMERA_FORWARD, engine->delta_time);
-      // player_process_keyboard_input(&engine->active_scene->player, CAMERA_FORWARD, engine->delta_time);
-    }
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS){
-      player_process_keyboard_input(scene, scene->local_player_entity_id, CAMERA_BACKWARD, engine->delta_time);
-      // player_process_keyboard_input(&engine->active_scene->player, CAMERA_BACKWARD, engine->delta_time);
-    }
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS){
-      player_process_keyboard_input(scene, scene->local_player_entity_id, CAMERA_LEFT, engine->delta_time);
-      // player_process_keyboard_input(&engine->active_scene->player, CAMERA_LEFT, engine->delta_time);
-    }
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS){
-      player_process_keyboard_input(scene, scene->local_player_entity_id, CAMERA_RIGHT, engine->delta_time);
-      // player_process_keyboard_input(&engine->active_scene->player, CAMERA_RIGHT, engine->delta_time);
-    }
+    // Movement, gathered into one displacement for the player's character controller
+    float forward = 0.0f;
+    float right = 0.0f;
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) forward += 1.0f;
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) forward -= 1.0f;
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) right += 1.0f;
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) right -= 1.0f;
+    player_process_movement_input(scene, scene->local_player_entity, forward, right, engine->delta_time);
 
     // Only process these inputs a single time per press
     int space_state = glfwGetKey(window, GLFW_KEY_SPACE);
     if (space_state == GLFW_PRESS && last_space_state == GLFW_RELEASE){
-      player_jump(scene, scene->local_player_entity_id);
+      player_jump(scene, scene->local_player_entity);
     }
     last_space_state = space_state;
   }
@@ -121,7 +113,7 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos){
 
   // Update camera
   if (game_state_is_playing()){
-    player_process_mouse_input(scene, scene->local_player_entity_id, xoffset, yoffset);
+    player_process_mouse_input(scene, scene->local_player_entity, xoffset, yoffset);
   }
 }
 
@@ -139,7 +131,7 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset){
   Engine *engine = (Engine *)glfwGetWindowUserPointer(window);
   struct Scene *scene = engine->scene_manager.active_scene;
 
-  struct CameraComponent *camera = scene_get_camera_by_entity_id(scene, scene->local_player_entity_id);
+  struct CameraComponent *camera = scene_get_camera(scene, scene->local_player_entity);
   if (!game_state_is_paused()){
     camera_process_scroll_input(camera, yoffset);
   }
@@ -160,6 +152,17 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 	    glfwSetInputMode(engine->window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     }
   }
+
+  // Cycle broad phases to compare them against each other
+  if (key == GLFW_KEY_F3 && action == GLFW_PRESS){
+    struct Scene *scene = engine->scene_manager.active_scene;
+    if (!scene || !scene->physics_world) return;
+
+    struct PhysicsWorld *physics_world = scene->physics_world;
+    BroadPhaseType next = (physics_world->broad_phase_type + 1) % BROAD_PHASE_COUNT;
+    physics_set_broad_phase(physics_world, next);
+    printf("Broad phase: %s\n", physics_broad_phase_name(next));
+  }
 }
 
 void engine_init(){
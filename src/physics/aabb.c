@@ -94,6 +94,38 @@ void AABB_update_by_vertex(struct AABB *aabb, vec3 vertex){
   }
 }
 
+// Smallest AABB enclosing both a and b.
+// Unlike AABB_merge, neither input is modified, so dest may alias a or b.
+void AABB_union(struct AABB *a, struct AABB *b, struct AABB *dest){
+  vec3 min, max;
+  for (int i = 0; i < 3; i++){
+    min[i] = glm_min(a->center[i] - a->extents[i], b->center[i] - b->extents[i]);
+    max[i] = glm_max(a->center[i] + a->extents[i], b->center[i] + b->extents[i]);
+  }
+  for (int i = 0; i < 3; i++){
+    dest->center[i] = (min[i] + max[i]) * 0.5f;
+    dest->extents[i] = (max[i] - min[i]) * 0.5f;
+  }
+  dest->initialized = true;
+}
+
+// Whether a fully encloses b
+bool AABB_contains(struct AABB *a, struct AABB *b){
+  for (int i = 0; i < 3; i++){
+    if (b->center[i] - b->extents[i] < a->center[i] - a->extents[i]) return false;
+    if (b->center[i] + b->extents[i] > a->center[i] + a->extents[i]) return false;
+  }
+  return true;
+}
+
+// Surface area, used as the insertion cost heuristic for the dynamic tree
+float AABB_surface_area(struct AABB *aabb){
+  float x = aabb->extents[0];
+  float y = aabb->extents[1];
+  float z = aabb->extents[2];
+  return 8.0f * (x * y + y * z + z * x);
+}
+
 // COLLISION TESTS
 //
 // Intersection between AABBs
@@ -104,6 +136,35 @@ bool AABB_intersect_AABB(struct AABB *a, struct AABB *b){
   return true;
 }
 
+// Slab test of the segment origin + t * translation, t in [0, max_fraction], against
+// the AABB grown by extents (a box swept along the segment hits the AABB
+// exactly when its center's segment hits the grown one). entry is the fraction it enters at
+bool AABB_intersect_segment(struct AABB *aabb, vec3 extents, vec3 origin, vec3 translation, float max_fraction, float *entry){
+  float t_min = 0.0f;
+  float t_max = max_fraction;
+  for (int i = 0; i < 3; i++){
+    float box_min = aabb->center[i] - aabb->extents[i] - extents[i];
+    float box_max = aabb->center[i] + aabb->extents[i] + extents[i];
+    if (translation[i] == 0.0f){
+      if (origin[i] < box_min || origin[i] > box_max) return false;
+      continue;
+    }
+    float inverse = 1.0f / translation[i];
+    float t1 = (box_min - origin[i]) * inverse;
+    float t2 = (box_max - origin[i]) * inverse;
+    if (t1 > t2){
+      float temp = t1;
+      t1 = t2;
+      t2 = temp;
+    }
+    if (t1 > t_min) t_min = t1;
+    if (t2 < t_max) t_max = t2;
+    if (t_min > t_max) return false;
+  }
+  *entry = t_min;
+  return true;
+}
+
 // Intersection between an AABB and a plane
 bool AABB_intersect_plane(struct AABB *box, struct Plane *plane){
 
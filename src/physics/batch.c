@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "physics/batch.h"
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#define INITIAL_BATCH_CAPACITY 64
+
+// Grow each component array to capacity. Arrays that grew before one failed
+// are just bigger than they need to be, so the batch stays usable at its old capacity
+static bool batch_reserve(float **arrays, int num_arrays, unsigned int *capacity, unsigned int count){
+  if (count < *capacity) return true;
+  unsigned int new_capacity = *capacity ? *capacity * 2 : INITIAL_BATCH_CAPACITY;
+  for (int i = 0; i < num_arrays; i++){
+    float *array = (float *)realloc(arrays[i], new_capacity * sizeof(float));
+    if (!array){
+      fprintf(stderr, "Error: failed to realloc batch arrays in batch_reserve\n");
+      return false;
+    }
+    arrays[i] = array;
+  }
+  *capacity = new_capacity;
+  return true;
+}
+
+// CANDIDATES
+//
+bool AABB_batch_push(struct AABBBatch *batch, struct AABB *aabb){
+  float *arrays[6] = {batch->center[0], batch->center[1], batch->center[2], batch->extents[0], batch->extents[1], batch->extents[2]};
+  bool reserved = batch_reserve(arrays, 6, &batch->capacity, batch->count);
+  for (int i = 0; i < 3; i++){
+    batch->center[i] = arrays[i];
+    batch->extents[i] = arrays[i + 3];
+  }
+  if (!reserved) return false;
+
+  unsigned int index = batch->count++;
+  for (int i = 0; i < 3; i++){
+    batch->center[i][index] = aabb->center[i];
+    batch->extents[i][index] = aabb->extents[i];
+  }
+  return true;
+}
+
+void AABB_batch_get(struct AABBBatch *batch, unsigned int index, struct AABB *dest){
+  for (int i = 0; i < 3; i++){
+    dest->center[i] = batch->center[i][index];
+    dest->extents[i] = batch->extents[i][index];
+  }
+  dest->initialized = true;
+}
+
+void AABB_batch_clear(struct AABBBatch *batch){
+  batch->count = 0;
+}
+
+void AABB_batch_free(struct AABBBatch *batch){
+  for (int i = 0; i < 3; i++){
+    free(batch->center[i]);
+    free(batch->extents[i]);
+    batch->center[i] = NULL;
+    batch->extents[i] = NULL;
+  }
+  batch->count = 0;
+  batch->capacity = 0;
+}
+
+// MOTION
+//
+bool motion_batch_push(struct MotionBatch *batch, vec3 position, vec3 velocity){
+  float *arrays[6] = {batch->position[0], batch->position[1], batch->position[2], batch->velocity[0], batch->velocity[1], batch->velocity[2]};
+  bool reserved = batch_reserve(arrays, 6, &batch->capacity, batch->count);
+  for (int i = 0; i < 3; i++){
+    batch->position[i] = arrays[i];
+    batch->velocity[i] = arrays[i + 3];
+  }
+  if (!reserved) return false;
+
+  unsigned int index = batch->count++;
+  for (int i = 0; i < 3; i++){
+    batch->position[i][index] = position[i];
+    batch->velocity[i][index] = velocity[i];
+  }
+  return true;
+}
+
+void motion_batch_get(struct MotionBatch *batch, unsigned int index, vec3 position, vec3 velocity){
+  for (int i = 0; i < 3; i++){
+    position[i] = batch->position[i][index];
+    velocity[i] = batch->velocity[i][index];
+  }
+}
+
+void motion_batch_clear(struct MotionBatch *batch){
+  batch->count = 0;
+}
+
+void motion_batch_free(struct MotionBatch *batch){
+  for (int i = 0; i < 3; i++){
+    free(batch->position[i]);
+    free(batch->velocity[i]);
+    batch->position[i] = NULL;
+    batch->velocity[i] = NULL;
+  }
+  batch->count = 0;
+  batch->capacity = 0;
+}
+
+// KERNELS
+//
+// Each SIMD loop stops at the last full group, and the scalar loop after it finishes the rest
+// (or everything, without SSE). SIMD comparisons are written the same way round as the scalar
+// ones, e.g. "not separated" rather than "overlapping", so NaNs come out the same too.
+#if defined(__SSE__)
+static inline __m128 batch_abs(__m128 x){
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+#endif
+
+void AABB_intersect_AABB_batch(struct AABB *query, struct AABBBatch *batch, bool *results){
+  unsigned int i = 0;
+#if defined(__SSE__)
+  __m128 query_center[3], query_extents[3];
+  for (int axis = 0; axis < 3; axis++){
+    query_center[axis] = _mm_set1_ps(query->center[axis]);
+    query_extents[axis] = _mm_set1_ps(query->extents[axis]);
+  }
+  for (; i + 4 <= batch->count; i += 4){
+    // Separated on any axis: |center difference| > extents sum
+    __m128 separated = _mm_setzero_ps();
+    for (int axis = 0; axis < 3; axis++){
+      __m128 difference = batch_abs(_mm_sub_ps(query_center[axis], _mm_loadu_ps(batch->center[axis] + i)));
+      __m128 extents = _mm_add_ps(query_extents[axis], _mm_loadu_ps(batch->extents[axis] + i));
+      separated = _mm_or_ps(separated, _mm_cmpgt_ps(difference, extents));
+    }
+    int mask = _mm_movemask_ps(separated);
+    for (int lane = 0; lane < 4; lane++){
+      results[i + lane] = !(mask & (1 << lane));
+    }
+  }
+#endif
+  for (; i < batch->count; i++){
+    struct AABB candidate;
+    AABB_batch_get(batch, i, &candidate);
+    results[i] = AABB_intersect_AABB(query, &candidate);
+  }
+}
+
+void motion_batch_integrate(struct MotionBatch *batch, float gravity_step, float delta_time){
+  unsigned int i = 0;
+#if defined(__SSE__)
+  const __m128 gravity = _mm_set1_ps(gravity_step);
+  const __m128 dt = _mm_set1_ps(delta_time);
+  for (; i + 4 <= batch->count; i += 4){
+    _mm_storeu_ps(batch->velocity[1] + i, _mm_sub_ps(_mm_loadu_ps(batch->velocity[1] + i), gravity));
+    for (int axis = 0; axis < 3; axis++){
+      __m128 velocity = _mm_loadu_ps(batch->velocity[axis] + i);
+      __m128 position = _mm_loadu_ps(batch->position[axis] + i);
+      _mm_storeu_ps(batch->position[axis] + i, _mm_add_ps(position, _mm_mul_ps(velocity, dt)));
+    }
+  }
+#endif
+  for (; i < batch->count; i++){
+    batch->velocity[1][i] -= gravity_step;
+    for (int axis = 0; axis < 3; axis++){
+      batch->position[axis][i] += batch->velocity[axis][i] * delta_time;
+    }
+  }
+}
@@ -0,0 +1,176 @@
+#include <cglm/cglm.h>
+#include "physics/world.h"
+#include "physics/character.h"
+#include "physics/query.h"
+#include "physics/island.h"
+
+// A move in progress: the capsule where the character has got to so far,
+// and how far that is from where the body started
+struct PhysicsCharacterMove {
+  struct PhysicsWorld *physics_world;
+  struct PhysicsCharacter *character;
+  struct PhysicsQueryFilter filter;
+  struct Capsule capsule;
+  vec3 offset;
+};
+
+void physics_character_init(struct PhysicsCharacter *character, PhysicsBodyHandle body){
+  character->body = body;
+  glm_vec3_zero(character->displacement);
+  character->step_height = CHARACTER_DEFAULT_STEP_HEIGHT;
+  character->snap_distance = CHARACTER_DEFAULT_SNAP_DISTANCE;
+  character->min_ground_normal_y = CHARACTER_DEFAULT_MIN_GROUND_NORMAL_Y;
+  character->grounded = false;
+  glm_vec3_copy((vec3){0.0f, 1.0f, 0.0f}, character->ground_normal);
+}
+
+void physics_character_add_displacement(struct PhysicsCharacter *character, vec3 displacement){
+  glm_vec3_add(character->displacement, displacement, character->displacement);
+}
+
+// HELPERS
+//
+static void physics_character_translate(struct PhysicsCharacterMove *move, vec3 translation){
+  glm_vec3_add(move->capsule.segment_A, translation, move->capsule.segment_A);
+  glm_vec3_add(move->capsule.segment_B, translation, move->capsule.segment_B);
+  glm_vec3_add(move->offset, translation, move->offset);
+}
+
+static bool physics_character_cast(struct PhysicsCharacterMove *move, vec3 direction, float distance, struct PhysicsQueryHit *hit){
+  return physics_capsule_cast(move->physics_world, &move->capsule, direction, distance, &move->filter, hit);
+}
+
+// How far to go towards a hit, stopping CHARACTER_SKIN short of it
+static float physics_character_travel(struct PhysicsQueryHit *hit, float distance){
+  return glm_max(hit->fraction * distance - CHARACTER_SKIN, 0.0f);
+}
+
+static bool physics_character_is_ground(struct PhysicsCharacter *character, vec3 normal){
+  return normal[1] >= character->min_ground_normal_y;
+}
+
+static void physics_character_set_ground(struct PhysicsCharacter *character, vec3 normal){
+  character->grounded = true;
+  glm_vec3_copy(normal, character->ground_normal);
+}
+
+// MOVEMENT
+//
+// Up by step_height, forward by the horizontal part of what's left, then back down.
+// Works on a copy of the move and only keeps it if the character made progress and landed on ground
+static bool physics_character_step_up(struct PhysicsCharacterMove *move, vec3 remaining){
+  struct PhysicsCharacter *character = move->character;
+  vec3 horizontal = {remaining[0], 0.0f, remaining[2]};
+  float distance = glm_vec3_norm(horizontal);
+  if (distance < CHARACTER_MIN_MOVE || character->step_height <= 0.0f) return false;
+
+  struct PhysicsCharacterMove step = *move;
+  struct PhysicsQueryHit hit;
+  float rise = character->step_height;
+  if (physics_character_cast(&step, (vec3){0.0f, 1.0f, 0.0f}, rise, &hit)) rise = physics_character_travel(&hit, rise);
+  physics_character_translate(&step, (vec3){0.0f, rise, 0.0f});
+
+  float forward = distance;
+  if (physics_character_cast(&step, horizontal, distance, &hit)) forward = physics_character_travel(&hit, distance);
+  // Still blocked, it's a wall rather than a step
+  if (forward < CHARACTER_SKIN) return false;
+  glm_vec3_scale(horizontal, forward / distance, horizontal);
+  physics_character_translate(&step, horizontal);
+
+  float drop = rise + CHARACTER_SKIN;
+  if (!physics_character_cast(&step, (vec3){0.0f, -1.0f, 0.0f}, drop, &hit)) return false;
+  if (!physics_character_is_ground(character, hit.normal)) return false;
+  physics_character_translate(&step, (vec3){0.0f, -physics_character_travel(&hit, drop), 0.0f});
+  physics_character_set_ground(character, hit.normal);
+
+  *move = step;
+  return true;
+}
+
+// Collide and slide
+static void physics_character_slide(struct PhysicsCharacterMove *move, vec3 displacement, bool can_step){
+  struct PhysicsCharacter *character = move->character;
+  vec3 remaining;
+  glm_vec3_copy(displacement, remaining);
+
+  for (int i = 0; i < CHARACTER_MAX_SLIDES; i++){
+    float distance = glm_vec3_norm(remaining);
+    if (distance < CHARACTER_MIN_MOVE) return;
+
+    struct PhysicsQueryHit hit;
+    if (!physics_character_cast(move, remaining, distance, &hit)){
+      physics_character_translate(move, remaining);
+      return;
+    }
+
+    vec3 travel;
+    glm_vec3_scale(remaining, physics_character_travel(&hit, distance) / distance, travel);
+    physics_character_translate(move, travel);
+    glm_vec3_scale(remaining, 1.0f - hit.fraction, remaining);
+
+    if (physics_character_is_ground(character, hit.normal)){
+      physics_character_set_ground(character, hit.normal);
+    }
+    else if (can_step && physics_character_step_up(move, remaining)){
+      return;
+    }
+
+    // Keep the part of what's left that runs along the surface
+    glm_vec3_mulsubs(hit.normal, glm_vec3_dot(remaining, hit.normal), remaining);
+  }
+}
+
+// Look for ground under the character, and pull it down onto ground within snap_distance if snap
+static void physics_character_snap(struct PhysicsCharacterMove *move, bool snap){
+  struct PhysicsCharacter *character = move->character;
+  struct PhysicsQueryHit hit;
+  float distance = character->snap_distance + CHARACTER_SKIN;
+  if (!physics_character_cast(move, (vec3){0.0f, -1.0f, 0.0f}, distance, &hit)) return;
+  if (!physics_character_is_ground(character, hit.normal)) return;
+
+  float drop = physics_character_travel(&hit, distance);
+  if (drop > CHARACTER_SKIN && !snap) return;
+  physics_character_translate(move, (vec3){0.0f, -drop, 0.0f});
+  physics_character_set_ground(character, hit.normal);
+}
+
+// Resolve the displacement added since the last move and move the body.
+// Returns false if the body is gone or isn't a capsule
+bool physics_character_move(struct PhysicsWorld *physics_world, struct PhysicsCharacter *character){
+  struct PhysicsBody *body = physics_get_body(physics_world, character->body);
+  if (!body){
+    fprintf(stderr, "Error: failed to get PhysicsBody in physics_character_move\n");
+    return false;
+  }
+  if (body->collider.type != COLLIDER_CAPSULE){
+    fprintf(stderr, "Error: character body must have a capsule collider in physics_character_move\n");
+    return false;
+  }
+
+  struct PhysicsCharacterMove move = {
+    .physics_world = physics_world,
+    .character = character,
+    .filter = {
+      .layer_mask = body->collision_mask,
+      .ignore = body->handle
+    }
+  };
+  physics_body_get_world_capsule(body, 0.0f, &move.capsule);
+  glm_vec3_zero(move.offset);
+
+  vec3 displacement;
+  glm_vec3_copy(character->displacement, displacement);
+  glm_vec3_zero(character->displacement);
+
+  // Characters on their way up (jumping) don't step up or snap down
+  bool was_grounded = character->grounded && body->velocity[1] <= 0.0f;
+  character->grounded = false;
+  physics_character_slide(&move, displacement, was_grounded);
+  physics_character_snap(&move, was_grounded);
+
+  if (glm_vec3_norm2(move.offset) > 0.0f){
+    glm_vec3_add(body->position, move.offset, body->position);
+    physics_body_wake(body);
+  }
+  return true;
+}
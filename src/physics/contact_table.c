@@ -0,0 +1,166 @@
+#include <stdlib.h>
+#include <string.h>
+#include "entity.h"
+#include "item.h"
+#include "event.h"
+#include "physics/world.h"
+#include "physics/contact_table.h"
+#include "physics/gjk.h"
+
+#define INITIAL_CONTACT_CAPACITY 64
+
+void physics_contact_table_free(struct PhysicsContactTable *table){
+  free(table->step.contacts);
+  free(table->contacts.contacts);
+  free(table->merged.contacts);
+  memset(table, 0, sizeof(struct PhysicsContactTable));
+}
+
+static bool physics_contact_list_push(struct PhysicsContactList *list, struct PhysicsContact *contact){
+  if (list->num_contacts == list->max_contacts){
+    unsigned int new_max_contacts = list->max_contacts ? list->max_contacts * 2 : INITIAL_CONTACT_CAPACITY;
+    struct PhysicsContact *new_contacts = (struct PhysicsContact *)realloc(list->contacts, new_max_contacts * sizeof(struct PhysicsContact));
+    if (!new_contacts){
+      fprintf(stderr, "Error: failed to realloc contacts in physics_contact_list_push\n");
+      return false;
+    }
+    list->contacts = new_contacts;
+    list->max_contacts = new_max_contacts;
+  }
+  list->contacts[list->num_contacts++] = *contact;
+  return true;
+}
+
+static int physics_contact_compare(const void *a, const void *b){
+  uint64_t key_A = ((const struct PhysicsContact *)a)->key;
+  uint64_t key_B = ((const struct PhysicsContact *)b)->key;
+  return (key_A > key_B) - (key_A < key_B);
+}
+
+// Record a pair that collided this step.
+// Returns the recorded contact so the solver can store its impulses, or NULL if it couldn't grow the list
+struct PhysicsContact *physics_contact_table_record(struct PhysicsContactTable *table, struct PhysicsBody *body_A, struct PhysicsBody *body_B, uint64_t step){
+  struct PhysicsContact contact = {
+    .key = gjk_cache_key(body_A->handle, body_B->handle),
+    .begin_step = step,
+    .last_step = step,
+    .persist_step = step
+  };
+  if (!physics_contact_list_push(&table->step, &contact)) return NULL;
+  return &table->step.contacts[table->step.num_contacts - 1];
+}
+
+// Binary search the persistent contacts, which stay sorted by key
+struct PhysicsContact *physics_contact_table_find(struct PhysicsContactTable *table, uint64_t key){
+  unsigned int low = 0, high = table->contacts.num_contacts;
+  while (low < high){
+    unsigned int mid = low + (high - low) / 2;
+    uint64_t mid_key = table->contacts.contacts[mid].key;
+    if (mid_key == key) return &table->contacts.contacts[mid];
+    if (mid_key < key) low = mid + 1;
+    else high = mid;
+  }
+  return NULL;
+}
+
+// EVENTS
+//
+// Bodies removed since the contact began have no entity left to report, so their END is dropped
+static void physics_emit_contact_event(struct PhysicsWorld *physics_world, EventType type, uint64_t key){
+  struct PhysicsBodyCold *cold_A = physics_get_body_cold(physics_world, (PhysicsBodyHandle)(key >> 32));
+  struct PhysicsBodyCold *cold_B = physics_get_body_cold(physics_world, (PhysicsBodyHandle)(key & 0xFFFFFFFFu));
+  if (!cold_A || !cold_B || !cold_A->entity || !cold_B->entity) return;
+  EntityType type_A = cold_A->entity->type;
+  EntityType type_B = cold_B->entity->type;
+
+  // Some entity pairs turn their BEGIN into a gameplay event, and send nothing else
+  EventType begin_type = get_event_type(type_A, type_B);
+  if (begin_type != EVENT_COLLISION_BEGIN){
+    if (type != EVENT_COLLISION_BEGIN) return;
+    type = begin_type;
+  }
+
+  struct GameEvent event;
+  event.tick = physics_world->step_count;
+  event.type = type;
+
+  switch(event.type){
+    case EVENT_PLAYER_ITEM_PICKUP: {
+      // Key order depends on handles, so check which body is the item
+      struct Entity *item_entity = (type_A == ENTITY_ITEM) ? cold_A->entity : cold_B->entity;
+      struct Entity *player_entity = (type_A == ENTITY_ITEM) ? cold_B->entity : cold_A->entity;
+      event.data.item_pickup.player_entity = player_entity->index;
+      event.data.item_pickup.item_id = item_entity->item->id;
+      event.data.item_pickup.item_count = item_entity->item->count;
+      event.data.item_pickup.item_entity = item_entity->index;
+      break;
+    }
+    default:
+      event.data.collision.entity_A = cold_A->entity->index;
+      event.data.collision.entity_B = cold_B->entity->index;
+      break;
+  }
+
+  game_event_queue_enqueue(event);
+}
+
+// A contact that wasn't seen this step is kept through the grace period,
+// or for as long as one of its bodies is asleep
+static bool physics_contact_keep(struct PhysicsWorld *physics_world, struct PhysicsContact *contact){
+  struct PhysicsBody *body_A = physics_get_body(physics_world, (PhysicsBodyHandle)(contact->key >> 32));
+  struct PhysicsBody *body_B = physics_get_body(physics_world, (PhysicsBodyHandle)(contact->key & 0xFFFFFFFFu));
+  if (!body_A || !body_B) return false;
+  if (body_A->sleeping || body_B->sleeping) return true;
+  return physics_world->step_count - contact->last_step < PHYSICS_CONTACT_END_STEPS;
+}
+
+// Merge this step's colliding pairs into the persistent contacts, emitting events as they change
+void physics_contact_table_update(struct PhysicsWorld *physics_world){
+  struct PhysicsContactTable *table = &physics_world->contact_table;
+  struct PhysicsContactList *step = &table->step;
+  struct PhysicsContactList *contacts = &table->contacts;
+  struct PhysicsContactList *merged = &table->merged;
+  uint64_t step_count = physics_world->step_count;
+
+  if (step->num_contacts > 1){
+    qsort(step->contacts, step->num_contacts, sizeof(struct PhysicsContact), physics_contact_compare);
+  }
+  merged->num_contacts = 0;
+
+  unsigned int i = 0, j = 0;
+  while (i < step->num_contacts || j < contacts->num_contacts){
+    if (j == contacts->num_contacts || (i < step->num_contacts && step->contacts[i].key < contacts->contacts[j].key)){
+      // New contact
+      physics_emit_contact_event(physics_world, EVENT_COLLISION_BEGIN, step->contacts[i].key);
+      physics_contact_list_push(merged, &step->contacts[i++]);
+    }
+    else if (i == step->num_contacts || contacts->contacts[j].key < step->contacts[i].key){
+      // Not seen this step
+      struct PhysicsContact *contact = &contacts->contacts[j++];
+      if (physics_contact_keep(physics_world, contact)){
+        physics_contact_list_push(merged, contact);
+      }
+      else{
+        physics_emit_contact_event(physics_world, EVENT_COLLISION_END, contact->key);
+      }
+    }
+    else{
+      // Still colliding
+      struct PhysicsContact contact = contacts->contacts[j++];
+      contact.last_step = step_count;
+      contact.normal_impulse = step->contacts[i].normal_impulse;
+      glm_vec3_copy(step->contacts[i].tangent_impulse, contact.tangent_impulse);
+      i++;
+      if (table->persist_interval && step_count - contact.persist_step >= table->persist_interval){
+        physics_emit_contact_event(physics_world, EVENT_COLLISION_PERSIST, contact.key);
+        contact.persist_step = step_count;
+      }
+      physics_contact_list_push(merged, &contact);
+    }
+  }
+
+  struct PhysicsContactList temp = *contacts;
+  *contacts = *merged;
+  *merged = temp;
+  step->num_contacts = 0;
+}
@@ -13,9 +13,10 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
   // TODO refactor the switch into its own function
   for (unsigned int i = 0; i < physics_world->num_player_bodies; i++){
     struct PhysicsBody *body = &physics_world->player_bodies[i];
+    struct PhysicsBodyCold *cold = &physics_world->player_cold[i];
 
-    glBindVertexArray(body->VAO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, body->EBO);
+    glBindVertexArray(cold->VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cold->EBO);
 
     mat4 model;
     glm_mat4_identity(model);
@@ -26,12 +27,10 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
         struct AABB *box = &body->collider.data.aabb;
 
         glm_translate(model, body->position);
-        glm_rotate_y(model, glm_rad(body->rotation[1]), model);
-        glm_rotate_x(model, glm_rad(body->rotation[0]), model);
-        glm_rotate_z(model, glm_rad(body->rotation[2]), model);
+        glm_quat_rotate(model, body->rotation, model);
         glm_scale(model, body->scale);
 
-        physics_debug_AABB_render(box, context, body->scene_node->world_transform);
+        physics_debug_AABB_render(box, context, cold->scene_node->world_transform);
         break;
       case COLLIDER_SPHERE:
         struct Sphere *sphere = &body->collider.data.sphere;
@@ -48,14 +47,12 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
       case COLLIDER_CAPSULE:
         struct Capsule *capsule = &body->collider.data.capsule;
 
-        if (body->scene_node){
-          physics_debug_capsule_render(capsule, context, body->scene_node->world_transform);
+        if (cold->scene_node){
+          physics_debug_capsule_render(capsule, context, cold->scene_node->world_transform);
         }
         else{
           glm_translate(model, body->position);
-          glm_rotate_y(model, glm_rad(body->rotation[1]), model);
-          glm_rotate_x(model, glm_rad(body->rotation[0]), model);
-          glm_rotate_z(model, glm_rad(body->rotation[2]), model);
+          glm_quat_rotate(model, body->rotation, model);
           glm_scale(model, body->scale);
           physics_debug_capsule_render(capsule, context, model);
         }
@@ -64,6 +61,10 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
       case COLLIDER_PLANE:
         // debug_plane_render(body);
         break;
+      case COLLIDER_OBB:
+        glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
+        physics_debug_OBB_render(&body->world_collider.data.obb, context);
+        break;
       default:
         break;
     }
@@ -72,10 +73,68 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
   // Render static bodies
   for (unsigned int i = 0; i < physics_world->num_static_bodies; i++){
     struct PhysicsBody *body = &physics_world->static_bodies[i];
+    struct PhysicsBodyCold *cold = &physics_world->static_cold[i];
+
+    glBindVertexArray(cold->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cold->EBO);
+
+    mat4 model;
+    glm_mat4_identity(model);
+
+    switch(body->collider.type){
+      case COLLIDER_AABB:
+        // Get updated AABB and model matrix
+        struct AABB *box = &body->collider.data.aabb;
+
+        glm_translate(model, body->position);
+        glm_quat_rotate(model, body->rotation, model);
+        glm_scale(model, body->scale);
+
+        // physics_debug_AABB_render(box, context, model);
+        physics_debug_AABB_render(box, context, cold->scene_node->world_transform);
+        break;
+      case COLLIDER_SPHERE:
+        struct Sphere *sphere = &body->collider.data.sphere;
+
+        glm_translate(model, body->position);
+        // Spheres are invariant to rotation
+        // glm_rotate_y(model, glm_rad(body->rotation[1]), model);
+        // glm_rotate_x(model, glm_rad(body->rotation[0]), model);
+        // glm_rotate_z(model, glm_rad(body->rotation[2]), model);
+        glm_scale(model, body->scale);
+
+        physics_debug_sphere_render(sphere, context, model);
+        break;
+      case COLLIDER_CAPSULE:
+        struct Capsule *capsule = &body->collider.data.capsule;
 
-    glBindVertexArray(body->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, body->VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, body->EBO);
+        glm_translate(model, body->position);
+        glm_quat_rotate(model, body->rotation, model);
+        glm_scale(model, body->scale);
+
+        physics_debug_capsule_render(capsule, context, model);
+        break;
+      case COLLIDER_PLANE:
+        // debug_plane_render(body);
+        break;
+      case COLLIDER_OBB:
+        glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
+        physics_debug_OBB_render(&body->world_collider.data.obb, context);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Render trigger bodies
+  for (unsigned int i = 0; i < physics_world->num_trigger_bodies; i++){
+    struct PhysicsBody *body = &physics_world->trigger_bodies[i];
+    struct PhysicsBodyCold *cold = &physics_world->trigger_cold[i];
+
+    glBindVertexArray(cold->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cold->EBO);
 
     mat4 model;
     glm_mat4_identity(model);
@@ -86,13 +145,11 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
         struct AABB *box = &body->collider.data.aabb;
 
         glm_translate(model, body->position);
-        glm_rotate_y(model, glm_rad(body->rotation[1]), model);
-        glm_rotate_x(model, glm_rad(body->rotation[0]), model);
-        glm_rotate_z(model, glm_rad(body->rotation[2]), model);
+        glm_quat_rotate(model, body->rotation, model);
         glm_scale(model, body->scale);
 
         // physics_debug_AABB_render(box, context, model);
-        physics_debug_AABB_render(box, context, body->scene_node->world_transform);
+        physics_debug_AABB_render(box, context, cold->scene_node->world_transform);
         break;
       case COLLIDER_SPHERE:
         struct Sphere *sphere = &body->collider.data.sphere;
@@ -110,9 +167,7 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
         struct Capsule *capsule = &body->collider.data.capsule;
 
         glm_translate(model, body->position);
-        glm_rotate_y(model, glm_rad(body->rotation[1]), model);
-        glm_rotate_x(model, glm_rad(body->rotation[0]), model);
-        glm_rotate_z(model, glm_rad(body->rotation[2]), model);
+        glm_quat_rotate(model, body->rotation, model);
         glm_scale(model, body->scale);
 
         physics_debug_capsule_render(capsule, context, model);
@@ -120,6 +175,10 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
       case COLLIDER_PLANE:
         // debug_plane_render(body);
         break;
+      case COLLIDER_OBB:
+        glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
+        physics_debug_OBB_render(&body->world_collider.data.obb, context);
+        break;
       default:
         break;
     }
@@ -128,10 +187,11 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
   // Render dynamic bodies
   for (unsigned int i = 0; i < physics_world->num_dynamic_bodies; i++){
     struct PhysicsBody *body = &physics_world->dynamic_bodies[i];
+    struct PhysicsBodyCold *cold = &physics_world->dynamic_cold[i];
 
-    glBindVertexArray(body->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, body->VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, body->EBO);
+    glBindVertexArray(cold->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cold->EBO);
 
     mat4 model;
     glm_mat4_identity(model);
@@ -142,13 +202,11 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
         struct AABB *box = &body->collider.data.aabb;
 
         glm_translate(model, body->position);
-        glm_rotate_y(model, glm_rad(body->rotation[1]), model);
-        glm_rotate_x(model, glm_rad(body->rotation[0]), model);
-        glm_rotate_z(model, glm_rad(body->rotation[2]), model);
+        glm_quat_rotate(model, body->rotation, model);
         glm_scale(model, body->scale);
 
         // physics_debug_AABB_render(box, context, model);
-        physics_debug_AABB_render(box, context, body->scene_node->world_transform);
+        physics_debug_AABB_render(box, context, cold->scene_node->world_transform);
         break;
       // case COLLIDER_AABB:
       //   // Get updated AABB and model matrix
@@ -192,24 +250,26 @@ void physics_debug_render(struct PhysicsWorld *physics_world, struct RenderConte
         // glm_rotate_z(model, glm_rad(body->rotation[2]), model);
         glm_scale(model, body->scale);
 
-        glBindVertexArray(body->VAO);
+        glBindVertexArray(cold->VAO);
         physics_debug_sphere_render(sphere, context, model);
         break;
       case COLLIDER_CAPSULE:
         struct Capsule *capsule = &body->collider.data.capsule;
 
         glm_translate(model, body->position);
-        glm_rotate_y(model, glm_rad(body->rotation[1]), model);
-        glm_rotate_x(model, glm_rad(body->rotation[0]), model);
-        glm_rotate_z(model, glm_rad(body->rotation[2]), model);
+        glm_quat_rotate(model, body->rotation, model);
         glm_scale(model, body->scale);
 
-        physics_debug_capsule_render(capsule, context, body->scene_node->world_transform);
+        physics_debug_capsule_render(capsule, context, cold->scene_node->world_transform);
         // physics_debug_capsule_render(capsule, context, model);
         break;
       case COLLIDER_PLANE:
         // debug_plane_render(body);
         break;
+      case COLLIDER_OBB:
+        glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
+        physics_debug_OBB_render(&body->world_collider.data.obb, context);
+        break;
       default:
         break;
     }
@@ -239,19 +299,23 @@ void physics_debug_renderer_init(struct PhysicsWorld *physics_world){
   // Init players' bodies
   for (unsigned int i = 0; i < physics_world->num_player_bodies; i++){
     struct PhysicsBody *body = &physics_world->player_bodies[i];
+    struct PhysicsBodyCold *cold = &physics_world->player_cold[i];
     switch(body->collider.type){
       case COLLIDER_AABB:
-        physics_debug_AABB_init(body);
+        physics_debug_AABB_init(body, cold);
         break;
       case COLLIDER_SPHERE:
-        physics_debug_sphere_init(body);
+        physics_debug_sphere_init(body, cold);
         break;
       case COLLIDER_CAPSULE:
-        physics_debug_capsule_init(body);
+        physics_debug_capsule_init(body, cold);
         break;
       case COLLIDER_PLANE:
         // debug_plane_init(body);
         break;
+      case COLLIDER_OBB:
+        physics_debug_OBB_init(body, cold);
+        break;
       default:
         break;
     }
@@ -260,19 +324,48 @@ void physics_debug_renderer_init(struct PhysicsWorld *physics_world){
   // Init static bodies
   for (unsigned int i = 0; i < physics_world->num_static_bodies; i++){
     struct PhysicsBody *body = &physics_world->static_bodies[i];
+    struct PhysicsBodyCold *cold = &physics_world->static_cold[i];
     switch(body->collider.type){
       case COLLIDER_AABB:
-        physics_debug_AABB_init(body);
+        physics_debug_AABB_init(body, cold);
         break;
       case COLLIDER_SPHERE:
-        physics_debug_sphere_init(body);
+        physics_debug_sphere_init(body, cold);
         break;
       case COLLIDER_CAPSULE:
-        physics_debug_capsule_init(body);
+        physics_debug_capsule_init(body, cold);
         break;
       case COLLIDER_PLANE:
         // debug_plane_init(body);
         break;
+      case COLLIDER_OBB:
+        physics_debug_OBB_init(body, cold);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Init trigger bodies
+  for (unsigned int i = 0; i < physics_world->num_trigger_bodies; i++){
+    struct PhysicsBody *body = &physics_world->trigger_bodies[i];
+    struct PhysicsBodyCold *cold = &physics_world->trigger_cold[i];
+    switch(body->collider.type){
+      case COLLIDER_AABB:
+        physics_debug_AABB_init(body, cold);
+        break;
+      case COLLIDER_SPHERE:
+        physics_debug_sphere_init(body, cold);
+        break;
+      case COLLIDER_CAPSULE:
+        physics_debug_capsule_init(body, cold);
+        break;
+      case COLLIDER_PLANE:
+        // debug_plane_init(body);
+        break;
+      case COLLIDER_OBB:
+        physics_debug_OBB_init(body, cold);
+        break;
       default:
         break;
     }
@@ -281,26 +374,30 @@ void physics_debug_renderer_init(struct PhysicsWorld *physics_world){
   // Init dynamic bodies
   for (unsigned int i = 0; i < physics_world->num_dynamic_bodies; i++){
     struct PhysicsBody *body = &physics_world->dynamic_bodies[i];
+    struct PhysicsBodyCold *cold = &physics_world->dynamic_cold[i];
     switch(body->collider.type){
       case COLLIDER_AABB:
-        physics_debug_AABB_init(body);
+        physics_debug_AABB_init(body, cold);
         break;
       case COLLIDER_SPHERE:
-        physics_debug_sphere_init(body);
+        physics_debug_sphere_init(body, cold);
         break;
       case COLLIDER_CAPSULE:
-        physics_debug_capsule_init(body);
+        physics_debug_capsule_init(body, cold);
         break;
       case COLLIDER_PLANE:
         // debug_plane_init(body);
         break;
+      case COLLIDER_OBB:
+        physics_debug_OBB_init(body, cold);
+        break;
       default:
         break;
     }
   }
 }
 
-void physics_debug_AABB_init(struct PhysicsBody *body){
+void physics_debug_AABB_init(struct PhysicsBody *body, struct PhysicsBodyCold *cold){
   if (!wireframeShader){
     fprintf(stderr, "Error: wireframe shader program not initialized\n");
     return;
@@ -343,15 +440,15 @@ void physics_debug_AABB_init(struct PhysicsBody *body){
   // }
 
   // Buffers
-  glGenVertexArrays(1, &body->VAO);
-  glGenBuffers(1, &body->VBO);
-  glGenBuffers(1, &body->EBO);
-  glBindVertexArray(body->VAO);
+  glGenVertexArrays(1, &cold->VAO);
+  glGenBuffers(1, &cold->VBO);
+  glGenBuffers(1, &cold->EBO);
+  glBindVertexArray(cold->VAO);
 
-  glBindBuffer(GL_ARRAY_BUFFER, body->VBO);
+  glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, body->EBO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cold->EBO);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
   // Configure attribute pointer, unbind
@@ -362,7 +459,71 @@ void physics_debug_AABB_init(struct PhysicsBody *body){
   glBindVertexArray(0);
 }
 
-void physics_debug_sphere_init(struct PhysicsBody *body){
+// Corners of a box in the order physics_debug_AABB_init lists them,
+// so OBBs can share its line indices
+static const float debug_box_corner_signs[8][3] = {
+  { 1.0f,  1.0f,  1.0f},
+  { 1.0f,  1.0f, -1.0f},
+  { 1.0f, -1.0f, -1.0f},
+  { 1.0f, -1.0f,  1.0f},
+  {-1.0f, -1.0f, -1.0f},
+  {-1.0f, -1.0f,  1.0f},
+  {-1.0f,  1.0f,  1.0f},
+  {-1.0f,  1.0f, -1.0f}
+};
+
+static void physics_debug_OBB_vertices(struct OBB *obb, float *vertices){
+  for (int i = 0; i < 8; i++){
+    const float *signs = debug_box_corner_signs[i];
+    OBB_corner(obb, signs[0], signs[1], signs[2], &vertices[i * 3]);
+  }
+}
+
+void physics_debug_OBB_init(struct PhysicsBody *body, struct PhysicsBodyCold *cold){
+  if (!wireframeShader){
+    fprintf(stderr, "Error: wireframe shader program not initialized\n");
+    return;
+  }
+
+  float vertices[24];
+  physics_debug_OBB_vertices(&body->collider.data.obb, vertices);
+  unsigned int indices[24] = {
+    0, 1,
+    1, 2,
+    2, 3,
+    3, 0,
+
+    0, 6,
+    1, 7,
+    2, 4,
+    3, 5,
+
+    4, 5,
+    5, 6,
+    6, 7,
+    7, 4
+  };
+
+  // Buffers
+  glGenVertexArrays(1, &cold->VAO);
+  glGenBuffers(1, &cold->VBO);
+  glGenBuffers(1, &cold->EBO);
+  glBindVertexArray(cold->VAO);
+
+  glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cold->EBO);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+  // Configure attribute pointer, unbind
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+
+  glBindVertexArray(0);
+}
+
+void physics_debug_sphere_init(struct PhysicsBody *body, struct PhysicsBodyCold *cold){
   if (!wireframeShader){
     fprintf(stderr, "Error: wireframe shader program not initialized\n");
     return;
@@ -438,15 +599,15 @@ void physics_debug_sphere_init(struct PhysicsBody *body){
   }
 
   // Buffers
-  glGenVertexArrays(1, &body->VAO);
-  glGenBuffers(1, &body->VBO);
-  glGenBuffers(1, &body->EBO);
-  glBindVertexArray(body->VAO);
+  glGenVertexArrays(1, &cold->VAO);
+  glGenBuffers(1, &cold->VBO);
+  glGenBuffers(1, &cold->EBO);
+  glBindVertexArray(cold->VAO);
 
-  glBindBuffer(GL_ARRAY_BUFFER, body->VBO);
+  glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
   glBufferData(GL_ARRAY_BUFFER, num_vertices * 3 * sizeof(float), vertices, GL_DYNAMIC_DRAW);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, body->EBO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cold->EBO);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, num_indices * sizeof(unsigned int), indices, GL_STATIC_DRAW);
 
   // Configure attribute pointer, unbind
@@ -460,7 +621,7 @@ void physics_debug_sphere_init(struct PhysicsBody *body){
   free(indices);
 }
 
-void physics_debug_capsule_init(struct PhysicsBody *body){
+void physics_debug_capsule_init(struct PhysicsBody *body, struct PhysicsBodyCold *cold){
   if (!wireframeShader){
     fprintf(stderr, "Error: wireframe shader program not initialized\n");
     return;
@@ -627,15 +788,15 @@ void physics_debug_capsule_init(struct PhysicsBody *body){
   // printf("Successfully generated %d capsule indices\n", indices_index);
 
   // Buffers
-  glGenVertexArrays(1, &body->VAO);
-  glGenBuffers(1, &body->VBO);
-  glGenBuffers(1, &body->EBO);
-  glBindVertexArray(body->VAO);
+  glGenVertexArrays(1, &cold->VAO);
+  glGenBuffers(1, &cold->VBO);
+  glGenBuffers(1, &cold->EBO);
+  glBindVertexArray(cold->VAO);
 
-  glBindBuffer(GL_ARRAY_BUFFER, body->VBO);
+  glBindBuffer(GL_ARRAY_BUFFER, cold->VBO);
   glBufferData(GL_ARRAY_BUFFER, num_vertices * 3 * sizeof(float), vertices, GL_DYNAMIC_DRAW);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, body->EBO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cold->EBO);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, num_indices * sizeof(unsigned int), indices, GL_STATIC_DRAW);
 
   // Configure attribute pointer, unbind
@@ -649,8 +810,8 @@ void physics_debug_capsule_init(struct PhysicsBody *body){
   free(indices);
 }
 
-void physics_debug_plane_init(struct PhysicsBody *body){
-
+void physics_debug_plane_init(struct PhysicsBody *body, struct PhysicsBodyCold *cold){
+  (void)cold;
 }
 
 // Using SceneNode world transforms, since the center is not scaled, vertices must be generated
@@ -710,6 +871,24 @@ void physics_debug_AABB_render(struct AABB *aabb, struct RenderContext *context,
   // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+// The world OBB is already in world space, so its corners are buffered as is
+void physics_debug_OBB_render(struct OBB *obb, struct RenderContext *context){
+  shader_use(wireframeShader);
+  mat4 identity;
+  glm_mat4_identity(identity);
+  shader_set_mat4(wireframeShader, "model", identity);
+
+  float vertices[24];
+  physics_debug_OBB_vertices(obb, vertices);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), &vertices);
+
+  // Draw lines
+  glLineWidth(2.0f);
+  glDrawElements(GL_LINES, 24, GL_UNSIGNED_INT, 0);
+
+  glBindVertexArray(0);
+}
+
 void physics_debug_sphere_render(struct Sphere *sphere, struct RenderContext *context, mat4 model){
   // Shader and uniforms
   shader_use(translucentShader);
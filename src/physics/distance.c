@@ -1,3 +1,4 @@
+#include <float.h>
 #include "scene.h"
 #include "physics/world.h"
 #include "distance.h"
@@ -10,67 +11,23 @@ DistanceFunction distance_functions[NUM_COLLIDER_TYPES][NUM_COLLIDER_TYPES] = {
   [COLLIDER_AABB][COLLIDER_CAPSULE] = min_dist_at_time_AABB_capsule,
   [COLLIDER_AABB][COLLIDER_PLANE] = min_dist_at_time_AABB_plane,
   [COLLIDER_SPHERE][COLLIDER_SPHERE] = min_dist_at_time_sphere_sphere,
-  [COLLIDER_SPHERE][COLLIDER_CAPSULE] = min_dist_at_time_sphere_capsule,
   [COLLIDER_SPHERE][COLLIDER_PLANE] = min_dist_at_time_sphere_plane,
-  [COLLIDER_CAPSULE][COLLIDER_CAPSULE] = min_dist_at_time_capsule_capsule,
-  [COLLIDER_CAPSULE][COLLIDER_PLANE] = min_dist_at_time_capsule_plane
+  [COLLIDER_CAPSULE][COLLIDER_PLANE] = min_dist_at_time_capsule_plane,
+  [COLLIDER_AABB][COLLIDER_OBB] = min_dist_at_time_AABB_OBB,
+  [COLLIDER_SPHERE][COLLIDER_OBB] = min_dist_at_time_sphere_OBB,
+  [COLLIDER_PLANE][COLLIDER_OBB] = min_dist_at_time_plane_OBB,
+  [COLLIDER_OBB][COLLIDER_OBB] = min_dist_at_time_OBB_OBB,
+  [COLLIDER_AABB][COLLIDER_MESH] = min_dist_at_time_convex_mesh,
+  [COLLIDER_SPHERE][COLLIDER_MESH] = min_dist_at_time_convex_mesh,
+  [COLLIDER_CAPSULE][COLLIDER_MESH] = min_dist_at_time_convex_mesh,
+  [COLLIDER_OBB][COLLIDER_MESH] = min_dist_at_time_convex_mesh
 };
 
 
 float min_dist_at_time_AABB_AABB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
-  struct AABB *aabb_A = &body_A->collider.data.aabb;
-  struct AABB *aabb_B = &body_B->collider.data.aabb;
-  struct AABB world_AABB_A = {0};
-  struct AABB world_AABB_B = {0};
-
-  if (body_A->scene_node){
-    vec3 world_position_A, world_rotation_A, world_scale_A;
-    glm_mat4_mulv3(body_A->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_A);
-    glm_vec3_muladds(body_A->velocity, time, world_position_A);
-    glm_decompose_scalev(body_A->scene_node->world_transform, world_scale_A);
-    mat3 rotation_mat3_A;
-    glm_mat4_pick3(body_A->scene_node->world_transform, rotation_mat3_A);
-    if (world_scale_A[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3_A, 1.0f / world_scale_A[0]);
-    }
-    AABB_update(aabb_A, rotation_mat3_A, world_position_A, world_scale_A, &world_AABB_A);
-  }
-  if (body_B->scene_node){
-    vec3 world_position_B, world_rotation_B, world_scale_B;
-    glm_mat4_mulv3(body_B->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_B);
-    glm_vec3_muladds(body_B->velocity, time, world_position_B);
-    glm_decompose_scalev(body_B->scene_node->world_transform, world_scale_B);
-    mat3 rotation_mat3_B;
-    glm_mat4_pick3(body_B->scene_node->world_transform, rotation_mat3_B);
-    if (world_scale_B[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3_B, 1.0f / world_scale_B[0]);
-    }
-    AABB_update(aabb_B, rotation_mat3_B, world_position_B, world_scale_B, &world_AABB_B);
-  }
-
-  // // Get world space bodies
-  // mat4 eulerA;
-  // mat3 rotationA;
-  // glm_euler_xyz(body_A->rotation, eulerA);
-  // glm_mat4_pick3(eulerA, rotationA);
-  // vec3 translationA;
-  // glm_vec3_copy(body_A->position, translationA);
-  // vec3 scaleA;
-  // glm_vec3_copy(body_A->scale, scaleA);
-  // struct AABB world_AABB_A = {0};
-  // AABB_update(aabb_A, rotationA, translationA, scaleA, &world_AABB_A);
-  //
-  // // Get world space bodies
-  // mat4 eulerB;
-  // mat3 rotationB;
-  // glm_euler_xyz(body_B->rotation, eulerB);
-  // glm_mat4_pick3(eulerB, rotationB);
-  // vec3 translationB;
-  // glm_vec3_copy(body_B->position, translationB);
-  // vec3 scaleB;
-  // glm_vec3_copy(body_B->scale, scaleB);
-  // struct AABB world_AABB_B = {0};
-  // AABB_update(aabb_B, rotationB, translationB, scaleB, &world_AABB_B);
+  struct AABB world_AABB_A, world_AABB_B;
+  physics_body_get_world_AABB(body_A, time, &world_AABB_A);
+  physics_body_get_world_AABB(body_B, time, &world_AABB_B);
 
   // Find squared distance on all 3 axes
   float distance_squared = 0.0f;
@@ -92,55 +49,10 @@ float min_dist_at_time_AABB_AABB(struct PhysicsBody *body_A, struct PhysicsBody
 }
 
 float min_dist_at_time_AABB_sphere(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
-  struct AABB *box = &body_A->collider.data.aabb;
-  struct Sphere *sphere = &body_B->collider.data.sphere;
-  struct AABB world_AABB = {0};
-  struct Sphere world_sphere = {0};
-
-  // Get world space bodies
-  if (body_A->scene_node){
-    vec3 world_position_A, world_rotation_A, world_scale_A;
-    glm_mat4_mulv3(body_A->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_A);
-    glm_vec3_muladds(body_A->velocity, time, world_position_A);
-    glm_decompose_scalev(body_A->scene_node->world_transform, world_scale_A);
-    mat3 rotation_mat3_A;
-    glm_mat4_pick3(body_A->scene_node->world_transform, rotation_mat3_A);
-    if (world_scale_A[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3_A, 1.0f / world_scale_A[0]);
-    }
-    AABB_update(box, rotation_mat3_A, world_position_A, world_scale_A, &world_AABB);
-  }
-  if (body_B->scene_node){
-    vec3 world_position_B, world_rotation_B, world_scale_B;
-    glm_mat4_mulv3(body_B->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_B);
-    glm_decompose_scalev(body_B->scene_node->world_transform, world_scale_B);
-    // mat3 rotation_mat3_B;
-    // glm_mat4_pick3(body_B->scene_node->world_transform, rotation_mat3_B);
-    // if (world_scale_B[0] != 0.0f){
-    //   glm_mat3_scale(rotation_mat3_B, 1.0f / world_scale_B[0]);
-    // }
-    glm_vec3_muladds(body_B->velocity, time, world_position_B);
-    glm_vec3_add(sphere->center, world_position_B, world_sphere.center);
-    world_sphere.radius = sphere->radius * world_scale_B[0];
-  }
-
-  // mat4 eulerA;
-  // mat3 rotationA;
-  // glm_euler_xyz(body_A->rotation, eulerA);
-  // glm_mat4_pick3(eulerA, rotationA);
-  //
-  // vec3 translationA, scaleA;
-  // glm_vec3_copy(body_A->position, translationA);
-  // glm_vec3_muladds(body_A->velocity, time, translationA);
-  // glm_vec3_copy(body_A->scale, scaleA);
-  //
-  // struct AABB world_AABB = {0};
-  // AABB_update(box, rotationA, translationA, scaleA, &world_AABB);
-
-  // struct Sphere world_sphere = {0};
-  // glm_vec3_add(sphere->center, body_B->position, world_sphere.center);
-  // glm_vec3_muladds(body_B->velocity, time, world_sphere.center);
-  // world_sphere.radius = sphere->radius * body_B->scale[0];
+  struct AABB world_AABB;
+  struct Sphere world_sphere;
+  physics_body_get_world_AABB(body_A, time, &world_AABB);
+  physics_body_get_world_sphere(body_B, time, &world_sphere);
 
   // Get squared distance between center and AABB
   float distance_squared = 0.0f;
@@ -158,60 +70,15 @@ float min_dist_at_time_AABB_sphere(struct PhysicsBody *body_A, struct PhysicsBod
 }
 
 float min_dist_at_time_AABB_capsule(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
-  // Get pointers to the bodies' colliders
-  struct AABB *box = &body_A->collider.data.aabb;
-  struct Capsule *capsule = &body_B->collider.data.capsule;
-
-  struct AABB world_AABB = {0};
-  struct AABB world_AABB_final = {0};
-  struct Capsule world_capsule = {0};
-
-  // Apply world transform to bodies
-  if (body_A->scene_node){
-    vec3 world_position, world_rotation, world_scale;
-    glm_mat4_mulv3(body_A->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position);
-    glm_vec3_muladds(body_A->velocity, time, world_position);
-    glm_decompose_scalev(body_A->scene_node->world_transform, world_scale);
-    mat3 rotation_mat3;
-    glm_mat4_pick3(body_A->scene_node->world_transform, rotation_mat3);
-    if (world_scale[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3, 1.0f / world_scale[0]);
-    }
-    AABB_update(box, rotation_mat3, world_position, world_scale, &world_AABB_final);
-  }
-  else{
-    world_AABB = *box;
-  }
-  if (body_B->scene_node){
-    // Transform capsule
-    glm_mat4_mulv3(body_B->scene_node->world_transform, capsule->segment_A, 1.0f, world_capsule.segment_A);
-    glm_mat4_mulv3(body_B->scene_node->world_transform, capsule->segment_B, 1.0f, world_capsule.segment_B);
-  }
-  // Player capsule
-  // else{
-  //   // Scale
-  //   glm_vec3_scale(capsule->segment_A, body_B->scale[0], world_capsule.segment_A);
-  //   glm_vec3_scale(capsule->segment_B, body_B->scale[0], world_capsule.segment_B);
-  //   // Rotate
-  //   mat4 eulerA;
-  //   mat3 rotationA;
-  //   vec3 rotatedA, rotatedB;
-  //   glm_euler_xyz(body_B->rotation, eulerA);
-  //   glm_mat4_pick3(eulerA, rotationA);
-  //   glm_mat3_mulv(rotationA, world_capsule.segment_A, world_capsule.segment_A);
-  //   glm_mat3_mulv(rotationA, world_capsule.segment_B, world_capsule.segment_B);
-  //   glm_vec3_add(world_capsule.segment_A, body_B->position, world_capsule.segment_A);
-  //   glm_vec3_add(world_capsule.segment_B, body_B->position, world_capsule.segment_B);
-  // }
-
-  // glm_vec3_muladds(body_B->velocity, time, world_capsule.segment_A);
-  // glm_vec3_muladds(body_B->velocity, time, world_capsule.segment_B);
-  world_capsule.radius = capsule->radius * body_B->scale[0];
+  struct AABB world_AABB;
+  struct Capsule world_capsule;
+  physics_body_get_world_AABB(body_A, time, &world_AABB);
+  physics_body_get_world_capsule(body_B, time, &world_capsule);
 
   // Find closest point on segment to AABB center
   vec3 segment, A_to_center;
   glm_vec3_sub(world_capsule.segment_B, world_capsule.segment_A, segment);
-  glm_vec3_sub(world_AABB_final.center, world_capsule.segment_A, A_to_center);
+  glm_vec3_sub(world_AABB.center, world_capsule.segment_A, A_to_center);
   float proj = glm_dot(segment, A_to_center);
   // Normalize projection of A->center onto segment, clamp between 0 and 1
   float t = proj / glm_vec3_dot(segment, segment);
@@ -223,14 +90,14 @@ float min_dist_at_time_AABB_capsule(struct PhysicsBody *body_A, struct PhysicsBo
   glm_vec3_muladds(segment, t, closest_point);
   // print_glm_vec3(world_capsule.segment_A, "World capsule segment A");
   // printf("World AABB is:\n");
-  // print_aabb(&world_AABB_final);
+  // print_aabb(&world_AABB);
   // print_glm_vec3(closest_point, "Closest point on segment to AABB");
 
   // Closest point on the AABB is the closest point on the segment clamped
   // to the extents of the AABB
   vec3 q;
   for (int i = 0; i < 3; i++){
-    q[i] = glm_clamp(closest_point[i], world_AABB_final.center[i] - world_AABB_final.extents[i], world_AABB_final.center[i] + world_AABB_final.extents[i]);
+    q[i] = glm_clamp(closest_point[i], world_AABB.center[i] - world_AABB.extents[i], world_AABB.center[i] + world_AABB.extents[i]);
   }
   // print_glm_vec3(q, "Closest point on AABB to capsule");
 
@@ -245,138 +112,43 @@ float min_dist_at_time_AABB_capsule(struct PhysicsBody *body_A, struct PhysicsBo
 
 float min_dist_at_time_AABB_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
 
-  // Get pointers to the bodies' colliders
-  struct AABB *box = &body_A->collider.data.aabb;
-  struct Plane *plane = &body_B->collider.data.plane;
-
-  // Get world space AABB to find minimum distance
-  mat4 eulerA;
-  mat3 rotationA;
-  glm_euler_xyz(body_A->rotation, eulerA);
-  glm_mat4_pick3(eulerA, rotationA);
-
-  vec3 translationA, scaleA;
-  glm_vec3_copy(body_A->position, translationA);
-  glm_vec3_muladds(body_A->velocity, time, translationA);
-  glm_vec3_copy(body_A->scale, scaleA);
-    
-  struct AABB worldAABB_A = {0};
-  AABB_update(box, rotationA, translationA, scaleA, &worldAABB_A);
+  struct AABB world_AABB;
+  struct Plane world_plane;
+  physics_body_get_world_AABB(body_A, time, &world_AABB);
+  physics_body_get_world_plane(body_B, time, &world_plane);
 
   // Get radius of the extents' projection interval onto the plane's normal
   float r =
-    worldAABB_A.extents[0] * fabs(plane->normal[0]) +
-    worldAABB_A.extents[1] * fabs(plane->normal[1]) +
-    worldAABB_A.extents[2] * fabs(plane->normal[2]); 
+    world_AABB.extents[0] * fabs(world_plane.normal[0]) +
+    world_AABB.extents[1] * fabs(world_plane.normal[1]) +
+    world_AABB.extents[2] * fabs(world_plane.normal[2]); 
   // Get distance from the center of AABB to the plane
-  float s = glm_dot(plane->normal, worldAABB_A.center) - plane->distance;
+  float s = glm_dot(world_plane.normal, world_AABB.center) - world_plane.distance;
 
   // If distance (s - r) is negative, their minimum distance is 0
   return glm_max(s - r, 0);
 }
 
 float min_dist_at_time_sphere_sphere(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
-  struct Sphere *sphere_A = &body_A->collider.data.sphere;
-  struct Sphere *sphere_B = &body_B->collider.data.sphere;
-
-  struct Sphere world_sphere_A = {0};
-  glm_vec3_add(sphere_A->center, body_A->position, world_sphere_A.center);
-  glm_vec3_muladds(body_A->velocity, time, world_sphere_A.center);
-  world_sphere_A.radius = sphere_A->radius * body_A->scale[0];
-
-  struct Sphere world_sphere_B = {0};
-  glm_vec3_add(sphere_B->center, body_B->position, world_sphere_B.center);
-  glm_vec3_muladds(body_B->velocity, time, world_sphere_B.center);
-  world_sphere_B.radius = sphere_B->radius * body_B->scale[0];
-
-  // Distance between spheres: distance between centers - sum of radii
-  vec3 difference;
-  glm_vec3_sub(world_sphere_A.center, world_sphere_B.center, difference);
-  float distance_squared = glm_dot(difference, difference);
-  float radius_sum = world_sphere_A.radius + world_sphere_B.radius;
-
-  return distance_squared < (radius_sum * radius_sum) ? 0.0f : sqrt(distance_squared) - radius_sum;
-}
-
-float min_dist_at_time_sphere_capsule(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
-
+  struct Sphere world_sphere_A, world_sphere_B;
+  physics_body_get_world_sphere(body_A, time, &world_sphere_A);
+  physics_body_get_world_sphere(body_B, time, &world_sphere_B);
+  return sphere_distance_sphere(&world_sphere_A, &world_sphere_B);
 }
 
 float min_dist_at_time_sphere_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
-  // Get pointers to the bodies' colliders
-  struct Sphere *sphere = &body_A->collider.data.sphere;
-  struct Plane *plane = &body_B->collider.data.plane;
-
-  struct Sphere world_sphere = {0};
-  glm_vec3_add(sphere->center, body_A->position, world_sphere.center);
-  glm_vec3_muladds(body_A->velocity, time, world_sphere.center);
-  // glm_vec3_scale(world_sphere.center, body_A->scale[0], world_sphere.center);
-  world_sphere.radius = sphere->radius * body_A->scale[0];
-
-  // Not finding a radius of projection, just want signed distance
-  float s = glm_dot(world_sphere.center, plane->normal) - plane->distance;
-  float distance = fabs(s) - world_sphere.radius;
-
-  return glm_max(distance, 0);
-}
-
-float min_dist_at_time_capsule_capsule(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
-  return 0;
+  struct Sphere world_sphere;
+  struct Plane world_plane;
+  physics_body_get_world_sphere(body_A, time, &world_sphere);
+  physics_body_get_world_plane(body_B, time, &world_plane);
+  return sphere_distance_plane(&world_sphere, &world_plane);
 }
 
 float min_dist_at_time_capsule_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
-  // Get pointers to the bodies' colliders
-  struct Capsule *capsule = &body_A->collider.data.capsule;
-  struct Plane *plane = &body_B->collider.data.plane;
-
-  struct Capsule world_capsule = {0};
-  struct Plane world_plane = {0};
-
-  // Apply world transform to bodies
-  // TODO Give Player a SceneNode
-  if (body_A->scene_node){
-    // Transform capsule
-    glm_mat4_mulv3(body_A->scene_node->world_transform, capsule->segment_A, 1.0f, world_capsule.segment_A);
-    glm_mat4_mulv3(body_A->scene_node->world_transform, capsule->segment_B, 1.0f, world_capsule.segment_B);
-  }
-  if (body_B->scene_node){
-    mat3 rotation_mat3;
-    vec3 world_position, world_rotation, world_scale;
-    glm_mat4_mulv3(body_B->scene_node->parent_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position);
-    glm_decompose_scalev(body_B->scene_node->parent_node->world_transform, world_scale);
-    glm_mat4_pick3(body_B->scene_node->parent_node->world_transform, rotation_mat3);
-    if (world_scale[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3, 1.0f / world_scale[0]);
-    }
-
-    // Transform plane
-    // print_glm_vec3(plane->normal, "Wall plane normal before transformation");
-    // print_glm_mat3(rotation_mat3, "Rotation mat3");
-    // glm_vec3_copy(plane->normal, world_plane.normal);
-    glm_mat3_mulv(rotation_mat3, plane->normal, world_plane.normal);
-    glm_vec3_normalize(world_plane.normal);
-    world_plane.distance = (plane->distance) + glm_vec3_dot(world_position, world_plane.normal);
-    // if (plane->distance == -5){
-    //   print_glm_vec3(plane->normal, "Wall plane normal");
-    //   print_glm_mat4(body_B->scene_node->world_transform, "World transform");
-    //   print_glm_vec3(world_plane.normal, "World wall plane normal");
-    // }
-  }
-
-  // Scale
-  glm_vec3_scale(capsule->segment_A, body_A->scale[0], world_capsule.segment_A);
-  glm_vec3_scale(capsule->segment_B, body_A->scale[0], world_capsule.segment_B);
-  // Rotate
-  mat4 eulerA;
-  mat3 rotationA;
-  vec3 rotatedA, rotatedB;
-  glm_euler_xyz(body_A->rotation, eulerA);
-  glm_mat4_pick3(eulerA, rotationA);
-  glm_mat3_mulv(rotationA, world_capsule.segment_A, world_capsule.segment_A);
-  glm_mat3_mulv(rotationA, world_capsule.segment_B, world_capsule.segment_B);
-  glm_vec3_add(world_capsule.segment_A, body_A->position, world_capsule.segment_A);
-  glm_vec3_add(world_capsule.segment_B, body_A->position, world_capsule.segment_B);
-  world_capsule.radius = capsule->radius * body_A->scale[0];
+  struct Capsule world_capsule;
+  struct Plane world_plane;
+  physics_body_get_world_capsule(body_A, time, &world_capsule);
+  physics_body_get_world_plane(body_B, time, &world_plane);
 
   // Get signed distance from capsule to plane: distance from point to plane minus radius
   // - A capsule is a sphere-swept volume, which is just a line segment and a radius
@@ -408,3 +180,63 @@ float min_dist_at_time_capsule_plane(struct PhysicsBody *body_A, struct PhysicsB
 
   return glm_max(distance, 0);
 }
+
+// The largest separation over the SAT axes is a lower bound on the distance between
+// two boxes (exact when it's along a face normal), which is all conservative advancement needs
+float min_dist_at_time_AABB_OBB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
+  struct AABB world_AABB;
+  struct OBB box_A, box_B;
+  physics_body_get_world_AABB(body_A, time, &world_AABB);
+  physics_body_get_world_OBB(body_B, time, &box_B);
+  OBB_from_AABB(&world_AABB, &box_A);
+
+  struct OBBSeparation separation;
+  OBB_separating_axis(&box_A, &box_B, &separation);
+  return glm_max(separation.separation, 0);
+}
+
+float min_dist_at_time_sphere_OBB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
+  struct Sphere world_sphere;
+  struct OBB world_OBB;
+  physics_body_get_world_sphere(body_A, time, &world_sphere);
+  physics_body_get_world_OBB(body_B, time, &world_OBB);
+
+  float distance_squared = OBB_distance_squared_point(&world_OBB, world_sphere.center);
+  return distance_squared < (world_sphere.radius * world_sphere.radius) ? 0.0f : sqrt(distance_squared) - world_sphere.radius;
+}
+
+float min_dist_at_time_plane_OBB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
+  struct Plane world_plane;
+  struct OBB world_OBB;
+  physics_body_get_world_plane(body_A, time, &world_plane);
+  physics_body_get_world_OBB(body_B, time, &world_OBB);
+
+  float r = OBB_projection_radius(&world_OBB, world_plane.normal);
+  float s = glm_dot(world_plane.normal, world_OBB.center) - world_plane.distance;
+  return glm_max(fabs(s) - r, 0);
+}
+
+float min_dist_at_time_OBB_OBB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
+  struct OBB box_A, box_B;
+  physics_body_get_world_OBB(body_A, time, &box_A);
+  physics_body_get_world_OBB(body_B, time, &box_B);
+
+  struct OBBSeparation separation;
+  OBB_separating_axis(&box_A, &box_B, &separation);
+  return glm_max(separation.separation, 0);
+}
+
+// Closest triangle in the mesh's BVH. Exact for spheres and capsules,
+// the SAT lower bound for boxes
+float min_dist_at_time_convex_mesh(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
+  struct ConvexShape shape;
+  struct MeshCollider world_mesh;
+  struct MeshContact contact;
+  convex_shape_from_body(body_A, time, &shape);
+  physics_body_get_world_mesh(body_B, time, &world_mesh);
+
+  if (!mesh_collider_contact(&world_mesh, &shape, &contact)){
+    return FLT_MAX;
+  }
+  return glm_max(contact.distance, 0);
+}
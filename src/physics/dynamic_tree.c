@@ -0,0 +1,466 @@
+#include "physics/dynamic_tree.h"
+#include <cglm/util.h>
+#include <cglm/vec3.h>
+
+#define DYNAMIC_TREE_INITIAL_CAPACITY 64
+#define DYNAMIC_TREE_STACK_CAPACITY 256
+
+// Chain nodes [start, max_nodes) onto the free list
+static void dynamic_tree_link_free_nodes(struct DynamicTree *tree, int start){
+  for (int i = start; i < tree->max_nodes - 1; i++){
+    tree->nodes[i].parent = i + 1;
+    tree->nodes[i].height = -1;
+  }
+  tree->nodes[tree->max_nodes - 1].parent = DYNAMIC_TREE_NULL_NODE;
+  tree->nodes[tree->max_nodes - 1].height = -1;
+  tree->free_list = start;
+}
+
+bool dynamic_tree_init(struct DynamicTree *tree){
+  tree->root = DYNAMIC_TREE_NULL_NODE;
+  tree->num_nodes = 0;
+  tree->max_nodes = DYNAMIC_TREE_INITIAL_CAPACITY;
+  tree->nodes = (struct DynamicTreeNode *)calloc(tree->max_nodes, sizeof(struct DynamicTreeNode));
+  if (!tree->nodes){
+    fprintf(stderr, "Error: failed to allocate nodes in dynamic_tree_init\n");
+    tree->max_nodes = 0;
+    tree->free_list = DYNAMIC_TREE_NULL_NODE;
+    return false;
+  }
+  dynamic_tree_link_free_nodes(tree, 0);
+  return true;
+}
+
+void dynamic_tree_free(struct DynamicTree *tree){
+  free(tree->nodes);
+  tree->nodes = NULL;
+  tree->root = DYNAMIC_TREE_NULL_NODE;
+  tree->num_nodes = 0;
+  tree->max_nodes = 0;
+  tree->free_list = DYNAMIC_TREE_NULL_NODE;
+}
+
+static int dynamic_tree_allocate_node(struct DynamicTree *tree){
+  // Grow the pool if the free list is empty
+  if (tree->free_list == DYNAMIC_TREE_NULL_NODE){
+    int new_max_nodes = tree->max_nodes ? tree->max_nodes * 2 : DYNAMIC_TREE_INITIAL_CAPACITY;
+    struct DynamicTreeNode *new_nodes = (struct DynamicTreeNode *)realloc(tree->nodes, new_max_nodes * sizeof(struct DynamicTreeNode));
+    if (!new_nodes){
+      fprintf(stderr, "Error: failed to realloc nodes in dynamic_tree_allocate_node\n");
+      return DYNAMIC_TREE_NULL_NODE;
+    }
+    int old_max_nodes = tree->max_nodes;
+    tree->nodes = new_nodes;
+    tree->max_nodes = new_max_nodes;
+    dynamic_tree_link_free_nodes(tree, old_max_nodes);
+  }
+
+  int node_id = tree->free_list;
+  struct DynamicTreeNode *node = &tree->nodes[node_id];
+  tree->free_list = node->parent;
+  node->parent = DYNAMIC_TREE_NULL_NODE;
+  node->left = DYNAMIC_TREE_NULL_NODE;
+  node->right = DYNAMIC_TREE_NULL_NODE;
+  node->height = 0;
+  node->user_data = NULL;
+  tree->num_nodes++;
+  return node_id;
+}
+
+static void dynamic_tree_free_node(struct DynamicTree *tree, int node_id){
+  tree->nodes[node_id].parent = tree->free_list;
+  tree->nodes[node_id].height = -1;
+  tree->free_list = node_id;
+  tree->num_nodes--;
+}
+
+static bool dynamic_tree_is_leaf(struct DynamicTreeNode *node){
+  return node->left == DYNAMIC_TREE_NULL_NODE;
+}
+
+// Perform a left or right rotation if node A is imbalanced.
+// Returns the new root of the subtree.
+static int dynamic_tree_balance(struct DynamicTree *tree, int index_A){
+  struct DynamicTreeNode *A = &tree->nodes[index_A];
+  if (dynamic_tree_is_leaf(A) || A->height < 2){
+    return index_A;
+  }
+
+  int index_B = A->left;
+  int index_C = A->right;
+  struct DynamicTreeNode *B = &tree->nodes[index_B];
+  struct DynamicTreeNode *C = &tree->nodes[index_C];
+
+  int balance = C->height - B->height;
+
+  // Rotate C up
+  if (balance > 1){
+    int index_F = C->left;
+    int index_G = C->right;
+    struct DynamicTreeNode *F = &tree->nodes[index_F];
+    struct DynamicTreeNode *G = &tree->nodes[index_G];
+
+    C->left = index_A;
+    C->parent = A->parent;
+    A->parent = index_C;
+
+    if (C->parent != DYNAMIC_TREE_NULL_NODE){
+      if (tree->nodes[C->parent].left == index_A) tree->nodes[C->parent].left = index_C;
+      else tree->nodes[C->parent].right = index_C;
+    }
+    else{
+      tree->root = index_C;
+    }
+
+    if (F->height > G->height){
+      C->right = index_F;
+      A->right = index_G;
+      G->parent = index_A;
+      AABB_union(&B->aabb, &G->aabb, &A->aabb);
+      AABB_union(&A->aabb, &F->aabb, &C->aabb);
+      A->height = 1 + glm_max(B->height, G->height);
+      C->height = 1 + glm_max(A->height, F->height);
+    }
+    else{
+      C->right = index_G;
+      A->right = index_F;
+      F->parent = index_A;
+      AABB_union(&B->aabb, &F->aabb, &A->aabb);
+      AABB_union(&A->aabb, &G->aabb, &C->aabb);
+      A->height = 1 + glm_max(B->height, F->height);
+      C->height = 1 + glm_max(A->height, G->height);
+    }
+    return index_C;
+  }
+
+  // Rotate B up
+  if (balance < -1){
+    int index_D = B->left;
+    int index_E = B->right;
+    struct DynamicTreeNode *D = &tree->nodes[index_D];
+    struct DynamicTreeNode *E = &tree->nodes[index_E];
+
+    B->left = index_A;
+    B->parent = A->parent;
+    A->parent = index_B;
+
+    if (B->parent != DYNAMIC_TREE_NULL_NODE){
+      if (tree->nodes[B->parent].left == index_A) tree->nodes[B->parent].left = index_B;
+      else tree->nodes[B->parent].right = index_B;
+    }
+    else{
+      tree->root = index_B;
+    }
+
+    if (D->height > E->height){
+      B->right = index_D;
+      A->left = index_E;
+      E->parent = index_A;
+      AABB_union(&C->aabb, &E->aabb, &A->aabb);
+      AABB_union(&A->aabb, &D->aabb, &B->aabb);
+      A->height = 1 + glm_max(C->height, E->height);
+      B->height = 1 + glm_max(A->height, D->height);
+    }
+    else{
+      B->right = index_E;
+      A->left = index_D;
+      D->parent = index_A;
+      AABB_union(&C->aabb, &D->aabb, &A->aabb);
+      AABB_union(&A->aabb, &E->aabb, &B->aabb);
+      A->height = 1 + glm_max(C->height, D->height);
+      B->height = 1 + glm_max(A->height, E->height);
+    }
+    return index_B;
+  }
+
+  return index_A;
+}
+
+// Walk from index back up to the root, refitting AABBs and heights
+static void dynamic_tree_refit_ancestors(struct DynamicTree *tree, int index){
+  while (index != DYNAMIC_TREE_NULL_NODE){
+    index = dynamic_tree_balance(tree, index);
+
+    struct DynamicTreeNode *node = &tree->nodes[index];
+    struct DynamicTreeNode *left = &tree->nodes[node->left];
+    struct DynamicTreeNode *right = &tree->nodes[node->right];
+    node->height = 1 + glm_max(left->height, right->height);
+    AABB_union(&left->aabb, &right->aabb, &node->aabb);
+
+    index = node->parent;
+  }
+}
+
+// Returns false, leaving the leaf unlinked, if a parent node couldn't be allocated for it
+static bool dynamic_tree_insert_leaf(struct DynamicTree *tree, int leaf){
+  if (tree->root == DYNAMIC_TREE_NULL_NODE){
+    tree->root = leaf;
+    tree->nodes[leaf].parent = DYNAMIC_TREE_NULL_NODE;
+    return true;
+  }
+
+  // Find the best sibling using the surface area heuristic
+  struct AABB leaf_aabb = tree->nodes[leaf].aabb;
+  int index = tree->root;
+  while (!dynamic_tree_is_leaf(&tree->nodes[index])){
+    struct DynamicTreeNode *node = &tree->nodes[index];
+    int left = node->left;
+    int right = node->right;
+
+    float area = AABB_surface_area(&node->aabb);
+    struct AABB combined;
+    AABB_union(&node->aabb, &leaf_aabb, &combined);
+    float combined_area = AABB_surface_area(&combined);
+
+    // Cost of creating a new parent for this node and the new leaf
+    float cost = 2.0f * combined_area;
+    // Minimum cost of pushing the leaf further down the tree
+    float inheritance_cost = 2.0f * (combined_area - area);
+
+    float cost_left, cost_right;
+    struct AABB child_combined;
+
+    AABB_union(&tree->nodes[left].aabb, &leaf_aabb, &child_combined);
+    if (dynamic_tree_is_leaf(&tree->nodes[left])){
+      cost_left = AABB_surface_area(&child_combined) + inheritance_cost;
+    }
+    else{
+      cost_left = AABB_surface_area(&child_combined) - AABB_surface_area(&tree->nodes[left].aabb) + inheritance_cost;
+    }
+
+    AABB_union(&tree->nodes[right].aabb, &leaf_aabb, &child_combined);
+    if (dynamic_tree_is_leaf(&tree->nodes[right])){
+      cost_right = AABB_surface_area(&child_combined) + inheritance_cost;
+    }
+    else{
+      cost_right = AABB_surface_area(&child_combined) - AABB_surface_area(&tree->nodes[right].aabb) + inheritance_cost;
+    }
+
+    if (cost < cost_left && cost < cost_right){
+      break;
+    }
+    index = (cost_left < cost_right) ? left : right;
+  }
+  int sibling = index;
+
+  // Create a new parent for the sibling and the leaf
+  int old_parent = tree->nodes[sibling].parent;
+  int new_parent = dynamic_tree_allocate_node(tree);
+  if (new_parent == DYNAMIC_TREE_NULL_NODE){
+    return false;
+  }
+  tree->nodes[new_parent].parent = old_parent;
+  AABB_union(&leaf_aabb, &tree->nodes[sibling].aabb, &tree->nodes[new_parent].aabb);
+  tree->nodes[new_parent].height = tree->nodes[sibling].height + 1;
+  tree->nodes[new_parent].left = sibling;
+  tree->nodes[new_parent].right = leaf;
+  tree->nodes[sibling].parent = new_parent;
+  tree->nodes[leaf].parent = new_parent;
+
+  if (old_parent != DYNAMIC_TREE_NULL_NODE){
+    if (tree->nodes[old_parent].left == sibling) tree->nodes[old_parent].left = new_parent;
+    else tree->nodes[old_parent].right = new_parent;
+  }
+  else{
+    tree->root = new_parent;
+  }
+
+  dynamic_tree_refit_ancestors(tree, tree->nodes[leaf].parent);
+  return true;
+}
+
+static void dynamic_tree_remove_leaf(struct DynamicTree *tree, int leaf){
+  if (leaf == tree->root){
+    tree->root = DYNAMIC_TREE_NULL_NODE;
+    return;
+  }
+
+  int parent = tree->nodes[leaf].parent;
+  int grandparent = tree->nodes[parent].parent;
+  int sibling = (tree->nodes[parent].left == leaf) ? tree->nodes[parent].right : tree->nodes[parent].left;
+
+  // Replace the parent with the sibling and free the parent
+  if (grandparent != DYNAMIC_TREE_NULL_NODE){
+    if (tree->nodes[grandparent].left == parent) tree->nodes[grandparent].left = sibling;
+    else tree->nodes[grandparent].right = sibling;
+    tree->nodes[sibling].parent = grandparent;
+    dynamic_tree_free_node(tree, parent);
+    dynamic_tree_refit_ancestors(tree, grandparent);
+  }
+  else{
+    tree->root = sibling;
+    tree->nodes[sibling].parent = DYNAMIC_TREE_NULL_NODE;
+    dynamic_tree_free_node(tree, parent);
+  }
+}
+
+int dynamic_tree_create_proxy(struct DynamicTree *tree, struct AABB *aabb, void *user_data){
+  int proxy_id = dynamic_tree_allocate_node(tree);
+  if (proxy_id == DYNAMIC_TREE_NULL_NODE){
+    fprintf(stderr, "Error: failed to allocate proxy in dynamic_tree_create_proxy\n");
+    return DYNAMIC_TREE_NULL_NODE;
+  }
+
+  // Fatten the AABB
+  struct DynamicTreeNode *node = &tree->nodes[proxy_id];
+  glm_vec3_copy(aabb->center, node->aabb.center);
+  glm_vec3_adds(aabb->extents, DYNAMIC_TREE_AABB_MARGIN, node->aabb.extents);
+  node->aabb.initialized = true;
+  node->user_data = user_data;
+  node->height = 0;
+
+  if (!dynamic_tree_insert_leaf(tree, proxy_id)){
+    fprintf(stderr, "Error: failed to insert proxy in dynamic_tree_create_proxy\n");
+    dynamic_tree_free_node(tree, proxy_id);
+    return DYNAMIC_TREE_NULL_NODE;
+  }
+  return proxy_id;
+}
+
+void dynamic_tree_destroy_proxy(struct DynamicTree *tree, int proxy_id){
+  if (proxy_id < 0 || proxy_id >= tree->max_nodes || !dynamic_tree_is_leaf(&tree->nodes[proxy_id])){
+    fprintf(stderr, "Error: invalid proxy id %d in dynamic_tree_destroy_proxy\n", proxy_id);
+    return;
+  }
+  dynamic_tree_remove_leaf(tree, proxy_id);
+  dynamic_tree_free_node(tree, proxy_id);
+}
+
+// Reinsert the proxy if aabb has left its fat AABB.
+// The new fat AABB is extended in the direction of displacement
+// so a body moving steadily doesn't need to be reinserted every step.
+// Returns true if the proxy was reinserted.
+bool dynamic_tree_move_proxy(struct DynamicTree *tree, int proxy_id, struct AABB *aabb, vec3 displacement){
+  if (proxy_id < 0 || proxy_id >= tree->max_nodes || !dynamic_tree_is_leaf(&tree->nodes[proxy_id])){
+    fprintf(stderr, "Error: invalid proxy id %d in dynamic_tree_move_proxy\n", proxy_id);
+    return false;
+  }
+  if (AABB_contains(&tree->nodes[proxy_id].aabb, aabb)){
+    return false;
+  }
+
+  dynamic_tree_remove_leaf(tree, proxy_id);
+
+  vec3 min, max;
+  for (int i = 0; i < 3; i++){
+    min[i] = aabb->center[i] - aabb->extents[i] - DYNAMIC_TREE_AABB_MARGIN;
+    max[i] = aabb->center[i] + aabb->extents[i] + DYNAMIC_TREE_AABB_MARGIN;
+
+    float predicted = DYNAMIC_TREE_DISPLACEMENT_MULTIPLIER * displacement[i];
+    if (predicted < 0.0f) min[i] += predicted;
+    else max[i] += predicted;
+  }
+
+  struct AABB *fat_aabb = &tree->nodes[proxy_id].aabb;
+  for (int i = 0; i < 3; i++){
+    fat_aabb->center[i] = (min[i] + max[i]) * 0.5f;
+    fat_aabb->extents[i] = (max[i] - min[i]) * 0.5f;
+  }
+  fat_aabb->initialized = true;
+
+  // Removing the leaf freed its parent (or emptied the tree), so reinserting it can't run out of nodes
+  dynamic_tree_insert_leaf(tree, proxy_id);
+  return true;
+}
+
+void *dynamic_tree_get_user_data(struct DynamicTree *tree, int proxy_id){
+  return tree->nodes[proxy_id].user_data;
+}
+
+void dynamic_tree_set_user_data(struct DynamicTree *tree, int proxy_id, void *user_data){
+  tree->nodes[proxy_id].user_data = user_data;
+}
+
+struct AABB *dynamic_tree_get_fat_AABB(struct DynamicTree *tree, int proxy_id){
+  return &tree->nodes[proxy_id].aabb;
+}
+
+// Make room for two more nodes on a traversal stack, moving it to the heap
+// once it outgrows the caller's fixed buffer
+static bool dynamic_tree_reserve_stack(int **stack, int *stack_capacity, int stack_count, int *stack_buffer){
+  if (stack_count + 2 <= *stack_capacity) return true;
+  int new_capacity = *stack_capacity * 2;
+  int *new_stack = (int *)malloc(new_capacity * sizeof(int));
+  if (!new_stack) return false;
+  memcpy(new_stack, *stack, stack_count * sizeof(int));
+  if (*stack != stack_buffer) free(*stack);
+  *stack = new_stack;
+  *stack_capacity = new_capacity;
+  return true;
+}
+
+void dynamic_tree_query(struct DynamicTree *tree, struct AABB *aabb, DynamicTreeQueryCallback callback, void *context){
+  if (tree->root == DYNAMIC_TREE_NULL_NODE) return;
+
+  // Iterative traversal with a small fixed stack, spilling to the heap for very deep trees
+  int stack_buffer[DYNAMIC_TREE_STACK_CAPACITY];
+  int *stack = stack_buffer;
+  int stack_capacity = DYNAMIC_TREE_STACK_CAPACITY;
+  int stack_count = 0;
+  stack[stack_count++] = tree->root;
+
+  while (stack_count > 0){
+    int index = stack[--stack_count];
+    struct DynamicTreeNode *node = &tree->nodes[index];
+    if (!AABB_intersect_AABB(&node->aabb, aabb)) continue;
+
+    if (dynamic_tree_is_leaf(node)){
+      if (!callback(index, node->user_data, context)) break;
+      continue;
+    }
+
+    if (!dynamic_tree_reserve_stack(&stack, &stack_capacity, stack_count, stack_buffer)){
+      fprintf(stderr, "Error: failed to grow traversal stack in dynamic_tree_query\n");
+      break;
+    }
+    stack[stack_count++] = node->left;
+    stack[stack_count++] = node->right;
+  }
+
+  if (stack != stack_buffer) free(stack);
+}
+
+void dynamic_tree_ray_cast(struct DynamicTree *tree, vec3 origin, vec3 translation, vec3 extents, float max_fraction, DynamicTreeRayCastCallback callback, void *context){
+  if (tree->root == DYNAMIC_TREE_NULL_NODE) return;
+
+  int stack_buffer[DYNAMIC_TREE_STACK_CAPACITY];
+  int *stack = stack_buffer;
+  int stack_capacity = DYNAMIC_TREE_STACK_CAPACITY;
+  int stack_count = 0;
+  stack[stack_count++] = tree->root;
+
+  while (stack_count > 0){
+    int index = stack[--stack_count];
+    struct DynamicTreeNode *node = &tree->nodes[index];
+    // Nodes are tested when popped, so ones pushed before a closer hit clipped the cast get skipped
+    float entry;
+    if (!AABB_intersect_segment(&node->aabb, extents, origin, translation, max_fraction, &entry)) continue;
+
+    if (dynamic_tree_is_leaf(node)){
+      float fraction = callback(index, node->user_data, max_fraction, context);
+      if (fraction <= 0.0f) break;
+      if (fraction < max_fraction) max_fraction = fraction;
+      continue;
+    }
+
+    if (!dynamic_tree_reserve_stack(&stack, &stack_capacity, stack_count, stack_buffer)){
+      fprintf(stderr, "Error: failed to grow traversal stack in dynamic_tree_ray_cast\n");
+      break;
+    }
+    // Visit the child further along the cast last, so closest hit casts clip early
+    struct DynamicTreeNode *left = &tree->nodes[node->left];
+    struct DynamicTreeNode *right = &tree->nodes[node->right];
+    vec3 between;
+    glm_vec3_sub(right->aabb.center, left->aabb.center, between);
+    if (glm_vec3_dot(between, translation) > 0.0f){
+      stack[stack_count++] = node->right;
+      stack[stack_count++] = node->left;
+    }
+    else{
+      stack[stack_count++] = node->left;
+      stack[stack_count++] = node->right;
+    }
+  }
+
+  if (stack != stack_buffer) free(stack);
+}
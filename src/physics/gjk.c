@@ -0,0 +1,785 @@
+#include <cglm/cglm.h>
+#include <float.h>
+#include <string.h>
+#include "physics/world.h"
+#include "physics/gjk.h"
+
+#define GJK_EPSILON 0.000001f
+#define INITIAL_GJK_CACHE_CAPACITY 64
+
+SupportFunction support_functions[COLLIDER_COUNT] = {
+  [COLLIDER_AABB] = support_AABB,
+  [COLLIDER_SPHERE] = support_sphere,
+  [COLLIDER_CAPSULE] = support_capsule,
+  [COLLIDER_OBB] = support_OBB
+};
+
+// SUPPORT FUNCTIONS
+//
+void support_AABB(struct ConvexShape *shape, vec3 direction, vec3 dest){
+  struct AABB *aabb = &shape->data.aabb;
+  for (int i = 0; i < 3; i++){
+    dest[i] = aabb->center[i] + (direction[i] >= 0.0f ? aabb->extents[i] : -aabb->extents[i]);
+  }
+}
+
+// A sphere's core is its center, the radius is added after GJK
+void support_sphere(struct ConvexShape *shape, vec3 direction, vec3 dest){
+  (void)direction;
+  glm_vec3_copy(shape->data.sphere.center, dest);
+}
+
+// A capsule's core is its segment
+void support_capsule(struct ConvexShape *shape, vec3 direction, vec3 dest){
+  struct Capsule *capsule = &shape->data.capsule;
+  if (glm_vec3_dot(capsule->segment_A, direction) >= glm_vec3_dot(capsule->segment_B, direction)){
+    glm_vec3_copy(capsule->segment_A, dest);
+  }
+  else{
+    glm_vec3_copy(capsule->segment_B, dest);
+  }
+}
+
+void support_OBB(struct ConvexShape *shape, vec3 direction, vec3 dest){
+  struct OBB *obb = &shape->data.obb;
+  glm_vec3_copy(obb->center, dest);
+  for (int i = 0; i < 3; i++){
+    float extent = glm_vec3_dot(obb->axes[i], direction) >= 0.0f ? obb->extents[i] : -obb->extents[i];
+    glm_vec3_muladds(obb->axes[i], extent, dest);
+  }
+}
+
+void convex_shape_from_body(struct PhysicsBody *body, float time, struct ConvexShape *dest){
+  dest->type = body->collider.type;
+  dest->radius = 0.0f;
+  switch(body->collider.type){
+    case COLLIDER_AABB:
+      physics_body_get_world_AABB(body, time, &dest->data.aabb);
+      break;
+    case COLLIDER_SPHERE:
+      physics_body_get_world_sphere(body, time, &dest->data.sphere);
+      dest->radius = dest->data.sphere.radius;
+      break;
+    case COLLIDER_CAPSULE:
+      physics_body_get_world_capsule(body, time, &dest->data.capsule);
+      dest->radius = dest->data.capsule.radius;
+      break;
+    case COLLIDER_PLANE:
+      physics_body_get_world_plane(body, time, &dest->data.plane);
+      break;
+    case COLLIDER_OBB:
+      physics_body_get_world_OBB(body, time, &dest->data.obb);
+      break;
+    case COLLIDER_MESH:
+      physics_body_get_world_mesh(body, time, &dest->data.mesh);
+      break;
+    default:
+      fprintf(stderr, "Error: invalid collider type %d in convex_shape_from_body\n", body->collider.type);
+      break;
+  }
+}
+
+// SIMPLEX
+//
+// A point of the Minkowski difference, with the support points it came from
+// so the closest points on each shape can be recovered
+struct GJKVertex {
+  vec3 w;
+  vec3 a;
+  vec3 b;
+  vec3 direction;
+};
+
+struct GJKSimplex {
+  struct GJKVertex vertices[4];
+  float lambdas[4];
+  int count;
+};
+
+// Support point of A - B in a direction
+static void gjk_support(struct ConvexShape *shape_A, struct ConvexShape *shape_B, vec3 direction, struct GJKVertex *dest){
+  vec3 negated;
+  glm_vec3_negate_to(direction, negated);
+  glm_vec3_copy(direction, dest->direction);
+  support_functions[shape_A->type](shape_A, direction, dest->a);
+  support_functions[shape_B->type](shape_B, negated, dest->b);
+  glm_vec3_sub(dest->a, dest->b, dest->w);
+}
+
+// Closest point to the origin on segment ab, as the vertices it lies between and their weights
+static int gjk_closest_segment(vec3 a, vec3 b, int *indices, float *lambdas){
+  vec3 ab;
+  glm_vec3_sub(b, a, ab);
+  float denominator = glm_vec3_dot(ab, ab);
+  float t = denominator > GJK_EPSILON ? -glm_vec3_dot(a, ab) / denominator : 0.0f;
+  if (t <= 0.0f){
+    indices[0] = 0;
+    lambdas[0] = 1.0f;
+    return 1;
+  }
+  if (t >= 1.0f){
+    indices[0] = 1;
+    lambdas[0] = 1.0f;
+    return 1;
+  }
+  indices[0] = 0;
+  indices[1] = 1;
+  lambdas[0] = 1.0f - t;
+  lambdas[1] = t;
+  return 2;
+}
+
+// Closest point to the origin on triangle abc by Voronoi regions (Ericson, 5.1.5)
+static int gjk_closest_triangle(vec3 a, vec3 b, vec3 c, int *indices, float *lambdas){
+  vec3 ab, ac, ap, bp, cp;
+  glm_vec3_sub(b, a, ab);
+  glm_vec3_sub(c, a, ac);
+  glm_vec3_negate_to(a, ap);
+  glm_vec3_negate_to(b, bp);
+  glm_vec3_negate_to(c, cp);
+
+  float d1 = glm_vec3_dot(ab, ap);
+  float d2 = glm_vec3_dot(ac, ap);
+  if (d1 <= 0.0f && d2 <= 0.0f){
+    indices[0] = 0;
+    lambdas[0] = 1.0f;
+    return 1;
+  }
+
+  float d3 = glm_vec3_dot(ab, bp);
+  float d4 = glm_vec3_dot(ac, bp);
+  if (d3 >= 0.0f && d4 <= d3){
+    indices[0] = 1;
+    lambdas[0] = 1.0f;
+    return 1;
+  }
+
+  float vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f){
+    float t = d1 / (d1 - d3);
+    indices[0] = 0;
+    indices[1] = 1;
+    lambdas[0] = 1.0f - t;
+    lambdas[1] = t;
+    return 2;
+  }
+
+  float d5 = glm_vec3_dot(ab, cp);
+  float d6 = glm_vec3_dot(ac, cp);
+  if (d6 >= 0.0f && d5 <= d6){
+    indices[0] = 2;
+    lambdas[0] = 1.0f;
+    return 1;
+  }
+
+  float vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f){
+    float t = d2 / (d2 - d6);
+    indices[0] = 0;
+    indices[1] = 2;
+    lambdas[0] = 1.0f - t;
+    lambdas[1] = t;
+    return 2;
+  }
+
+  float va = d3 * d6 - d5 * d4;
+  if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f){
+    float t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+    indices[0] = 1;
+    indices[1] = 2;
+    lambdas[0] = 1.0f - t;
+    lambdas[1] = t;
+    return 2;
+  }
+
+  float denominator = va + vb + vc;
+  if (fabsf(denominator) < GJK_EPSILON){
+    // Degenerate triangle, use its longer edge from a
+    int far = glm_vec3_distance2(a, b) > glm_vec3_distance2(a, c) ? 1 : 2;
+    int count = gjk_closest_segment(a, far == 1 ? b : c, indices, lambdas);
+    for (int i = 0; i < count; i++){
+      if (indices[i] == 1) indices[i] = far;
+    }
+    return count;
+  }
+  float v = vb / denominator;
+  float w = vc / denominator;
+  indices[0] = 0;
+  indices[1] = 1;
+  indices[2] = 2;
+  lambdas[0] = 1.0f - v - w;
+  lambdas[1] = v;
+  lambdas[2] = w;
+  return 3;
+}
+
+// Keep only the given vertices of the simplex, with their new weights
+static void gjk_simplex_reduce(struct GJKSimplex *simplex, const int *indices, const float *lambdas, int count){
+  struct GJKVertex vertices[4];
+  for (int i = 0; i < count; i++){
+    vertices[i] = simplex->vertices[indices[i]];
+  }
+  for (int i = 0; i < count; i++){
+    simplex->vertices[i] = vertices[i];
+    simplex->lambdas[i] = lambdas[i];
+  }
+  simplex->count = count;
+}
+
+// Whether the origin is on the opposite side of face abc from d.
+// A flat tetrahedron counts as outside, so it's never mistaken for containing the origin
+static bool gjk_origin_outside_face(vec3 a, vec3 b, vec3 c, vec3 d){
+  vec3 ab, ac, ad, normal;
+  glm_vec3_sub(b, a, ab);
+  glm_vec3_sub(c, a, ac);
+  glm_vec3_sub(d, a, ad);
+  glm_vec3_cross(ab, ac, normal);
+  float sign_origin = -glm_vec3_dot(a, normal);
+  float sign_d = glm_vec3_dot(ad, normal);
+  if (fabsf(sign_d) < GJK_EPSILON) return true;
+  return sign_origin * sign_d < 0.0f;
+}
+
+// Reduce the simplex to the smallest sub-simplex containing its closest point to the origin,
+// and write that point to v. Returns false if the simplex is a tetrahedron containing the origin
+static bool gjk_simplex_solve(struct GJKSimplex *simplex, vec3 v){
+  int indices[3];
+  float lambdas[3];
+  struct GJKVertex *vertices = simplex->vertices;
+
+  switch(simplex->count){
+    case 1:
+      simplex->lambdas[0] = 1.0f;
+      break;
+    case 2: {
+      int count = gjk_closest_segment(vertices[0].w, vertices[1].w, indices, lambdas);
+      gjk_simplex_reduce(simplex, indices, lambdas, count);
+      break;
+    }
+    case 3: {
+      int count = gjk_closest_triangle(vertices[0].w, vertices[1].w, vertices[2].w, indices, lambdas);
+      gjk_simplex_reduce(simplex, indices, lambdas, count);
+      break;
+    }
+    case 4: {
+      // Check each face the origin is outside of, keep the closest
+      static const int faces[4][4] = {
+        {0, 1, 2, 3},
+        {0, 2, 3, 1},
+        {0, 3, 1, 2},
+        {1, 3, 2, 0}
+      };
+      float best_distance = FLT_MAX;
+      int best_indices[3];
+      float best_lambdas[3];
+      int best_count = 0;
+      for (int f = 0; f < 4; f++){
+        const int *face = faces[f];
+        if (!gjk_origin_outside_face(vertices[face[0]].w, vertices[face[1]].w, vertices[face[2]].w, vertices[face[3]].w)) continue;
+
+        int count = gjk_closest_triangle(vertices[face[0]].w, vertices[face[1]].w, vertices[face[2]].w, indices, lambdas);
+        vec3 point = {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < count; i++){
+          glm_vec3_muladds(vertices[face[indices[i]]].w, lambdas[i], point);
+        }
+        float distance = glm_vec3_norm2(point);
+        if (distance < best_distance){
+          best_distance = distance;
+          best_count = count;
+          for (int i = 0; i < count; i++){
+            best_indices[i] = face[indices[i]];
+            best_lambdas[i] = lambdas[i];
+          }
+        }
+      }
+      if (best_count == 0) return false;
+      gjk_simplex_reduce(simplex, best_indices, best_lambdas, best_count);
+      break;
+    }
+  }
+
+  glm_vec3_zero(v);
+  for (int i = 0; i < simplex->count; i++){
+    glm_vec3_muladds(simplex->vertices[i].w, simplex->lambdas[i], v);
+  }
+  return true;
+}
+
+// Closest points on each core, from the simplex weights
+static void gjk_simplex_witnesses(struct GJKSimplex *simplex, vec3 point_A, vec3 point_B){
+  glm_vec3_zero(point_A);
+  glm_vec3_zero(point_B);
+  for (int i = 0; i < simplex->count; i++){
+    glm_vec3_muladds(simplex->vertices[i].a, simplex->lambdas[i], point_A);
+    glm_vec3_muladds(simplex->vertices[i].b, simplex->lambdas[i], point_B);
+  }
+}
+
+// EPA
+//
+struct EPAFace {
+  int vertices[3];
+  vec3 normal;
+  float distance;
+};
+
+struct EPAPolytope {
+  struct GJKVertex vertices[EPA_MAX_VERTICES];
+  struct EPAFace faces[EPA_MAX_FACES];
+  int num_vertices;
+  int num_faces;
+};
+
+// Add face abc with its normal pointing away from the given interior point
+static bool epa_add_face(struct EPAPolytope *polytope, int a, int b, int c, vec3 interior){
+  if (polytope->num_faces == EPA_MAX_FACES) return false;
+  struct EPAFace *face = &polytope->faces[polytope->num_faces];
+  vec3 ab, ac, to_interior;
+  glm_vec3_sub(polytope->vertices[b].w, polytope->vertices[a].w, ab);
+  glm_vec3_sub(polytope->vertices[c].w, polytope->vertices[a].w, ac);
+  glm_vec3_cross(ab, ac, face->normal);
+  float length = glm_vec3_norm(face->normal);
+  if (length < GJK_EPSILON) return false;
+  glm_vec3_scale(face->normal, 1.0f / length, face->normal);
+
+  face->vertices[0] = a;
+  face->vertices[1] = b;
+  face->vertices[2] = c;
+  glm_vec3_sub(interior, polytope->vertices[a].w, to_interior);
+  if (glm_vec3_dot(face->normal, to_interior) > 0.0f){
+    face->vertices[1] = c;
+    face->vertices[2] = b;
+    glm_vec3_negate(face->normal);
+  }
+  face->distance = glm_vec3_dot(face->normal, polytope->vertices[a].w);
+  polytope->num_faces++;
+  return true;
+}
+
+// Grow GJK's final simplex into a tetrahedron. Fails if A - B is flat, which
+// happens when both cores are points or segments (sphere and capsule pairs)
+static bool epa_build_tetrahedron(struct ConvexShape *shape_A, struct ConvexShape *shape_B, struct GJKSimplex *simplex){
+  static vec3 axes[6] = {
+    {1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f},
+    {0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+    {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}
+  };
+  struct GJKVertex *vertices = simplex->vertices;
+
+  if (simplex->count == 1){
+    for (int i = 0; i < 6 && simplex->count == 1; i++){
+      gjk_support(shape_A, shape_B, axes[i], &vertices[1]);
+      if (glm_vec3_distance2(vertices[1].w, vertices[0].w) > GJK_EPSILON) simplex->count = 2;
+    }
+    if (simplex->count == 1) return false;
+  }
+
+  if (simplex->count == 2){
+    vec3 line;
+    glm_vec3_sub(vertices[1].w, vertices[0].w, line);
+    // Search perpendicular to the line, starting from the axis least aligned with it
+    int axis = 0;
+    for (int i = 1; i < 3; i++){
+      if (fabsf(line[i]) < fabsf(line[axis])) axis = i;
+    }
+    vec3 directions[4];
+    glm_vec3_cross(line, axes[axis * 2], directions[0]);
+    glm_vec3_cross(line, directions[0], directions[1]);
+    glm_vec3_negate_to(directions[0], directions[2]);
+    glm_vec3_negate_to(directions[1], directions[3]);
+    for (int i = 0; i < 4 && simplex->count == 2; i++){
+      gjk_support(shape_A, shape_B, directions[i], &vertices[2]);
+      vec3 to_vertex, cross;
+      glm_vec3_sub(vertices[2].w, vertices[0].w, to_vertex);
+      glm_vec3_cross(to_vertex, line, cross);
+      if (glm_vec3_norm2(cross) > GJK_EPSILON) simplex->count = 3;
+    }
+    if (simplex->count == 2) return false;
+  }
+
+  if (simplex->count == 3){
+    vec3 ab, ac, normal;
+    glm_vec3_sub(vertices[1].w, vertices[0].w, ab);
+    glm_vec3_sub(vertices[2].w, vertices[0].w, ac);
+    glm_vec3_cross(ab, ac, normal);
+    for (int i = 0; i < 2 && simplex->count == 3; i++){
+      gjk_support(shape_A, shape_B, normal, &vertices[3]);
+      vec3 to_vertex;
+      glm_vec3_sub(vertices[3].w, vertices[0].w, to_vertex);
+      if (fabsf(glm_vec3_dot(to_vertex, normal)) > GJK_EPSILON) simplex->count = 4;
+      glm_vec3_negate(normal);
+    }
+    if (simplex->count == 3) return false;
+  }
+  return true;
+}
+
+// Horizon edges left when the faces visible from a new point are removed.
+// An edge shared by two removed faces appears twice with opposite winding and cancels out
+static void epa_add_edge(int edges[][2], int *num_edges, int a, int b){
+  for (int i = 0; i < *num_edges; i++){
+    if (edges[i][0] == b && edges[i][1] == a){
+      edges[i][0] = edges[*num_edges - 1][0];
+      edges[i][1] = edges[*num_edges - 1][1];
+      (*num_edges)--;
+      return;
+    }
+  }
+  edges[*num_edges][0] = a;
+  edges[*num_edges][1] = b;
+  (*num_edges)++;
+}
+
+// Expand the polytope towards the boundary of A - B until the face closest to the origin
+// stops moving. That face's normal and distance are the penetration normal (from A to B) and depth
+static bool epa_penetration(struct ConvexShape *shape_A, struct ConvexShape *shape_B, struct GJKSimplex *simplex, float *depth, vec3 normal, vec3 point_A, vec3 point_B, unsigned int *iterations){
+  if (!epa_build_tetrahedron(shape_A, shape_B, simplex)) return false;
+
+  struct EPAPolytope polytope;
+  polytope.num_vertices = 4;
+  polytope.num_faces = 0;
+  vec3 interior = {0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < 4; i++){
+    polytope.vertices[i] = simplex->vertices[i];
+    glm_vec3_muladds(simplex->vertices[i].w, 0.25f, interior);
+  }
+  if (!epa_add_face(&polytope, 0, 1, 2, interior) ||
+      !epa_add_face(&polytope, 0, 3, 1, interior) ||
+      !epa_add_face(&polytope, 0, 2, 3, interior) ||
+      !epa_add_face(&polytope, 1, 3, 2, interior)){
+    return false;
+  }
+
+  struct EPAFace *closest = NULL;
+  for (unsigned int iteration = 0; iteration < EPA_MAX_ITERATIONS; iteration++){
+    (*iterations)++;
+    closest = &polytope.faces[0];
+    for (int i = 1; i < polytope.num_faces; i++){
+      if (polytope.faces[i].distance < closest->distance) closest = &polytope.faces[i];
+    }
+
+    struct GJKVertex vertex;
+    gjk_support(shape_A, shape_B, closest->normal, &vertex);
+    if (glm_vec3_dot(vertex.w, closest->normal) - closest->distance < EPA_TOLERANCE) break;
+    if (polytope.num_vertices == EPA_MAX_VERTICES) break;
+
+    // Remove every face the new point can see, remembering their outline
+    int new_index = polytope.num_vertices;
+    polytope.vertices[polytope.num_vertices++] = vertex;
+    int edges[EPA_MAX_FACES * 3][2];
+    int num_edges = 0;
+    for (int i = 0; i < polytope.num_faces; i++){
+      struct EPAFace *face = &polytope.faces[i];
+      vec3 to_vertex;
+      glm_vec3_sub(vertex.w, polytope.vertices[face->vertices[0]].w, to_vertex);
+      if (glm_vec3_dot(face->normal, to_vertex) <= 0.0f) continue;
+
+      epa_add_edge(edges, &num_edges, face->vertices[0], face->vertices[1]);
+      epa_add_edge(edges, &num_edges, face->vertices[1], face->vertices[2]);
+      epa_add_edge(edges, &num_edges, face->vertices[2], face->vertices[0]);
+      polytope.faces[i--] = polytope.faces[--polytope.num_faces];
+    }
+
+    // Patch the hole with faces from the outline to the new point
+    for (int i = 0; i < num_edges; i++){
+      epa_add_face(&polytope, edges[i][0], edges[i][1], new_index, interior);
+    }
+    closest = NULL;
+    if (polytope.num_faces == 0) return false;
+  }
+  if (!closest){
+    closest = &polytope.faces[0];
+    for (int i = 1; i < polytope.num_faces; i++){
+      if (polytope.faces[i].distance < closest->distance) closest = &polytope.faces[i];
+    }
+  }
+
+  // Barycentric coordinates of the origin's projection on the closest face give the witness points
+  struct GJKVertex *a = &polytope.vertices[closest->vertices[0]];
+  struct GJKVertex *b = &polytope.vertices[closest->vertices[1]];
+  struct GJKVertex *c = &polytope.vertices[closest->vertices[2]];
+  vec3 projection, v0, v1, v2;
+  glm_vec3_scale(closest->normal, closest->distance, projection);
+  glm_vec3_sub(b->w, a->w, v0);
+  glm_vec3_sub(c->w, a->w, v1);
+  glm_vec3_sub(projection, a->w, v2);
+  float d00 = glm_vec3_dot(v0, v0);
+  float d01 = glm_vec3_dot(v0, v1);
+  float d11 = glm_vec3_dot(v1, v1);
+  float d20 = glm_vec3_dot(v2, v0);
+  float d21 = glm_vec3_dot(v2, v1);
+  float denominator = d00 * d11 - d01 * d01;
+  float v = 0.0f, w = 0.0f;
+  if (fabsf(denominator) > GJK_EPSILON){
+    v = (d11 * d20 - d01 * d21) / denominator;
+    w = (d00 * d21 - d01 * d20) / denominator;
+  }
+  float u = 1.0f - v - w;
+
+  glm_vec3_scale(a->a, u, point_A);
+  glm_vec3_muladds(b->a, v, point_A);
+  glm_vec3_muladds(c->a, w, point_A);
+  glm_vec3_scale(a->b, u, point_B);
+  glm_vec3_muladds(b->b, v, point_B);
+  glm_vec3_muladds(c->b, w, point_B);
+  glm_vec3_copy(closest->normal, normal);
+  *depth = closest->distance;
+  return true;
+}
+
+// HALF SPACES
+//
+// Signed distance from a convex shape to a plane, measured from the shape's deepest point
+static struct GJKResult gjk_half_space(struct ConvexShape *shape, struct Plane *plane){
+  struct GJKResult result = {0};
+  if (!support_functions[shape->type]){
+    fprintf(stderr, "Error: no support function for collider type %d in gjk_half_space\n", shape->type);
+    result.distance = FLT_MAX;
+    return result;
+  }
+  result.iterations = 1;
+  vec3 direction, deepest;
+  glm_vec3_negate_to(plane->normal, direction);
+  support_functions[shape->type](shape, direction, deepest);
+
+  glm_vec3_copy(direction, result.normal);
+  glm_vec3_copy(deepest, result.point_A);
+  glm_vec3_muladds(result.normal, shape->radius, result.point_A);
+  result.distance = glm_vec3_dot(result.point_A, plane->normal) - plane->distance;
+  glm_vec3_copy(result.point_A, result.point_B);
+  glm_vec3_mulsubs(plane->normal, result.distance, result.point_B);
+  return result;
+}
+
+// GJK
+//
+struct GJKResult gjk_distance(struct ConvexShape *shape_A, struct ConvexShape *shape_B, struct GJKCache *cache){
+  struct GJKResult result = {0};
+
+  // Planes: pairs are ordered by collider type, so a plane is A against an OBB and B otherwise
+  if (shape_A->type == COLLIDER_PLANE && shape_B->type == COLLIDER_PLANE){
+    result.distance = FLT_MAX;
+    glm_vec3_copy((vec3){0.0f, 1.0f, 0.0f}, result.normal);
+    return result;
+  }
+  if (shape_B->type == COLLIDER_PLANE){
+    return gjk_half_space(shape_A, &shape_B->data.plane);
+  }
+  if (shape_A->type == COLLIDER_PLANE){
+    result = gjk_half_space(shape_B, &shape_A->data.plane);
+    vec3 point_B;
+    glm_vec3_copy(result.point_A, point_B);
+    glm_vec3_copy(result.point_B, result.point_A);
+    glm_vec3_copy(point_B, result.point_B);
+    glm_vec3_negate(result.normal);
+    return result;
+  }
+  if (!support_functions[shape_A->type] || !support_functions[shape_B->type]){
+    fprintf(stderr, "Error: no support function for collider types %d, %d in gjk_distance\n", shape_A->type, shape_B->type);
+    result.distance = FLT_MAX;
+    return result;
+  }
+
+  // Start from last step's axis if there is one
+  struct GJKSimplex simplex = {0};
+  vec3 v = {1.0f, 0.0f, 0.0f};
+  bool overlap = false;
+  if (cache && cache->valid && glm_vec3_norm2(cache->axis) > GJK_EPSILON){
+    glm_vec3_copy(cache->axis, v);
+
+    // Rebuild last step's simplex from the directions that found it
+    if (cache->num_directions > 0){
+      result.iterations++;
+      for (unsigned int i = 0; i < cache->num_directions && i < 3; i++){
+        gjk_support(shape_A, shape_B, cache->directions[i], &simplex.vertices[simplex.count]);
+        bool repeated = false;
+        for (int j = 0; j < simplex.count; j++){
+          if (glm_vec3_distance2(simplex.vertices[j].w, simplex.vertices[simplex.count].w) < GJK_EPSILON * GJK_EPSILON) repeated = true;
+        }
+        if (!repeated) simplex.count++;
+      }
+      gjk_simplex_solve(&simplex, v);
+      if (glm_vec3_norm2(v) <= GJK_TOLERANCE * GJK_TOLERANCE) overlap = true;
+    }
+  }
+
+  while (!overlap && result.iterations < GJK_MAX_ITERATIONS){
+    result.iterations++;
+    struct GJKVertex vertex;
+    vec3 direction;
+    glm_vec3_negate_to(v, direction);
+    gjk_support(shape_A, shape_B, direction, &vertex);
+
+    if (simplex.count > 0){
+      // Nothing in A - B is meaningfully closer to the origin than v
+      float vv = glm_vec3_norm2(v);
+      if (vv - glm_vec3_dot(v, vertex.w) <= GJK_TOLERANCE * vv) break;
+
+      // A repeated vertex means no progress, v is as close as float precision gets
+      bool repeated = false;
+      for (int i = 0; i < simplex.count; i++){
+        if (glm_vec3_distance2(simplex.vertices[i].w, vertex.w) < GJK_EPSILON * GJK_EPSILON) repeated = true;
+      }
+      if (repeated) break;
+    }
+
+    simplex.vertices[simplex.count++] = vertex;
+    if (!gjk_simplex_solve(&simplex, v) || glm_vec3_norm2(v) <= GJK_TOLERANCE * GJK_TOLERANCE){
+      overlap = true;
+      break;
+    }
+  }
+
+  if (!overlap){
+    // Separated cores: the distance between them minus the radii
+    float core_distance = glm_vec3_norm(v);
+    vec3 core_A, core_B;
+    gjk_simplex_witnesses(&simplex, core_A, core_B);
+    glm_vec3_scale(v, -1.0f / core_distance, result.normal);
+    result.distance = core_distance - shape_A->radius - shape_B->radius;
+    glm_vec3_copy(core_A, result.point_A);
+    glm_vec3_muladds(result.normal, shape_A->radius, result.point_A);
+    glm_vec3_copy(core_B, result.point_B);
+    glm_vec3_mulsubs(result.normal, shape_B->radius, result.point_B);
+
+    if (cache){
+      glm_vec3_copy(v, cache->axis);
+      cache->num_directions = (unsigned int)simplex.count;
+      for (int i = 0; i < simplex.count; i++){
+        glm_vec3_copy(simplex.vertices[i].direction, cache->directions[i]);
+      }
+      cache->valid = true;
+    }
+    return result;
+  }
+
+  // Overlapping cores: penetration depth from EPA
+  float depth = 0.0f;
+  vec3 core_A, core_B;
+  if (!epa_penetration(shape_A, shape_B, &simplex, &depth, result.normal, core_A, core_B, &result.iterations)){
+    // A - B is flat, so the cores touch at a point or line.
+    // The penetration is just the radii, along the last known axis
+    gjk_simplex_witnesses(&simplex, core_A, core_B);
+    if (cache && cache->valid && glm_vec3_norm2(cache->axis) > GJK_EPSILON){
+      glm_vec3_normalize_to(cache->axis, result.normal);
+      glm_vec3_negate(result.normal);
+    }
+    else{
+      glm_vec3_copy((vec3){0.0f, 1.0f, 0.0f}, result.normal);
+    }
+    depth = 0.0f;
+  }
+
+  result.distance = -depth - shape_A->radius - shape_B->radius;
+  glm_vec3_copy(core_A, result.point_A);
+  glm_vec3_muladds(result.normal, shape_A->radius, result.point_A);
+  glm_vec3_copy(core_B, result.point_B);
+  glm_vec3_mulsubs(result.normal, shape_B->radius, result.point_B);
+
+  // Remember the direction the shapes separate in, A - B's axis points from B to A
+  if (cache){
+    glm_vec3_negate_to(result.normal, cache->axis);
+    cache->num_directions = 0;
+    cache->valid = true;
+  }
+  return result;
+}
+
+// Distance function fallback for pairs without an entry in distance_functions
+float gjk_body_distance(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
+  struct ConvexShape shape_A, shape_B;
+  convex_shape_from_body(body_A, time, &shape_A);
+  convex_shape_from_body(body_B, time, &shape_B);
+  struct GJKResult result = gjk_distance(&shape_A, &shape_B, NULL);
+  return glm_max(result.distance, 0.0f);
+}
+
+// CACHE TABLE
+//
+// The same cache seen from the other body: A - B becomes B - A
+void gjk_cache_flip(struct GJKCache *cache){
+  glm_vec3_negate(cache->axis);
+  for (unsigned int i = 0; i < cache->num_directions; i++){
+    glm_vec3_negate(cache->directions[i]);
+  }
+}
+
+uint64_t gjk_cache_key(PhysicsBodyHandle handle_A, PhysicsBodyHandle handle_B){
+  if (handle_A > handle_B){
+    PhysicsBodyHandle temp = handle_A;
+    handle_A = handle_B;
+    handle_B = temp;
+  }
+  return ((uint64_t)handle_A << 32) | handle_B;
+}
+
+static unsigned int gjk_cache_hash(uint64_t key, unsigned int capacity){
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return (unsigned int)key & (capacity - 1);
+}
+
+bool gjk_cache_table_find(struct GJKCacheTable *table, uint64_t key, struct GJKCache *dest){
+  if (table->num_entries == 0) return false;
+  unsigned int index = gjk_cache_hash(key, table->capacity);
+  while (table->entries[index].key != 0){
+    if (table->entries[index].key == key){
+      *dest = table->entries[index].cache;
+      return true;
+    }
+    index = (index + 1) & (table->capacity - 1);
+  }
+  return false;
+}
+
+// Keep the table at most half full, rehashing into double the capacity
+static bool gjk_cache_table_grow(struct GJKCacheTable *table){
+  unsigned int new_capacity = table->capacity ? table->capacity * 2 : INITIAL_GJK_CACHE_CAPACITY;
+  struct GJKCacheEntry *new_entries = (struct GJKCacheEntry *)calloc(new_capacity, sizeof(struct GJKCacheEntry));
+  if (!new_entries){
+    fprintf(stderr, "Error: failed to allocate cache entries in gjk_cache_table_grow\n");
+    return false;
+  }
+  for (unsigned int i = 0; i < table->capacity; i++){
+    if (table->entries[i].key == 0) continue;
+    unsigned int index = gjk_cache_hash(table->entries[i].key, new_capacity);
+    while (new_entries[index].key != 0){
+      index = (index + 1) & (new_capacity - 1);
+    }
+    new_entries[index] = table->entries[i];
+  }
+  free(table->entries);
+  table->entries = new_entries;
+  table->capacity = new_capacity;
+  return true;
+}
+
+bool gjk_cache_table_insert(struct GJKCacheTable *table, uint64_t key, struct GJKCache *cache){
+  if ((table->num_entries + 1) * 2 > table->capacity && !gjk_cache_table_grow(table)){
+    return false;
+  }
+  unsigned int index = gjk_cache_hash(key, table->capacity);
+  while (table->entries[index].key != 0 && table->entries[index].key != key){
+    index = (index + 1) & (table->capacity - 1);
+  }
+  if (table->entries[index].key == 0){
+    table->entries[index].key = key;
+    table->num_entries++;
+  }
+  table->entries[index].cache = *cache;
+  return true;
+}
+
+void gjk_cache_table_clear(struct GJKCacheTable *table){
+  if (table->num_entries == 0) return;
+  memset(table->entries, 0, table->capacity * sizeof(struct GJKCacheEntry));
+  table->num_entries = 0;
+}
+
+void gjk_cache_table_free(struct GJKCacheTable *table){
+  free(table->entries);
+  table->entries = NULL;
+  table->capacity = 0;
+  table->num_entries = 0;
+}
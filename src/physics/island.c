@@ -0,0 +1,226 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <cglm/cglm.h>
+#include "physics/world.h"
+#include "physics/pipeline.h"
+#include "physics/island.h"
+
+// flags bits. Per body: touched by a player this step.
+// Per island root: has an awake member, must wake
+#define ISLAND_BODY_TOUCHED_BY_PLAYER 0x1
+#define ISLAND_HAS_AWAKE 0x2
+#define ISLAND_WAKE 0x4
+
+void physics_islands_free(struct PhysicsIslands *islands){
+  free(islands->parent);
+  free(islands->min_sleep_counter);
+  free(islands->flags);
+  free(islands->sleepers);
+  islands->parent = NULL;
+  islands->min_sleep_counter = NULL;
+  islands->flags = NULL;
+  islands->sleepers = NULL;
+  islands->capacity = 0;
+}
+
+static bool physics_islands_reserve(struct PhysicsIslands *islands, unsigned int capacity){
+  if (capacity <= islands->capacity) return true;
+
+  int *parent = (int *)realloc(islands->parent, capacity * sizeof(int));
+  if (parent) islands->parent = parent;
+  unsigned int *min_sleep_counter = (unsigned int *)realloc(islands->min_sleep_counter, capacity * sizeof(unsigned int));
+  if (min_sleep_counter) islands->min_sleep_counter = min_sleep_counter;
+  unsigned char *flags = (unsigned char *)realloc(islands->flags, capacity * sizeof(unsigned char));
+  if (flags) islands->flags = flags;
+  struct IslandSleeper *sleepers = (struct IslandSleeper *)realloc(islands->sleepers, capacity * sizeof(struct IslandSleeper));
+  if (sleepers) islands->sleepers = sleepers;
+
+  if (!parent || !min_sleep_counter || !flags || !sleepers){
+    fprintf(stderr, "Error: failed to realloc island arrays in physics_islands_reserve\n");
+    return false;
+  }
+  islands->capacity = capacity;
+  return true;
+}
+
+static int island_find(int *parent, int i){
+  // Path halving
+  while (parent[i] != i){
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+static void island_union(int *parent, int a, int b){
+  int root_a = island_find(parent, a);
+  int root_b = island_find(parent, b);
+  if (root_a == root_b) return;
+  // Lower index becomes the root, so islands don't depend on contact order
+  if (root_a < root_b) parent[root_b] = root_a;
+  else parent[root_a] = root_b;
+}
+
+static int island_sleeper_compare(const void *a, const void *b){
+  const struct IslandSleeper *sleeper_A = (const struct IslandSleeper *)a;
+  const struct IslandSleeper *sleeper_B = (const struct IslandSleeper *)b;
+  if (sleeper_A->island_id != sleeper_B->island_id){
+    return sleeper_A->island_id < sleeper_B->island_id ? -1 : 1;
+  }
+  return (int)sleeper_A->body_index - (int)sleeper_B->body_index;
+}
+
+bool physics_body_is_awake(struct PhysicsBody *body){
+  return body->dynamic && !body->sleeping;
+}
+
+void physics_body_wake(struct PhysicsBody *body){
+  body->sleeping = false;
+  body->sleep_counter = 0;
+  body->at_rest = false;
+}
+
+// Index into dynamic_bodies, or -1 for static and player bodies
+static int physics_dynamic_body_index(struct PhysicsWorld *physics_world, struct PhysicsBody *body){
+  if (body < physics_world->dynamic_bodies || body >= physics_world->dynamic_bodies + physics_world->num_dynamic_bodies){
+    return -1;
+  }
+  return (int)(body - physics_world->dynamic_bodies);
+}
+
+// Sleeping islands are kept in parent between steps: each sleeping body points into its own
+// island and every awake body is its own root. Swapping bodies around in dynamic_bodies breaks that,
+// so after an add or remove the sleeping islands are rebuilt once from island_id
+static void physics_islands_rebuild(struct PhysicsWorld *physics_world){
+  struct PhysicsIslands *islands = &physics_world->islands;
+  unsigned int num_bodies = physics_world->num_dynamic_bodies;
+  int *parent = islands->parent;
+  unsigned int num_sleepers = 0;
+  for (unsigned int i = 0; i < num_bodies; i++){
+    parent[i] = (int)i;
+    struct PhysicsBody *body = &physics_world->dynamic_bodies[i];
+    if (body->sleeping){
+      islands->sleepers[num_sleepers].island_id = body->island_id;
+      islands->sleepers[num_sleepers].body_index = i;
+      num_sleepers++;
+    }
+  }
+  qsort(islands->sleepers, num_sleepers, sizeof(struct IslandSleeper), island_sleeper_compare);
+  for (unsigned int i = 1; i < num_sleepers; i++){
+    if (islands->sleepers[i].island_id == islands->sleepers[i - 1].island_id){
+      island_union(parent, islands->sleepers[i - 1].body_index, islands->sleepers[i].body_index);
+    }
+  }
+  islands->dirty = false;
+}
+
+void physics_update_islands(struct PhysicsWorld *physics_world, float delta_time){
+  struct PhysicsIslands *islands = &physics_world->islands;
+  struct PhysicsStepStats *stats = &physics_world->step_stats;
+  struct PhysicsContactBuffer *contacts = &physics_world->contacts;
+  unsigned int num_bodies = physics_world->num_dynamic_bodies;
+  (void)delta_time;
+  stats->num_islands = 0;
+  stats->num_sleeping_bodies = 0;
+  if (num_bodies == 0) return;
+
+  // Nothing awake and nothing touching: every island stays asleep as it is
+  bool any_awake = false;
+  for (unsigned int i = 0; i < num_bodies && !any_awake; i++){
+    any_awake = !physics_world->dynamic_bodies[i].sleeping;
+  }
+  if (!any_awake && contacts->num_contacts == 0){
+    stats->num_sleeping_bodies = num_bodies;
+    return;
+  }
+
+  if (num_bodies > islands->capacity) islands->dirty = true;
+  if (!physics_islands_reserve(islands, num_bodies)) return;
+  if (islands->dirty) physics_islands_rebuild(physics_world);
+
+  int *parent = islands->parent;
+  unsigned char *flags = islands->flags;
+  for (unsigned int i = 0; i < num_bodies; i++){
+    flags[i] = 0;
+    islands->min_sleep_counter[i] = UINT_MAX;
+  }
+
+  // Join bodies in contact this step. Static bodies don't join islands,
+  // and a player touching a body keeps its island awake
+  for (unsigned int i = 0; i < contacts->num_contacts; i++){
+    struct CollisionPair *pair = &physics_world->pairs[contacts->pair_indices[i]];
+    int index_A = physics_dynamic_body_index(physics_world, pair->body_A);
+    int index_B = physics_dynamic_body_index(physics_world, pair->body_B);
+    if (index_A >= 0 && index_B >= 0){
+      island_union(parent, index_A, index_B);
+    }
+    else if (index_A >= 0 && physics_body_is_player(physics_world, pair->body_B)){
+      flags[index_A] |= ISLAND_BODY_TOUCHED_BY_PLAYER;
+    }
+    else if (index_B >= 0 && physics_body_is_player(physics_world, pair->body_A)){
+      flags[index_B] |= ISLAND_BODY_TOUCHED_BY_PLAYER;
+    }
+  }
+
+  // Count how long each awake body has been slow, and gather it into its island
+  float threshold_squared = SLEEP_VELOCITY_THRESHOLD * SLEEP_VELOCITY_THRESHOLD;
+  for (unsigned int i = 0; i < num_bodies; i++){
+    struct PhysicsBody *body = &physics_world->dynamic_bodies[i];
+    int root = island_find(parent, (int)i);
+
+    if (!body->sleeping){
+      if (glm_vec3_norm2(body->velocity) < threshold_squared){
+        if (body->sleep_counter < SLEEP_STEPS) body->sleep_counter++;
+      }
+      else{
+        body->sleep_counter = 0;
+      }
+      flags[root] |= ISLAND_HAS_AWAKE;
+      if (body->sleep_counter < islands->min_sleep_counter[root]){
+        islands->min_sleep_counter[root] = body->sleep_counter;
+      }
+    }
+    if (flags[i] & ISLAND_BODY_TOUCHED_BY_PLAYER){
+      flags[root] |= ISLAND_WAKE;
+    }
+  }
+
+  // Islands with an awake member either all sleep, if every awake member is ready, or all wake.
+  // Islands that are entirely asleep and weren't touched stay asleep without being visited again
+  unsigned int island_id_base = islands->next_island_id;
+  islands->next_island_id += num_bodies;
+  for (unsigned int i = 0; i < num_bodies; i++){
+    struct PhysicsBody *body = &physics_world->dynamic_bodies[i];
+    int root = island_find(parent, (int)i);
+    unsigned char island_flags = flags[root];
+
+    if ((int)i == root && (island_flags & ISLAND_HAS_AWAKE)){
+      stats->num_islands++;
+    }
+
+    if (island_flags & ISLAND_WAKE){
+      if (body->sleeping) physics_body_wake(body);
+    }
+    else if (island_flags & ISLAND_HAS_AWAKE){
+      if (islands->min_sleep_counter[root] >= SLEEP_STEPS){
+        body->sleeping = true;
+        body->island_id = island_id_base + (unsigned int)root;
+        glm_vec3_zero(body->velocity);
+      }
+      else if (body->sleeping){
+        physics_body_wake(body);
+      }
+    }
+
+    if (body->sleeping) stats->num_sleeping_bodies++;
+  }
+
+  // Whole islands sleep or wake together, so sleeping bodies only lead to sleeping roots.
+  // Point them straight at it, then split every awake body back out on its own for the next step
+  for (unsigned int i = 0; i < num_bodies; i++){
+    if (physics_world->dynamic_bodies[i].sleeping) parent[i] = island_find(parent, (int)i);
+  }
+  for (unsigned int i = 0; i < num_bodies; i++){
+    if (!physics_world->dynamic_bodies[i].sleeping) parent[i] = (int)i;
+  }
+}
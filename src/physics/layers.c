@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <string.h>
+#include "physics/layers.h"
+#include "types.h"
+
+// Layers named after the entity types, in EntityType order
+static const char *entity_layer_names[ENTITY_TYPE_COUNT] = {
+  "grouping",
+  "world",
+  "item",
+  "player"
+};
+
+void physics_layers_init(struct PhysicsLayers *layers){
+  memset(layers, 0, sizeof(struct PhysicsLayers));
+  for (int i = 0; i < ENTITY_TYPE_COUNT; i++){
+    physics_layers_add(layers, entity_layer_names[i]);
+  }
+}
+
+// Add a layer that collides with every existing layer.
+// Returns its index, or the existing one if a layer with that name is already there
+int physics_layers_add(struct PhysicsLayers *layers, const char *name){
+  int existing = physics_layers_find(layers, name);
+  if (existing != PHYSICS_NULL_LAYER) return existing;
+
+  if (layers->num_layers == PHYSICS_MAX_LAYERS){
+    fprintf(stderr, "Error: no room for layer %s in physics_layers_add, the limit is %d\n", name, PHYSICS_MAX_LAYERS);
+    return PHYSICS_NULL_LAYER;
+  }
+  if (strlen(name) >= PHYSICS_LAYER_NAME_LENGTH){
+    fprintf(stderr, "Error: layer name %s is too long in physics_layers_add\n", name);
+    return PHYSICS_NULL_LAYER;
+  }
+
+  int layer = layers->num_layers++;
+  strcpy(layers->names[layer], name);
+  for (int i = 0; i <= layer; i++){
+    physics_layers_set_collision(layers, layer, i, true);
+  }
+  return layer;
+}
+
+int physics_layers_find(struct PhysicsLayers *layers, const char *name){
+  for (unsigned int i = 0; i < layers->num_layers; i++){
+    if (strcmp(layers->names[i], name) == 0) return i;
+  }
+  return PHYSICS_NULL_LAYER;
+}
+
+// Sets both (A, B) and (B, A), so the matrix stays symmetric
+void physics_layers_set_collision(struct PhysicsLayers *layers, int layer_A, int layer_B, bool collides){
+  if (layer_A < 0 || layer_B < 0 || layer_A >= (int)layers->num_layers || layer_B >= (int)layers->num_layers){
+    fprintf(stderr, "Error: invalid layers %d and %d in physics_layers_set_collision\n", layer_A, layer_B);
+    return;
+  }
+  if (collides){
+    layers->matrix[layer_A] |= 1u << layer_B;
+    layers->matrix[layer_B] |= 1u << layer_A;
+  }
+  else{
+    layers->matrix[layer_A] &= ~(1u << layer_B);
+    layers->matrix[layer_B] &= ~(1u << layer_A);
+  }
+}
+
+// Collision mask for a body on the given layers: every layer any of them collides with
+uint32_t physics_layers_mask(struct PhysicsLayers *layers, uint32_t layer_bits){
+  uint32_t mask = 0;
+  for (unsigned int i = 0; i < layers->num_layers; i++){
+    if (layer_bits & (1u << i)) mask |= layers->matrix[i];
+  }
+  return mask;
+}
@@ -1,7 +1,10 @@
 #include <stdbool.h>
 #include "scene.h"
 #include "physics/narrow_phase.h"
+#include "physics/toi.h"
+#include "physics/gjk.h"
 #include "utils.h"
+#include <float.h>
 
 #define EPSILON 0.0001
 
@@ -11,66 +14,19 @@ NarrowPhaseFunction narrow_phase_functions[NUM_COLLIDER_TYPES][NUM_COLLIDER_TYPE
   [COLLIDER_AABB][COLLIDER_CAPSULE] = narrow_phase_AABB_capsule,
   [COLLIDER_AABB][COLLIDER_PLANE] = narrow_phase_AABB_plane,
   [COLLIDER_SPHERE][COLLIDER_SPHERE] = narrow_phase_sphere_sphere,
-  [COLLIDER_SPHERE][COLLIDER_CAPSULE] = narrow_phase_sphere_capsule,
   [COLLIDER_SPHERE][COLLIDER_PLANE] = narrow_phase_sphere_plane,
-  [COLLIDER_SPHERE][COLLIDER_CAPSULE] = narrow_phase_sphere_capsule,
-  [COLLIDER_CAPSULE][COLLIDER_CAPSULE] = narrow_phase_capsule_capsule,
-  [COLLIDER_CAPSULE][COLLIDER_PLANE] = narrow_phase_capsule_plane
+  [COLLIDER_CAPSULE][COLLIDER_PLANE] = narrow_phase_capsule_plane,
+  [COLLIDER_AABB][COLLIDER_OBB] = narrow_phase_AABB_OBB,
+  [COLLIDER_SPHERE][COLLIDER_OBB] = narrow_phase_sphere_OBB,
+  [COLLIDER_PLANE][COLLIDER_OBB] = narrow_phase_plane_OBB,
+  [COLLIDER_OBB][COLLIDER_OBB] = narrow_phase_OBB_OBB
 };
 
 struct CollisionResult narrow_phase_AABB_AABB(struct PhysicsBody *body_AABB_A, struct PhysicsBody *body_AABB_B, float delta_time){
-  struct AABB *aabb_A = &body_AABB_A->collider.data.aabb;
-  struct AABB *aabb_B = &body_AABB_B->collider.data.aabb;
-  struct AABB world_AABB_A = {0};
-  struct AABB world_AABB_B = {0};
+  struct AABB world_AABB_A, world_AABB_B;
   struct CollisionResult result = {0};
-
-  if (body_AABB_A->scene_node){
-    vec3 world_position_A, world_rotation_A, world_scale_A;
-    glm_mat4_mulv3(body_AABB_A->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_A);
-    glm_decompose_scalev(body_AABB_A->scene_node->world_transform, world_scale_A);
-    mat3 rotation_mat3_A;
-    glm_mat4_pick3(body_AABB_A->scene_node->world_transform, rotation_mat3_A);
-    if (world_scale_A[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3_A, 1.0f / world_scale_A[0]);
-    }
-    AABB_update(aabb_A, rotation_mat3_A, world_position_A, world_scale_A, &world_AABB_A);
-  }
-  if (body_AABB_B->scene_node){
-    vec3 world_position_B, world_rotation_B, world_scale_B;
-    glm_mat4_mulv3(body_AABB_B->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_B);
-    glm_decompose_scalev(body_AABB_B->scene_node->world_transform, world_scale_B);
-    mat3 rotation_mat3_B;
-    glm_mat4_pick3(body_AABB_B->scene_node->world_transform, rotation_mat3_B);
-    if (world_scale_B[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3_B, 1.0f / world_scale_B[0]);
-    }
-    AABB_update(aabb_B, rotation_mat3_B, world_position_B, world_scale_B, &world_AABB_B);
-  }
-
-  // Get world space bodies
-  // mat4 eulerA;
-  // mat3 rotationA;
-  // glm_euler_xyz(body_AABB_A->rotation, eulerA);
-  // glm_mat4_pick3(eulerA, rotationA);
-  // vec3 translationA;
-  // glm_vec3_copy(body_AABB_A->position, translationA);
-  // vec3 scaleA;
-  // glm_vec3_copy(body_AABB_A->scale, scaleA);
-  // struct AABB world_AABB_A = {0};
-  // AABB_update(aabb_A, rotationA, translationA, scaleA, &world_AABB_A);
-  //
-  // // Get world space bodies
-  // mat4 eulerB;
-  // mat3 rotationB;
-  // glm_euler_xyz(body_AABB_B->rotation, eulerB);
-  // glm_mat4_pick3(eulerB, rotationB);
-  // vec3 translationB;
-  // glm_vec3_copy(body_AABB_B->position, translationB);
-  // vec3 scaleB;
-  // glm_vec3_copy(body_AABB_B->scale, scaleB);
-  // struct AABB world_AABB_B = {0};
-  // AABB_update(aabb_B, rotationB, translationB, scaleB, &world_AABB_B);
+  physics_body_get_world_AABB(body_AABB_A, 0.0f, &world_AABB_A);
+  physics_body_get_world_AABB(body_AABB_B, 0.0f, &world_AABB_B);
 
   // If already intersecting, they're already colliding
   if (AABB_intersect_AABB(&world_AABB_A, &world_AABB_B)){
@@ -141,38 +97,11 @@ struct CollisionResult narrow_phase_AABB_AABB(struct PhysicsBody *body_AABB_A, s
 }
 
 struct CollisionResult narrow_phase_AABB_sphere(struct PhysicsBody *body_AABB, struct PhysicsBody *body_sphere, float delta_time){
-  struct AABB *box = &body_AABB->collider.data.aabb;
-  struct Sphere *sphere = &body_sphere->collider.data.sphere;
-  struct AABB world_AABB = {0};
-  struct Sphere world_sphere = {0};
+  struct AABB world_AABB;
+  struct Sphere world_sphere;
   struct CollisionResult result = {0};
-
-  // Get world space bodies
-  if (body_AABB->scene_node){
-    vec3 world_position_A, world_rotation_A, world_scale_A;
-    glm_mat4_mulv3(body_AABB->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_A);
-    // glm_vec3_muladds(body_AABB->velocity, time, world_position_A);
-    glm_decompose_scalev(body_AABB->scene_node->world_transform, world_scale_A);
-    mat3 rotation_mat3_A;
-    glm_mat4_pick3(body_AABB->scene_node->world_transform, rotation_mat3_A);
-    if (world_scale_A[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3_A, 1.0f / world_scale_A[0]);
-    }
-    AABB_update(box, rotation_mat3_A, world_position_A, world_scale_A, &world_AABB);
-  }
-  if (body_sphere->scene_node){
-    vec3 world_position_B, world_rotation_B, world_scale_B;
-    glm_mat4_mulv3(body_sphere->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_B);
-    glm_decompose_scalev(body_sphere->scene_node->world_transform, world_scale_B);
-    // mat3 rotation_mat3_B;
-    // glm_mat4_pick3(body_B->scene_node->world_transform, rotation_mat3_B);
-    // if (world_scale_B[0] != 0.0f){
-    //   glm_mat3_scale(rotation_mat3_B, 1.0f / world_scale_B[0]);
-    // }
-    glm_vec3_add(sphere->center, world_position_B, world_sphere.center);
-    // glm_vec3_muladds(body_sphere->velocity, time, world_position_B);
-    world_sphere.radius = sphere->radius * world_scale_B[0];
-  }
+  physics_body_get_world_AABB(body_AABB, 0.0f, &world_AABB);
+  physics_body_get_world_sphere(body_sphere, 0.0f, &world_sphere);
 
   // LAZY VERSION: Assume sphere direction ray intersection with the bounding AABB e an intersection with the world AABB.
   // Come back to this later for more precise edge and corner testing and point of contact.
@@ -231,54 +160,17 @@ struct CollisionResult narrow_phase_AABB_sphere(struct PhysicsBody *body_AABB, s
 }
 
 struct CollisionResult narrow_phase_AABB_capsule(struct PhysicsBody *body_AABB, struct PhysicsBody *body_capsule, float delta_time){
-  struct AABB *box = &body_AABB->collider.data.aabb;
-  struct Capsule *capsule = &body_capsule->collider.data.capsule;
+  struct AABB world_AABB;
+  struct Capsule world_capsule;
   struct CollisionResult result = {0};
-
-  struct AABB world_AABB = {0};
-  struct AABB world_AABB_final = {0};
-  struct Capsule world_capsule = {0};
-
-  // Apply world transform to bodies
-  if (body_AABB->scene_node){
-    vec3 world_position, world_rotation, world_scale;
-    glm_mat4_mulv3(body_AABB->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position);
-    glm_decompose_scalev(body_AABB->scene_node->world_transform, world_scale);
-    mat3 rotation_mat3;
-    glm_mat4_pick3(body_AABB->scene_node->world_transform, rotation_mat3);
-    if (world_scale[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3, 1.0f / world_scale[0]);
-    }
-    AABB_update(box, rotation_mat3, world_position, world_scale, &world_AABB_final);
-  }
-  else{
-    world_AABB = *box;
-  }
-  if (body_capsule->scene_node){
-    // Transform capsule
-    glm_mat4_mulv3(body_capsule->scene_node->world_transform, capsule->segment_A, 1.0f, world_capsule.segment_A);
-    glm_mat4_mulv3(body_capsule->scene_node->world_transform, capsule->segment_B, 1.0f, world_capsule.segment_B);
-  }
-
-  // glm_vec3_scale(capsule->segment_A, body_capsule->scale[0], world_capsule.segment_A);
-  // glm_vec3_scale(capsule->segment_B, body_capsule->scale[0], world_capsule.segment_B);
-  // mat4 eulerA;
-  // mat3 rotationA;
-  // vec3 rotatedA, rotatedB;
-  // glm_euler_xyz(body_capsule->rotation, eulerA);
-  // glm_mat4_pick3(eulerA, rotationA);
-  // glm_mat3_mulv(rotationA, world_capsule.segment_A, world_capsule.segment_A);
-  // glm_mat3_mulv(rotationA, world_capsule.segment_B, world_capsule.segment_B);
-  //
-  // glm_vec3_add(world_capsule.segment_A, body_capsule->position, world_capsule.segment_A);
-  // glm_vec3_add(world_capsule.segment_B, body_capsule->position, world_capsule.segment_B);
-  world_capsule.radius = capsule->radius * body_capsule->scale[0];
+  physics_body_get_world_AABB(body_AABB, 0.0f, &world_AABB);
+  physics_body_get_world_capsule(body_capsule, 0.0f, &world_capsule);
 
   // Get distance from closest point on capsule segment to AABB
   // Find closest point on segment to AABB center
   vec3 segment, A_to_center;
   glm_vec3_sub(world_capsule.segment_B, world_capsule.segment_A, segment);
-  glm_vec3_sub(world_AABB_final.center, world_capsule.segment_A, A_to_center);
+  glm_vec3_sub(world_AABB.center, world_capsule.segment_A, A_to_center);
   float proj = glm_dot(segment, A_to_center);
   // Normalize projection of A->center onto segment, clamp between 0 and 1
   float t = proj / glm_vec3_dot(segment, segment);
@@ -292,7 +184,7 @@ struct CollisionResult narrow_phase_AABB_capsule(struct PhysicsBody *body_AABB,
   // Closest point on the AABB is the segment's closest point clamped to AABB extents
   vec3 q, pq;
   for (int i = 0; i < 3; i++){
-    q[i] = glm_clamp(closest_point[i], world_AABB_final.center[i] - world_AABB_final.extents[i], world_AABB_final.center[i] + world_AABB_final.extents[i]);
+    q[i] = glm_clamp(closest_point[i], world_AABB.center[i] - world_AABB.extents[i], world_AABB.center[i] + world_AABB.extents[i]);
   }
   glm_vec3_sub(q, closest_point, pq);
   float distance = glm_vec3_norm(pq) - world_capsule.radius;
@@ -342,22 +234,11 @@ struct CollisionResult narrow_phase_AABB_capsule(struct PhysicsBody *body_AABB,
 }
 
 struct CollisionResult narrow_phase_AABB_plane(struct PhysicsBody *body_AABB, struct PhysicsBody *body_plane, float delta_time){
-  struct AABB *box = &body_AABB->collider.data.aabb;
-  struct Plane *plane = &body_plane->collider.data.plane;
+  struct AABB world_AABB;
+  struct Plane world_plane;
   struct CollisionResult result = {0};
-
-  // Get a world space version of the current AABB
-  mat4 eulerA;
-  mat3 rotationA;
-  glm_euler_xyz(body_AABB->rotation, eulerA);
-  glm_mat4_pick3(eulerA, rotationA);
-
-  vec3 translationA;
-  glm_vec3_copy(body_AABB->position, translationA);
-  vec3 scaleA;
-  glm_vec3_copy(body_AABB->scale, scaleA);
-  struct AABB worldAABB_A = {0};
-  AABB_update(box, rotationA, translationA, scaleA, &worldAABB_A);
+  physics_body_get_world_AABB(body_AABB, 0.0f, &world_AABB);
+  physics_body_get_world_plane(body_plane, 0.0f, &world_plane);
 
   // Get relative velocity
   vec3 rel_v;
@@ -365,21 +246,21 @@ struct CollisionResult narrow_phase_AABB_plane(struct PhysicsBody *body_AABB, st
 
   // Get radius of projection interval
   float r =
-    worldAABB_A.extents[0] * fabs(plane->normal[0]) +
-    worldAABB_A.extents[1] * fabs(plane->normal[1]) +
-    worldAABB_A.extents[2] * fabs(plane->normal[2]); 
+    world_AABB.extents[0] * fabs(world_plane.normal[0]) +
+    world_AABB.extents[1] * fabs(world_plane.normal[1]) +
+    world_AABB.extents[2] * fabs(world_plane.normal[2]); 
 
   // Get distance from center of AABB to plane
-  // printf("Dot product of plane normal and world aabb center %f\n", glm_dot(plane->normal, worldAABB_A.center));
-  // printf("Plane distance from origin: %f\n", plane->distance);
-  float s = glm_dot(plane->normal, worldAABB_A.center) - plane->distance;
+  // printf("Dot product of plane normal and world aabb center %f\n", glm_dot(world_plane.normal, world_AABB.center));
+  // printf("Plane distance from origin: %f\n", world_plane.distance);
+  float s = glm_dot(world_plane.normal, world_AABB.center) - world_plane.distance;
   // printf("Distance from center to plane: %f\n", s);
 
   // Get dot product of normal and relative velocity
   // - n*v = 0 => moving parallel
   // - n*v < 0 => moving towards plane
   // - n*v > 0 => moving away from the plane
-  float n_dot_v = glm_dot(plane->normal, rel_v);
+  float n_dot_v = glm_dot(world_plane.normal, rel_v);
   // printf("r: %f, s: %f, n_dot_v: %f\n", r, s, n_dot_v);
 
   // n*v == 0 => parallel movement
@@ -438,37 +319,31 @@ struct CollisionResult narrow_phase_AABB_plane(struct PhysicsBody *body_AABB, st
     // Point of contact Q = C(t) - rn
     // vec3 Q;
     // if (result.colliding){
-    //   glm_vec3_copy(worldAABB_A.center, result.point_of_contact);
+    //   glm_vec3_copy(world_AABB.center, result.point_of_contact);
     //   glm_vec3_muladds(body_AABB->velocity, result.hit_time, result.point_of_contact);
     //
     //   if (fabs(s) < r){
-    //     float dist = glm_dot(plane->normal, result.point_of_contact) - plane->distance;
+    //     float dist = glm_dot(world_plane.normal, result.point_of_contact) - world_plane.distance;
     //     result.penetration = dist;
     //     // printf("Result penetration %f\n", s - dist);
-    //     glm_vec3_mulsubs(plane->normal, dist, result.point_of_contact);
+    //     glm_vec3_mulsubs(world_plane.normal, dist, result.point_of_contact);
     //   }
     // }
-    // glm_vec3_copy(worldAABB_A.center, result.point_of_contact);
+    // glm_vec3_copy(world_AABB.center, result.point_of_contact);
     // glm_vec3_muladds(body_AABB->velocity, result.hit_time, result.point_of_contact);
-    // glm_vec3_mulsubs(plane->normal, r, result.point_of_contact);
+    // glm_vec3_mulsubs(world_plane.normal, r, result.point_of_contact);
   }
 
   return result;
 }
 
 struct CollisionResult narrow_phase_sphere_sphere(struct PhysicsBody *body_sphere_A, struct PhysicsBody *body_sphere_B, float delta_time){
-  struct Sphere *sphere_A = &body_sphere_A->collider.data.sphere;
-  struct Sphere *sphere_B = &body_sphere_B->collider.data.sphere;
   struct CollisionResult result = {0};
 
   // Get world space spheres
-  struct Sphere world_sphere_A = {0};
-  glm_vec3_add(sphere_A->center, body_sphere_A->position, world_sphere_A.center);
-  world_sphere_A.radius = sphere_A->radius * body_sphere_A->scale[0];
-
-  struct Sphere world_sphere_B = {0};
-  glm_vec3_add(sphere_B->center, body_sphere_B->position, world_sphere_B.center);
-  world_sphere_B.radius = sphere_B->radius * body_sphere_B->scale[0];
+  struct Sphere world_sphere_A, world_sphere_B;
+  physics_body_get_world_sphere(body_sphere_A, 0.0f, &world_sphere_A);
+  physics_body_get_world_sphere(body_sphere_B, 0.0f, &world_sphere_B);
 
   // s - difference between centers
   // v - relative velocity
@@ -519,28 +394,21 @@ struct CollisionResult narrow_phase_sphere_sphere(struct PhysicsBody *body_spher
   return result;
 }
 
-struct CollisionResult narrow_phase_sphere_capsule(struct PhysicsBody *body_sphere, struct PhysicsBody *body_capsule, float delta_time){
-
-}
-
 struct CollisionResult narrow_phase_sphere_plane(struct PhysicsBody *body_sphere, struct PhysicsBody *body_plane, float delta_time){
-  struct Sphere *sphere = &body_sphere->collider.data.sphere;
-  struct Plane *plane = &body_plane->collider.data.plane;
   struct CollisionResult result = {0};
 
-  // Get world space sphere
-  struct Sphere world_sphere = {0};
-  glm_vec3_add(sphere->center, body_sphere->position, world_sphere.center);
-  // glm_vec3_muladds(body_A->velocity, time, world_sphere.center);
-  // glm_vec3_scale(world_sphere.center, body_sphere->scale[0], world_sphere.center);
-  world_sphere.radius = sphere->radius * body_sphere->scale[0];
+  // Get world space bodies
+  struct Sphere world_sphere;
+  struct Plane world_plane;
+  physics_body_get_world_sphere(body_sphere, 0.0f, &world_sphere);
+  physics_body_get_world_plane(body_plane, 0.0f, &world_plane);
 
   // Get signed distance from sphere center to plane
-  float s = glm_dot(world_sphere.center, plane->normal) - plane->distance;
+  float s = glm_dot(world_sphere.center, world_plane.normal) - world_plane.distance;
   // printf("Signed distance from sphere center to plane: %f\n", s);
 
   // Get velocity along normal
-  float n_dot_v = glm_dot(body_sphere->velocity, plane->normal);
+  float n_dot_v = glm_dot(body_sphere->velocity, world_plane.normal);
 
   // Compute product of signed distance and normal velocity
   float discriminant = s * n_dot_v;
@@ -587,53 +455,14 @@ struct CollisionResult narrow_phase_sphere_plane(struct PhysicsBody *body_sphere
   return result;
 }
 
-struct CollisionResult narrow_phase_capsule_capsule(struct PhysicsBody *body_capsule_A, struct PhysicsBody *body_capsule_B, float delta_time){
-
-}
-
 struct CollisionResult narrow_phase_capsule_plane(struct PhysicsBody *body_capsule, struct PhysicsBody *body_plane, float delta_time){
-  struct Capsule *capsule = &body_capsule->collider.data.capsule;
-  struct Plane *plane = &body_plane->collider.data.plane;
   struct CollisionResult result = {0};
 
-  // Get world space capsule
-  struct Capsule world_capsule = {0};
-  struct Plane world_plane = {0};
-  // Apply world transform to capsule segments
-  if (body_capsule->scene_node){
-    glm_mat4_mulv3(body_capsule->scene_node->world_transform, capsule->segment_A, 1.0f, world_capsule.segment_A);
-    glm_mat4_mulv3(body_capsule->scene_node->world_transform, capsule->segment_B, 1.0f, world_capsule.segment_B);
-  }
-  if (body_plane->scene_node){
-    mat3 rotation_mat3;
-    vec3 world_position, world_rotation, world_scale;
-    // Plane normal and distance include an already-applied local transformation
-    glm_mat4_mulv3(body_plane->scene_node->parent_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position);
-    glm_decompose_scalev(body_plane->scene_node->parent_node->world_transform, world_scale);
-    glm_mat4_pick3(body_plane->scene_node->parent_node->world_transform, rotation_mat3);
-    if (world_scale[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3, 1.0f / world_scale[0]);
-    }
-
-    // Transform plane
-    glm_mat3_mulv(rotation_mat3, plane->normal, world_plane.normal);
-    glm_vec3_normalize(world_plane.normal);
-    world_plane.distance = (plane->distance) + glm_vec3_dot(world_position, world_plane.normal);
-  }
-
-  glm_vec3_scale(capsule->segment_A, body_capsule->scale[0], world_capsule.segment_A);
-  glm_vec3_scale(capsule->segment_B, body_capsule->scale[0], world_capsule.segment_B);
-  mat4 eulerA;
-  mat3 rotationA;
-  vec3 rotatedA, rotatedB;
-  glm_euler_xyz(body_capsule->rotation, eulerA);
-  glm_mat4_pick3(eulerA, rotationA);
-  glm_mat3_mulv(rotationA, world_capsule.segment_A, world_capsule.segment_A);
-  glm_mat3_mulv(rotationA, world_capsule.segment_B, world_capsule.segment_B);
-
-  glm_vec3_add(world_capsule.segment_A, body_capsule->position, world_capsule.segment_A);
-  glm_vec3_add(world_capsule.segment_B, body_capsule->position, world_capsule.segment_B);
-  world_capsule.radius = capsule->radius * body_capsule->scale[0];
+  // Get world space bodies
+  struct Capsule world_capsule;
+  struct Plane world_plane;
+  physics_body_get_world_capsule(body_capsule, 0.0f, &world_capsule);
+  physics_body_get_world_plane(body_plane, 0.0f, &world_plane);
 
   // Get distance from closest point on capsule to plane
   float n_dot_A = glm_dot(world_plane.normal, world_capsule.segment_A);
@@ -697,8 +526,229 @@ struct CollisionResult narrow_phase_capsule_plane(struct PhysicsBody *body_capsu
   return result;
 }
 
+// ORIENTED BOUNDING BOXES
+//
+// Boxes are tested with SAT against each other and against AABBs, which are just OBBs
+// with the world axes. Capsule-OBB has no entry: GJK already gives the exact
+// result for a segment against a box, so it goes through narrow_phase_gjk.
+// All of these fill in the normal and penetration for resolve_collision_gjk.
+static struct CollisionResult narrow_phase_box_box(struct OBB *box_A, struct OBB *box_B, vec3 velocity_A, vec3 velocity_B, float delta_time){
+  struct CollisionResult result = {0};
+  vec3 rel_v;
+  glm_vec3_sub(velocity_A, velocity_B, rel_v);
+
+  float hit_time;
+  vec3 normal;
+  if (!sweep_OBB_OBB(box_A, box_B, rel_v, delta_time, &hit_time, normal)){
+    result.hit_time = -1;
+    result.colliding = false;
+    return result;
+  }
+
+  result.hit_time = hit_time;
+  result.colliding = true;
+  glm_vec3_copy(normal, result.normal);
+
+  // Already overlapping: push out along the axis of least penetration
+  if (hit_time == 0.0f){
+    struct OBBSeparation separation;
+    OBB_separating_axis(box_A, box_B, &separation);
+    result.penetration = glm_max(-separation.separation, 0.0f);
+    glm_vec3_copy(separation.normal, result.normal);
+  }
+  // Midpoint between the centers at hit_time
+  vec3 velocity_sum;
+  glm_vec3_add(velocity_A, velocity_B, velocity_sum);
+  glm_vec3_lerp(box_A->center, box_B->center, 0.5f, result.point_of_contact);
+  glm_vec3_muladds(velocity_sum, 0.5f * hit_time, result.point_of_contact);
+  return result;
+}
+
+struct CollisionResult narrow_phase_AABB_OBB(struct PhysicsBody *body_AABB, struct PhysicsBody *body_OBB, float delta_time){
+  struct AABB world_AABB;
+  struct OBB box_A, box_B;
+  physics_body_get_world_AABB(body_AABB, 0.0f, &world_AABB);
+  physics_body_get_world_OBB(body_OBB, 0.0f, &box_B);
+  OBB_from_AABB(&world_AABB, &box_A);
+  return narrow_phase_box_box(&box_A, &box_B, body_AABB->velocity, body_OBB->velocity, delta_time);
+}
+
+struct CollisionResult narrow_phase_OBB_OBB(struct PhysicsBody *body_OBB_A, struct PhysicsBody *body_OBB_B, float delta_time){
+  struct OBB box_A, box_B;
+  physics_body_get_world_OBB(body_OBB_A, 0.0f, &box_A);
+  physics_body_get_world_OBB(body_OBB_B, 0.0f, &box_B);
+  return narrow_phase_box_box(&box_A, &box_B, body_OBB_A->velocity, body_OBB_B->velocity, delta_time);
+}
+
+struct CollisionResult narrow_phase_sphere_OBB(struct PhysicsBody *body_sphere, struct PhysicsBody *body_OBB, float delta_time){
+  struct CollisionResult result = {0};
+  struct Sphere world_sphere;
+  struct OBB world_OBB;
+  physics_body_get_world_sphere(body_sphere, 0.0f, &world_sphere);
+  physics_body_get_world_OBB(body_OBB, 0.0f, &world_OBB);
+
+  // Move the sphere relative to the box, which stays put
+  vec3 rel_v;
+  glm_vec3_sub(body_sphere->velocity, body_OBB->velocity, rel_v);
+  float speed = glm_vec3_norm(rel_v);
+
+  // The closest point on the box to the center gives the exact distance,
+  // so advance conservatively by distance / speed like time_of_impact does
+  float time = 0.0f;
+  vec3 center;
+  unsigned int iterations = 0;
+  while (true){
+    glm_vec3_copy(world_sphere.center, center);
+    glm_vec3_muladds(rel_v, time, center);
+    float distance = sqrtf(OBB_distance_squared_point(&world_OBB, center)) - world_sphere.radius;
+    if (distance <= TOI_TOLERANCE || iterations++ >= TOI_MAX_ITERATIONS) break;
+    if (speed < EPSILON){
+      result.hit_time = -1;
+      result.colliding = false;
+      return result;
+    }
+    time += distance / speed;
+    if (time > delta_time){
+      result.hit_time = -1;
+      result.colliding = false;
+      return result;
+    }
+  }
+
+  result.hit_time = time;
+  result.colliding = true;
+
+  // Normal from the sphere to the box, through the closest point on the box.
+  // If the center is inside the box, push out through the nearest face instead
+  vec3 closest_point, difference;
+  OBB_closest_point(&world_OBB, center, closest_point);
+  glm_vec3_sub(closest_point, center, difference);
+  float distance = glm_vec3_norm(difference);
+  if (distance > EPSILON){
+    glm_vec3_scale(difference, 1.0f / distance, result.normal);
+    result.penetration = glm_max(world_sphere.radius - distance, 0.0f);
+  }
+  else{
+    vec3 d;
+    glm_vec3_sub(center, world_OBB.center, d);
+    float min_depth = FLT_MAX;
+    for (int i = 0; i < 3; i++){
+      float distance_along = glm_vec3_dot(d, world_OBB.axes[i]);
+      float depth = world_OBB.extents[i] - fabsf(distance_along);
+      if (depth < min_depth){
+        min_depth = depth;
+        glm_vec3_scale(world_OBB.axes[i], distance_along >= 0.0f ? -1.0f : 1.0f, result.normal);
+      }
+    }
+    result.penetration = min_depth + world_sphere.radius;
+  }
+  glm_vec3_copy(closest_point, result.point_of_contact);
+  glm_vec3_muladds(body_OBB->velocity, time, result.point_of_contact);
+  return result;
+}
+
+// Planes sort before OBBs, so the plane is A here
+struct CollisionResult narrow_phase_plane_OBB(struct PhysicsBody *body_plane, struct PhysicsBody *body_OBB, float delta_time){
+  struct CollisionResult result = {0};
+  struct Plane world_plane;
+  struct OBB world_OBB;
+  physics_body_get_world_plane(body_plane, 0.0f, &world_plane);
+  physics_body_get_world_OBB(body_OBB, 0.0f, &world_OBB);
+
+  // Same slab test as AABB-plane, with the radius projected along the box's axes
+  float r = OBB_projection_radius(&world_OBB, world_plane.normal);
+  float s = glm_dot(world_plane.normal, world_OBB.center) - world_plane.distance;
+
+  vec3 rel_v;
+  glm_vec3_sub(body_OBB->velocity, body_plane->velocity, rel_v);
+  float n_dot_v = glm_dot(world_plane.normal, rel_v);
+
+  // Normal from the plane towards the side the box is on
+  glm_vec3_copy(world_plane.normal, result.normal);
+  if (s < 0.0f) glm_vec3_negate(result.normal);
+
+  if (fabsf(s) <= r){
+    result.hit_time = 0;
+    result.colliding = true;
+    result.penetration = r - fabsf(s);
+  }
+  else if (fabsf(n_dot_v) < EPSILON){
+    result.hit_time = -1;
+    result.colliding = false;
+  }
+  else{
+    // In front of the plane: t = (r - s) / (n * v), behind it: t = (-r - s) / (n * v)
+    result.hit_time = (s > 0.0f) ? (r - s) / n_dot_v : (-r - s) / n_dot_v;
+    result.colliding = (result.hit_time >= 0 && result.hit_time <= delta_time);
+    if (!result.colliding){
+      result.hit_time = -1;
+    }
+  }
+
+  if (result.colliding){
+    // Deepest point of the box along the normal
+    glm_vec3_copy(world_OBB.center, result.point_of_contact);
+    glm_vec3_muladds(body_OBB->velocity, result.hit_time, result.point_of_contact);
+    glm_vec3_mulsubs(result.normal, r, result.point_of_contact);
+  }
+  return result;
+}
+
+// TRIANGLE MESHES
+//
+// Meshes are static and sort after every other collider type, so the mesh is always B.
+// The BVH query gives the closest (or deepest) triangle contact for spheres, capsules
+// and boxes, and the body is advanced conservatively towards the mesh like sphere-OBB
+// Time of impact has already advanced the pair to first contact, like narrow_phase_gjk,
+// so this only needs the contact at that time
+struct CollisionResult narrow_phase_convex_mesh(struct PhysicsBody *body_convex, struct PhysicsBody *body_mesh, float hit_time, float delta_time){
+  struct CollisionResult result = {0};
+  struct ConvexShape shape;
+  struct MeshCollider world_mesh;
+  struct MeshContact contact;
+  convex_shape_from_body(body_convex, hit_time, &shape);
+  physics_body_get_world_mesh(body_mesh, hit_time, &world_mesh);
+
+  if (!mesh_collider_contact(&world_mesh, &shape, &contact) || contact.distance > TOI_TOLERANCE || hit_time > delta_time){
+    result.hit_time = -1;
+    result.colliding = false;
+    return result;
+  }
+
+  result.hit_time = hit_time;
+  result.colliding = true;
+  result.penetration = glm_max(-contact.distance, 0.0f);
+  glm_vec3_copy(contact.normal, result.normal);
+  glm_vec3_copy(contact.point, result.point_of_contact);
+  return result;
+}
+
 
 // HELPERS
+// Generic narrow phase for pairs without a dedicated function.
+// Time of impact has already advanced the pair to first contact (or to the
+// start of the step if it's already touching), so the bodies are tested there
+struct CollisionResult narrow_phase_gjk(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct GJKCache *cache, float hit_time, float delta_time){
+  struct CollisionResult result = {0};
+  struct ConvexShape shape_A, shape_B;
+  convex_shape_from_body(body_A, hit_time, &shape_A);
+  convex_shape_from_body(body_B, hit_time, &shape_B);
+
+  struct GJKResult gjk = gjk_distance(&shape_A, &shape_B, cache);
+  if (gjk.distance > TOI_TOLERANCE || hit_time > delta_time){
+    result.hit_time = -1;
+    result.colliding = false;
+    return result;
+  }
+
+  result.hit_time = hit_time;
+  result.colliding = true;
+  result.penetration = glm_max(-gjk.distance, 0.0f);
+  glm_vec3_copy(gjk.normal, result.normal);
+  glm_vec3_lerp(gjk.point_A, gjk.point_B, 0.5f, result.point_of_contact);
+  return result;
+}
+
 bool ray_intersect_AABB(vec3 p, vec3 d, struct AABB *aabb, float *hit_time, float end_time){
   *hit_time = 0.0f;
   float t_max = end_time;
@@ -737,3 +787,51 @@ bool ray_intersect_AABB(vec3 p, vec3 d, struct AABB *aabb, float *hit_time, floa
   // The ray intersects all 3 slabs
   return true;
 }
+
+// Moving separating axis test between two boxes, with A moving at rel_v relative to B.
+// Boxes only translate during a step, so the candidate axes don't change, and on each one
+// the distance between centers moves linearly: d(t) = T * L - t(v * L).
+// The boxes overlap on L while |d(t)| <= r_A + r_B, and overlap for real
+// between the latest entry and the earliest exit over all axes, like AABB-AABB.
+// normal is the axis of the latest entry, from A to B
+bool sweep_OBB_OBB(struct OBB *a, struct OBB *b, vec3 rel_v, float end_time, float *hit_time, vec3 normal){
+  vec3 t;
+  glm_vec3_sub(b->center, a->center, t);
+  vec3 axes[OBB_MAX_SEPARATING_AXES];
+  int num_axes = OBB_separating_axes(a, b, axes);
+
+  float t_first = 0.0f;
+  float t_last = end_time;
+  glm_vec3_copy((vec3){0.0f, 1.0f, 0.0f}, normal);
+  for (int i = 0; i < num_axes; i++){
+    float d = glm_vec3_dot(t, axes[i]);
+    float v = glm_vec3_dot(rel_v, axes[i]);
+    float r = OBB_projection_radius(a, axes[i]) + OBB_projection_radius(b, axes[i]);
+
+    // Not moving on this axis: separated on it for the whole step, or never
+    if (fabsf(v) < EPSILON){
+      if (fabsf(d) > r) return false;
+      continue;
+    }
+
+    // Times at which d(t) = -r and d(t) = r
+    float t1 = (d + r) / v;
+    float t2 = (d - r) / v;
+    if (t1 > t2){
+      float temp = t1;
+      t1 = t2;
+      t2 = temp;
+    }
+    if (t1 > t_first){
+      t_first = t1;
+      // Entering from d > 0 means B is on the positive side of the axis
+      glm_vec3_copy(axes[i], normal);
+      if (d < 0.0f) glm_vec3_negate(normal);
+    }
+    if (t2 < t_last) t_last = t2;
+    if (t_first > t_last) return false;
+  }
+
+  *hit_time = t_first;
+  return true;
+}
@@ -0,0 +1,153 @@
+#include "physics/obb.h"
+#include <float.h>
+#include <cglm/util.h>
+#include <cglm/vec3.h>
+
+// Cross products shorter than this come from (nearly) parallel edges.
+// Their axis is already covered by the face axes, so SAT skips it
+#define OBB_PARALLEL_EPSILON 0.000001f
+
+void OBB_from_AABB(struct AABB *aabb, struct OBB *dest){
+  glm_vec3_copy(aabb->center, dest->center);
+  glm_vec3_copy(aabb->extents, dest->extents);
+  glm_vec3_copy((vec3){1.0f, 0.0f, 0.0f}, dest->axes[0]);
+  glm_vec3_copy((vec3){0.0f, 1.0f, 0.0f}, dest->axes[1]);
+  glm_vec3_copy((vec3){0.0f, 0.0f, 1.0f}, dest->axes[2]);
+}
+
+// Same convention as AABB_update: the center is rotated and translated but not scaled.
+// Unlike AABB_update the extents stay along the box's own axes, so each one
+// is scaled by its own axis' scale and the box doesn't grow when it rotates
+void OBB_update(struct OBB *src, mat3 rotation, vec3 translation, vec3 scale, struct OBB *dest){
+  vec3 center;
+  glm_mat3_mulv(rotation, src->center, center);
+  glm_vec3_add(center, translation, dest->center);
+  for (int i = 0; i < 3; i++){
+    glm_mat3_mulv(rotation, src->axes[i], dest->axes[i]);
+    glm_vec3_normalize(dest->axes[i]);
+    dest->extents[i] = src->extents[i] * fabsf(scale[i]);
+  }
+}
+
+// Smallest AABB enclosing the OBB, for the broad phase
+void OBB_to_AABB(struct OBB *obb, struct AABB *dest){
+  glm_vec3_copy(obb->center, dest->center);
+  for (int i = 0; i < 3; i++){
+    dest->extents[i] =
+      fabsf(obb->axes[0][i]) * obb->extents[0] +
+      fabsf(obb->axes[1][i]) * obb->extents[1] +
+      fabsf(obb->axes[2][i]) * obb->extents[2];
+  }
+  dest->initialized = true;
+}
+
+// center + sign_x * e_x * u_x + sign_y * e_y * u_y + sign_z * e_z * u_z
+void OBB_corner(struct OBB *obb, float sign_x, float sign_y, float sign_z, vec3 dest){
+  glm_vec3_copy(obb->center, dest);
+  glm_vec3_muladds(obb->axes[0], sign_x * obb->extents[0], dest);
+  glm_vec3_muladds(obb->axes[1], sign_y * obb->extents[1], dest);
+  glm_vec3_muladds(obb->axes[2], sign_z * obb->extents[2], dest);
+}
+
+// HELPERS
+//
+// Radius of the box's projection interval onto an axis
+float OBB_projection_radius(struct OBB *obb, vec3 axis){
+  return
+    obb->extents[0] * fabsf(glm_vec3_dot(obb->axes[0], axis)) +
+    obb->extents[1] * fabsf(glm_vec3_dot(obb->axes[1], axis)) +
+    obb->extents[2] * fabsf(glm_vec3_dot(obb->axes[2], axis));
+}
+
+// Closest point on (or in) the box to a point: clamp the point's
+// coordinates along each axis to the extents (Ericson, 5.1.4)
+void OBB_closest_point(struct OBB *obb, vec3 point, vec3 dest){
+  vec3 d;
+  glm_vec3_sub(point, obb->center, d);
+  glm_vec3_copy(obb->center, dest);
+  for (int i = 0; i < 3; i++){
+    float distance = glm_clamp(glm_vec3_dot(d, obb->axes[i]), -obb->extents[i], obb->extents[i]);
+    glm_vec3_muladds(obb->axes[i], distance, dest);
+  }
+}
+
+float OBB_distance_squared_point(struct OBB *obb, vec3 point){
+  vec3 d;
+  glm_vec3_sub(point, obb->center, d);
+  float distance_squared = 0.0f;
+  for (int i = 0; i < 3; i++){
+    float distance = glm_vec3_dot(d, obb->axes[i]);
+    float excess = 0.0f;
+    if (distance < -obb->extents[i]) excess = distance + obb->extents[i];
+    else if (distance > obb->extents[i]) excess = distance - obb->extents[i];
+    distance_squared += excess * excess;
+  }
+  return distance_squared;
+}
+
+// COLLISION TESTS
+//
+// Normalized candidate separating axes between two boxes: the 3 face normals of each
+// and the 9 cross products of their edges. Returns how many were written to dest
+int OBB_separating_axes(struct OBB *a, struct OBB *b, vec3 *dest){
+  int num_axes = 0;
+  for (int i = 0; i < 3; i++){
+    glm_vec3_copy(a->axes[i], dest[num_axes++]);
+    glm_vec3_copy(b->axes[i], dest[num_axes++]);
+  }
+  for (int i = 0; i < 3; i++){
+    for (int j = 0; j < 3; j++){
+      vec3 axis;
+      glm_vec3_cross(a->axes[i], b->axes[j], axis);
+      float length = glm_vec3_norm(axis);
+      if (length < OBB_PARALLEL_EPSILON) continue;
+      glm_vec3_scale(axis, 1.0f / length, dest[num_axes++]);
+    }
+  }
+  return num_axes;
+}
+
+// Separating axis test between two boxes (Ericson, 4.4.1).
+// On each (normalized) axis L the boxes are separated by |T * L| - (r_A + r_B),
+// where T is the vector between centers. The largest of those is the separation:
+// - positive: the boxes don't intersect, and it's a lower bound on their distance
+// - negative: they do, and its magnitude is the penetration depth along normal
+// Returns whether the boxes intersect
+bool OBB_separating_axis(struct OBB *a, struct OBB *b, struct OBBSeparation *dest){
+  vec3 t;
+  glm_vec3_sub(b->center, a->center, t);
+
+  vec3 axes[OBB_MAX_SEPARATING_AXES];
+  int num_axes = OBB_separating_axes(a, b, axes);
+
+  dest->separation = -FLT_MAX;
+  glm_vec3_copy((vec3){0.0f, 1.0f, 0.0f}, dest->normal);
+  for (int i = 0; i < num_axes; i++){
+    float distance = glm_vec3_dot(t, axes[i]);
+    float separation = fabsf(distance) - OBB_projection_radius(a, axes[i]) - OBB_projection_radius(b, axes[i]);
+    if (separation > dest->separation){
+      dest->separation = separation;
+      // Point the axis from A towards B
+      glm_vec3_copy(axes[i], dest->normal);
+      if (distance < 0.0f) glm_vec3_negate(dest->normal);
+    }
+  }
+
+  return dest->separation <= 0.0f;
+}
+
+bool OBB_intersect_OBB(struct OBB *a, struct OBB *b){
+  struct OBBSeparation separation;
+  return OBB_separating_axis(a, b, &separation);
+}
+
+bool OBB_intersect_sphere(struct OBB *obb, struct Sphere *sphere){
+  return OBB_distance_squared_point(obb, sphere->center) <= sphere->radius * sphere->radius;
+}
+
+// Same as AABB_intersect_plane, with the extents projected along the box's axes
+bool OBB_intersect_plane(struct OBB *obb, struct Plane *plane){
+  float r = OBB_projection_radius(obb, plane->normal);
+  float s = glm_dot(plane->normal, obb->center) - plane->distance;
+  return fabsf(s) <= r;
+}
@@ -0,0 +1,463 @@
+#include <cglm/vec3.h>
+#include <stdbool.h>
+#include "entity.h"
+#include "item.h"
+#include "physics/world.h"
+#include "physics/pipeline.h"
+#include "narrow_phase.h"
+#include "resolution.h"
+#include "event.h"
+#include "batch.h"
+#include "time.h"
+
+#define INITIAL_PAIR_CAPACITY 256
+
+// Below this many pairs the narrow phase runs on the calling thread only
+#define PARALLEL_NARROW_PHASE_MIN_PAIRS 128
+
+// PAIR BUFFER
+//
+// Append a candidate pair, ordering the bodies by collider type.
+// Pairs whose layers don't collide are dropped here, before time of impact or the narrow phase
+bool physics_push_pair(struct PhysicsWorld *physics_world, struct PhysicsBody *body_A, struct PhysicsBody *body_B){
+  if (!physics_bodies_can_collide(body_A, body_B)) return true;
+
+  if (physics_world->num_pairs == physics_world->max_pairs){
+    unsigned int new_max_pairs = physics_world->max_pairs ? physics_world->max_pairs * 2 : INITIAL_PAIR_CAPACITY;
+    struct CollisionPair *new_pairs = (struct CollisionPair *)realloc(physics_world->pairs, new_max_pairs * sizeof(struct CollisionPair));
+    if (!new_pairs){
+      fprintf(stderr, "Error: failed to realloc pair buffer in physics_push_pair\n");
+      return false;
+    }
+    physics_world->pairs = new_pairs;
+    physics_world->max_pairs = new_max_pairs;
+  }
+
+  if (body_A->collider.type > body_B->collider.type){
+    struct PhysicsBody *temp = body_A;
+    body_A = body_B;
+    body_B = temp;
+  }
+
+  struct CollisionPair *pair = &physics_world->pairs[physics_world->num_pairs++];
+  pair->body_A = body_A;
+  pair->body_B = body_B;
+  memset(&pair->result, 0, sizeof(struct CollisionResult));
+  memset(&pair->toi, 0, sizeof(struct TOIResult));
+  pair->gjk_cache.valid = false;
+  return true;
+}
+
+bool physics_body_is_player(struct PhysicsWorld *physics_world, struct PhysicsBody *body){
+  return body >= physics_world->player_bodies && body < physics_world->player_bodies + physics_world->num_player_bodies;
+}
+
+// PAIR GENERATION
+//
+// Swept AABBs of every static and dynamic body go into SoA batches once per step,
+// then each player and awake dynamic body tests its own swept AABB against a whole batch
+// at a time, and only pairs whose bounds overlap are pushed
+static bool *physics_batch_results(struct PhysicsWorld *physics_world, unsigned int count){
+  if (count > physics_world->max_batch_results){
+    bool *results = (bool *)realloc(physics_world->batch_results, count * sizeof(bool));
+    if (!results){
+      fprintf(stderr, "Error: failed to realloc batch results in physics_batch_results\n");
+      return NULL;
+    }
+    physics_world->batch_results = results;
+    physics_world->max_batch_results = count;
+  }
+  return physics_world->batch_results;
+}
+
+static void physics_fill_AABB_batch(struct AABBBatch *batch, struct PhysicsBody *bodies, unsigned int num_bodies, float delta_time){
+  AABB_batch_clear(batch);
+  for (unsigned int i = 0; i < num_bodies; i++){
+    struct AABB swept_AABB;
+    physics_body_compute_swept_AABB(&bodies[i], delta_time, &swept_AABB);
+    AABB_batch_push(batch, &swept_AABB);
+  }
+}
+
+// Push body against every body in the array whose swept AABB overlaps its own.
+// body_index is body's own index when it's in the array, -1 otherwise.
+// Only players and awake bodies query, so pairs with sleeping bodies are found from the other side,
+// and awake pairs are found from both sides and only pushed from the earlier body
+static void physics_push_batch_pairs(struct PhysicsWorld *physics_world, struct PhysicsBody *body, struct AABBBatch *batch, struct PhysicsBody *bodies, int body_index, float delta_time){
+  if (batch->count == 0) return;
+  bool *results = physics_batch_results(physics_world, batch->count);
+  if (!results) return;
+
+  struct AABB swept_AABB;
+  physics_body_compute_swept_AABB(body, delta_time, &swept_AABB);
+  AABB_intersect_AABB_batch(&swept_AABB, batch, results);
+  for (unsigned int i = 0; i < batch->count; i++){
+    if (!results[i] || (int)i == body_index) continue;
+    if ((int)i < body_index && physics_body_is_awake(&bodies[i])) continue;
+    physics_push_pair(physics_world, body, &bodies[i]);
+  }
+}
+
+void physics_generate_pairs_brute_force(struct PhysicsWorld *physics_world, float delta_time){
+  struct AABBBatch *static_AABBs = &physics_world->static_AABBs;
+  struct AABBBatch *dynamic_AABBs = &physics_world->dynamic_AABBs;
+  physics_fill_AABB_batch(static_AABBs, physics_world->static_bodies, physics_world->num_static_bodies, delta_time);
+  physics_fill_AABB_batch(dynamic_AABBs, physics_world->dynamic_bodies, physics_world->num_dynamic_bodies, delta_time);
+
+  for (unsigned int i = 0; i < physics_world->num_player_bodies; i++){
+    struct PhysicsBody *player_body = &physics_world->player_bodies[i];
+    physics_push_batch_pairs(physics_world, player_body, static_AABBs, physics_world->static_bodies, -1, delta_time);
+    physics_push_batch_pairs(physics_world, player_body, dynamic_AABBs, physics_world->dynamic_bodies, -1, delta_time);
+  }
+
+  // Sleeping bodies are skipped entirely, a settled pile costs nothing until something wakes it
+  for (unsigned int i = 0; i < physics_world->num_dynamic_bodies; i++){
+    struct PhysicsBody *dynamic_body = &physics_world->dynamic_bodies[i];
+    if (!physics_body_is_awake(dynamic_body)) continue;
+    physics_push_batch_pairs(physics_world, dynamic_body, static_AABBs, physics_world->static_bodies, -1, delta_time);
+    physics_push_batch_pairs(physics_world, dynamic_body, dynamic_AABBs, physics_world->dynamic_bodies, (int)i, delta_time);
+  }
+}
+
+// Create proxies for new bodies and refit the ones that moved.
+// Static bodies don't integrate, but their scene node can still be moved, so they're
+// refit too. move_proxy returns early while the bounds stay inside the fat AABB,
+// so an unmoved static only costs the containment test.
+static void physics_update_tree_proxies(struct PhysicsWorld *physics_world, struct PhysicsBody *bodies, unsigned int num_bodies, bool movable, float delta_time){
+  for (unsigned int i = 0; i < num_bodies; i++){
+    struct PhysicsBody *body = &bodies[i];
+    struct AABB swept_AABB;
+    if (body->proxy_id == DYNAMIC_TREE_NULL_NODE){
+      physics_body_compute_swept_AABB(body, delta_time, &swept_AABB);
+      body->proxy_id = dynamic_tree_create_proxy(&physics_world->tree, &swept_AABB, (void *)(uintptr_t)body->handle);
+    }
+    else if (!movable){
+      physics_body_compute_swept_AABB(body, delta_time, &swept_AABB);
+      vec3 displacement = {0.0f, 0.0f, 0.0f};
+      dynamic_tree_move_proxy(&physics_world->tree, body->proxy_id, &swept_AABB, displacement);
+    }
+    else if (!body->sleeping){
+      physics_body_compute_swept_AABB(body, delta_time, &swept_AABB);
+      vec3 displacement;
+      glm_vec3_scale(body->velocity, delta_time, displacement);
+      dynamic_tree_move_proxy(&physics_world->tree, body->proxy_id, &swept_AABB, displacement);
+    }
+  }
+}
+
+struct TreeQuery {
+  struct PhysicsWorld *physics_world;
+  struct PhysicsBody *body;
+  bool body_is_player;
+};
+
+// Players are tested against every non-player.
+// Dynamic bodies leave player pairs to the player's query,
+// and only take dynamic pairs with a later body so each pair is pushed once.
+static bool physics_tree_query_callback(int proxy_id, void *user_data, void *context){
+  struct TreeQuery *query = (struct TreeQuery *)context;
+  struct PhysicsBody *candidate = physics_get_body(query->physics_world, (PhysicsBodyHandle)(uintptr_t)user_data);
+  (void)proxy_id;
+
+  if (!candidate) return true;
+  if (candidate == query->body) return true;
+  if (physics_body_is_player(query->physics_world, candidate)) return true;
+  // Awake dynamic pairs are found from both sides, keep one. Sleeping bodies don't query,
+  // so pairs with them are only found from the awake side
+  if (!query->body_is_player && physics_body_is_awake(candidate) && candidate < query->body) return true;
+
+  physics_push_pair(query->physics_world, query->body, candidate);
+  return true;
+}
+
+void physics_generate_pairs_dynamic_tree(struct PhysicsWorld *physics_world, float delta_time){
+  physics_update_tree_proxies(physics_world, physics_world->static_bodies, physics_world->num_static_bodies, false, delta_time);
+  physics_update_tree_proxies(physics_world, physics_world->dynamic_bodies, physics_world->num_dynamic_bodies, true, delta_time);
+  physics_update_tree_proxies(physics_world, physics_world->player_bodies, physics_world->num_player_bodies, true, delta_time);
+
+  struct TreeQuery query = {.physics_world = physics_world};
+  struct AABB swept_AABB;
+
+  for (unsigned int i = 0; i < physics_world->num_player_bodies; i++){
+    query.body = &physics_world->player_bodies[i];
+    query.body_is_player = true;
+    physics_body_compute_swept_AABB(query.body, delta_time, &swept_AABB);
+    dynamic_tree_query(&physics_world->tree, &swept_AABB, physics_tree_query_callback, &query);
+  }
+
+  for (unsigned int i = 0; i < physics_world->num_dynamic_bodies; i++){
+    query.body = &physics_world->dynamic_bodies[i];
+    if (query.body->sleeping) continue;
+    query.body_is_player = false;
+    physics_body_compute_swept_AABB(query.body, delta_time, &swept_AABB);
+    dynamic_tree_query(&physics_world->tree, &swept_AABB, physics_tree_query_callback, &query);
+  }
+}
+
+// Same as physics_update_tree_proxies. Static proxies are only moved once their
+// bounds leave the proxy's, so unmoved statics leave their endpoints alone.
+static void physics_update_sap_proxies(struct PhysicsWorld *physics_world, struct PhysicsBody *bodies, unsigned int num_bodies, bool movable, float delta_time){
+  for (unsigned int i = 0; i < num_bodies; i++){
+    struct PhysicsBody *body = &bodies[i];
+    struct AABB swept_AABB;
+    if (body->sap_proxy_id == SAP_NULL_PROXY){
+      physics_body_compute_swept_AABB(body, delta_time, &swept_AABB);
+      body->sap_proxy_id = sap_create_proxy(&physics_world->sap, &swept_AABB, (void *)(uintptr_t)body->handle);
+    }
+    else if (!movable){
+      physics_body_compute_swept_AABB(body, delta_time, &swept_AABB);
+      if (!AABB_contains(&physics_world->sap.proxies[body->sap_proxy_id].aabb, &swept_AABB)){
+        sap_move_proxy(&physics_world->sap, body->sap_proxy_id, &swept_AABB);
+      }
+    }
+    else if (!body->sleeping){
+      physics_body_compute_swept_AABB(body, delta_time, &swept_AABB);
+      sap_move_proxy(&physics_world->sap, body->sap_proxy_id, &swept_AABB);
+    }
+  }
+}
+
+void physics_generate_pairs_sweep_and_prune(struct PhysicsWorld *physics_world, float delta_time){
+  physics_update_sap_proxies(physics_world, physics_world->static_bodies, physics_world->num_static_bodies, false, delta_time);
+  physics_update_sap_proxies(physics_world, physics_world->dynamic_bodies, physics_world->num_dynamic_bodies, true, delta_time);
+  physics_update_sap_proxies(physics_world, physics_world->player_bodies, physics_world->num_player_bodies, true, delta_time);
+
+  // Re-sort endpoints, adding and removing pairs where endpoints cross
+  struct SweepAndPrune *sap = &physics_world->sap;
+  sap_update_pairs(sap);
+
+  // The persistent set holds every overlap, including ones nothing cares about
+  for (unsigned int i = 0; i < sap->num_pairs; i++){
+    struct PhysicsBody *body_A = physics_get_body(physics_world, (PhysicsBodyHandle)(uintptr_t)sap_get_user_data(sap, sap->pairs[i].proxy_A));
+    struct PhysicsBody *body_B = physics_get_body(physics_world, (PhysicsBodyHandle)(uintptr_t)sap_get_user_data(sap, sap->pairs[i].proxy_B));
+    if (!body_A || !body_B) continue;
+    bool player_A = physics_body_is_player(physics_world, body_A);
+    bool player_B = physics_body_is_player(physics_world, body_B);
+
+    if (player_A && player_B) continue;
+    if (!player_A && !player_B && !physics_body_is_awake(body_A) && !physics_body_is_awake(body_B)) continue;
+    physics_push_pair(physics_world, body_A, body_B);
+  }
+}
+
+// NARROW PHASE
+//
+bool physics_contact_buffer_push(struct PhysicsContactBuffer *buffer, unsigned int pair_index){
+  if (buffer->num_contacts == buffer->max_contacts){
+    unsigned int new_max_contacts = buffer->max_contacts ? buffer->max_contacts * 2 : INITIAL_PAIR_CAPACITY;
+    unsigned int *new_indices = (unsigned int *)realloc(buffer->pair_indices, new_max_contacts * sizeof(unsigned int));
+    if (!new_indices){
+      fprintf(stderr, "Error: failed to realloc contact buffer in physics_contact_buffer_push\n");
+      return false;
+    }
+    buffer->pair_indices = new_indices;
+    buffer->max_contacts = new_max_contacts;
+  }
+  buffer->pair_indices[buffer->num_contacts++] = pair_index;
+  return true;
+}
+
+struct NarrowPhaseJob {
+  struct PhysicsWorld *physics_world;
+  struct PhysicsContactBuffer *contact_buffers;
+  float delta_time;
+};
+
+// Narrow phase over one worker's range of the pair buffer.
+// Only reads bodies and writes its own pairs and contact buffer, so ranges can run in parallel
+static void physics_narrow_phase_range(void *context, int worker_index, unsigned int begin, unsigned int end){
+  struct NarrowPhaseJob *job = (struct NarrowPhaseJob *)context;
+  struct PhysicsContactBuffer *contacts = &job->contact_buffers[worker_index];
+
+  for (unsigned int i = begin; i < end; i++){
+    struct CollisionPair *pair = &job->physics_world->pairs[i];
+    struct PhysicsBody *body_A = pair->body_A;
+    struct PhysicsBody *body_B = pair->body_B;
+
+    // Time of impact rejects pairs that can't touch this step
+    pair->toi = time_of_impact(body_A, body_B, 0, job->delta_time);
+    contacts->toi_iterations += pair->toi.iterations;
+    if (pair->toi.iterations > contacts->max_toi_iterations){
+      contacts->max_toi_iterations = pair->toi.iterations;
+    }
+    if (!pair->toi.hit) continue;
+
+    // Mesh pairs pick up from where time of impact stopped instead of advancing again
+    NarrowPhaseFunction narrow_phase_function = narrow_phase_functions[body_A->collider.type][body_B->collider.type];
+    if (body_B->collider.type == COLLIDER_MESH){
+      pair->result = narrow_phase_convex_mesh(body_A, body_B, pair->toi.time, job->delta_time);
+    }
+    else if (narrow_phase_function){
+      pair->result = narrow_phase_function(body_A, body_B, job->delta_time);
+    }
+    else{
+      pair->result = narrow_phase_gjk(body_A, body_B, &pair->gjk_cache, pair->toi.time, job->delta_time);
+    }
+    if (pair->result.colliding && pair->result.hit_time >= 0){
+      physics_contact_buffer_push(contacts, i);
+    }
+  }
+}
+
+static bool physics_pair_uses_gjk(struct CollisionPair *pair){
+  return pair->body_B->collider.type != COLLIDER_MESH && !narrow_phase_functions[pair->body_A->collider.type][pair->body_B->collider.type];
+}
+
+// Give GJK pairs the simplex and axis they ended last step with.
+// Caches are stored with the lower handle as A, so flip them for pairs ordered the other way
+static void physics_load_gjk_caches(struct PhysicsWorld *physics_world){
+  for (unsigned int i = 0; i < physics_world->num_pairs; i++){
+    struct CollisionPair *pair = &physics_world->pairs[i];
+    if (!physics_pair_uses_gjk(pair)) continue;
+    uint64_t key = gjk_cache_key(pair->body_A->handle, pair->body_B->handle);
+    if (gjk_cache_table_find(&physics_world->gjk_cache, key, &pair->gjk_cache) && pair->body_A->handle > pair->body_B->handle){
+      gjk_cache_flip(&pair->gjk_cache);
+    }
+  }
+}
+
+// Write this step's caches into a fresh table, so pairs that stopped overlapping
+// in the broad phase drop out of the cache on their own
+static void physics_store_gjk_caches(struct PhysicsWorld *physics_world){
+  struct GJKCacheTable *next = &physics_world->next_gjk_cache;
+  gjk_cache_table_clear(next);
+  for (unsigned int i = 0; i < physics_world->num_pairs; i++){
+    struct CollisionPair *pair = &physics_world->pairs[i];
+    if (!pair->gjk_cache.valid) continue;
+    struct GJKCache cache = pair->gjk_cache;
+    if (pair->body_A->handle > pair->body_B->handle){
+      gjk_cache_flip(&cache);
+    }
+    gjk_cache_table_insert(next, gjk_cache_key(pair->body_A->handle, pair->body_B->handle), &cache);
+  }
+
+  struct GJKCacheTable temp = physics_world->gjk_cache;
+  physics_world->gjk_cache = *next;
+  *next = temp;
+}
+
+// Split the pair buffer across the worker pool, then merge each worker's contacts in worker order.
+// Workers get contiguous ranges in order, so the merged contacts are in pair buffer order
+// no matter which thread finished first.
+void physics_narrow_phase_pairs(struct PhysicsWorld *physics_world, float delta_time){
+  struct PhysicsStepStats *stats = &physics_world->step_stats;
+  struct PhysicsContactBuffer *merged = &physics_world->contacts;
+  merged->num_contacts = 0;
+  stats->toi_iterations = 0;
+  stats->max_toi_iterations = 0;
+  physics_load_gjk_caches(physics_world);
+
+  // Without per-worker buffers, run everything on this thread into the merged buffer
+  struct NarrowPhaseJob job = {physics_world, physics_world->worker_contacts, delta_time};
+  if (physics_world->num_worker_contacts == 0){
+    job.contact_buffers = merged;
+    merged->toi_iterations = 0;
+    merged->max_toi_iterations = 0;
+    physics_narrow_phase_range(&job, 0, 0, physics_world->num_pairs);
+    stats->toi_iterations = merged->toi_iterations;
+    stats->max_toi_iterations = merged->max_toi_iterations;
+    physics_store_gjk_caches(physics_world);
+    return;
+  }
+
+  for (int i = 0; i < physics_world->num_worker_contacts; i++){
+    physics_world->worker_contacts[i].num_contacts = 0;
+    physics_world->worker_contacts[i].toi_iterations = 0;
+    physics_world->worker_contacts[i].max_toi_iterations = 0;
+  }
+
+  // Small steps aren't worth waking the workers for
+  if (physics_world->num_pairs < PARALLEL_NARROW_PHASE_MIN_PAIRS){
+    physics_narrow_phase_range(&job, 0, 0, physics_world->num_pairs);
+  }
+  else{
+    physics_worker_pool_run(physics_world->worker_pool, physics_narrow_phase_range, &job, physics_world->num_pairs);
+  }
+
+  for (int i = 0; i < physics_world->num_worker_contacts; i++){
+    struct PhysicsContactBuffer *contacts = &physics_world->worker_contacts[i];
+    for (unsigned int j = 0; j < contacts->num_contacts; j++){
+      physics_contact_buffer_push(merged, contacts->pair_indices[j]);
+    }
+    stats->toi_iterations += contacts->toi_iterations;
+    if (contacts->max_toi_iterations > stats->max_toi_iterations){
+      stats->max_toi_iterations = contacts->max_toi_iterations;
+    }
+  }
+  physics_store_gjk_caches(physics_world);
+}
+
+// RESOLUTION
+//
+void physics_resolve_pairs(struct PhysicsWorld *physics_world, float delta_time){
+  physics_world->step_stats.num_collisions = 0;
+
+  // Contacts are in pair buffer order, whichever workers found them
+  struct PhysicsContactBuffer *contacts = &physics_world->contacts;
+  for (unsigned int i = 0; i < contacts->num_contacts; i++){
+    struct CollisionPair *pair = &physics_world->pairs[contacts->pair_indices[i]];
+
+    struct PhysicsBody *body_A = pair->body_A;
+    struct PhysicsBody *body_B = pair->body_B;
+    physics_world->step_stats.num_collisions++;
+
+    // Determine resolution strategy
+    CollisionBehavior behavior = get_collision_behavior(body_A->entity_type, body_B->entity_type);
+    switch(behavior){
+      case COLLISION_BEHAVIOR_PHYSICS:
+        ResolutionFunction resolution_function = resolution_functions[body_A->collider.type][body_B->collider.type];
+        if (!resolution_function){
+          resolution_function = resolve_collision_gjk;
+        }
+        resolution_function(body_A, body_B, pair->result, delta_time);
+        break;
+      case COLLISION_BEHAVIOR_TRIGGER:
+        break;
+    }
+
+    physics_contact_table_record(&physics_world->contact_table, body_A, body_B, physics_world->step_count);
+  }
+
+  // Events only for contacts that began, ended or are due a PERSIST
+  physics_contact_table_update(physics_world);
+}
+
+// INTEGRATION
+//
+// Apply gravity then velocity to every awake body in the array. Awake bodies are gathered into
+// the world's motion batch, integrated 4 at a time with SSE, then scattered back in the same order.
+// If the batch can't grow, the bodies that didn't fit are integrated in place
+static void physics_integrate_body_array(struct PhysicsWorld *physics_world, struct PhysicsBody *bodies, unsigned int num_bodies, float gravity, float delta_time){
+  struct MotionBatch *batch = &physics_world->motion_batch;
+  motion_batch_clear(batch);
+  float gravity_step = gravity * delta_time;
+  for (unsigned int i = 0; i < num_bodies; i++){
+    struct PhysicsBody *body = &bodies[i];
+    if (body->at_rest || body->sleeping) continue;
+    if (!motion_batch_push(batch, body->position, body->velocity)){
+      body->velocity[1] -= gravity_step;
+      glm_vec3_muladds(body->velocity, delta_time, body->position);
+    }
+  }
+
+  motion_batch_integrate(batch, gravity_step, delta_time);
+
+  unsigned int index = 0;
+  for (unsigned int i = 0; i < num_bodies && index < batch->count; i++){
+    struct PhysicsBody *body = &bodies[i];
+    if (body->at_rest || body->sleeping) continue;
+    motion_batch_get(batch, index++, body->position, body->velocity);
+  }
+}
+
+void physics_integrate_bodies(struct PhysicsWorld *physics_world, float delta_time){
+  float gravity = 9.8f;
+  physics_integrate_body_array(physics_world, physics_world->player_bodies, physics_world->num_player_bodies, gravity, delta_time);
+  physics_integrate_body_array(physics_world, physics_world->dynamic_bodies, physics_world->num_dynamic_bodies, gravity, delta_time);
+}
+
+// Integration for the solver, which has already applied gravity to velocities
+void physics_integrate_positions(struct PhysicsWorld *physics_world, float delta_time){
+  physics_integrate_body_array(physics_world, physics_world->player_bodies, physics_world->num_player_bodies, 0.0f, delta_time);
+  physics_integrate_body_array(physics_world, physics_world->dynamic_bodies, physics_world->num_dynamic_bodies, 0.0f, delta_time);
+}
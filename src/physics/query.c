@@ -0,0 +1,464 @@
+#include <float.h>
+#include <cglm/cglm.h>
+#include "physics/world.h"
+#include "physics/query.h"
+#include "physics/gjk.h"
+#include "physics/toi.h"
+
+// State for one cast. Closest hit queries are all hits queries that keep one hit
+struct PhysicsQueryCast {
+  struct PhysicsWorld *physics_world;
+  struct PhysicsQueryFilter filter;
+  // The shape where the cast starts, unused for rays
+  struct ConvexShape shape;
+  bool ray;
+  // Start of the ray, or the center of the shape's bounds, and their half size
+  vec3 origin;
+  vec3 extents;
+  vec3 translation;
+  // Hits so far, closest first
+  struct PhysicsQueryHit *hits;
+  unsigned int num_hits;
+  unsigned int max_hits;
+};
+
+struct PhysicsQueryOverlap {
+  struct PhysicsWorld *physics_world;
+  struct PhysicsQueryFilter filter;
+  struct ConvexShape shape;
+  struct AABB bounds;
+  PhysicsBodyHandle *handles;
+  unsigned int num_handles;
+  unsigned int max_handles;
+};
+
+static bool physics_query_accepts(struct PhysicsQueryFilter *filter, struct PhysicsBody *body){
+  if (!body || body->handle == filter->ignore) return false;
+  return (body->collision_layer & filter->layer_mask) != 0;
+}
+
+static void physics_query_set_filter(struct PhysicsQueryFilter *filter, struct PhysicsQueryFilter *dest){
+  if (filter){
+    *dest = *filter;
+    return;
+  }
+  dest->layer_mask = PHYSICS_QUERY_ALL_LAYERS;
+  dest->ignore = PHYSICS_NULL_HANDLE;
+}
+
+// Shapes are described to GJK the same way bodies are
+static void physics_query_shape_sphere(struct Sphere *sphere, struct ConvexShape *dest){
+  dest->type = COLLIDER_SPHERE;
+  dest->data.sphere = *sphere;
+  dest->radius = sphere->radius;
+}
+
+static void physics_query_shape_capsule(struct Capsule *capsule, struct ConvexShape *dest){
+  dest->type = COLLIDER_CAPSULE;
+  dest->data.capsule = *capsule;
+  dest->radius = capsule->radius;
+}
+
+static void physics_query_capsule_bounds(struct Capsule *capsule, struct AABB *dest){
+  for (int i = 0; i < 3; i++){
+    dest->center[i] = (capsule->segment_A[i] + capsule->segment_B[i]) * 0.5f;
+    dest->extents[i] = fabsf(capsule->segment_B[i] - capsule->segment_A[i]) * 0.5f + capsule->radius;
+  }
+  dest->initialized = true;
+}
+
+static void physics_query_translate_shape(struct ConvexShape *shape, vec3 translation, float fraction, struct ConvexShape *dest){
+  *dest = *shape;
+  switch(shape->type){
+    case COLLIDER_SPHERE:
+      glm_vec3_muladds(translation, fraction, dest->data.sphere.center);
+      break;
+    case COLLIDER_CAPSULE:
+      glm_vec3_muladds(translation, fraction, dest->data.capsule.segment_A);
+      glm_vec3_muladds(translation, fraction, dest->data.capsule.segment_B);
+      break;
+    default:
+      break;
+  }
+}
+
+// RAYS
+//
+// Closed form tests for the common targets. Each fills in the hit's fraction, point and normal
+static bool physics_query_ray_AABB(vec3 origin, vec3 translation, struct AABB *aabb, float max_fraction, struct PhysicsQueryHit *hit){
+  float t_min = -FLT_MAX;
+  float t_max = max_fraction;
+  int entry_axis = -1;
+  float entry_sign = 0.0f;
+  for (int i = 0; i < 3; i++){
+    float box_min = aabb->center[i] - aabb->extents[i];
+    float box_max = aabb->center[i] + aabb->extents[i];
+    if (translation[i] == 0.0f){
+      if (origin[i] < box_min || origin[i] > box_max) return false;
+      continue;
+    }
+    // Entering through the min face means the surface faces -axis
+    float t1 = (box_min - origin[i]) / translation[i];
+    float t2 = (box_max - origin[i]) / translation[i];
+    float sign = -1.0f;
+    if (t1 > t2){
+      float temp = t1;
+      t1 = t2;
+      t2 = temp;
+      sign = 1.0f;
+    }
+    if (t1 > t_min){
+      t_min = t1;
+      entry_axis = i;
+      entry_sign = sign;
+    }
+    if (t2 < t_max) t_max = t2;
+    if (t_min > t_max) return false;
+  }
+  // Entered before the ray started, so it starts inside
+  if (entry_axis < 0 || t_min < 0.0f) return false;
+
+  hit->fraction = t_min;
+  glm_vec3_zero(hit->normal);
+  hit->normal[entry_axis] = entry_sign;
+  glm_vec3_copy(origin, hit->point);
+  glm_vec3_muladds(translation, t_min, hit->point);
+  return true;
+}
+
+static bool physics_query_ray_sphere(vec3 origin, vec3 translation, struct Sphere *sphere, float max_fraction, struct PhysicsQueryHit *hit){
+  // |m + t d|^2 = r^2, with m from the center to the origin
+  vec3 m;
+  glm_vec3_sub(origin, sphere->center, m);
+  float b = glm_vec3_dot(m, translation);
+  float c = glm_vec3_dot(m, m) - sphere->radius * sphere->radius;
+  // Starts inside, or on or outside the surface and heading away
+  if (c < 0.0f || b >= 0.0f) return false;
+  float a = glm_vec3_dot(translation, translation);
+  float discriminant = b * b - a * c;
+  if (discriminant < 0.0f) return false;
+  float t = glm_max((-b - sqrtf(discriminant)) / a, 0.0f);
+  if (t > max_fraction) return false;
+
+  hit->fraction = t;
+  glm_vec3_copy(origin, hit->point);
+  glm_vec3_muladds(translation, t, hit->point);
+  glm_vec3_sub(hit->point, sphere->center, hit->normal);
+  glm_vec3_normalize(hit->normal);
+  return true;
+}
+
+// Planes are solid behind, so only their front face is hit
+static bool physics_query_ray_plane(vec3 origin, vec3 translation, struct Plane *plane, float max_fraction, struct PhysicsQueryHit *hit){
+  float s = glm_vec3_dot(plane->normal, origin) - plane->distance;
+  float approach = glm_vec3_dot(plane->normal, translation);
+  if (s < 0.0f || approach >= 0.0f) return false;
+  float t = -s / approach;
+  if (t > max_fraction) return false;
+
+  hit->fraction = t;
+  glm_vec3_copy(plane->normal, hit->normal);
+  glm_vec3_copy(origin, hit->point);
+  glm_vec3_muladds(translation, t, hit->point);
+  return true;
+}
+
+// SHAPE CASTS
+//
+// Conservative advancement against a convex body. GJK's normal is a separating axis, so the
+// cast can close the whole distance along it before anything of the body is in reach.
+// Rays are cast as a sphere with no radius
+static bool physics_query_cast_convex(struct PhysicsQueryCast *cast, struct ConvexShape *target, float max_fraction, struct PhysicsQueryHit *hit){
+  struct ConvexShape shape;
+  if (cast->ray){
+    shape.type = COLLIDER_SPHERE;
+    glm_vec3_copy(cast->origin, shape.data.sphere.center);
+    shape.data.sphere.radius = 0.0f;
+    shape.radius = 0.0f;
+  }
+  else{
+    shape = cast->shape;
+  }
+
+  struct GJKCache cache = {0};
+  struct ConvexShape moved;
+  float fraction = 0.0f;
+  for (unsigned int iteration = 0; ; iteration++){
+    physics_query_translate_shape(&shape, cast->translation, fraction, &moved);
+    struct GJKResult gjk = gjk_distance(&moved, target, &cache);
+    float approach = glm_vec3_dot(cast->translation, gjk.normal);
+    if (gjk.distance <= TOI_TOLERANCE){
+      // Already touching: only a hit moving further in, and never from inside for rays
+      if (fraction == 0.0f && (approach <= 0.0f || (cast->ray && gjk.distance < 0.0f))) return false;
+      hit->fraction = fraction;
+      glm_vec3_negate_to(gjk.normal, hit->normal);
+      glm_vec3_copy(gjk.point_B, hit->point);
+      return true;
+    }
+    if (approach <= 0.0f || iteration >= TOI_MAX_ITERATIONS) return false;
+    fraction += gjk.distance / approach;
+    if (fraction > max_fraction) return false;
+  }
+}
+
+static bool physics_query_cast_body(struct PhysicsQueryCast *cast, struct PhysicsBody *body, float max_fraction, struct PhysicsQueryHit *hit){
+  if (body->collider.type == COLLIDER_MESH){
+    struct MeshCollider mesh;
+    struct MeshCastHit mesh_hit;
+    physics_body_get_world_mesh(body, 0.0f, &mesh);
+    bool found = cast->ray
+      ? mesh_collider_ray_cast(&mesh, cast->origin, cast->translation, max_fraction, &mesh_hit)
+      : mesh_collider_shape_cast(&mesh, &cast->shape, cast->translation, max_fraction, TOI_TOLERANCE, &mesh_hit);
+    if (!found) return false;
+    hit->fraction = mesh_hit.fraction;
+    glm_vec3_copy(mesh_hit.normal, hit->normal);
+    glm_vec3_copy(mesh_hit.point, hit->point);
+    return true;
+  }
+
+  if (cast->ray){
+    switch(body->collider.type){
+      case COLLIDER_AABB: {
+        struct AABB aabb;
+        physics_body_get_world_AABB(body, 0.0f, &aabb);
+        return physics_query_ray_AABB(cast->origin, cast->translation, &aabb, max_fraction, hit);
+      }
+      case COLLIDER_SPHERE: {
+        struct Sphere sphere;
+        physics_body_get_world_sphere(body, 0.0f, &sphere);
+        return physics_query_ray_sphere(cast->origin, cast->translation, &sphere, max_fraction, hit);
+      }
+      case COLLIDER_PLANE: {
+        struct Plane plane;
+        physics_body_get_world_plane(body, 0.0f, &plane);
+        return physics_query_ray_plane(cast->origin, cast->translation, &plane, max_fraction, hit);
+      }
+      default:
+        break;
+    }
+  }
+
+  struct ConvexShape target;
+  convex_shape_from_body(body, 0.0f, &target);
+  return physics_query_cast_convex(cast, &target, max_fraction, hit);
+}
+
+// Keep the hit if it's among the closest max_hits. Returns the fraction the cast
+// can be clipped to: the furthest hit kept once the list is full
+static float physics_query_add_hit(struct PhysicsQueryCast *cast, struct PhysicsQueryHit *hit, float max_fraction){
+  unsigned int index = cast->num_hits;
+  if (index == cast->max_hits){
+    if (hit->fraction >= cast->hits[index - 1].fraction) return max_fraction;
+    index--;
+  }
+  else{
+    cast->num_hits++;
+  }
+  while (index > 0 && cast->hits[index - 1].fraction > hit->fraction){
+    cast->hits[index] = cast->hits[index - 1];
+    index--;
+  }
+  cast->hits[index] = *hit;
+  if (cast->num_hits < cast->max_hits) return max_fraction;
+  return cast->hits[cast->num_hits - 1].fraction;
+}
+
+static float physics_query_cast_candidate(struct PhysicsQueryCast *cast, struct PhysicsBody *body, float max_fraction){
+  if (!physics_query_accepts(&cast->filter, body)) return max_fraction;
+  struct PhysicsQueryHit hit;
+  if (!physics_query_cast_body(cast, body, max_fraction, &hit)) return max_fraction;
+  hit.handle = body->handle;
+  return physics_query_add_hit(cast, &hit, max_fraction);
+}
+
+static float physics_query_cast_callback(int proxy_id, void *user_data, float max_fraction, void *context){
+  (void)proxy_id;
+  struct PhysicsQueryCast *cast = (struct PhysicsQueryCast *)context;
+  struct PhysicsBody *body = physics_get_body(cast->physics_world, (PhysicsBodyHandle)(uintptr_t)user_data);
+  return physics_query_cast_candidate(cast, body, max_fraction);
+}
+
+// Without the tree, test every body's AABB against the swept bounds
+static float physics_query_cast_bodies(struct PhysicsQueryCast *cast, struct PhysicsBody *bodies, unsigned int num_bodies, float max_fraction){
+  for (unsigned int i = 0; i < num_bodies; i++){
+    struct AABB aabb;
+    float entry;
+    physics_body_compute_AABB(&bodies[i], 0.0f, &aabb);
+    if (!AABB_intersect_segment(&aabb, cast->extents, cast->origin, cast->translation, max_fraction, &entry)) continue;
+    max_fraction = physics_query_cast_candidate(cast, &bodies[i], max_fraction);
+  }
+  return max_fraction;
+}
+
+static unsigned int physics_query_cast(struct PhysicsQueryCast *cast, vec3 direction, float max_distance){
+  struct PhysicsWorld *physics_world = cast->physics_world;
+  cast->num_hits = 0;
+  if (cast->max_hits == 0 || max_distance <= 0.0f) return 0;
+  float length = glm_vec3_norm(direction);
+  if (length == 0.0f){
+    fprintf(stderr, "Error: zero length direction in physics_query_cast\n");
+    return 0;
+  }
+  glm_vec3_scale(direction, max_distance / length, cast->translation);
+
+  if (physics_world->broad_phase_type == BROAD_PHASE_DYNAMIC_TREE){
+    dynamic_tree_ray_cast(&physics_world->tree, cast->origin, cast->translation, cast->extents, 1.0f, physics_query_cast_callback, cast);
+  }
+  else{
+    float max_fraction = 1.0f;
+    max_fraction = physics_query_cast_bodies(cast, physics_world->static_bodies, physics_world->num_static_bodies, max_fraction);
+    max_fraction = physics_query_cast_bodies(cast, physics_world->dynamic_bodies, physics_world->num_dynamic_bodies, max_fraction);
+    physics_query_cast_bodies(cast, physics_world->player_bodies, physics_world->num_player_bodies, max_fraction);
+  }
+  return cast->num_hits;
+}
+
+static void physics_query_init_ray(struct PhysicsQueryCast *cast, struct PhysicsWorld *physics_world, vec3 origin, struct PhysicsQueryFilter *filter){
+  cast->physics_world = physics_world;
+  physics_query_set_filter(filter, &cast->filter);
+  cast->ray = true;
+  glm_vec3_copy(origin, cast->origin);
+  glm_vec3_zero(cast->extents);
+}
+
+static void physics_query_init_sphere(struct PhysicsQueryCast *cast, struct PhysicsWorld *physics_world, struct Sphere *sphere, struct PhysicsQueryFilter *filter){
+  cast->physics_world = physics_world;
+  physics_query_set_filter(filter, &cast->filter);
+  cast->ray = false;
+  physics_query_shape_sphere(sphere, &cast->shape);
+  glm_vec3_copy(sphere->center, cast->origin);
+  glm_vec3_fill(cast->extents, sphere->radius);
+}
+
+static void physics_query_init_capsule(struct PhysicsQueryCast *cast, struct PhysicsWorld *physics_world, struct Capsule *capsule, struct PhysicsQueryFilter *filter){
+  cast->physics_world = physics_world;
+  physics_query_set_filter(filter, &cast->filter);
+  cast->ray = false;
+  physics_query_shape_capsule(capsule, &cast->shape);
+  struct AABB bounds;
+  physics_query_capsule_bounds(capsule, &bounds);
+  glm_vec3_copy(bounds.center, cast->origin);
+  glm_vec3_copy(bounds.extents, cast->extents);
+}
+
+bool physics_raycast(struct PhysicsWorld *physics_world, vec3 origin, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hit){
+  struct PhysicsQueryCast cast = {.hits = hit, .max_hits = 1};
+  physics_query_init_ray(&cast, physics_world, origin, filter);
+  return physics_query_cast(&cast, direction, max_distance) > 0;
+}
+
+unsigned int physics_raycast_all(struct PhysicsWorld *physics_world, vec3 origin, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hits, unsigned int max_hits){
+  struct PhysicsQueryCast cast = {.hits = hits, .max_hits = max_hits};
+  physics_query_init_ray(&cast, physics_world, origin, filter);
+  return physics_query_cast(&cast, direction, max_distance);
+}
+
+bool physics_sphere_cast(struct PhysicsWorld *physics_world, struct Sphere *sphere, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hit){
+  struct PhysicsQueryCast cast = {.hits = hit, .max_hits = 1};
+  physics_query_init_sphere(&cast, physics_world, sphere, filter);
+  return physics_query_cast(&cast, direction, max_distance) > 0;
+}
+
+unsigned int physics_sphere_cast_all(struct PhysicsWorld *physics_world, struct Sphere *sphere, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hits, unsigned int max_hits){
+  struct PhysicsQueryCast cast = {.hits = hits, .max_hits = max_hits};
+  physics_query_init_sphere(&cast, physics_world, sphere, filter);
+  return physics_query_cast(&cast, direction, max_distance);
+}
+
+bool physics_capsule_cast(struct PhysicsWorld *physics_world, struct Capsule *capsule, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hit){
+  struct PhysicsQueryCast cast = {.hits = hit, .max_hits = 1};
+  physics_query_init_capsule(&cast, physics_world, capsule, filter);
+  return physics_query_cast(&cast, direction, max_distance) > 0;
+}
+
+unsigned int physics_capsule_cast_all(struct PhysicsWorld *physics_world, struct Capsule *capsule, vec3 direction, float max_distance, struct PhysicsQueryFilter *filter, struct PhysicsQueryHit *hits, unsigned int max_hits){
+  struct PhysicsQueryCast cast = {.hits = hits, .max_hits = max_hits};
+  physics_query_init_capsule(&cast, physics_world, capsule, filter);
+  return physics_query_cast(&cast, direction, max_distance);
+}
+
+// OVERLAP
+//
+static bool physics_query_overlaps_body(struct ConvexShape *shape, struct PhysicsBody *body){
+  if (body->collider.type == COLLIDER_MESH){
+    struct MeshCollider mesh;
+    struct MeshContact contact;
+    physics_body_get_world_mesh(body, 0.0f, &mesh);
+    return mesh_collider_contact(&mesh, shape, &contact) && contact.distance <= 0.0f;
+  }
+  struct ConvexShape target;
+  convex_shape_from_body(body, 0.0f, &target);
+  struct GJKCache cache = {0};
+  return gjk_distance(shape, &target, &cache).distance <= 0.0f;
+}
+
+// Returns false once the handle list is full
+static bool physics_query_overlap_candidate(struct PhysicsQueryOverlap *overlap, struct PhysicsBody *body){
+  if (!physics_query_accepts(&overlap->filter, body)) return true;
+  if (!physics_query_overlaps_body(&overlap->shape, body)) return true;
+  overlap->handles[overlap->num_handles++] = body->handle;
+  return overlap->num_handles < overlap->max_handles;
+}
+
+static bool physics_query_overlap_callback(int proxy_id, void *user_data, void *context){
+  (void)proxy_id;
+  struct PhysicsQueryOverlap *overlap = (struct PhysicsQueryOverlap *)context;
+  struct PhysicsBody *body = physics_get_body(overlap->physics_world, (PhysicsBodyHandle)(uintptr_t)user_data);
+  return physics_query_overlap_candidate(overlap, body);
+}
+
+static bool physics_query_overlap_bodies(struct PhysicsQueryOverlap *overlap, struct PhysicsBody *bodies, unsigned int num_bodies){
+  for (unsigned int i = 0; i < num_bodies; i++){
+    struct AABB aabb;
+    physics_body_compute_AABB(&bodies[i], 0.0f, &aabb);
+    if (!AABB_intersect_AABB(&aabb, &overlap->bounds)) continue;
+    if (!physics_query_overlap_candidate(overlap, &bodies[i])) return false;
+  }
+  return true;
+}
+
+static unsigned int physics_query_overlap(struct PhysicsQueryOverlap *overlap){
+  struct PhysicsWorld *physics_world = overlap->physics_world;
+  overlap->num_handles = 0;
+  if (overlap->max_handles == 0) return 0;
+
+  if (physics_world->broad_phase_type == BROAD_PHASE_DYNAMIC_TREE){
+    dynamic_tree_query(&physics_world->tree, &overlap->bounds, physics_query_overlap_callback, overlap);
+  }
+  else{
+    if (physics_query_overlap_bodies(overlap, physics_world->static_bodies, physics_world->num_static_bodies) &&
+        physics_query_overlap_bodies(overlap, physics_world->dynamic_bodies, physics_world->num_dynamic_bodies)){
+      physics_query_overlap_bodies(overlap, physics_world->player_bodies, physics_world->num_player_bodies);
+    }
+  }
+  return overlap->num_handles;
+}
+
+unsigned int physics_overlap_sphere(struct PhysicsWorld *physics_world, struct Sphere *sphere, struct PhysicsQueryFilter *filter, PhysicsBodyHandle *handles, unsigned int max_handles){
+  struct PhysicsQueryOverlap overlap = {.physics_world = physics_world, .handles = handles, .max_handles = max_handles};
+  physics_query_set_filter(filter, &overlap.filter);
+  physics_query_shape_sphere(sphere, &overlap.shape);
+  glm_vec3_copy(sphere->center, overlap.bounds.center);
+  glm_vec3_fill(overlap.bounds.extents, sphere->radius);
+  overlap.bounds.initialized = true;
+  return physics_query_overlap(&overlap);
+}
+
+unsigned int physics_overlap_capsule(struct PhysicsWorld *physics_world, struct Capsule *capsule, struct PhysicsQueryFilter *filter, PhysicsBodyHandle *handles, unsigned int max_handles){
+  struct PhysicsQueryOverlap overlap = {.physics_world = physics_world, .handles = handles, .max_handles = max_handles};
+  physics_query_set_filter(filter, &overlap.filter);
+  physics_query_shape_capsule(capsule, &overlap.shape);
+  physics_query_capsule_bounds(capsule, &overlap.bounds);
+  return physics_query_overlap(&overlap);
+}
+
+unsigned int physics_overlap_AABB(struct PhysicsWorld *physics_world, struct AABB *aabb, struct PhysicsQueryFilter *filter, PhysicsBodyHandle *handles, unsigned int max_handles){
+  struct PhysicsQueryOverlap overlap = {.physics_world = physics_world, .handles = handles, .max_handles = max_handles};
+  physics_query_set_filter(filter, &overlap.filter);
+  overlap.shape.type = COLLIDER_AABB;
+  overlap.shape.data.aabb = *aabb;
+  overlap.shape.radius = 0.0f;
+  overlap.bounds = *aabb;
+  overlap.bounds.initialized = true;
+  return physics_query_overlap(&overlap);
+}
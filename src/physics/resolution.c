@@ -11,18 +11,13 @@ ResolutionFunction resolution_functions[NUM_COLLIDER_TYPES][NUM_COLLIDER_TYPES]
   [COLLIDER_AABB][COLLIDER_CAPSULE] = resolve_collision_AABB_capsule,
   [COLLIDER_AABB][COLLIDER_PLANE] = resolve_collision_AABB_plane,
   [COLLIDER_SPHERE][COLLIDER_SPHERE] = resolve_collision_sphere_sphere,
-  [COLLIDER_SPHERE][COLLIDER_CAPSULE] = resolve_collision_sphere_capsule,
   [COLLIDER_SPHERE][COLLIDER_PLANE] = resolve_collision_sphere_plane,
-  [COLLIDER_CAPSULE][COLLIDER_CAPSULE] = resolve_collision_capsule_capsule,
   [COLLIDER_CAPSULE][COLLIDER_PLANE] = resolve_collision_capsule_plane
 };
 
 
 void resolve_collision_AABB_AABB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct CollisionResult result, float delta_time){
-  struct AABB *aabb_A = &body_A->collider.data.aabb;
-  struct AABB *aabb_B = &body_B->collider.data.aabb;
-  struct AABB world_AABB_A = {0};
-  struct AABB world_AABB_B = {0};
+  struct AABB world_AABB_A, world_AABB_B;
 
   // Move bodies according to velocity
   float gravity = 9.8f;
@@ -38,30 +33,9 @@ void resolve_collision_AABB_AABB(struct PhysicsBody *body_A, struct PhysicsBody
     glm_vec3_muladds(velocity_before_B, result.hit_time, body_B->position);
   }
 
-  if (body_A->scene_node){
-    vec3 world_position_A, world_rotation_A, world_scale_A;
-    glm_mat4_mulv3(body_A->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_A);
-    glm_decompose_scalev(body_A->scene_node->world_transform, world_scale_A);
-    mat3 rotation_mat3_A;
-    glm_mat4_pick3(body_A->scene_node->world_transform, rotation_mat3_A);
-    if (world_scale_A[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3_A, 1.0f / world_scale_A[0]);
-    }
-    glm_vec3_muladds(velocity_before_A, result.hit_time, world_position_A);
-    AABB_update(aabb_A, rotation_mat3_A, world_position_A, world_scale_A, &world_AABB_A);
-  }
-  if (body_B->scene_node){
-    vec3 world_position_B, world_rotation_B, world_scale_B;
-    glm_mat4_mulv3(body_B->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_B);
-    glm_decompose_scalev(body_B->scene_node->world_transform, world_scale_B);
-    mat3 rotation_mat3_B;
-    glm_mat4_pick3(body_B->scene_node->world_transform, rotation_mat3_B);
-    if (world_scale_B[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3_B, 1.0f / world_scale_B[0]);
-    }
-    glm_vec3_muladds(velocity_before_B, result.hit_time, world_position_B);
-    AABB_update(aabb_B, rotation_mat3_B, world_position_B, world_scale_B, &world_AABB_B);
-  }
+  // Bodies have been moved to hit_time, so read their world colliders at time 0
+  physics_body_get_world_AABB(body_A, 0.0f, &world_AABB_A);
+  physics_body_get_world_AABB(body_B, 0.0f, &world_AABB_B);
 
   // Find the axis with minimum penetration:
   // - get vector from center A to center B
@@ -150,10 +124,8 @@ void resolve_collision_AABB_AABB(struct PhysicsBody *body_A, struct PhysicsBody
 }
 
 void resolve_collision_AABB_sphere(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct CollisionResult result, float delta_time){
-  struct AABB *box = &body_A->collider.data.aabb;
-  struct Sphere *sphere = &body_B->collider.data.sphere;
-  struct AABB world_AABB = {0};
-  struct Sphere world_sphere = {0};
+  struct AABB world_AABB;
+  struct Sphere world_sphere;
 
   // Move bodies according to velocity
   float gravity = 9.8f;
@@ -169,28 +141,9 @@ void resolve_collision_AABB_sphere(struct PhysicsBody *body_A, struct PhysicsBod
     glm_vec3_muladds(velocity_before_B, result.hit_time, body_B->position);
   }
 
-  // Get world space bodies
-  if (body_A->scene_node){
-    vec3 world_position_A, world_rotation_A, world_scale_A;
-    glm_mat4_mulv3(body_A->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_A);
-    glm_decompose_scalev(body_A->scene_node->world_transform, world_scale_A);
-    mat3 rotation_mat3_A;
-    glm_mat4_pick3(body_A->scene_node->world_transform, rotation_mat3_A);
-    if (world_scale_A[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3_A, 1.0f / world_scale_A[0]);
-    }
-    glm_vec3_muladds(velocity_before_A, result.hit_time, world_position_A);
-    AABB_update(box, rotation_mat3_A, world_position_A, world_scale_A, &world_AABB);
-  }
-  if (body_B->scene_node){
-    vec3 world_position_B, world_rotation_B, world_scale_B;
-    glm_mat4_mulv3(body_B->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position_B);
-    glm_decompose_scalev(body_B->scene_node->world_transform, world_scale_B);
-
-    glm_vec3_muladds(velocity_before_B, result.hit_time, world_position_B);
-    glm_vec3_add(sphere->center, world_position_B, world_sphere.center);
-    world_sphere.radius = sphere->radius * world_scale_B[0];
-  }
+  // Get world space bodies at hit_time
+  physics_body_get_world_AABB(body_A, 0.0f, &world_AABB);
+  physics_body_get_world_sphere(body_B, 0.0f, &world_sphere);
 
   // Get closest point on AABB to sphere center
   vec3 closest;
@@ -303,12 +256,8 @@ void resolve_collision_AABB_sphere(struct PhysicsBody *body_A, struct PhysicsBod
 
 void resolve_collision_AABB_capsule(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct CollisionResult result, float delta_time){
   // printf("AABB CAPSULE COLLISION\n");
-  struct AABB *box = &body_A->collider.data.aabb;
-  struct Capsule *capsule = &body_B->collider.data.capsule;
-
-  struct AABB world_AABB = {0};
-  struct AABB world_AABB_final = {0};
-  struct Capsule world_capsule = {0};
+  struct AABB world_AABB;
+  struct Capsule world_capsule;
 
   // Move bodies according to velocity
   float gravity = 9.8f;
@@ -317,50 +266,14 @@ void resolve_collision_AABB_capsule(struct PhysicsBody *body_A, struct PhysicsBo
   velocity_before[1] -= gravity * result.hit_time;
   glm_vec3_muladds(velocity_before, result.hit_time, body_B->position);
 
-  // Apply world transform to bodies
-  if (body_A->scene_node){
-    vec3 world_position, world_rotation, world_scale;
-    glm_mat4_mulv3(body_A->scene_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position);
-    glm_decompose_scalev(body_A->scene_node->world_transform, world_scale);
-    mat3 rotation_mat3;
-    glm_mat4_pick3(body_A->scene_node->world_transform, rotation_mat3);
-    if (world_scale[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3, 1.0f / world_scale[0]);
-    }
-    AABB_update(box, rotation_mat3, world_position, world_scale, &world_AABB_final);
-  }
-  else{
-    world_AABB = *box;
-  }
-  if (body_B->scene_node){
-    // Transform capsule
-    glm_mat4_mulv3(body_B->scene_node->world_transform, capsule->segment_A, 1.0f, world_capsule.segment_A);
-    glm_mat4_mulv3(body_B->scene_node->world_transform, capsule->segment_B, 1.0f, world_capsule.segment_B);
-    glm_vec3_muladds(velocity_before, result.hit_time, world_capsule.segment_A);
-    glm_vec3_muladds(velocity_before, result.hit_time, world_capsule.segment_B);
-  }
-  // Player capsule
-  // else{
-  //   // Scale
-  //   glm_vec3_scale(capsule->segment_A, body_B->scale[0], world_capsule.segment_A);
-  //   glm_vec3_scale(capsule->segment_B, body_B->scale[0], world_capsule.segment_B);
-  //   // Rotate
-  //   mat4 eulerA;
-  //   mat3 rotationA;
-  //   vec3 rotatedA, rotatedB;
-  //   glm_euler_xyz(body_B->rotation, eulerA);
-  //   glm_mat4_pick3(eulerA, rotationA);
-  //   glm_mat3_mulv(rotationA, world_capsule.segment_A, world_capsule.segment_A);
-  //   glm_mat3_mulv(rotationA, world_capsule.segment_B, world_capsule.segment_B);
-  //   glm_vec3_add(world_capsule.segment_A, body_B->position, world_capsule.segment_A);
-  //   glm_vec3_add(world_capsule.segment_B, body_B->position, world_capsule.segment_B);
-  // }
-  world_capsule.radius = capsule->radius * body_B->scale[0];
+  // Get world space bodies at hit_time
+  physics_body_get_world_AABB(body_A, 0.0f, &world_AABB);
+  physics_body_get_world_capsule(body_B, 0.0f, &world_capsule);
 
   // Penetration correction
   vec3 segment, A_to_center;
   glm_vec3_sub(world_capsule.segment_B, world_capsule.segment_A, segment);
-  glm_vec3_sub(world_AABB_final.center, world_capsule.segment_A, A_to_center);
+  glm_vec3_sub(world_AABB.center, world_capsule.segment_A, A_to_center);
   float proj = glm_dot(segment, A_to_center);
   float t = proj / glm_dot(segment, segment);
   t = glm_clamp(t, 0.0f, 1.0f);
@@ -373,7 +286,7 @@ void resolve_collision_AABB_capsule(struct PhysicsBody *body_A, struct PhysicsBo
   // Closest point on the AABB is the segment's closest point clamped to AABB extents
   vec3 q, pq;
   for (int i = 0; i < 3; i++){
-    q[i] = glm_clamp(closest_point[i], world_AABB_final.center[i] - world_AABB_final.extents[i], world_AABB_final.center[i] + world_AABB_final.extents[i]);
+    q[i] = glm_clamp(closest_point[i], world_AABB.center[i] - world_AABB.extents[i], world_AABB.center[i] + world_AABB.extents[i]);
   }
 
   glm_vec3_sub(q, closest_point, pq);
@@ -408,15 +321,12 @@ void resolve_collision_AABB_capsule(struct PhysicsBody *body_A, struct PhysicsBo
     glm_vec3_zero(body_B->velocity);
     body_B->at_rest = true;
   }
-  if (body_B->entity != NULL){
-    // entity_play_sound_effect(body_B->entity);
-  }
+  // if (body_B->entity != NULL){
+  //   entity_play_sound_effect(body_B->entity);
+  // }
 }
 
 void resolve_collision_AABB_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct CollisionResult result, float delta_time){
-  struct AABB *box = &body_A->collider.data.aabb;
-  struct Plane *plane = &body_B->collider.data.plane;
-
   // First move by velocity according to hit_time, applying gravity until collision
   float gravity = 9.8f;
   vec3 velocity_before;
@@ -424,22 +334,17 @@ void resolve_collision_AABB_plane(struct PhysicsBody *body_A, struct PhysicsBody
   velocity_before[1] -= gravity * result.hit_time;
   glm_vec3_muladds(velocity_before, result.hit_time, body_A->position);
 
-  struct AABB worldAABB = {0};
-  mat4 eulerA;
-  mat3 rotationA;
-  vec3 translationA, scaleA;
-  glm_euler_xyz(body_A->rotation, eulerA);
-  glm_mat4_pick3(eulerA, rotationA);
-  glm_vec3_copy(body_A->position, translationA);
-  glm_vec3_copy(body_A->scale, scaleA);
-  AABB_update(box, rotationA, translationA, scaleA, &worldAABB);
+  struct AABB world_AABB;
+  struct Plane world_plane;
+  physics_body_get_world_AABB(body_A, 0.0f, &world_AABB);
+  physics_body_get_world_plane(body_B, 0.0f, &world_plane);
 
   vec3 normal;
-  glm_vec3_copy(plane->normal, normal);
-  float r = worldAABB.extents[0] * fabsf(normal[0]) +
-            worldAABB.extents[1] * fabsf(normal[1]) +
-            worldAABB.extents[2] * fabsf(normal[2]);
-  float s = glm_vec3_dot(normal, worldAABB.center) - plane->distance;
+  glm_vec3_copy(world_plane.normal, normal);
+  float r = world_AABB.extents[0] * fabsf(normal[0]) +
+            world_AABB.extents[1] * fabsf(normal[1]) +
+            world_AABB.extents[2] * fabsf(normal[2]);
+  float s = glm_vec3_dot(normal, world_AABB.center) - world_plane.distance;
   float penetration = (s < r) ? (r - s) + 0.001 : 0.0f; // Only correct if penetrating
   if (penetration > 0.0f) {
     vec3 correction;
@@ -450,24 +355,21 @@ void resolve_collision_AABB_plane(struct PhysicsBody *body_A, struct PhysicsBody
   // Reflect velocity vector over normal
   // float restitution = 1.0f;
   float rest_velocity_threshold = 0.1f;
-  float v_dot_n = glm_dot(velocity_before, plane->normal);
+  float v_dot_n = glm_dot(velocity_before, world_plane.normal);
   vec3 reflection;
-  glm_vec3_scale(plane->normal, -2.0f * v_dot_n * body_A->restitution, reflection);
+  glm_vec3_scale(world_plane.normal, -2.0f * v_dot_n * body_A->restitution, reflection);
   glm_vec3_add(velocity_before, reflection, body_A->velocity);
 
   // If velocity along the normal is very small,
   // and the normal is opposite gravity, stop
   v_dot_n = glm_dot(normal, body_A->velocity);
   if (v_dot_n < 0.5 && glm_dot(normal, (vec3){0.0f, -1.0f, 0.0f}) < 0){
-    float distance_to_plane = glm_dot(body_A->position, normal) - plane->distance;
+    float distance_to_plane = glm_dot(body_A->position, normal) - world_plane.distance;
     glm_vec3_zero(body_A->velocity);
     body_A->at_rest = true;
   }
 }
 void resolve_collision_sphere_sphere(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct CollisionResult result, float delta_time){
-  struct Sphere *sphere_A = &body_A->collider.data.sphere;
-  struct Sphere *sphere_B = &body_B->collider.data.sphere;
-
   // Move spheres according to velocity
   float gravity = 9.8f;
   vec3 velocity_before_A, velocity_before_B;
@@ -479,13 +381,9 @@ void resolve_collision_sphere_sphere(struct PhysicsBody *body_A, struct PhysicsB
   glm_vec3_muladds(velocity_before_B, result.hit_time, body_B->position);
 
   // Get world space spheres for penetration correction
-  struct Sphere world_sphere_A = {0};
-  glm_vec3_add(sphere_A->center, body_A->position, world_sphere_A.center);
-  world_sphere_A.radius = sphere_A->radius * body_A->scale[0];
-
-  struct Sphere world_sphere_B = {0};
-  glm_vec3_add(sphere_B->center, body_B->position, world_sphere_B.center);
-  world_sphere_B.radius = sphere_B->radius * body_B->scale[0];
+  struct Sphere world_sphere_A, world_sphere_B;
+  physics_body_get_world_sphere(body_A, 0.0f, &world_sphere_A);
+  physics_body_get_world_sphere(body_B, 0.0f, &world_sphere_B);
 
   // Get contact normal, penetration
   vec3 difference, contact_normal;
@@ -569,16 +467,9 @@ void resolve_collision_sphere_sphere(struct PhysicsBody *body_A, struct PhysicsB
   // }
 }
 
-void resolve_collision_sphere_capsule(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct CollisionResult result, float delta_time){
-
-}
-
 void resolve_collision_sphere_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct CollisionResult result, float delta_time){
   // Might be able to merge collision resolution into one function, with helpers
   // based on types?
-  struct Sphere *sphere = &body_A->collider.data.sphere;
-  struct Plane *plane = &body_B->collider.data.plane;
-
   // First move by velocity according to hit_time, applying gravity until collision
   float gravity = 9.8f;
   vec3 velocity_before;
@@ -587,48 +478,42 @@ void resolve_collision_sphere_plane(struct PhysicsBody *body_A, struct PhysicsBo
   glm_vec3_muladds(velocity_before, result.hit_time, body_A->position);
 
   // Correct penetration
-  struct Sphere world_sphere = {0};
-  glm_vec3_add(sphere->center, body_A->position, world_sphere.center);
-  world_sphere.radius = sphere->radius * body_A->scale[0];
+  struct Sphere world_sphere;
+  struct Plane world_plane;
+  physics_body_get_world_sphere(body_A, 0.0f, &world_sphere);
+  physics_body_get_world_plane(body_B, 0.0f, &world_plane);
 
-  float s = glm_dot(world_sphere.center, plane->normal) - plane->distance;
-  float n_dot_v = glm_dot(body_A->velocity, plane->normal);
+  float s = glm_dot(world_sphere.center, world_plane.normal) - world_plane.distance;
+  float n_dot_v = glm_dot(body_A->velocity, world_plane.normal);
   float penetration = (s < world_sphere.radius) ? (world_sphere.radius - s) + 0.001 : 0.0f;
   if (penetration > 0.0f) {
     vec3 correction;
-    glm_vec3_scale(plane->normal, penetration, correction);
+    glm_vec3_scale(world_plane.normal, penetration, correction);
     glm_vec3_add(body_A->position, correction, body_A->position);
   }
 
   // Reflect velocity over normal
   // float restitution = 1.0f;
   float rest_velocity_threshold = 0.1f;
-  float v_dot_n = glm_dot(velocity_before, plane->normal);
+  float v_dot_n = glm_dot(velocity_before, world_plane.normal);
   vec3 reflection;
-  glm_vec3_scale(plane->normal, -2.0f * v_dot_n * body_A->restitution, reflection);
+  glm_vec3_scale(world_plane.normal, -2.0f * v_dot_n * body_A->restitution, reflection);
   glm_vec3_add(velocity_before, reflection, body_A->velocity);
 
   // If velocity along the normal is very small,
   // and the normal is opposite gravity, stop (eventually, spheres should be able to roll)
-  v_dot_n = glm_dot(plane->normal, body_A->velocity);
-  if (v_dot_n < 0.5 && glm_dot(plane->normal, (vec3){0.0f, -1.0f, 0.0f}) < 0){
-    float distance_to_plane = glm_dot(body_A->position, plane->normal) - plane->distance;
+  v_dot_n = glm_dot(world_plane.normal, body_A->velocity);
+  if (v_dot_n < 0.5 && glm_dot(world_plane.normal, (vec3){0.0f, -1.0f, 0.0f}) < 0){
+    float distance_to_plane = glm_dot(body_A->position, world_plane.normal) - world_plane.distance;
     glm_vec3_zero(body_A->velocity);
     body_A->at_rest = true;
   }
-  if (body_A->entity != NULL){
-    // entity_play_sound_effect(body_A->entity);
-  }
-}
-
-void resolve_collision_capsule_capsule(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct CollisionResult result, float delta_time){
-
+  // if (body_A->entity != NULL){
+  //   entity_play_sound_effect(body_A->entity);
+  // }
 }
 
 void resolve_collision_capsule_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct CollisionResult result, float delta_time){
-  struct Capsule *capsule = &body_A->collider.data.capsule;
-  struct Plane *plane = &body_B->collider.data.plane;
-
   // First move by velocity according to hit_time, applying gravity until collision
   float gravity = 9.8f;
   vec3 velocity_before;
@@ -636,42 +521,11 @@ void resolve_collision_capsule_plane(struct PhysicsBody *body_A, struct PhysicsB
   velocity_before[1] -= gravity * result.hit_time;
   glm_vec3_muladds(velocity_before, result.hit_time, body_A->position);
 
-  // Get world space capsule
-  struct Capsule world_capsule = {0};
-  struct Plane world_plane = {0};
-  // Apply world transform to capsule segments
-  if (body_A->scene_node){
-    glm_mat4_mulv3(body_A->scene_node->world_transform, capsule->segment_A, 1.0f, world_capsule.segment_A);
-    glm_mat4_mulv3(body_A->scene_node->world_transform, capsule->segment_B, 1.0f, world_capsule.segment_B);
-  }
-  if (body_B->scene_node){
-    mat3 rotation_mat3;
-    vec3 world_position, world_rotation, world_scale;
-    glm_mat4_mulv3(body_B->scene_node->parent_node->world_transform, (vec3){0.0f, 0.0f, 0.0f}, 1.0f, world_position);
-    glm_decompose_scalev(body_B->scene_node->parent_node->world_transform, world_scale);
-    glm_mat4_pick3(body_B->scene_node->parent_node->world_transform, rotation_mat3);
-    if (world_scale[0] != 0.0f){
-      glm_mat3_scale(rotation_mat3, 1.0f / world_scale[0]);
-    }
-
-    // Transform plane
-    glm_mat3_mulv(rotation_mat3, plane->normal, world_plane.normal);
-    glm_vec3_normalize(world_plane.normal);
-    world_plane.distance = (plane->distance) + glm_vec3_dot(world_position, world_plane.normal);
-  }
-
-  glm_vec3_scale(capsule->segment_A, body_A->scale[0], world_capsule.segment_A);
-  glm_vec3_scale(capsule->segment_B, body_A->scale[0], world_capsule.segment_B);
-  mat4 eulerA;
-  mat3 rotationA;
-  glm_euler_xyz(body_A->rotation, eulerA);
-  glm_mat4_pick3(eulerA, rotationA);
-  glm_mat3_mulv(rotationA, world_capsule.segment_A, world_capsule.segment_A);
-  glm_mat3_mulv(rotationA, world_capsule.segment_B, world_capsule.segment_B);
-
-  glm_vec3_add(world_capsule.segment_A, body_A->position, world_capsule.segment_A);
-  glm_vec3_add(world_capsule.segment_B, body_A->position, world_capsule.segment_B);
-  world_capsule.radius = capsule->radius * body_A->scale[0];
+  // Get world space bodies at hit_time
+  struct Capsule world_capsule;
+  struct Plane world_plane;
+  physics_body_get_world_capsule(body_A, 0.0f, &world_capsule);
+  physics_body_get_world_plane(body_B, 0.0f, &world_plane);
 
   // Correct penetration
   float n_dot_A = glm_dot(world_plane.normal, world_capsule.segment_A);
@@ -711,7 +565,83 @@ void resolve_collision_capsule_plane(struct PhysicsBody *body_A, struct PhysicsB
     glm_vec3_zero(body_A->velocity);
     body_A->at_rest = true;
   }
-  if (body_A->entity != NULL){
-    // entity_play_sound_effect(body_A->entity);
+  // if (body_A->entity != NULL){
+  //   entity_play_sound_effect(body_A->entity);
+  // }
+}
+
+// Players move under resolution even though they aren't dynamic bodies
+static bool resolution_body_moves(struct PhysicsBody *body){
+  return body->dynamic || body->entity_type == ENTITY_PLAYER;
+}
+
+// Generic resolution for pairs that went through GJK, using the contact normal
+// and penetration from narrow_phase_gjk instead of re-deriving them per shape
+void resolve_collision_gjk(struct PhysicsBody *body_A, struct PhysicsBody *body_B, struct CollisionResult result, float delta_time){
+  bool moves_A = resolution_body_moves(body_A);
+  bool moves_B = resolution_body_moves(body_B);
+  if (!moves_A && !moves_B) return;
+
+  // First move by velocity according to hit_time, applying gravity until collision
+  float gravity = 9.8f;
+  vec3 velocity_before_A = {0.0f, 0.0f, 0.0f};
+  vec3 velocity_before_B = {0.0f, 0.0f, 0.0f};
+  if (moves_A){
+    glm_vec3_copy(body_A->velocity, velocity_before_A);
+    velocity_before_A[1] -= gravity * result.hit_time;
+    glm_vec3_muladds(velocity_before_A, result.hit_time, body_A->position);
+  }
+  if (moves_B){
+    glm_vec3_copy(body_B->velocity, velocity_before_B);
+    velocity_before_B[1] -= gravity * result.hit_time;
+    glm_vec3_muladds(velocity_before_B, result.hit_time, body_B->position);
+  }
+
+  // Penetration correction along the normal, split between the bodies that can move
+  if (result.penetration > 0.0f){
+    float penetration = result.penetration + 0.001f;
+    float share = (moves_A && moves_B) ? 0.5f : 1.0f;
+    if (moves_A) glm_vec3_mulsubs(result.normal, penetration * share, body_A->position);
+    if (moves_B) glm_vec3_muladds(result.normal, penetration * share, body_B->position);
+  }
+
+  // Bodies moving apart keep their velocities
+  vec3 rel_v;
+  glm_vec3_sub(velocity_before_B, velocity_before_A, rel_v);
+  if (glm_dot(rel_v, result.normal) >= 0.0f){
+    if (moves_A) glm_vec3_copy(velocity_before_A, body_A->velocity);
+    if (moves_B) glm_vec3_copy(velocity_before_B, body_B->velocity);
+    return;
+  }
+
+  if (moves_A && moves_B){
+    // Equal masses, swap the bodies' velocities along the normal like sphere-sphere
+    float v_dot_n_A = glm_dot(velocity_before_A, result.normal);
+    float v_dot_n_B = glm_dot(velocity_before_B, result.normal);
+    glm_vec3_copy(velocity_before_A, body_A->velocity);
+    glm_vec3_muladds(result.normal, v_dot_n_B - v_dot_n_A, body_A->velocity);
+    glm_vec3_copy(velocity_before_B, body_B->velocity);
+    glm_vec3_muladds(result.normal, v_dot_n_A - v_dot_n_B, body_B->velocity);
+    return;
+  }
+
+  // One body against a static one: reflect its normal velocity scaled by restitution,
+  // with the normal pointing from the static body towards the moving one
+  struct PhysicsBody *body = moves_A ? body_A : body_B;
+  float *velocity_before = moves_A ? velocity_before_A : velocity_before_B;
+  vec3 normal;
+  glm_vec3_copy(result.normal, normal);
+  if (moves_A) glm_vec3_negate(normal);
+
+  float v_dot_n = glm_dot(velocity_before, normal);
+  glm_vec3_copy(velocity_before, body->velocity);
+  glm_vec3_muladds(normal, -(1.0f + body->restitution) * v_dot_n, body->velocity);
+
+  // If velocity along the normal is very small,
+  // and the normal is opposite gravity, stop
+  v_dot_n = glm_dot(body->velocity, normal);
+  if (v_dot_n < 0.5 && glm_dot(normal, (vec3){0.0f, -1.0f, 0.0f}) < 0){
+    glm_vec3_zero(body->velocity);
+    body->at_rest = true;
   }
 }
@@ -0,0 +1,219 @@
+#include <stdlib.h>
+#include <cglm/cglm.h>
+#include "entity.h"
+#include "physics/world.h"
+#include "physics/pipeline.h"
+#include "physics/solver.h"
+#include "physics/gjk.h"
+
+#define INITIAL_SOLVER_CONTACT_CAPACITY 64
+
+void physics_solver_free(struct PhysicsSolver *solver){
+  free(solver->contacts);
+  solver->contacts = NULL;
+  solver->num_contacts = 0;
+  solver->max_contacts = 0;
+}
+
+static struct SolverContact *physics_solver_push(struct PhysicsSolver *solver){
+  if (solver->num_contacts == solver->max_contacts){
+    unsigned int new_max_contacts = solver->max_contacts ? solver->max_contacts * 2 : INITIAL_SOLVER_CONTACT_CAPACITY;
+    struct SolverContact *new_contacts = (struct SolverContact *)realloc(solver->contacts, new_max_contacts * sizeof(struct SolverContact));
+    if (!new_contacts){
+      fprintf(stderr, "Error: failed to realloc solver contacts in physics_solver_push\n");
+      return NULL;
+    }
+    solver->contacts = new_contacts;
+    solver->max_contacts = new_max_contacts;
+  }
+  return &solver->contacts[solver->num_contacts++];
+}
+
+// Bodies integration will move this step. Sleeping and resting bodies act as static
+// until the island stage wakes them, so they don't absorb impulses they can't act on
+static bool physics_solver_body_moves(struct PhysicsBody *body){
+  if (body->sleeping || body->at_rest) return false;
+  return body->dynamic || body->entity_type == ENTITY_PLAYER;
+}
+
+// Gravity is applied before solving so contacts hold bodies up against it.
+// It stays applied, so the integrate stage must not add it again
+static void physics_solver_apply_gravity(struct PhysicsBody *bodies, unsigned int num_bodies, float delta_v){
+  for (unsigned int i = 0; i < num_bodies; i++){
+    struct PhysicsBody *body = &bodies[i];
+    if (body->at_rest || body->sleeping) continue;
+    body->velocity[1] += delta_v;
+  }
+}
+
+// CONTACTS
+//
+// Normal and separation where the bodies are at the start of the step.
+// Meshes have no support function, so mesh pairs use what their narrow phase found
+static void physics_solver_contact_geometry(struct CollisionPair *pair, vec3 normal, float *separation){
+  if (pair->body_A->collider.type == COLLIDER_MESH || pair->body_B->collider.type == COLLIDER_MESH){
+    glm_vec3_copy(pair->result.normal, normal);
+    *separation = -pair->result.penetration;
+    return;
+  }
+
+  struct ConvexShape shape_A, shape_B;
+  convex_shape_from_body(pair->body_A, 0.0f, &shape_A);
+  convex_shape_from_body(pair->body_B, 0.0f, &shape_B);
+  struct GJKCache cache = pair->gjk_cache;
+  struct GJKResult gjk = gjk_distance(&shape_A, &shape_B, &cache);
+  glm_vec3_copy(gjk.normal, normal);
+  *separation = gjk.distance;
+}
+
+static void physics_solver_prepare_contact(struct PhysicsWorld *physics_world, struct CollisionPair *pair, float delta_time){
+  struct PhysicsBody *body_A = pair->body_A;
+  struct PhysicsBody *body_B = pair->body_B;
+  float inverse_mass_A = physics_solver_body_moves(body_A) ? 1.0f : 0.0f;
+  float inverse_mass_B = physics_solver_body_moves(body_B) ? 1.0f : 0.0f;
+  if (inverse_mass_A + inverse_mass_B == 0.0f) return;
+
+  vec3 normal;
+  float separation;
+  physics_solver_contact_geometry(pair, normal, &separation);
+  if (glm_vec3_norm2(normal) < 0.5f) return;
+
+  struct SolverContact *contact = physics_solver_push(&physics_world->solver);
+  if (!contact) return;
+  contact->body_A = body_A;
+  contact->body_B = body_B;
+  contact->inverse_mass_A = inverse_mass_A;
+  contact->inverse_mass_B = inverse_mass_B;
+  glm_vec3_copy(normal, contact->normal);
+  contact->separation = separation;
+  contact->normal_mass = 1.0f / (inverse_mass_A + inverse_mass_B);
+  contact->friction = SOLVER_FRICTION;
+  contact->key = gjk_cache_key(body_A->handle, body_B->handle);
+
+  // Pairs may close in until they overlap by SOLVER_SLOP within this step, and recover part of
+  // any penetration past that. Resting pairs settle at the slop, so the narrow phase
+  // keeps seeing them overlap instead of the contact dropping in and out
+  float excess_penetration = -separation - SOLVER_SLOP;
+  if (excess_penetration < 0.0f){
+    contact->velocity_bias = excess_penetration / delta_time;
+  }
+  else{
+    contact->velocity_bias = SOLVER_BAUMGARTE * excess_penetration / delta_time;
+  }
+
+  // Bounce off pairs approaching fast enough to touch this step
+  vec3 rel_v;
+  glm_vec3_sub(body_B->velocity, body_A->velocity, rel_v);
+  float normal_v = glm_vec3_dot(rel_v, normal);
+  if (normal_v < -SOLVER_RESTITUTION_THRESHOLD && separation + normal_v * delta_time <= 0.0f){
+    float restitution = glm_max(body_A->restitution, body_B->restitution);
+    contact->velocity_bias = glm_max(contact->velocity_bias, -restitution * normal_v);
+  }
+
+  // Warm start from the impulses this pair ended last step with, if it was touching then
+  contact->normal_impulse = 0.0f;
+  glm_vec3_zero(contact->tangent_impulse);
+  struct PhysicsContact *cached = physics_contact_table_find(&physics_world->contact_table, contact->key);
+  if (cached && cached->last_step + 1 == physics_world->step_count){
+    contact->normal_impulse = cached->normal_impulse;
+    // Keep the part of last step's friction that still lies in the contact plane
+    glm_vec3_copy(cached->tangent_impulse, contact->tangent_impulse);
+    if (body_A->handle > body_B->handle) glm_vec3_negate(contact->tangent_impulse);
+    glm_vec3_mulsubs(normal, glm_vec3_dot(contact->tangent_impulse, normal), contact->tangent_impulse);
+  }
+}
+
+// Apply the cached impulses. Runs once every contact is prepared,
+// so bounces are judged on the velocities bodies came into the step with
+static void physics_solver_warm_start(struct SolverContact *contact){
+  vec3 impulse;
+  glm_vec3_scale(contact->normal, contact->normal_impulse, impulse);
+  glm_vec3_add(impulse, contact->tangent_impulse, impulse);
+  glm_vec3_mulsubs(impulse, contact->inverse_mass_A, contact->body_A->velocity);
+  glm_vec3_muladds(impulse, contact->inverse_mass_B, contact->body_B->velocity);
+}
+
+// One Gauss-Seidel pass over a contact: friction first, then the normal impulse,
+// so the normal constraint gets the last word on penetration
+static void physics_solver_solve_contact(struct SolverContact *contact){
+  struct PhysicsBody *body_A = contact->body_A;
+  struct PhysicsBody *body_B = contact->body_B;
+  vec3 rel_v;
+
+  // Friction: cancel the tangential relative velocity, within the friction cone
+  glm_vec3_sub(body_B->velocity, body_A->velocity, rel_v);
+  vec3 tangent_v;
+  glm_vec3_copy(rel_v, tangent_v);
+  glm_vec3_mulsubs(contact->normal, glm_vec3_dot(rel_v, contact->normal), tangent_v);
+
+  vec3 old_tangent_impulse, delta;
+  glm_vec3_copy(contact->tangent_impulse, old_tangent_impulse);
+  glm_vec3_muladds(tangent_v, -contact->normal_mass, contact->tangent_impulse);
+  float max_friction = contact->friction * contact->normal_impulse;
+  float tangent_impulse = glm_vec3_norm(contact->tangent_impulse);
+  if (tangent_impulse > max_friction){
+    glm_vec3_scale(contact->tangent_impulse, max_friction / tangent_impulse, contact->tangent_impulse);
+  }
+  glm_vec3_sub(contact->tangent_impulse, old_tangent_impulse, delta);
+  glm_vec3_mulsubs(delta, contact->inverse_mass_A, body_A->velocity);
+  glm_vec3_muladds(delta, contact->inverse_mass_B, body_B->velocity);
+
+  // Normal: push until the relative normal velocity reaches the bias, never pull
+  glm_vec3_sub(body_B->velocity, body_A->velocity, rel_v);
+  float normal_v = glm_vec3_dot(rel_v, contact->normal);
+  float lambda = -contact->normal_mass * (normal_v - contact->velocity_bias);
+  float old_normal_impulse = contact->normal_impulse;
+  contact->normal_impulse = glm_max(old_normal_impulse + lambda, 0.0f);
+  lambda = contact->normal_impulse - old_normal_impulse;
+  glm_vec3_mulsubs(contact->normal, lambda * contact->inverse_mass_A, body_A->velocity);
+  glm_vec3_muladds(contact->normal, lambda * contact->inverse_mass_B, body_B->velocity);
+}
+
+// STAGE
+//
+void physics_solve_contacts(struct PhysicsWorld *physics_world, float delta_time){
+  struct PhysicsSolver *solver = &physics_world->solver;
+  struct PhysicsContactBuffer *contacts = &physics_world->contacts;
+  float gravity = 9.8f;
+  physics_world->step_stats.num_collisions = contacts->num_contacts;
+  solver->num_contacts = 0;
+
+  physics_solver_apply_gravity(physics_world->player_bodies, physics_world->num_player_bodies, -gravity * delta_time);
+  physics_solver_apply_gravity(physics_world->dynamic_bodies, physics_world->num_dynamic_bodies, -gravity * delta_time);
+
+  // Contacts are in pair buffer order, whichever workers found them
+  for (unsigned int i = 0; i < contacts->num_contacts; i++){
+    struct CollisionPair *pair = &physics_world->pairs[contacts->pair_indices[i]];
+    if (get_collision_behavior(pair->body_A->entity_type, pair->body_B->entity_type) != COLLISION_BEHAVIOR_PHYSICS) continue;
+    physics_solver_prepare_contact(physics_world, pair, delta_time);
+  }
+
+  for (unsigned int i = 0; i < solver->num_contacts; i++){
+    physics_solver_warm_start(&solver->contacts[i]);
+  }
+
+  for (unsigned int iteration = 0; iteration < solver->iterations; iteration++){
+    for (unsigned int i = 0; i < solver->num_contacts; i++){
+      physics_solver_solve_contact(&solver->contacts[i]);
+    }
+  }
+
+  // Record every colliding pair for events, with the impulses of the ones that were solved.
+  // Solver contacts were pushed in contact buffer order, so walk both together
+  unsigned int solved = 0;
+  for (unsigned int i = 0; i < contacts->num_contacts; i++){
+    struct CollisionPair *pair = &physics_world->pairs[contacts->pair_indices[i]];
+    struct PhysicsContact *recorded = physics_contact_table_record(&physics_world->contact_table, pair->body_A, pair->body_B, physics_world->step_count);
+    if (solved == solver->num_contacts) continue;
+    struct SolverContact *contact = &solver->contacts[solved];
+    if (contact->body_A != pair->body_A || contact->body_B != pair->body_B) continue;
+    solved++;
+    if (!recorded) continue;
+    recorded->normal_impulse = contact->normal_impulse;
+    glm_vec3_copy(contact->tangent_impulse, recorded->tangent_impulse);
+    if (pair->body_A->handle > pair->body_B->handle) glm_vec3_negate(recorded->tangent_impulse);
+  }
+
+  // Events only for contacts that began, ended or are due a PERSIST
+  physics_contact_table_update(physics_world);
+}
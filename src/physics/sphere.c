@@ -1,3 +1,4 @@
+#include <math.h>
 #include <cglm/vec3.h>
 #include <stdbool.h>
 #include "sphere.h"
@@ -10,3 +11,22 @@ bool sphere_intersect_sphere(struct Sphere *sphere_A, struct Sphere *sphere_B){
   float radius_sum = sphere_A->radius + sphere_B->radius;
   return dist2 <= radius_sum * radius_sum;
 }
+
+// Distance between spheres: distance between centers - sum of radii.
+// Single precision throughout, so the batch kernels can match it exactly
+float sphere_distance_sphere(struct Sphere *sphere_A, struct Sphere *sphere_B){
+  vec3 difference;
+  glm_vec3_sub(sphere_A->center, sphere_B->center, difference);
+  float distance_squared = glm_dot(difference, difference);
+  float radius_sum = sphere_A->radius + sphere_B->radius;
+
+  return distance_squared < (radius_sum * radius_sum) ? 0.0f : sqrtf(distance_squared) - radius_sum;
+}
+
+float sphere_distance_plane(struct Sphere *sphere, struct Plane *plane){
+  // Not finding a radius of projection, just want signed distance
+  float s = glm_dot(sphere->center, plane->normal) - plane->distance;
+  float distance = fabsf(s) - sphere->radius;
+
+  return glm_max(distance, 0.0f);
+}
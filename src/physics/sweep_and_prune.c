@@ -0,0 +1,344 @@
+#include "physics/sweep_and_prune.h"
+#include <stdint.h>
+#include <string.h>
+#include <cglm/vec3.h>
+
+#define SAP_INITIAL_PROXIES 64
+#define SAP_INITIAL_PAIRS 64
+
+// PAIR SET
+//
+static uint32_t sap_pair_hash(int proxy_A, int proxy_B){
+  uint64_t key = ((uint64_t)(uint32_t)proxy_A << 32) | (uint32_t)proxy_B;
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return (uint32_t)key;
+}
+
+// Returns the table slot holding the pair, or the empty slot where it would go
+static unsigned int sap_pair_find_slot(struct SweepAndPrune *sap, int proxy_A, int proxy_B){
+  unsigned int mask = sap->pair_table_capacity - 1;
+  unsigned int slot = sap_pair_hash(proxy_A, proxy_B) & mask;
+  while (sap->pair_table[slot] != -1){
+    struct SAPPair *pair = &sap->pairs[sap->pair_table[slot]];
+    if (pair->proxy_A == proxy_A && pair->proxy_B == proxy_B) break;
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+static bool sap_pair_table_grow(struct SweepAndPrune *sap){
+  unsigned int new_capacity = sap->pair_table_capacity ? sap->pair_table_capacity * 2 : SAP_INITIAL_PAIRS * 2;
+  int *new_table = (int *)malloc(new_capacity * sizeof(int));
+  if (!new_table){
+    fprintf(stderr, "Error: failed to allocate pair table in sap_pair_table_grow\n");
+    return false;
+  }
+  memset(new_table, -1, new_capacity * sizeof(int));
+  free(sap->pair_table);
+  sap->pair_table = new_table;
+  sap->pair_table_capacity = new_capacity;
+
+  // Rehash the dense pairs
+  for (unsigned int i = 0; i < sap->num_pairs; i++){
+    unsigned int slot = sap_pair_find_slot(sap, sap->pairs[i].proxy_A, sap->pairs[i].proxy_B);
+    sap->pair_table[slot] = i;
+  }
+  return true;
+}
+
+static void sap_add_pair(struct SweepAndPrune *sap, int proxy_A, int proxy_B){
+  if (proxy_A > proxy_B){
+    int temp = proxy_A;
+    proxy_A = proxy_B;
+    proxy_B = temp;
+  }
+
+  // Keep the load factor at or below one half
+  if ((sap->num_pairs + 1) * 2 > sap->pair_table_capacity){
+    if (!sap_pair_table_grow(sap)) return;
+  }
+
+  unsigned int slot = sap_pair_find_slot(sap, proxy_A, proxy_B);
+  if (sap->pair_table[slot] != -1) return;
+
+  if (sap->num_pairs == sap->max_pairs){
+    unsigned int new_max_pairs = sap->max_pairs ? sap->max_pairs * 2 : SAP_INITIAL_PAIRS;
+    struct SAPPair *new_pairs = (struct SAPPair *)realloc(sap->pairs, new_max_pairs * sizeof(struct SAPPair));
+    if (!new_pairs){
+      fprintf(stderr, "Error: failed to realloc pairs in sap_add_pair\n");
+      return;
+    }
+    sap->pairs = new_pairs;
+    sap->max_pairs = new_max_pairs;
+  }
+
+  sap->pairs[sap->num_pairs] = (struct SAPPair){proxy_A, proxy_B};
+  sap->pair_table[slot] = sap->num_pairs;
+  sap->num_pairs++;
+}
+
+static void sap_remove_pair(struct SweepAndPrune *sap, int proxy_A, int proxy_B){
+  if (proxy_A > proxy_B){
+    int temp = proxy_A;
+    proxy_A = proxy_B;
+    proxy_B = temp;
+  }
+  if (sap->num_pairs == 0) return;
+
+  unsigned int slot = sap_pair_find_slot(sap, proxy_A, proxy_B);
+  int pair_index = sap->pair_table[slot];
+  if (pair_index == -1) return;
+
+  // Backward shift deletion keeps probe chains intact without tombstones
+  unsigned int mask = sap->pair_table_capacity - 1;
+  unsigned int hole = slot;
+  unsigned int next = slot;
+  while (true){
+    next = (next + 1) & mask;
+    if (sap->pair_table[next] == -1) break;
+    struct SAPPair *pair = &sap->pairs[sap->pair_table[next]];
+    unsigned int home = sap_pair_hash(pair->proxy_A, pair->proxy_B) & mask;
+    // Move the entry into the hole unless its home slot lies cyclically in (hole, next]
+    bool in_range = (hole <= next) ? (home > hole && home <= next) : (home > hole || home <= next);
+    if (!in_range){
+      sap->pair_table[hole] = sap->pair_table[next];
+      hole = next;
+    }
+  }
+  sap->pair_table[hole] = -1;
+
+  // Swap and pop the dense array, then point the moved pair's slot at its new index
+  unsigned int last = sap->num_pairs - 1;
+  if ((unsigned int)pair_index != last){
+    sap->pairs[pair_index] = sap->pairs[last];
+    unsigned int moved_slot = sap_pair_find_slot(sap, sap->pairs[pair_index].proxy_A, sap->pairs[pair_index].proxy_B);
+    sap->pair_table[moved_slot] = pair_index;
+  }
+  sap->num_pairs--;
+}
+
+// INIT
+//
+bool sap_init(struct SweepAndPrune *sap){
+  memset(sap, 0, sizeof(struct SweepAndPrune));
+  sap->free_list = SAP_NULL_PROXY;
+
+  sap->max_proxies = SAP_INITIAL_PROXIES;
+  sap->proxies = (struct SAPProxy *)calloc(sap->max_proxies, sizeof(struct SAPProxy));
+  if (!sap->proxies){
+    fprintf(stderr, "Error: failed to allocate proxies in sap_init\n");
+    return false;
+  }
+
+  sap->max_endpoints = SAP_INITIAL_PROXIES * 2;
+  for (int axis = 0; axis < 3; axis++){
+    sap->endpoints[axis] = (struct SAPEndpoint *)calloc(sap->max_endpoints, sizeof(struct SAPEndpoint));
+    if (!sap->endpoints[axis]){
+      fprintf(stderr, "Error: failed to allocate endpoints in sap_init\n");
+      sap_free(sap);
+      return false;
+    }
+  }
+
+  if (!sap_pair_table_grow(sap)){
+    sap_free(sap);
+    return false;
+  }
+  return true;
+}
+
+void sap_free(struct SweepAndPrune *sap){
+  free(sap->proxies);
+  for (int axis = 0; axis < 3; axis++){
+    free(sap->endpoints[axis]);
+  }
+  free(sap->pairs);
+  free(sap->pair_table);
+  memset(sap, 0, sizeof(struct SweepAndPrune));
+  sap->free_list = SAP_NULL_PROXY;
+}
+
+// SORTING
+//
+// Ties put min endpoints first, so touching AABBs count as overlapping
+// like they do in AABB_intersect_AABB
+static bool sap_endpoint_less(struct SAPEndpoint *a, struct SAPEndpoint *b){
+  if (a->value < b->value) return true;
+  if (a->value > b->value) return false;
+  return !a->is_max && b->is_max;
+}
+
+static void sap_set_endpoint_index(struct SweepAndPrune *sap, int axis, unsigned int index){
+  struct SAPEndpoint *endpoint = &sap->endpoints[axis][index];
+  struct SAPProxy *proxy = &sap->proxies[endpoint->proxy_id];
+  if (endpoint->is_max) proxy->max_index[axis] = index;
+  else proxy->min_index[axis] = index;
+}
+
+static void sap_sort_axis(struct SweepAndPrune *sap, int axis){
+  struct SAPEndpoint *endpoints = sap->endpoints[axis];
+  for (unsigned int i = 1; i < sap->num_endpoints; i++){
+    struct SAPEndpoint key = endpoints[i];
+    unsigned int j = i;
+    while (j > 0 && sap_endpoint_less(&key, &endpoints[j - 1])){
+      struct SAPEndpoint *other = &endpoints[j - 1];
+      if (other->proxy_id != key.proxy_id){
+        // A min moving left past a max: the proxies may have started overlapping
+        if (!key.is_max && other->is_max){
+          if (AABB_intersect_AABB(&sap->proxies[key.proxy_id].aabb, &sap->proxies[other->proxy_id].aabb)){
+            sap_add_pair(sap, key.proxy_id, other->proxy_id);
+          }
+        }
+        // A max moving left past a min: the proxies stopped overlapping
+        else if (key.is_max && !other->is_max){
+          sap_remove_pair(sap, key.proxy_id, other->proxy_id);
+        }
+      }
+      endpoints[j] = *other;
+      sap_set_endpoint_index(sap, axis, j);
+      j--;
+    }
+    endpoints[j] = key;
+    sap_set_endpoint_index(sap, axis, j);
+  }
+}
+
+// Re-sort all endpoints after proxies have been created or moved, updating the pair set.
+// Call once per step after every sap_create_proxy and sap_move_proxy.
+void sap_update_pairs(struct SweepAndPrune *sap){
+  for (int axis = 0; axis < 3; axis++){
+    sap_sort_axis(sap, axis);
+  }
+}
+
+// PROXIES
+//
+int sap_create_proxy(struct SweepAndPrune *sap, struct AABB *aabb, void *user_data){
+  // Grow the proxy pool
+  if (sap->free_list == SAP_NULL_PROXY && sap->num_proxies == sap->max_proxies){
+    int new_max_proxies = sap->max_proxies ? sap->max_proxies * 2 : SAP_INITIAL_PROXIES;
+    struct SAPProxy *new_proxies = (struct SAPProxy *)realloc(sap->proxies, new_max_proxies * sizeof(struct SAPProxy));
+    if (!new_proxies){
+      fprintf(stderr, "Error: failed to realloc proxies in sap_create_proxy\n");
+      return SAP_NULL_PROXY;
+    }
+    memset(new_proxies + sap->max_proxies, 0, (new_max_proxies - sap->max_proxies) * sizeof(struct SAPProxy));
+    sap->proxies = new_proxies;
+    sap->max_proxies = new_max_proxies;
+  }
+
+  // Grow the endpoint arrays
+  if (sap->num_endpoints + 2 > sap->max_endpoints){
+    unsigned int new_max_endpoints = sap->max_endpoints ? sap->max_endpoints * 2 : SAP_INITIAL_PROXIES * 2;
+    for (int axis = 0; axis < 3; axis++){
+      struct SAPEndpoint *new_endpoints = (struct SAPEndpoint *)realloc(sap->endpoints[axis], new_max_endpoints * sizeof(struct SAPEndpoint));
+      if (!new_endpoints){
+        fprintf(stderr, "Error: failed to realloc endpoints in sap_create_proxy\n");
+        return SAP_NULL_PROXY;
+      }
+      sap->endpoints[axis] = new_endpoints;
+    }
+    sap->max_endpoints = new_max_endpoints;
+  }
+
+  int proxy_id;
+  if (sap->free_list != SAP_NULL_PROXY){
+    proxy_id = sap->free_list;
+    sap->free_list = sap->proxies[proxy_id].next_free;
+  }
+  else{
+    proxy_id = sap->num_proxies++;
+  }
+
+  struct SAPProxy *proxy = &sap->proxies[proxy_id];
+  proxy->aabb = *aabb;
+  proxy->user_data = user_data;
+  proxy->next_free = SAP_NULL_PROXY;
+  proxy->active = true;
+
+  // Append both endpoints. The next sap_update_pairs moves them into place with everything else,
+  // which also adds any pairs the new proxy overlaps, so creating n proxies costs one sort instead of n
+  for (int axis = 0; axis < 3; axis++){
+    unsigned int min_index = sap->num_endpoints;
+    unsigned int max_index = sap->num_endpoints + 1;
+    sap->endpoints[axis][min_index] = (struct SAPEndpoint){aabb->center[axis] - aabb->extents[axis], proxy_id, false};
+    sap->endpoints[axis][max_index] = (struct SAPEndpoint){aabb->center[axis] + aabb->extents[axis], proxy_id, true};
+    proxy->min_index[axis] = min_index;
+    proxy->max_index[axis] = max_index;
+  }
+  sap->num_endpoints += 2;
+
+  return proxy_id;
+}
+
+// Remove the endpoint at index from an axis array currently holding num_endpoints endpoints
+static void sap_remove_endpoint(struct SweepAndPrune *sap, int axis, unsigned int index, unsigned int num_endpoints){
+  struct SAPEndpoint *endpoints = sap->endpoints[axis];
+  unsigned int count = num_endpoints - index - 1;
+  memmove(&endpoints[index], &endpoints[index + 1], count * sizeof(struct SAPEndpoint));
+  for (unsigned int i = index; i < index + count; i++){
+    sap_set_endpoint_index(sap, axis, i);
+  }
+}
+
+void sap_destroy_proxy(struct SweepAndPrune *sap, int proxy_id){
+  if (proxy_id < 0 || proxy_id >= sap->num_proxies || !sap->proxies[proxy_id].active){
+    fprintf(stderr, "Error: invalid proxy id %d in sap_destroy_proxy\n", proxy_id);
+    return;
+  }
+  struct SAPProxy *proxy = &sap->proxies[proxy_id];
+
+  // Remove the max first so the min's index stays valid
+  for (int axis = 0; axis < 3; axis++){
+    unsigned int min_index = proxy->min_index[axis];
+    sap_remove_endpoint(sap, axis, proxy->max_index[axis], sap->num_endpoints);
+    sap_remove_endpoint(sap, axis, min_index, sap->num_endpoints - 1);
+  }
+  sap->num_endpoints -= 2;
+
+  // Remove pairs containing the proxy
+  for (unsigned int i = 0; i < sap->num_pairs;){
+    struct SAPPair pair = sap->pairs[i];
+    if (pair.proxy_A == proxy_id || pair.proxy_B == proxy_id){
+      sap_remove_pair(sap, pair.proxy_A, pair.proxy_B);
+    }
+    else{
+      i++;
+    }
+  }
+
+  proxy->active = false;
+  proxy->user_data = NULL;
+  proxy->next_free = sap->free_list;
+  sap->free_list = proxy_id;
+}
+
+// Update a proxy's bounds. Endpoints are re-sorted by sap_update_pairs.
+void sap_move_proxy(struct SweepAndPrune *sap, int proxy_id, struct AABB *aabb){
+  struct SAPProxy *proxy = &sap->proxies[proxy_id];
+  proxy->aabb = *aabb;
+  for (int axis = 0; axis < 3; axis++){
+    sap->endpoints[axis][proxy->min_index[axis]].value = aabb->center[axis] - aabb->extents[axis];
+    sap->endpoints[axis][proxy->max_index[axis]].value = aabb->center[axis] + aabb->extents[axis];
+  }
+}
+
+// Whether the pair is in the persistent set, as of the last sap_update_pairs
+bool sap_has_pair(struct SweepAndPrune *sap, int proxy_A, int proxy_B){
+  if (proxy_A > proxy_B){
+    int temp = proxy_A;
+    proxy_A = proxy_B;
+    proxy_B = temp;
+  }
+  return sap->pair_table[sap_pair_find_slot(sap, proxy_A, proxy_B)] != -1;
+}
+
+void *sap_get_user_data(struct SweepAndPrune *sap, int proxy_id){
+  return sap->proxies[proxy_id].user_data;
+}
+
+void sap_set_user_data(struct SweepAndPrune *sap, int proxy_id, void *user_data){
+  sap->proxies[proxy_id].user_data = user_data;
+}
@@ -0,0 +1,181 @@
+#include <cglm/cglm.h>
+#include "physics/world.h"
+#include "physics/toi.h"
+#include "distance.h"
+
+#define TOI_EPSILON 0.000001f
+
+TOIFunction toi_functions[NUM_COLLIDER_TYPES][NUM_COLLIDER_TYPES] = {
+  [COLLIDER_SPHERE][COLLIDER_SPHERE] = toi_sphere_sphere,
+  [COLLIDER_AABB][COLLIDER_PLANE] = toi_AABB_plane,
+  [COLLIDER_SPHERE][COLLIDER_PLANE] = toi_sphere_plane,
+  [COLLIDER_PLANE][COLLIDER_OBB] = toi_plane_OBB
+};
+
+struct TOIResult time_of_impact(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time){
+  TOIFunction toi_function = toi_functions[body_A->collider.type][body_B->collider.type];
+  if (toi_function){
+    return toi_function(body_A, body_B, start_time, end_time);
+  }
+  return toi_conservative_advancement(body_A, body_B, start_time, end_time);
+}
+
+struct TOIResult toi_conservative_advancement(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time){
+  struct TOIResult result = {0};
+  result.time = start_time;
+
+  // World colliders only translate during a step, so the distance between the bodies
+  // can shrink no faster than their relative speed
+  vec3 rel_v;
+  glm_vec3_sub(body_A->velocity, body_B->velocity, rel_v);
+  float closing_speed = glm_vec3_norm(rel_v);
+
+  float time = start_time;
+  while (result.iterations < TOI_MAX_ITERATIONS){
+    result.iterations++;
+    float distance = minimum_object_distance_at_time(body_A, body_B, time);
+    result.distance = distance;
+    result.time = time;
+
+    if (distance <= TOI_TOLERANCE){
+      result.hit = true;
+      return result;
+    }
+
+    // Not moving towards each other fast enough to matter
+    if (closing_speed < TOI_EPSILON){
+      return result;
+    }
+
+    // Advancing by distance / closing_speed can't pass the time of first contact
+    time += distance / closing_speed;
+    if (time > end_time){
+      return result;
+    }
+  }
+
+  // Out of iterations while still closing in: report contact at the last safe time
+  // and let the narrow phase decide
+  result.hit = true;
+  return result;
+}
+
+struct TOIResult toi_sphere_sphere(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time){
+  struct TOIResult result = {0};
+  result.iterations = 1;
+  result.time = start_time;
+
+  struct Sphere sphere_A, sphere_B;
+  physics_body_get_world_sphere(body_A, start_time, &sphere_A);
+  physics_body_get_world_sphere(body_B, start_time, &sphere_B);
+
+  // Solve |s + vt| = r for the first t, where
+  // s - difference between centers
+  // v - relative velocity
+  // r - sum of radii
+  vec3 s, v;
+  glm_vec3_sub(sphere_A.center, sphere_B.center, s);
+  glm_vec3_sub(body_A->velocity, body_B->velocity, v);
+  float r = sphere_A.radius + sphere_B.radius;
+
+  float c = glm_dot(s, s) - r * r;
+  result.distance = glm_max(glm_vec3_norm(s) - r, 0.0f);
+  if (c <= 0.0f){
+    result.hit = true;
+    return result;
+  }
+
+  // Not moving relative to each other, or moving apart
+  float a = glm_dot(v, v);
+  float b = glm_dot(v, s);
+  if (a < TOI_EPSILON || b >= 0.0f){
+    return result;
+  }
+
+  // No real root => the spheres pass each other
+  float d = b * b - a * c;
+  if (d < 0.0f){
+    return result;
+  }
+
+  float t = (-b - sqrtf(d)) / a;
+  if (start_time + t > end_time){
+    return result;
+  }
+  result.time = start_time + t;
+  result.distance = 0.0f;
+  result.hit = true;
+  return result;
+}
+
+// Shared by the plane solvers: a shape whose projection onto the plane normal is
+// [s - r, s + r], moving at n_dot_v along the normal. Touches when |s(t)| = r
+static struct TOIResult toi_slab_plane(float s, float r, float n_dot_v, float start_time, float end_time){
+  struct TOIResult result = {0};
+  result.iterations = 1;
+  result.time = start_time;
+  result.distance = glm_max(fabsf(s) - r, 0.0f);
+
+  // Already intersecting
+  if (fabsf(s) <= r){
+    result.hit = true;
+    return result;
+  }
+  if (fabsf(n_dot_v) < TOI_EPSILON){
+    return result;
+  }
+
+  // In front of the plane: t = (r - s) / (n * v), behind it: t = (-r - s) / (n * v)
+  float t = (s > 0.0f) ? (r - s) / n_dot_v : (-r - s) / n_dot_v;
+  if (t < 0.0f || start_time + t > end_time){
+    return result;
+  }
+  result.time = start_time + t;
+  result.distance = 0.0f;
+  result.hit = true;
+  return result;
+}
+
+struct TOIResult toi_sphere_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time){
+  struct Sphere sphere;
+  struct Plane plane;
+  physics_body_get_world_sphere(body_A, start_time, &sphere);
+  physics_body_get_world_plane(body_B, start_time, &plane);
+
+  vec3 rel_v;
+  glm_vec3_sub(body_A->velocity, body_B->velocity, rel_v);
+  float s = glm_dot(sphere.center, plane.normal) - plane.distance;
+  return toi_slab_plane(s, sphere.radius, glm_dot(rel_v, plane.normal), start_time, end_time);
+}
+
+struct TOIResult toi_AABB_plane(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time){
+  struct AABB box;
+  struct Plane plane;
+  physics_body_get_world_AABB(body_A, start_time, &box);
+  physics_body_get_world_plane(body_B, start_time, &plane);
+
+  // Radius of the extents' projection onto the plane normal
+  float r =
+    box.extents[0] * fabsf(plane.normal[0]) +
+    box.extents[1] * fabsf(plane.normal[1]) +
+    box.extents[2] * fabsf(plane.normal[2]);
+
+  vec3 rel_v;
+  glm_vec3_sub(body_A->velocity, body_B->velocity, rel_v);
+  float s = glm_dot(plane.normal, box.center) - plane.distance;
+  return toi_slab_plane(s, r, glm_dot(rel_v, plane.normal), start_time, end_time);
+}
+
+// Planes sort before OBBs, so the plane is A and the box moves relative to it
+struct TOIResult toi_plane_OBB(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time){
+  struct Plane plane;
+  struct OBB box;
+  physics_body_get_world_plane(body_A, start_time, &plane);
+  physics_body_get_world_OBB(body_B, start_time, &box);
+
+  vec3 rel_v;
+  glm_vec3_sub(body_B->velocity, body_A->velocity, rel_v);
+  float r = OBB_projection_radius(&box, plane.normal);
+  float s = glm_dot(plane.normal, box.center) - plane.distance;
+  return toi_slab_plane(s, r, glm_dot(rel_v, plane.normal), start_time, end_time);
+}
@@ -0,0 +1,1070 @@
+#include <cglm/cglm.h>
+#include <float.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <assimp/cimport.h>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include "physics/triangle_mesh.h"
+#include "physics/gjk.h"
+#include "utils.h"
+
+#define MESH_EPSILON 0.000001f
+
+// Cross product axes are only preferred over the triangle's face normal when they're
+// shallower by more than this, so boxes resting on a flat mesh don't catch on the
+// edges between its triangles
+#define MESH_FACE_AXIS_RELATIVE_TOLERANCE 0.95f
+#define MESH_FACE_AXIS_ABSOLUTE_TOLERANCE 0.01f
+
+struct MeshBVHCacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint32_t num_vertices;
+  uint32_t num_triangles;
+  uint32_t num_nodes;
+  uint32_t padding;
+};
+
+// LOADING
+//
+// Flatten a node's meshes into model space, the same way model_process_node does
+static bool triangle_mesh_process_node(struct TriangleMesh *mesh, struct aiNode *node, const struct aiScene *scene, struct aiMatrix4x4 parent_transform, unsigned int *num_vertices, unsigned int *num_triangles){
+  struct aiMatrix4x4 current_transform = parent_transform;
+  aiMultiplyMatrix4(&current_transform, &node->mTransformation);
+  mat4 transform;
+  aiMatrix4x4_to_mat4(&current_transform, transform);
+
+  for (unsigned int i = 0; i < node->mNumMeshes; i++){
+    struct aiMesh *ai_mesh = scene->mMeshes[node->mMeshes[i]];
+    unsigned int first_vertex = *num_vertices;
+
+    for (unsigned int j = 0; j < ai_mesh->mNumVertices; j++){
+      vec3 position = {ai_mesh->mVertices[j].x, ai_mesh->mVertices[j].y, ai_mesh->mVertices[j].z};
+      glm_mat4_mulv3(transform, position, 1.0f, mesh->vertices[(*num_vertices)++]);
+    }
+
+    // Points and lines have nothing to collide with
+    for (unsigned int j = 0; j < ai_mesh->mNumFaces; j++){
+      struct aiFace face = ai_mesh->mFaces[j];
+      if (face.mNumIndices != 3) continue;
+      uint32_t *triangle = &mesh->indices[(*num_triangles)++ * 3];
+      triangle[0] = first_vertex + face.mIndices[0];
+      triangle[1] = first_vertex + face.mIndices[1];
+      triangle[2] = first_vertex + face.mIndices[2];
+    }
+  }
+
+  for (unsigned int i = 0; i < node->mNumChildren; i++){
+    if (!triangle_mesh_process_node(mesh, node->mChildren[i], scene, current_transform, num_vertices, num_triangles)){
+      return false;
+    }
+  }
+  return true;
+}
+
+// Meshes can be instanced by several nodes, so count what the node hierarchy references
+static void triangle_mesh_count_node(struct aiNode *node, const struct aiScene *scene, unsigned int *num_vertices, unsigned int *num_faces){
+  for (unsigned int i = 0; i < node->mNumMeshes; i++){
+    struct aiMesh *ai_mesh = scene->mMeshes[node->mMeshes[i]];
+    *num_vertices += ai_mesh->mNumVertices;
+    *num_faces += ai_mesh->mNumFaces;
+  }
+  for (unsigned int i = 0; i < node->mNumChildren; i++){
+    triangle_mesh_count_node(node->mChildren[i], scene, num_vertices, num_faces);
+  }
+}
+
+static bool triangle_mesh_import(struct TriangleMesh *mesh, const char *path){
+  const struct aiScene *scene = aiImportFile(path, aiProcessPreset_TargetRealtime_Fast);
+  if (!scene || !scene->mRootNode || !scene->mMeshes || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE){
+    fprintf(stderr, "Error: failed to import %s in triangle_mesh_import: %s\n", path, aiGetErrorString());
+    if (scene) aiReleaseImport(scene);
+    return false;
+  }
+
+  unsigned int max_vertices = 0;
+  unsigned int max_faces = 0;
+  triangle_mesh_count_node(scene->mRootNode, scene, &max_vertices, &max_faces);
+  mesh->vertices = (vec3 *)malloc((max_vertices ? max_vertices : 1) * sizeof(vec3));
+  mesh->indices = (uint32_t *)malloc((max_faces ? max_faces : 1) * 3 * sizeof(uint32_t));
+  if (!mesh->vertices || !mesh->indices){
+    fprintf(stderr, "Error: failed to allocate triangles for %s in triangle_mesh_import\n", path);
+    aiReleaseImport(scene);
+    return false;
+  }
+
+  unsigned int num_vertices = 0;
+  unsigned int num_triangles = 0;
+  struct aiMatrix4x4 root_transform;
+  aiIdentityMatrix4(&root_transform);
+  bool processed = triangle_mesh_process_node(mesh, scene->mRootNode, scene, root_transform, &num_vertices, &num_triangles);
+  aiReleaseImport(scene);
+
+  mesh->num_vertices = num_vertices;
+  mesh->num_triangles = num_triangles;
+  return processed;
+}
+
+// Load a model file's triangles and BVH, from its cache file if it's up to date
+struct TriangleMesh *triangle_mesh_load(const char *path){
+  struct stat source_stat;
+  if (stat(path, &source_stat) != 0){
+    fprintf(stderr, "Error: failed to stat %s in triangle_mesh_load\n", path);
+    return NULL;
+  }
+
+  struct TriangleMesh *mesh = (struct TriangleMesh *)calloc(1, sizeof(struct TriangleMesh));
+  if (!mesh){
+    fprintf(stderr, "Error: failed to allocate triangle mesh in triangle_mesh_load\n");
+    return NULL;
+  }
+  mesh->path = strdup(path);
+
+  size_t cache_path_length = strlen(path) + strlen(MESH_BVH_CACHE_EXTENSION) + 1;
+  char *cache_path = (char *)malloc(cache_path_length);
+  if (!mesh->path || !cache_path){
+    fprintf(stderr, "Error: failed to allocate paths in triangle_mesh_load\n");
+    free(cache_path);
+    triangle_mesh_free(mesh);
+    return NULL;
+  }
+  snprintf(cache_path, cache_path_length, "%s%s", path, MESH_BVH_CACHE_EXTENSION);
+
+  uint64_t source_size = (uint64_t)source_stat.st_size;
+  int64_t source_mtime = (int64_t)source_stat.st_mtime;
+  if (triangle_mesh_read_cache(mesh, cache_path, source_size, source_mtime)){
+    free(cache_path);
+    return mesh;
+  }
+
+  if (!triangle_mesh_import(mesh, path) || !triangle_mesh_build(mesh)){
+    fprintf(stderr, "Error: failed to build triangle mesh for %s in triangle_mesh_load\n", path);
+    free(cache_path);
+    triangle_mesh_free(mesh);
+    return NULL;
+  }
+
+  // A failed write only costs a rebuild next time
+  triangle_mesh_write_cache(mesh, cache_path, source_size, source_mtime);
+  free(cache_path);
+  return mesh;
+}
+
+void triangle_mesh_free(struct TriangleMesh *mesh){
+  if (!mesh) return;
+  free(mesh->path);
+  free(mesh->vertices);
+  free(mesh->indices);
+  free(mesh->nodes);
+  free(mesh);
+}
+
+// BVH BUILD
+//
+struct MeshBVHBuild {
+  struct TriangleMesh *mesh;
+  vec3 *centroids;
+  uint32_t *order;
+};
+
+static void mesh_bvh_node_bounds(struct MeshBVHBuild *build, struct MeshBVHNode *node, uint32_t first, uint32_t count){
+  glm_vec3_fill(node->min, FLT_MAX);
+  glm_vec3_fill(node->max, -FLT_MAX);
+  for (uint32_t i = first; i < first + count; i++){
+    uint32_t *triangle = &build->mesh->indices[build->order[i] * 3];
+    for (int j = 0; j < 3; j++){
+      glm_vec3_minv(node->min, build->mesh->vertices[triangle[j]], node->min);
+      glm_vec3_maxv(node->max, build->mesh->vertices[triangle[j]], node->max);
+    }
+  }
+}
+
+// Split at the middle of the centroids' bounds on their longest axis.
+// Leaves stop at MESH_BVH_MAX_LEAF_TRIANGLES, or when the tree gets as deep
+// as the query stack can handle
+static void mesh_bvh_subdivide(struct MeshBVHBuild *build, uint32_t node_index, uint32_t first, uint32_t count, unsigned int depth){
+  struct TriangleMesh *mesh = build->mesh;
+  struct MeshBVHNode *node = &mesh->nodes[node_index];
+  mesh_bvh_node_bounds(build, node, first, count);
+  node->first = first;
+  node->count = count;
+  if (count <= MESH_BVH_MAX_LEAF_TRIANGLES || depth >= MESH_BVH_STACK_SIZE - 2) return;
+
+  vec3 centroid_min, centroid_max, centroid_extent;
+  glm_vec3_fill(centroid_min, FLT_MAX);
+  glm_vec3_fill(centroid_max, -FLT_MAX);
+  for (uint32_t i = first; i < first + count; i++){
+    glm_vec3_minv(centroid_min, build->centroids[build->order[i]], centroid_min);
+    glm_vec3_maxv(centroid_max, build->centroids[build->order[i]], centroid_max);
+  }
+  glm_vec3_sub(centroid_max, centroid_min, centroid_extent);
+  int axis = 0;
+  if (centroid_extent[1] > centroid_extent[axis]) axis = 1;
+  if (centroid_extent[2] > centroid_extent[axis]) axis = 2;
+
+  // Partition the triangles around the split
+  float split = (centroid_min[axis] + centroid_max[axis]) * 0.5f;
+  uint32_t i = first;
+  uint32_t j = first + count;
+  while (i < j){
+    if (build->centroids[build->order[i]][axis] < split){
+      i++;
+    }
+    else{
+      j--;
+      uint32_t temp = build->order[i];
+      build->order[i] = build->order[j];
+      build->order[j] = temp;
+    }
+  }
+  uint32_t left_count = i - first;
+  // Every centroid in the same place: any split is as good as another
+  if (left_count == 0 || left_count == count){
+    left_count = count / 2;
+  }
+
+  uint32_t left = mesh->num_nodes;
+  mesh->num_nodes += 2;
+  node->first = left;
+  node->count = 0;
+  mesh_bvh_subdivide(build, left, first, left_count, depth + 1);
+  mesh_bvh_subdivide(build, left + 1, first + left_count, count - left_count, depth + 1);
+}
+
+// Build the BVH over the mesh's triangles and reorder them into leaf order
+bool triangle_mesh_build(struct TriangleMesh *mesh){
+  free(mesh->nodes);
+  mesh->nodes = NULL;
+  mesh->num_nodes = 0;
+  if (mesh->num_triangles == 0) return true;
+
+  struct MeshBVHBuild build = {0};
+  build.mesh = mesh;
+  build.centroids = (vec3 *)malloc(mesh->num_triangles * sizeof(vec3));
+  build.order = (uint32_t *)malloc(mesh->num_triangles * sizeof(uint32_t));
+  uint32_t *sorted_indices = (uint32_t *)malloc(mesh->num_triangles * 3 * sizeof(uint32_t));
+  // A binary tree with one triangle per leaf at worst
+  mesh->nodes = (struct MeshBVHNode *)malloc((2 * mesh->num_triangles - 1) * sizeof(struct MeshBVHNode));
+  if (!build.centroids || !build.order || !sorted_indices || !mesh->nodes){
+    fprintf(stderr, "Error: failed to allocate BVH build data in triangle_mesh_build\n");
+    free(build.centroids);
+    free(build.order);
+    free(sorted_indices);
+    free(mesh->nodes);
+    mesh->nodes = NULL;
+    return false;
+  }
+
+  for (uint32_t i = 0; i < mesh->num_triangles; i++){
+    uint32_t *triangle = &mesh->indices[i * 3];
+    glm_vec3_add(mesh->vertices[triangle[0]], mesh->vertices[triangle[1]], build.centroids[i]);
+    glm_vec3_add(build.centroids[i], mesh->vertices[triangle[2]], build.centroids[i]);
+    glm_vec3_scale(build.centroids[i], 1.0f / 3.0f, build.centroids[i]);
+    build.order[i] = i;
+  }
+
+  mesh->num_nodes = 1;
+  mesh_bvh_subdivide(&build, 0, 0, mesh->num_triangles, 0);
+
+  for (uint32_t i = 0; i < mesh->num_triangles; i++){
+    memcpy(&sorted_indices[i * 3], &mesh->indices[build.order[i] * 3], 3 * sizeof(uint32_t));
+  }
+  free(mesh->indices);
+  mesh->indices = sorted_indices;
+
+  struct MeshBVHNode *nodes = (struct MeshBVHNode *)realloc(mesh->nodes, mesh->num_nodes * sizeof(struct MeshBVHNode));
+  if (nodes) mesh->nodes = nodes;
+
+  free(build.centroids);
+  free(build.order);
+  return true;
+}
+
+void triangle_mesh_bounds(struct TriangleMesh *mesh, struct AABB *dest){
+  dest->initialized = true;
+  if (mesh->num_nodes == 0){
+    glm_vec3_zero(dest->center);
+    glm_vec3_zero(dest->extents);
+    return;
+  }
+  glm_vec3_add(mesh->nodes[0].min, mesh->nodes[0].max, dest->center);
+  glm_vec3_scale(dest->center, 0.5f, dest->center);
+  glm_vec3_sub(mesh->nodes[0].max, mesh->nodes[0].min, dest->extents);
+  glm_vec3_scale(dest->extents, 0.5f, dest->extents);
+}
+
+// CACHE FILE
+//
+// Header, then the vertices, indices and nodes as they're laid out in memory.
+// The source file's size and modification time say whether the cache is stale
+
+// Check a cache's indices and nodes before anything follows them, so a corrupt
+// cache gets rebuilt instead of read out of bounds
+static bool mesh_bvh_cache_valid(struct MeshBVHCacheHeader *header, uint32_t *indices, struct MeshBVHNode *nodes){
+  // The build makes no nodes for an empty mesh, and at most one leaf per triangle otherwise
+  if (header->num_triangles == 0) return header->num_nodes == 0;
+  if (header->num_nodes == 0 || header->num_nodes > 2 * header->num_triangles - 1) return false;
+
+  for (uint32_t i = 0; i < header->num_triangles * 3; i++){
+    if (indices[i] >= header->num_vertices) return false;
+  }
+  for (uint32_t i = 0; i < header->num_nodes; i++){
+    struct MeshBVHNode *node = &nodes[i];
+    if (node->count == 0){
+      // Children always come after their parent, which also rules out cycles
+      if (node->first <= i || node->first >= header->num_nodes - 1) return false;
+    }
+    else if (node->first > header->num_triangles || node->count > header->num_triangles - node->first){
+      return false;
+    }
+  }
+  return true;
+}
+
+bool triangle_mesh_read_cache(struct TriangleMesh *mesh, const char *cache_path, uint64_t source_size, int64_t source_mtime){
+  FILE *file = fopen(cache_path, "rb");
+  if (!file) return false;
+
+  struct MeshBVHCacheHeader header;
+  if (fread(&header, sizeof(header), 1, file) != 1
+    || header.magic != MESH_BVH_CACHE_MAGIC
+    || header.version != MESH_BVH_CACHE_VERSION
+    || header.source_size != source_size
+    || header.source_mtime != source_mtime){
+    fclose(file);
+    return false;
+  }
+  // Keep the allocation sizes below from overflowing
+  if (header.num_vertices > UINT32_MAX / sizeof(vec3)
+    || header.num_triangles > UINT32_MAX / (3 * sizeof(uint32_t))
+    || header.num_nodes > UINT32_MAX / sizeof(struct MeshBVHNode)){
+    fprintf(stderr, "Error: invalid BVH cache %s in triangle_mesh_read_cache\n", cache_path);
+    fclose(file);
+    return false;
+  }
+
+  vec3 *vertices = (vec3 *)malloc((header.num_vertices ? header.num_vertices : 1) * sizeof(vec3));
+  uint32_t *indices = (uint32_t *)malloc((header.num_triangles ? header.num_triangles : 1) * 3 * sizeof(uint32_t));
+  struct MeshBVHNode *nodes = (struct MeshBVHNode *)malloc((header.num_nodes ? header.num_nodes : 1) * sizeof(struct MeshBVHNode));
+  if (!vertices || !indices || !nodes
+    || fread(vertices, sizeof(vec3), header.num_vertices, file) != header.num_vertices
+    || fread(indices, 3 * sizeof(uint32_t), header.num_triangles, file) != header.num_triangles
+    || fread(nodes, sizeof(struct MeshBVHNode), header.num_nodes, file) != header.num_nodes){
+    fprintf(stderr, "Error: failed to read BVH cache %s in triangle_mesh_read_cache\n", cache_path);
+    free(vertices);
+    free(indices);
+    free(nodes);
+    fclose(file);
+    return false;
+  }
+  fclose(file);
+
+  // triangle_mesh_load falls back to importing and building the mesh
+  if (!mesh_bvh_cache_valid(&header, indices, nodes)){
+    fprintf(stderr, "Error: invalid BVH cache %s in triangle_mesh_read_cache\n", cache_path);
+    free(vertices);
+    free(indices);
+    free(nodes);
+    return false;
+  }
+
+  free(mesh->vertices);
+  free(mesh->indices);
+  free(mesh->nodes);
+  mesh->vertices = vertices;
+  mesh->indices = indices;
+  mesh->nodes = nodes;
+  mesh->num_vertices = header.num_vertices;
+  mesh->num_triangles = header.num_triangles;
+  mesh->num_nodes = header.num_nodes;
+  return true;
+}
+
+bool triangle_mesh_write_cache(struct TriangleMesh *mesh, const char *cache_path, uint64_t source_size, int64_t source_mtime){
+  FILE *file = fopen(cache_path, "wb");
+  if (!file){
+    fprintf(stderr, "Error: failed to open BVH cache %s in triangle_mesh_write_cache\n", cache_path);
+    return false;
+  }
+
+  struct MeshBVHCacheHeader header = {0};
+  header.magic = MESH_BVH_CACHE_MAGIC;
+  header.version = MESH_BVH_CACHE_VERSION;
+  header.source_size = source_size;
+  header.source_mtime = source_mtime;
+  header.num_vertices = mesh->num_vertices;
+  header.num_triangles = mesh->num_triangles;
+  header.num_nodes = mesh->num_nodes;
+
+  bool written = fwrite(&header, sizeof(header), 1, file) == 1
+    && fwrite(mesh->vertices, sizeof(vec3), mesh->num_vertices, file) == mesh->num_vertices
+    && fwrite(mesh->indices, 3 * sizeof(uint32_t), mesh->num_triangles, file) == mesh->num_triangles
+    && fwrite(mesh->nodes, sizeof(struct MeshBVHNode), mesh->num_nodes, file) == mesh->num_nodes;
+  fclose(file);
+
+  // Don't leave a truncated cache behind for the next load to trip over
+  if (!written){
+    fprintf(stderr, "Error: failed to write BVH cache %s in triangle_mesh_write_cache\n", cache_path);
+    remove(cache_path);
+  }
+  return written;
+}
+
+// TRIANGLE HELPERS
+//
+// Closest point on triangle abc to p, by Voronoi regions (Ericson, 5.1.5)
+void closest_point_on_triangle(vec3 p, vec3 a, vec3 b, vec3 c, vec3 dest){
+  vec3 ab, ac, ap, bp, cp;
+  glm_vec3_sub(b, a, ab);
+  glm_vec3_sub(c, a, ac);
+  glm_vec3_sub(p, a, ap);
+
+  float d1 = glm_vec3_dot(ab, ap);
+  float d2 = glm_vec3_dot(ac, ap);
+  if (d1 <= 0.0f && d2 <= 0.0f){
+    glm_vec3_copy(a, dest);
+    return;
+  }
+
+  glm_vec3_sub(p, b, bp);
+  float d3 = glm_vec3_dot(ab, bp);
+  float d4 = glm_vec3_dot(ac, bp);
+  if (d3 >= 0.0f && d4 <= d3){
+    glm_vec3_copy(b, dest);
+    return;
+  }
+
+  float vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f){
+    glm_vec3_copy(a, dest);
+    glm_vec3_muladds(ab, d1 / (d1 - d3), dest);
+    return;
+  }
+
+  glm_vec3_sub(p, c, cp);
+  float d5 = glm_vec3_dot(ab, cp);
+  float d6 = glm_vec3_dot(ac, cp);
+  if (d6 >= 0.0f && d5 <= d6){
+    glm_vec3_copy(c, dest);
+    return;
+  }
+
+  float vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f){
+    glm_vec3_copy(a, dest);
+    glm_vec3_muladds(ac, d2 / (d2 - d6), dest);
+    return;
+  }
+
+  float va = d3 * d6 - d5 * d4;
+  if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f){
+    vec3 bc;
+    glm_vec3_sub(c, b, bc);
+    glm_vec3_copy(b, dest);
+    glm_vec3_muladds(bc, (d4 - d3) / ((d4 - d3) + (d5 - d6)), dest);
+    return;
+  }
+
+  float denominator = 1.0f / (va + vb + vc);
+  glm_vec3_copy(a, dest);
+  glm_vec3_muladds(ab, vb * denominator, dest);
+  glm_vec3_muladds(ac, vc * denominator, dest);
+}
+
+// Closest points c1 on segment p1q1 and c2 on segment p2q2 (Ericson, 5.1.9).
+// Returns the squared distance between them
+float closest_points_segment_segment(vec3 p1, vec3 q1, vec3 p2, vec3 q2, vec3 c1, vec3 c2){
+  vec3 d1, d2, r;
+  glm_vec3_sub(q1, p1, d1);
+  glm_vec3_sub(q2, p2, d2);
+  glm_vec3_sub(p1, p2, r);
+  float a = glm_vec3_dot(d1, d1);
+  float e = glm_vec3_dot(d2, d2);
+  float f = glm_vec3_dot(d2, r);
+  float s, t;
+
+  if (a <= MESH_EPSILON && e <= MESH_EPSILON){
+    s = t = 0.0f;
+  }
+  else if (a <= MESH_EPSILON){
+    s = 0.0f;
+    t = glm_clamp(f / e, 0.0f, 1.0f);
+  }
+  else{
+    float c = glm_vec3_dot(d1, r);
+    if (e <= MESH_EPSILON){
+      t = 0.0f;
+      s = glm_clamp(-c / a, 0.0f, 1.0f);
+    }
+    else{
+      float b = glm_vec3_dot(d1, d2);
+      float denominator = a * e - b * b;
+      s = denominator != 0.0f ? glm_clamp((b * f - c * e) / denominator, 0.0f, 1.0f) : 0.0f;
+      t = (b * s + f) / e;
+      if (t < 0.0f){
+        t = 0.0f;
+        s = glm_clamp(-c / a, 0.0f, 1.0f);
+      }
+      else if (t > 1.0f){
+        t = 1.0f;
+        s = glm_clamp((b - c) / a, 0.0f, 1.0f);
+      }
+    }
+  }
+
+  glm_vec3_copy(p1, c1);
+  glm_vec3_muladds(d1, s, c1);
+  glm_vec3_copy(p2, c2);
+  glm_vec3_muladds(d2, t, c2);
+  return glm_vec3_distance2(c1, c2);
+}
+
+// Unit normal of triangle abc, false if it has no area
+static bool triangle_normal(vec3 a, vec3 b, vec3 c, vec3 dest){
+  vec3 ab, ac;
+  glm_vec3_sub(b, a, ab);
+  glm_vec3_sub(c, a, ac);
+  glm_vec3_cross(ab, ac, dest);
+  float length = glm_vec3_norm(dest);
+  if (length < MESH_EPSILON) return false;
+  glm_vec3_scale(dest, 1.0f / length, dest);
+  return true;
+}
+
+// SHAPE-TRIANGLE TESTS
+//
+// Everything here is in the mesh's space.
+// Each one fills in the contact between its shape and one triangle
+typedef bool (*MeshTriangleFunction)(struct ConvexShape *shape, vec3 a, vec3 b, vec3 c, struct MeshContact *dest);
+
+static bool mesh_triangle_sphere(struct ConvexShape *shape, vec3 a, vec3 b, vec3 c, struct MeshContact *dest){
+  struct Sphere *sphere = &shape->data.sphere;
+  vec3 normal;
+  if (!triangle_normal(a, b, c, normal)) return false;
+
+  vec3 difference;
+  closest_point_on_triangle(sphere->center, a, b, c, dest->point);
+  glm_vec3_sub(dest->point, sphere->center, difference);
+  float distance = glm_vec3_norm(difference);
+
+  // Center on the triangle: push out along the face normal
+  if (distance < MESH_EPSILON){
+    glm_vec3_negate_to(normal, dest->normal);
+    dest->distance = -sphere->radius;
+    return true;
+  }
+  glm_vec3_scale(difference, 1.0f / distance, dest->normal);
+  dest->distance = distance - sphere->radius;
+  return true;
+}
+
+static bool mesh_triangle_capsule(struct ConvexShape *shape, vec3 a, vec3 b, vec3 c, struct MeshContact *dest){
+  struct Capsule *capsule = &shape->data.capsule;
+  vec3 normal;
+  if (!triangle_normal(a, b, c, normal)) return false;
+
+  // Signed distances of the segment's ends to the triangle's plane
+  vec3 a_to_A, a_to_B;
+  glm_vec3_sub(capsule->segment_A, a, a_to_A);
+  glm_vec3_sub(capsule->segment_B, a, a_to_B);
+  float distance_A = glm_vec3_dot(a_to_A, normal);
+  float distance_B = glm_vec3_dot(a_to_B, normal);
+
+  // If the segment crosses the plane inside the triangle, the segment touches it
+  if ((distance_A <= 0.0f) != (distance_B <= 0.0f)){
+    vec3 crossing, closest;
+    glm_vec3_lerp(capsule->segment_A, capsule->segment_B, distance_A / (distance_A - distance_B), crossing);
+    closest_point_on_triangle(crossing, a, b, c, closest);
+    if (glm_vec3_distance2(crossing, closest) < MESH_EPSILON){
+      // Push the lower end back out above the face
+      float lowest = glm_min(distance_A, distance_B);
+      glm_vec3_negate_to(normal, dest->normal);
+      glm_vec3_copy(closest, dest->point);
+      dest->distance = lowest - capsule->radius;
+      return true;
+    }
+  }
+
+  // Otherwise the closest points are between one of the segment's ends and the triangle,
+  // or between the segment and one of the triangle's edges
+  vec3 best_segment, best_triangle;
+  float best = FLT_MAX;
+  vec3 *ends[2] = {&capsule->segment_A, &capsule->segment_B};
+  for (int i = 0; i < 2; i++){
+    vec3 closest;
+    closest_point_on_triangle(*ends[i], a, b, c, closest);
+    float distance_squared = glm_vec3_distance2(*ends[i], closest);
+    if (distance_squared < best){
+      best = distance_squared;
+      glm_vec3_copy(*ends[i], best_segment);
+      glm_vec3_copy(closest, best_triangle);
+    }
+  }
+  vec3 *edges[3][2] = {{(vec3 *)a, (vec3 *)b}, {(vec3 *)b, (vec3 *)c}, {(vec3 *)c, (vec3 *)a}};
+  for (int i = 0; i < 3; i++){
+    vec3 on_segment, on_edge;
+    float distance_squared = closest_points_segment_segment(capsule->segment_A, capsule->segment_B, *edges[i][0], *edges[i][1], on_segment, on_edge);
+    if (distance_squared < best){
+      best = distance_squared;
+      glm_vec3_copy(on_segment, best_segment);
+      glm_vec3_copy(on_edge, best_triangle);
+    }
+  }
+
+  float distance = sqrtf(best);
+  glm_vec3_copy(best_triangle, dest->point);
+  if (distance < MESH_EPSILON){
+    glm_vec3_negate_to(normal, dest->normal);
+    dest->distance = glm_min(distance_A, distance_B) - capsule->radius;
+    return true;
+  }
+  glm_vec3_sub(best_triangle, best_segment, dest->normal);
+  glm_vec3_scale(dest->normal, 1.0f / distance, dest->normal);
+  dest->distance = distance - capsule->radius;
+  return true;
+}
+
+// Separating axis test between a box and a triangle: the box's 3 axes, the triangle's
+// normal and the 9 cross products of their edges (Akenine-Moller).
+// Like OBB_separating_axis, the largest separation is a lower bound on the distance,
+// or the penetration depth when it's negative
+static bool mesh_triangle_box(struct ConvexShape *shape, vec3 a, vec3 b, vec3 c, struct MeshContact *dest){
+  struct OBB *box = &shape->data.obb;
+  vec3 normal;
+  if (!triangle_normal(a, b, c, normal)) return false;
+
+  vec3 axes[13];
+  int num_axes = 0;
+  glm_vec3_copy(normal, axes[num_axes++]);
+  for (int i = 0; i < 3; i++){
+    glm_vec3_copy(box->axes[i], axes[num_axes++]);
+  }
+  vec3 edges[3];
+  glm_vec3_sub(b, a, edges[0]);
+  glm_vec3_sub(c, b, edges[1]);
+  glm_vec3_sub(a, c, edges[2]);
+  for (int i = 0; i < 3; i++){
+    for (int j = 0; j < 3; j++){
+      vec3 axis;
+      glm_vec3_cross(edges[i], box->axes[j], axis);
+      float length = glm_vec3_norm(axis);
+      if (length < MESH_EPSILON) continue;
+      glm_vec3_scale(axis, 1.0f / length, axes[num_axes++]);
+    }
+  }
+
+  float face_separation = -FLT_MAX;
+  vec3 face_normal;
+  float best_separation = -FLT_MAX;
+  vec3 best_normal;
+  for (int i = 0; i < num_axes; i++){
+    float center = glm_vec3_dot(box->center, axes[i]);
+    float radius = OBB_projection_radius(box, axes[i]);
+    float projection_a = glm_vec3_dot(a, axes[i]);
+    float projection_b = glm_vec3_dot(b, axes[i]);
+    float projection_c = glm_vec3_dot(c, axes[i]);
+    float triangle_min = glm_min(projection_a, glm_min(projection_b, projection_c));
+    float triangle_max = glm_max(projection_a, glm_max(projection_b, projection_c));
+
+    // Gap with the triangle on the positive or negative side of the box
+    float gap_positive = triangle_min - (center + radius);
+    float gap_negative = (center - radius) - triangle_max;
+    float separation = glm_max(gap_positive, gap_negative);
+    if (separation > best_separation){
+      best_separation = separation;
+      glm_vec3_copy(axes[i], best_normal);
+      if (gap_negative > gap_positive) glm_vec3_negate(best_normal);
+    }
+    if (i == 0){
+      face_separation = separation;
+      glm_vec3_copy(best_normal, face_normal);
+    }
+  }
+
+  // Overlapping: prefer the face normal unless an edge axis is clearly shallower
+  if (best_separation <= 0.0f && best_separation <= MESH_FACE_AXIS_RELATIVE_TOLERANCE * face_separation + MESH_FACE_AXIS_ABSOLUTE_TOLERANCE){
+    best_separation = face_separation;
+    glm_vec3_copy(face_normal, best_normal);
+  }
+
+  dest->distance = best_separation;
+  glm_vec3_copy(best_normal, dest->normal);
+  closest_point_on_triangle(box->center, a, b, c, dest->point);
+  return true;
+}
+
+// QUERIES
+//
+// Mesh space is world space undone by the collider's transform:
+// local = R^T (world - T) / scale
+static void mesh_to_local_vector(struct MeshCollider *collider, vec3 v, vec3 dest){
+  vec3 result;
+  for (int i = 0; i < 3; i++){
+    result[i] = glm_vec3_dot(collider->rotation[i], v);
+  }
+  glm_vec3_copy(result, dest);
+}
+
+static void mesh_to_local_point(struct MeshCollider *collider, vec3 p, vec3 dest){
+  vec3 offset;
+  glm_vec3_sub(p, collider->translation, offset);
+  mesh_to_local_vector(collider, offset, dest);
+  glm_vec3_scale(dest, 1.0f / collider->scale, dest);
+}
+
+static void mesh_to_world_point(struct MeshCollider *collider, vec3 p, vec3 dest){
+  vec3 scaled;
+  glm_vec3_scale(p, collider->scale, scaled);
+  glm_mat3_mulv(collider->rotation, scaled, dest);
+  glm_vec3_add(dest, collider->translation, dest);
+}
+
+void mesh_collider_identity(struct TriangleMesh *mesh, struct MeshCollider *dest){
+  dest->mesh = mesh;
+  glm_mat3_identity(dest->rotation);
+  glm_vec3_zero(dest->translation);
+  dest->scale = 1.0f;
+}
+
+// World space bounds of the whole mesh, for the broad phase
+void mesh_collider_bounds(struct MeshCollider *collider, struct AABB *dest){
+  struct AABB local_bounds;
+  triangle_mesh_bounds(collider->mesh, &local_bounds);
+  glm_vec3_scale(local_bounds.center, collider->scale, local_bounds.center);
+  AABB_update(&local_bounds, collider->rotation, collider->translation, (vec3){collider->scale, collider->scale, collider->scale}, dest);
+  dest->initialized = true;
+}
+
+// Distance between the query's bounds and a node's, a lower bound on the
+// distance between the query shape and any triangle under the node
+static float mesh_bvh_node_distance(struct MeshBVHNode *node, vec3 query_min, vec3 query_max){
+  float distance_squared = 0.0f;
+  for (int i = 0; i < 3; i++){
+    float gap = glm_max(node->min[i] - query_max[i], query_min[i] - node->max[i]);
+    if (gap > 0.0f) distance_squared += gap * gap;
+  }
+  return sqrtf(distance_squared);
+}
+
+// Move a world space shape into the mesh's space and bound it there.
+// Returns the triangle test for its type, or NULL if it isn't supported
+static MeshTriangleFunction mesh_local_shape(struct MeshCollider *collider, struct ConvexShape *shape, struct ConvexShape *local, vec3 query_min, vec3 query_max){
+  *local = *shape;
+  float inverse_scale = 1.0f / collider->scale;
+  switch(shape->type){
+    case COLLIDER_SPHERE: {
+      struct Sphere *sphere = &local->data.sphere;
+      mesh_to_local_point(collider, shape->data.sphere.center, sphere->center);
+      sphere->radius *= inverse_scale;
+      glm_vec3_subs(sphere->center, sphere->radius, query_min);
+      glm_vec3_adds(sphere->center, sphere->radius, query_max);
+      return mesh_triangle_sphere;
+    }
+    case COLLIDER_CAPSULE: {
+      struct Capsule *capsule = &local->data.capsule;
+      mesh_to_local_point(collider, shape->data.capsule.segment_A, capsule->segment_A);
+      mesh_to_local_point(collider, shape->data.capsule.segment_B, capsule->segment_B);
+      capsule->radius *= inverse_scale;
+      glm_vec3_minv(capsule->segment_A, capsule->segment_B, query_min);
+      glm_vec3_maxv(capsule->segment_A, capsule->segment_B, query_max);
+      glm_vec3_subs(query_min, capsule->radius, query_min);
+      glm_vec3_adds(query_max, capsule->radius, query_max);
+      return mesh_triangle_capsule;
+    }
+    case COLLIDER_AABB:
+    case COLLIDER_OBB: {
+      // An AABB is an OBB in the mesh's space unless the mesh isn't rotated
+      struct OBB box;
+      if (shape->type == COLLIDER_AABB) OBB_from_AABB(&shape->data.aabb, &box);
+      else box = shape->data.obb;
+      local->type = COLLIDER_OBB;
+      mesh_to_local_point(collider, box.center, local->data.obb.center);
+      for (int i = 0; i < 3; i++){
+        mesh_to_local_vector(collider, box.axes[i], local->data.obb.axes[i]);
+      }
+      glm_vec3_scale(box.extents, inverse_scale, local->data.obb.extents);
+      struct AABB bounds;
+      OBB_to_AABB(&local->data.obb, &bounds);
+      glm_vec3_sub(bounds.center, bounds.extents, query_min);
+      glm_vec3_add(bounds.center, bounds.extents, query_max);
+      return mesh_triangle_box;
+    }
+    default:
+      fprintf(stderr, "Error: unsupported collider type %d in mesh_local_shape\n", shape->type);
+      return NULL;
+  }
+}
+
+// Closest contact between a world space shape and the mesh, or the deepest one if they overlap.
+// Returns false if the mesh is empty or the shape type isn't supported
+bool mesh_collider_contact(struct MeshCollider *collider, struct ConvexShape *shape, struct MeshContact *dest){
+  struct TriangleMesh *mesh = collider->mesh;
+  dest->found = false;
+  dest->distance = FLT_MAX;
+  if (!mesh || mesh->num_nodes == 0 || collider->scale == 0.0f) return false;
+
+  // Move the shape into mesh space, and bound it there
+  struct ConvexShape local;
+  vec3 query_min, query_max;
+  MeshTriangleFunction triangle_function = mesh_local_shape(collider, shape, &local, query_min, query_max);
+  if (!triangle_function) return false;
+
+  // Nearest child first. Nodes the query overlaps are always visited so the
+  // deepest penetration is found, the rest only if they could hold something closer
+  uint32_t stack[MESH_BVH_STACK_SIZE];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0){
+    struct MeshBVHNode *node = &mesh->nodes[stack[--stack_size]];
+    float node_distance = mesh_bvh_node_distance(node, query_min, query_max);
+    if (node_distance > 0.0f && node_distance >= dest->distance) continue;
+
+    if (node->count > 0){
+      for (uint32_t i = node->first; i < node->first + node->count; i++){
+        uint32_t *triangle = &mesh->indices[i * 3];
+        struct MeshContact contact;
+        if (!triangle_function(&local, mesh->vertices[triangle[0]], mesh->vertices[triangle[1]], mesh->vertices[triangle[2]], &contact)) continue;
+        if (contact.distance < dest->distance){
+          *dest = contact;
+          dest->triangle = i;
+          dest->found = true;
+        }
+      }
+      continue;
+    }
+
+    uint32_t near = node->first;
+    uint32_t far = node->first + 1;
+    float near_distance = mesh_bvh_node_distance(&mesh->nodes[near], query_min, query_max);
+    float far_distance = mesh_bvh_node_distance(&mesh->nodes[far], query_min, query_max);
+    if (far_distance < near_distance){
+      uint32_t temp = near;
+      near = far;
+      far = temp;
+    }
+    // Depth is capped at build time, so the stack can't overflow
+    stack[stack_size++] = far;
+    stack[stack_size++] = near;
+  }
+
+  if (!dest->found) return false;
+
+  // Back to world space
+  dest->distance *= collider->scale;
+  vec3 normal;
+  glm_mat3_mulv(collider->rotation, dest->normal, normal);
+  glm_vec3_normalize_to(normal, dest->normal);
+  mesh_to_world_point(collider, dest->point, dest->point);
+  return true;
+}
+
+// CASTS
+//
+// Slab test of the segment origin + t * translation against a node grown by extents,
+// like AABB_intersect_segment
+static bool mesh_bvh_node_ray(struct MeshBVHNode *node, vec3 extents, vec3 origin, vec3 inverse_translation, float max_fraction, float *entry){
+  float t_min = 0.0f;
+  float t_max = max_fraction;
+  for (int i = 0; i < 3; i++){
+    float node_min = node->min[i] - extents[i];
+    float node_max = node->max[i] + extents[i];
+    // inverse_translation is infinite on axes the segment doesn't move along, which works out
+    // unless the origin is exactly on a slab's face (0 * inf), so test those axes directly
+    if (isinf(inverse_translation[i])){
+      if (origin[i] < node_min || origin[i] > node_max) return false;
+      continue;
+    }
+    float t1 = (node_min - origin[i]) * inverse_translation[i];
+    float t2 = (node_max - origin[i]) * inverse_translation[i];
+    t_min = glm_max(t_min, glm_min(t1, t2));
+    t_max = glm_min(t_max, glm_max(t1, t2));
+    if (t_min > t_max) return false;
+  }
+  *entry = t_min;
+  return true;
+}
+
+// Ray against a triangle from either side (Moller-Trumbore), for the fraction along translation
+static bool mesh_triangle_ray(vec3 origin, vec3 translation, vec3 a, vec3 b, vec3 c, float *fraction){
+  vec3 ab, ac, p, s, q;
+  glm_vec3_sub(b, a, ab);
+  glm_vec3_sub(c, a, ac);
+  glm_vec3_cross(translation, ac, p);
+  float determinant = glm_vec3_dot(ab, p);
+  // Parallel to the triangle
+  if (fabsf(determinant) < MESH_EPSILON) return false;
+  float inverse_determinant = 1.0f / determinant;
+  glm_vec3_sub(origin, a, s);
+  float u = glm_vec3_dot(s, p) * inverse_determinant;
+  if (u < 0.0f || u > 1.0f) return false;
+  glm_vec3_cross(s, ab, q);
+  float v = glm_vec3_dot(translation, q) * inverse_determinant;
+  if (v < 0.0f || u + v > 1.0f) return false;
+  *fraction = glm_vec3_dot(ac, q) * inverse_determinant;
+  return *fraction >= 0.0f;
+}
+
+static void mesh_translate_shape(struct ConvexShape *shape, vec3 translation, float fraction, struct ConvexShape *dest){
+  *dest = *shape;
+  switch(shape->type){
+    case COLLIDER_SPHERE:
+      glm_vec3_muladds(translation, fraction, dest->data.sphere.center);
+      break;
+    case COLLIDER_CAPSULE:
+      glm_vec3_muladds(translation, fraction, dest->data.capsule.segment_A);
+      glm_vec3_muladds(translation, fraction, dest->data.capsule.segment_B);
+      break;
+    case COLLIDER_OBB:
+      glm_vec3_muladds(translation, fraction, dest->data.obb.center);
+      break;
+    default:
+      break;
+  }
+}
+
+// Conservative advancement of a shape against one triangle. The contact normal is a separating axis,
+// so the shape can close the whole distance along it before anything of the triangle is in reach.
+// A shape already touching the triangle only hits it if it's moving further in.
+// Touching a triangle also only counts while moving towards its plane, so a shape sliding across
+// a flat mesh doesn't catch on the edges of the triangles it slides onto
+static bool mesh_triangle_cast(MeshTriangleFunction triangle_function, struct ConvexShape *shape, vec3 translation, float max_fraction, float tolerance, vec3 a, vec3 b, vec3 c, float *fraction, struct MeshContact *dest){
+  vec3 face_normal;
+  if (!triangle_normal(a, b, c, face_normal)) return false;
+  float face_approach = glm_vec3_dot(translation, face_normal);
+
+  struct ConvexShape moved;
+  float t = 0.0f;
+  for (unsigned int iteration = 0; ; iteration++){
+    mesh_translate_shape(shape, translation, t, &moved);
+    if (!triangle_function(&moved, a, b, c, dest)) return false;
+    float approach = glm_vec3_dot(translation, dest->normal);
+    if (dest->distance <= tolerance){
+      if (t == 0.0f && approach <= 0.0f) return false;
+      if (face_approach * glm_vec3_dot(dest->normal, face_normal) <= 0.0f) return false;
+      *fraction = t;
+      return true;
+    }
+    if (approach <= 0.0f || iteration >= MESH_CAST_MAX_ITERATIONS) return false;
+    t += dest->distance / approach;
+    if (t > max_fraction) return false;
+  }
+}
+
+// Walk the BVH nearest node first along the cast, clipping it at each triangle it hits.
+// shape is NULL for a ray, extents are its half size in mesh space
+static void mesh_cast(struct TriangleMesh *mesh, MeshTriangleFunction triangle_function, struct ConvexShape *shape, vec3 extents, vec3 origin, vec3 translation, float tolerance, struct MeshCastHit *dest, struct MeshContact *contact){
+  vec3 inverse_translation;
+  for (int i = 0; i < 3; i++){
+    inverse_translation[i] = translation[i] != 0.0f ? 1.0f / translation[i] : INFINITY;
+  }
+
+  uint32_t stack[MESH_BVH_STACK_SIZE];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0){
+    struct MeshBVHNode *node = &mesh->nodes[stack[--stack_size]];
+    float entry;
+    if (!mesh_bvh_node_ray(node, extents, origin, inverse_translation, dest->fraction, &entry)) continue;
+
+    if (node->count > 0){
+      for (uint32_t i = node->first; i < node->first + node->count; i++){
+        uint32_t *triangle = &mesh->indices[i * 3];
+        vec3 *vertices = mesh->vertices;
+        float fraction;
+        struct MeshContact triangle_contact;
+        bool hit = shape
+          ? mesh_triangle_cast(triangle_function, shape, translation, dest->fraction, tolerance, vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]], &fraction, &triangle_contact)
+          : mesh_triangle_ray(origin, translation, vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]], &fraction);
+        if (!hit || fraction > dest->fraction) continue;
+        dest->fraction = fraction;
+        dest->triangle = i;
+        dest->found = true;
+        if (shape) *contact = triangle_contact;
+      }
+      continue;
+    }
+
+    // Nearest child on top, so the far one is usually clipped by the time it's popped
+    uint32_t near = node->first;
+    uint32_t far = node->first + 1;
+    float near_entry, far_entry;
+    bool near_hit = mesh_bvh_node_ray(&mesh->nodes[near], extents, origin, inverse_translation, dest->fraction, &near_entry);
+    bool far_hit = mesh_bvh_node_ray(&mesh->nodes[far], extents, origin, inverse_translation, dest->fraction, &far_entry);
+    if (far_hit && (!near_hit || far_entry < near_entry)){
+      uint32_t temp = near;
+      near = far;
+      far = temp;
+      bool temp_hit = near_hit;
+      near_hit = far_hit;
+      far_hit = temp_hit;
+    }
+    // Depth is capped at build time, so the stack can't overflow
+    if (far_hit) stack[stack_size++] = far;
+    if (near_hit) stack[stack_size++] = near;
+  }
+}
+
+// First triangle the segment origin + t * translation (world space) hits, for t up to max_fraction.
+// Triangles are two sided, like the shape tests, and the normal faces back along the ray.
+// Fractions are the same in mesh space, since the transform is a rotation and a uniform scale
+bool mesh_collider_ray_cast(struct MeshCollider *collider, vec3 origin, vec3 translation, float max_fraction, struct MeshCastHit *dest){
+  struct TriangleMesh *mesh = collider->mesh;
+  dest->found = false;
+  dest->fraction = max_fraction;
+  if (!mesh || mesh->num_nodes == 0 || collider->scale == 0.0f) return false;
+
+  vec3 local_origin, local_translation;
+  mesh_to_local_point(collider, origin, local_origin);
+  mesh_to_local_vector(collider, translation, local_translation);
+  glm_vec3_scale(local_translation, 1.0f / collider->scale, local_translation);
+  mesh_cast(mesh, NULL, NULL, (vec3){0.0f, 0.0f, 0.0f}, local_origin, local_translation, 0.0f, dest, NULL);
+  if (!dest->found) return false;
+
+  // Face normal in world space, facing the ray
+  uint32_t *triangle = &mesh->indices[dest->triangle * 3];
+  vec3 local_normal;
+  triangle_normal(mesh->vertices[triangle[0]], mesh->vertices[triangle[1]], mesh->vertices[triangle[2]], local_normal);
+  if (glm_vec3_dot(local_normal, local_translation) > 0.0f) glm_vec3_negate(local_normal);
+  glm_mat3_mulv(collider->rotation, local_normal, dest->normal);
+  glm_vec3_normalize(dest->normal);
+  glm_vec3_copy(origin, dest->point);
+  glm_vec3_muladds(translation, dest->fraction, dest->point);
+  return true;
+}
+
+// First triangle a world space sphere, capsule or box moved by translation hits, for fractions
+// up to max_fraction. Each triangle the swept shape's bounds reach is advanced against on its own,
+// so a shape touching the floor still finds the wall in front of it.
+// The normal points from the mesh back towards the shape, and tolerance is in world units
+bool mesh_collider_shape_cast(struct MeshCollider *collider, struct ConvexShape *shape, vec3 translation, float max_fraction, float tolerance, struct MeshCastHit *dest){
+  struct TriangleMesh *mesh = collider->mesh;
+  dest->found = false;
+  dest->fraction = max_fraction;
+  if (!mesh || mesh->num_nodes == 0 || collider->scale == 0.0f) return false;
+
+  struct ConvexShape local;
+  vec3 query_min, query_max;
+  MeshTriangleFunction triangle_function = mesh_local_shape(collider, shape, &local, query_min, query_max);
+  if (!triangle_function) return false;
+
+  // Sweep the shape's bounds through the BVH
+  vec3 local_translation, center, extents;
+  mesh_to_local_vector(collider, translation, local_translation);
+  glm_vec3_scale(local_translation, 1.0f / collider->scale, local_translation);
+  glm_vec3_add(query_min, query_max, center);
+  glm_vec3_scale(center, 0.5f, center);
+  glm_vec3_sub(query_max, center, extents);
+  struct MeshContact contact;
+  mesh_cast(mesh, triangle_function, &local, extents, center, local_translation, tolerance / collider->scale, dest, &contact);
+  if (!dest->found) return false;
+
+  vec3 normal;
+  glm_mat3_mulv(collider->rotation, contact.normal, normal);
+  glm_vec3_normalize(normal);
+  glm_vec3_negate_to(normal, dest->normal);
+  mesh_to_world_point(collider, contact.point, dest->point);
+  return true;
+}
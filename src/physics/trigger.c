@@ -0,0 +1,138 @@
+#include <stdlib.h>
+#include <string.h>
+#include "entity.h"
+#include "event.h"
+#include "physics/world.h"
+#include "physics/trigger.h"
+#include "physics/gjk.h"
+
+#define INITIAL_TRIGGER_OVERLAP_CAPACITY 16
+
+bool physics_triggers_init(struct PhysicsTriggers *triggers){
+  memset(triggers, 0, sizeof(struct PhysicsTriggers));
+  return dynamic_tree_init(&triggers->tree);
+}
+
+void physics_triggers_free(struct PhysicsTriggers *triggers){
+  dynamic_tree_free(&triggers->tree);
+  free(triggers->overlaps.keys);
+  free(triggers->previous_overlaps.keys);
+  triggers->overlaps.keys = NULL;
+  triggers->previous_overlaps.keys = NULL;
+}
+
+static uint64_t physics_trigger_key(PhysicsBodyHandle trigger, PhysicsBodyHandle player){
+  return ((uint64_t)trigger << 32) | player;
+}
+
+static bool physics_trigger_overlaps_push(struct PhysicsTriggerOverlaps *overlaps, uint64_t key){
+  if (overlaps->num_keys == overlaps->max_keys){
+    unsigned int new_max_keys = overlaps->max_keys ? overlaps->max_keys * 2 : INITIAL_TRIGGER_OVERLAP_CAPACITY;
+    uint64_t *new_keys = (uint64_t *)realloc(overlaps->keys, new_max_keys * sizeof(uint64_t));
+    if (!new_keys){
+      fprintf(stderr, "Error: failed to realloc trigger overlaps in physics_trigger_overlaps_push\n");
+      return false;
+    }
+    overlaps->keys = new_keys;
+    overlaps->max_keys = new_max_keys;
+  }
+  overlaps->keys[overlaps->num_keys++] = key;
+  return true;
+}
+
+static int physics_trigger_key_compare(const void *a, const void *b){
+  uint64_t key_A = *(const uint64_t *)a;
+  uint64_t key_B = *(const uint64_t *)b;
+  return (key_A > key_B) - (key_A < key_B);
+}
+
+// Triggers don't move, so their collider and proxy are only built once
+static void physics_create_trigger_proxies(struct PhysicsWorld *physics_world){
+  struct PhysicsTriggers *triggers = &physics_world->triggers;
+  for (unsigned int i = 0; i < physics_world->num_trigger_bodies; i++){
+    struct PhysicsBody *body = &physics_world->trigger_bodies[i];
+    if (body->proxy_id != DYNAMIC_TREE_NULL_NODE) continue;
+    physics_body_update_world_collider(body, physics_world->trigger_cold[i].scene_node);
+    struct AABB aabb;
+    physics_body_compute_AABB(body, 0.0f, &aabb);
+    body->proxy_id = dynamic_tree_create_proxy(&triggers->tree, &aabb, (void *)(uintptr_t)body->handle);
+  }
+  triggers->pending = false;
+}
+
+struct TriggerQuery {
+  struct PhysicsWorld *physics_world;
+  struct PhysicsBody *player_body;
+};
+
+static bool physics_trigger_query_callback(int proxy_id, void *user_data, void *context){
+  struct TriggerQuery *query = (struct TriggerQuery *)context;
+  struct PhysicsBody *trigger_body = physics_get_body(query->physics_world, (PhysicsBodyHandle)(uintptr_t)user_data);
+  (void)proxy_id;
+
+  if (!trigger_body) return true;
+  if (!physics_bodies_can_collide(trigger_body, query->player_body)) return true;
+  if (gjk_body_distance(trigger_body, query->player_body, 0.0f) > 0.0f) return true;
+
+  physics_trigger_overlaps_push(&query->physics_world->triggers.overlaps, physics_trigger_key(trigger_body->handle, query->player_body->handle));
+  return true;
+}
+
+// Bodies removed since the overlap began (e.g. a picked up item) have no entity
+// left to report, so their exit is dropped
+static void physics_emit_trigger_event(struct PhysicsWorld *physics_world, EventType type, uint64_t key){
+  struct PhysicsBodyCold *trigger_cold = physics_get_body_cold(physics_world, (PhysicsBodyHandle)(key >> 32));
+  struct PhysicsBodyCold *other_cold = physics_get_body_cold(physics_world, (PhysicsBodyHandle)(key & 0xFFFFFFFFu));
+  if (!trigger_cold || !other_cold || !trigger_cold->entity || !other_cold->entity) return;
+
+  struct GameEvent event;
+  event.tick = physics_world->step_count;
+  event.type = type;
+  event.data.trigger.trigger_entity = trigger_cold->entity->index;
+  event.data.trigger.other_entity = other_cold->entity->index;
+  game_event_queue_enqueue(event);
+}
+
+void physics_update_triggers(struct PhysicsWorld *physics_world, float delta_time){
+  struct PhysicsTriggers *triggers = &physics_world->triggers;
+  (void)delta_time;
+  if (triggers->pending){
+    physics_create_trigger_proxies(physics_world);
+  }
+
+  // Players' colliders were cached at the start of the step, the zero time offset
+  // moves them to where integration left them
+  triggers->overlaps.num_keys = 0;
+  struct TriggerQuery query = {.physics_world = physics_world};
+  for (unsigned int i = 0; i < physics_world->num_player_bodies; i++){
+    query.player_body = &physics_world->player_bodies[i];
+    struct AABB aabb;
+    physics_body_compute_AABB(query.player_body, 0.0f, &aabb);
+    dynamic_tree_query(&triggers->tree, &aabb, physics_trigger_query_callback, &query);
+  }
+  if (triggers->overlaps.num_keys > 1){
+    qsort(triggers->overlaps.keys, triggers->overlaps.num_keys, sizeof(uint64_t), physics_trigger_key_compare);
+  }
+  physics_world->step_stats.num_trigger_overlaps = triggers->overlaps.num_keys;
+
+  // Merge against last step's overlaps: keys only in this step's entered, keys only in last step's exited
+  struct PhysicsTriggerOverlaps *current = &triggers->overlaps;
+  struct PhysicsTriggerOverlaps *previous = &triggers->previous_overlaps;
+  unsigned int i = 0, j = 0;
+  while (i < current->num_keys || j < previous->num_keys){
+    if (j == previous->num_keys || (i < current->num_keys && current->keys[i] < previous->keys[j])){
+      physics_emit_trigger_event(physics_world, EVENT_TRIGGER_ENTER, current->keys[i++]);
+    }
+    else if (i == current->num_keys || previous->keys[j] < current->keys[i]){
+      physics_emit_trigger_event(physics_world, EVENT_TRIGGER_EXIT, previous->keys[j++]);
+    }
+    else{
+      i++;
+      j++;
+    }
+  }
+
+  struct PhysicsTriggerOverlaps temp = triggers->overlaps;
+  triggers->overlaps = triggers->previous_overlaps;
+  triggers->previous_overlaps = temp;
+}
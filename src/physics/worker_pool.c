@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "physics/worker_pool.h"
+
+static int physics_worker_main(void *arg){
+  struct PhysicsWorker *worker = (struct PhysicsWorker *)arg;
+  struct PhysicsWorkerPool *pool = worker->pool;
+
+  mtx_lock(&pool->mutex);
+  while (true){
+    while (!pool->shutdown && pool->generation == worker->seen_generation){
+      cnd_wait(&pool->work_ready, &pool->mutex);
+    }
+    if (pool->shutdown) break;
+    worker->seen_generation = pool->generation;
+
+    PhysicsJobFunction function = pool->function;
+    void *context = pool->context;
+    unsigned int begin = worker->begin;
+    unsigned int end = worker->end;
+    mtx_unlock(&pool->mutex);
+
+    if (begin < end){
+      function(context, worker->index, begin, end);
+    }
+
+    mtx_lock(&pool->mutex);
+    if (--pool->pending == 0){
+      cnd_signal(&pool->work_done);
+    }
+  }
+  mtx_unlock(&pool->mutex);
+  return 0;
+}
+
+// One worker per online core, counting the calling thread
+int physics_worker_pool_default_threads(){
+  long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+  if (num_cores < 1) num_cores = 1;
+  if (num_cores - 1 > PHYSICS_MAX_WORKER_THREADS) return PHYSICS_MAX_WORKER_THREADS;
+  return (int)num_cores - 1;
+}
+
+struct PhysicsWorkerPool *physics_worker_pool_create(int num_threads){
+  if (num_threads < 0) num_threads = 0;
+  if (num_threads > PHYSICS_MAX_WORKER_THREADS) num_threads = PHYSICS_MAX_WORKER_THREADS;
+
+  struct PhysicsWorkerPool *pool = (struct PhysicsWorkerPool *)calloc(1, sizeof(struct PhysicsWorkerPool));
+  if (!pool){
+    fprintf(stderr, "Error: failed to allocate worker pool in physics_worker_pool_create\n");
+    return NULL;
+  }
+  if (mtx_init(&pool->mutex, mtx_plain) != thrd_success){
+    fprintf(stderr, "Error: failed to init mutex in physics_worker_pool_create\n");
+    free(pool);
+    return NULL;
+  }
+  if (cnd_init(&pool->work_ready) != thrd_success){
+    fprintf(stderr, "Error: failed to init work_ready condition in physics_worker_pool_create\n");
+    mtx_destroy(&pool->mutex);
+    free(pool);
+    return NULL;
+  }
+  if (cnd_init(&pool->work_done) != thrd_success){
+    fprintf(stderr, "Error: failed to init work_done condition in physics_worker_pool_create\n");
+    cnd_destroy(&pool->work_ready);
+    mtx_destroy(&pool->mutex);
+    free(pool);
+    return NULL;
+  }
+
+  // Worker index 0 is the calling thread, so threads start at 1.
+  // If a thread fails to start, run with the ones that did
+  for (int i = 0; i < num_threads; i++){
+    struct PhysicsWorker *worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->index = i + 1;
+    worker->seen_generation = pool->generation;
+    if (thrd_create(&pool->threads[i], physics_worker_main, worker) != thrd_success){
+      fprintf(stderr, "Error: failed to start worker thread %d in physics_worker_pool_create\n", i);
+      break;
+    }
+    pool->num_threads++;
+  }
+
+  return pool;
+}
+
+void physics_worker_pool_destroy(struct PhysicsWorkerPool *pool){
+  if (!pool) return;
+
+  mtx_lock(&pool->mutex);
+  pool->shutdown = true;
+  cnd_broadcast(&pool->work_ready);
+  mtx_unlock(&pool->mutex);
+
+  for (int i = 0; i < pool->num_threads; i++){
+    thrd_join(pool->threads[i], NULL);
+  }
+  cnd_destroy(&pool->work_ready);
+  cnd_destroy(&pool->work_done);
+  mtx_destroy(&pool->mutex);
+  free(pool);
+}
+
+int physics_worker_pool_num_workers(struct PhysicsWorkerPool *pool){
+  return pool ? pool->num_threads + 1 : 1;
+}
+
+void physics_worker_pool_run(struct PhysicsWorkerPool *pool, PhysicsJobFunction function, void *context, unsigned int num_items){
+  if (num_items == 0) return;
+  if (!pool || pool->num_threads == 0){
+    function(context, 0, 0, num_items);
+    return;
+  }
+
+  unsigned int num_workers = (unsigned int)pool->num_threads + 1;
+  unsigned int chunk = (num_items + num_workers - 1) / num_workers;
+
+  mtx_lock(&pool->mutex);
+  for (int i = 0; i < pool->num_threads; i++){
+    struct PhysicsWorker *worker = &pool->workers[i];
+    unsigned int begin = (unsigned int)worker->index * chunk;
+    worker->begin = begin < num_items ? begin : num_items;
+    worker->end = (begin + chunk) < num_items ? begin + chunk : num_items;
+  }
+  pool->function = function;
+  pool->context = context;
+  pool->pending = pool->num_threads;
+  pool->generation++;
+  cnd_broadcast(&pool->work_ready);
+  mtx_unlock(&pool->mutex);
+
+  // The calling thread takes the first range
+  function(context, 0, 0, chunk < num_items ? chunk : num_items);
+
+  mtx_lock(&pool->mutex);
+  while (pool->pending > 0){
+    cnd_wait(&pool->work_done, &pool->mutex);
+  }
+  mtx_unlock(&pool->mutex);
+}
@@ -1,9 +1,11 @@
 #include <cglm/vec3.h>
 #include <stdbool.h>
+#include <string.h>
 #include "entity.h"
 #include "item.h"
 #include "scene.h"
 #include "physics/world.h"
+#include "physics/pipeline.h"
 #include "narrow_phase.h"
 #include "distance.h"
 #include "resolution.h"
@@ -12,13 +14,11 @@
 #include "time.h"
 #include "physics/utils.h"
 
-#define MAX_PHYSICS_BODIES 128
+// Starting capacity of each body array and the slot table, they double as they fill
+#define INITIAL_BODY_CAPACITY 16
 
-// Fixed time step to avoid huge delta time values
-#define MAX_DELTA_TIME 0.01666
-
-// Collision timing
-#define INTERVAL_EPSILON 0.000001f
+// Half-size of the bounds given to infinite planes in the broad phase
+#define PLANE_BROAD_PHASE_EXTENT 10000.0f
 
 struct PhysicsWorld *physics_world_create(){
   struct PhysicsWorld *world = (struct PhysicsWorld *)calloc(1, sizeof(struct PhysicsWorld));
@@ -26,36 +26,292 @@ struct PhysicsWorld *physics_world_create(){
     printf("Error: failed to allocate PhysicsWorld in physics_world_create\n");
     return NULL;
   }
-  // Good opportunity for optimization here:
-  // - each bodies array should only have enough memory allocated for initial loading
-  // - if a static body becomes dynamic, or vice versa, reallocate accordingly
-  world->static_bodies = (struct PhysicsBody *)calloc(MAX_PHYSICS_BODIES, sizeof(struct PhysicsBody));
-  world->dynamic_bodies = (struct PhysicsBody *)calloc(MAX_PHYSICS_BODIES, sizeof(struct PhysicsBody));
-  world->player_bodies = (struct PhysicsBody *)calloc(MAX_PHYSICS_BODIES, sizeof(struct PhysicsBody));
+  // Body arrays and handle slots are allocated on the first add
+  world->free_body_slot = -1;
+
+  // One layer per entity type, all colliding with each other
+  physics_layers_init(&world->layers);
+
+  // Broad phase
+  world->broad_phase_type = BROAD_PHASE_DYNAMIC_TREE;
+  if (!dynamic_tree_init(&world->tree)){
+    fprintf(stderr, "Error: failed to init dynamic tree in physics_world_create, falling back to brute force broad phase\n");
+    world->broad_phase_type = BROAD_PHASE_BRUTE_FORCE;
+  }
+  if (!sap_init(&world->sap)){
+    fprintf(stderr, "Error: failed to init sweep and prune in physics_world_create\n");
+  }
+  if (!physics_triggers_init(&world->triggers)){
+    fprintf(stderr, "Error: failed to init trigger tree in physics_world_create\n");
+  }
+
+  // Narrow phase workers, one contact buffer per worker
+  world->worker_pool = physics_worker_pool_create(physics_worker_pool_default_threads());
+  world->num_worker_contacts = physics_worker_pool_num_workers(world->worker_pool);
+  world->worker_contacts = (struct PhysicsContactBuffer *)calloc(world->num_worker_contacts, sizeof(struct PhysicsContactBuffer));
+  if (!world->worker_contacts){
+    fprintf(stderr, "Error: failed to allocate worker contact buffers in physics_world_create\n");
+    physics_worker_pool_destroy(world->worker_pool);
+    world->worker_pool = NULL;
+    world->num_worker_contacts = 0;
+  }
+
+  // Default pipeline, the pair buffer grows on first use
+  world->pipeline.narrow_phase = physics_narrow_phase_pairs;
+  world->pipeline.resolve = physics_solve_contacts;
+  world->pipeline.islands = physics_update_islands;
+  world->pipeline.integrate = physics_integrate_positions;
+  world->pipeline.triggers = physics_update_triggers;
+  world->solver.iterations = SOLVER_DEFAULT_ITERATIONS;
+  physics_set_broad_phase(world, world->broad_phase_type);
 
   // Might want some kind of default field population later.
   // calloc should be fine for now, though.
   return world;
 }
 
-struct PhysicsBody *physics_add_body(struct PhysicsWorld *physics_world, struct SceneNode *scene_node, struct Entity *entity, struct Collider collider, float restitution, bool dynamic){
-  // Memory is already allocated: get a pointer, assign values, return the pointer
-struct PhysicsBody *body;
-  switch(dynamic){
-    case true:
-      body = &physics_world->dynamic_bodies[physics_world->num_dynamic_bodies++];
-      glm_vec3_copy(entity->velocity, body->velocity);
-      break;
-    case false:
-      body = &physics_world->static_bodies[physics_world->num_static_bodies++];
-      glm_vec3_copy((vec3){0.0f, 0.0f, 0.0f}, body->velocity);
-      break;
+void physics_world_destroy(struct PhysicsWorld *physics_world){
+  if (!physics_world) return;
+
+  dynamic_tree_free(&physics_world->tree);
+  sap_free(&physics_world->sap);
+  AABB_batch_free(&physics_world->static_AABBs);
+  AABB_batch_free(&physics_world->dynamic_AABBs);
+  motion_batch_free(&physics_world->motion_batch);
+  free(physics_world->batch_results);
+  physics_triggers_free(&physics_world->triggers);
+  physics_contact_table_free(&physics_world->contact_table);
+  physics_solver_free(&physics_world->solver);
+  physics_worker_pool_destroy(physics_world->worker_pool);
+  for (int i = 0; i < physics_world->num_worker_contacts; i++){
+    free(physics_world->worker_contacts[i].pair_indices);
+  }
+  free(physics_world->worker_contacts);
+  free(physics_world->contacts.pair_indices);
+  physics_islands_free(&physics_world->islands);
+  gjk_cache_table_free(&physics_world->gjk_cache);
+  gjk_cache_table_free(&physics_world->next_gjk_cache);
+  for (unsigned int i = 0; i < physics_world->num_meshes; i++){
+    triangle_mesh_free(physics_world->meshes[i]);
+  }
+  free(physics_world->meshes);
+  free(physics_world->pairs);
+  free(physics_world->static_bodies);
+  free(physics_world->dynamic_bodies);
+  free(physics_world->player_bodies);
+  free(physics_world->trigger_bodies);
+  free(physics_world->static_cold);
+  free(physics_world->dynamic_cold);
+  free(physics_world->player_cold);
+  free(physics_world->trigger_cold);
+  free(physics_world->body_slots);
+  free(physics_world);
+}
+
+// BODY POOLS
+//
+static struct PhysicsBody **physics_body_array(struct PhysicsWorld *physics_world, PhysicsBodyCategory category, unsigned int **num_bodies, unsigned int **max_bodies){
+  switch(category){
+    case PHYSICS_BODY_STATIC:
+      *num_bodies = &physics_world->num_static_bodies;
+      *max_bodies = &physics_world->max_static_bodies;
+      return &physics_world->static_bodies;
+    case PHYSICS_BODY_DYNAMIC:
+      *num_bodies = &physics_world->num_dynamic_bodies;
+      *max_bodies = &physics_world->max_dynamic_bodies;
+      return &physics_world->dynamic_bodies;
+    case PHYSICS_BODY_PLAYER:
+      *num_bodies = &physics_world->num_player_bodies;
+      *max_bodies = &physics_world->max_player_bodies;
+      return &physics_world->player_bodies;
+    case PHYSICS_BODY_TRIGGER:
+      *num_bodies = &physics_world->num_trigger_bodies;
+      *max_bodies = &physics_world->max_trigger_bodies;
+      return &physics_world->trigger_bodies;
+    default:
+      return NULL;
+  }
+}
+
+// The cold array parallel to a category's body array, sharing its count and capacity
+static struct PhysicsBodyCold **physics_body_cold_array(struct PhysicsWorld *physics_world, PhysicsBodyCategory category){
+  switch(category){
+    case PHYSICS_BODY_STATIC:
+      return &physics_world->static_cold;
+    case PHYSICS_BODY_DYNAMIC:
+      return &physics_world->dynamic_cold;
+    case PHYSICS_BODY_PLAYER:
+      return &physics_world->player_cold;
+    case PHYSICS_BODY_TRIGGER:
+      return &physics_world->trigger_cold;
+    default:
+      return NULL;
+  }
+}
+
+// Append a zeroed body and cold entry to the end of a category's arrays, growing them if they're full.
+// Growing moves every body in the array, which is fine since nothing outside
+// the world holds pointers to them across steps
+static struct PhysicsBody *physics_body_array_push(struct PhysicsWorld *physics_world, PhysicsBodyCategory category, unsigned int *index){
+  unsigned int *num_bodies, *max_bodies;
+  struct PhysicsBody **bodies = physics_body_array(physics_world, category, &num_bodies, &max_bodies);
+  struct PhysicsBodyCold **cold = physics_body_cold_array(physics_world, category);
+  if (*num_bodies == *max_bodies){
+    unsigned int new_max_bodies = *max_bodies ? *max_bodies * 2 : INITIAL_BODY_CAPACITY;
+    struct PhysicsBody *new_bodies = (struct PhysicsBody *)realloc(*bodies, new_max_bodies * sizeof(struct PhysicsBody));
+    if (!new_bodies){
+      fprintf(stderr, "Error: failed to realloc bodies in physics_body_array_push\n");
+      return NULL;
+    }
+    *bodies = new_bodies;
+    // The body array keeps its extra room if this fails, max_bodies just isn't raised
+    struct PhysicsBodyCold *new_cold = (struct PhysicsBodyCold *)realloc(*cold, new_max_bodies * sizeof(struct PhysicsBodyCold));
+    if (!new_cold){
+      fprintf(stderr, "Error: failed to realloc cold body data in physics_body_array_push\n");
+      return NULL;
+    }
+    *cold = new_cold;
+    *max_bodies = new_max_bodies;
   }
+  *index = (*num_bodies)++;
+  if (category == PHYSICS_BODY_DYNAMIC) physics_world->islands.dirty = true;
+  struct PhysicsBody *body = &(*bodies)[*index];
+  memset(body, 0, sizeof(struct PhysicsBody));
+  memset(&(*cold)[*index], 0, sizeof(struct PhysicsBodyCold));
+  return body;
+}
+
+// Swap the last body of a category's arrays into the given index and pop it,
+// pointing the moved body's slot at its new index
+static void physics_body_array_remove(struct PhysicsWorld *physics_world, PhysicsBodyCategory category, unsigned int index){
+  unsigned int *num_bodies, *max_bodies;
+  struct PhysicsBody *bodies = *physics_body_array(physics_world, category, &num_bodies, &max_bodies);
+  struct PhysicsBodyCold *cold = *physics_body_cold_array(physics_world, category);
+  unsigned int last = *num_bodies - 1;
+  if (index != last){
+    bodies[index] = bodies[last];
+    cold[index] = cold[last];
+    physics_world->body_slots[PHYSICS_HANDLE_INDEX(bodies[index].handle)].index = index;
+  }
+  (*num_bodies)--;
+  // The sleeping islands kept between steps are indexed by dynamic body
+  if (category == PHYSICS_BODY_DYNAMIC) physics_world->islands.dirty = true;
+}
+
+// Take a slot from the free list, or a new one from the end of the table
+static int physics_body_slot_alloc(struct PhysicsWorld *physics_world){
+  if (physics_world->free_body_slot != -1){
+    int slot_index = physics_world->free_body_slot;
+    physics_world->free_body_slot = physics_world->body_slots[slot_index].next_free;
+    return slot_index;
+  }
+
+  if (physics_world->num_body_slots > PHYSICS_HANDLE_INDEX_MASK){
+    fprintf(stderr, "Error: out of body handles in physics_body_slot_alloc\n");
+    return -1;
+  }
+  if (physics_world->num_body_slots == physics_world->max_body_slots){
+    unsigned int new_max_slots = physics_world->max_body_slots ? physics_world->max_body_slots * 2 : INITIAL_BODY_CAPACITY;
+    struct PhysicsBodySlot *new_slots = (struct PhysicsBodySlot *)realloc(physics_world->body_slots, new_max_slots * sizeof(struct PhysicsBodySlot));
+    if (!new_slots){
+      fprintf(stderr, "Error: failed to realloc body slots in physics_body_slot_alloc\n");
+      return -1;
+    }
+    physics_world->body_slots = new_slots;
+    physics_world->max_body_slots = new_max_slots;
+  }
+  int slot_index = (int)physics_world->num_body_slots++;
+  physics_world->body_slots[slot_index].generation = 1;
+  return slot_index;
+}
+
+// Allocate a body and the slot for its handle
+static struct PhysicsBody *physics_body_create(struct PhysicsWorld *physics_world, PhysicsBodyCategory category){
+  int slot_index = physics_body_slot_alloc(physics_world);
+  if (slot_index == -1) return NULL;
+  struct PhysicsBodySlot *slot = &physics_world->body_slots[slot_index];
+
+  unsigned int index;
+  struct PhysicsBody *body = physics_body_array_push(physics_world, category, &index);
+  if (!body){
+    slot->next_free = physics_world->free_body_slot;
+    physics_world->free_body_slot = slot_index;
+    return NULL;
+  }
+
+  slot->index = index;
+  slot->category = category;
+  slot->active = true;
+  body->handle = PHYSICS_MAKE_HANDLE(slot_index, slot->generation);
+
+  // Proxies are created lazily in the first physics_step,
+  // once the scene has built the node's world transform
+  body->proxy_id = DYNAMIC_TREE_NULL_NODE;
+  body->sap_proxy_id = SAP_NULL_PROXY;
+  return body;
+}
+
+static struct PhysicsBodySlot *physics_get_body_slot(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle){
+  unsigned int slot_index = PHYSICS_HANDLE_INDEX(handle);
+  if (handle == PHYSICS_NULL_HANDLE || slot_index >= physics_world->num_body_slots) return NULL;
+  struct PhysicsBodySlot *slot = &physics_world->body_slots[slot_index];
+  if (!slot->active || slot->generation != PHYSICS_HANDLE_GENERATION(handle)) return NULL;
+  return slot;
+}
+
+// Current location of a body, or NULL if the handle is null or the body has been removed.
+// The pointer is only good until the next add, remove, or physics_body_set_dynamic
+struct PhysicsBody *physics_get_body(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle){
+  struct PhysicsBodySlot *slot = physics_get_body_slot(physics_world, handle);
+  if (!slot) return NULL;
+  unsigned int *num_bodies, *max_bodies;
+  struct PhysicsBody *bodies = *physics_body_array(physics_world, slot->category, &num_bodies, &max_bodies);
+  return &bodies[slot->index];
+}
 
+// Cold data of a body, or NULL if the handle is null or the body has been removed.
+// Same lifetime as physics_get_body's pointer
+struct PhysicsBodyCold *physics_get_body_cold(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle){
+  struct PhysicsBodySlot *slot = physics_get_body_slot(physics_world, handle);
+  if (!slot) return NULL;
+  return &(*physics_body_cold_array(physics_world, slot->category))[slot->index];
+}
+
+// Point a new body's cold entry at its entity and node, and copy the entity type it resolves with
+static void physics_body_init_cold(struct PhysicsWorld *physics_world, struct PhysicsBody *body, struct SceneNode *scene_node, struct Entity *entity){
+  struct PhysicsBodyCold *cold = physics_get_body_cold(physics_world, body->handle);
+  cold->entity = entity;
+  cold->scene_node = scene_node;
+  body->entity_type = entity ? entity->type : ENTITY_WORLD;
+}
+
+// Put a new body on its entity type's layer
+static void physics_body_init_layer(struct PhysicsWorld *physics_world, struct PhysicsBody *body, struct Entity *entity){
+  int layer = entity ? (int)entity->type : ENTITY_WORLD;
+  body->collision_layer = 1u << layer;
+  body->collision_mask = physics_layers_mask(&physics_world->layers, body->collision_layer);
+}
+
+PhysicsBodyHandle physics_add_body(struct PhysicsWorld *physics_world, struct SceneNode *scene_node, struct Entity *entity, struct Collider collider, float restitution, bool dynamic){
   // Check type validity
   if (collider.type < 0 || collider.type > COLLIDER_COUNT){
     fprintf(stderr, "Error: collider type provided to physics_add_body is invalid\n");
-    return NULL;
+    return PHYSICS_NULL_HANDLE;
+  }
+
+  // Mesh queries assume the mesh never moves, and planes have no narrow phase against meshes
+  if ((collider.type == COLLIDER_MESH || collider.type == COLLIDER_PLANE) && dynamic){
+    fprintf(stderr, "Error: mesh and plane colliders must be static in physics_add_body, adding as static\n");
+    dynamic = false;
+  }
+
+  struct PhysicsBody *body = physics_body_create(physics_world, dynamic ? PHYSICS_BODY_DYNAMIC : PHYSICS_BODY_STATIC);
+  if (!body){
+    fprintf(stderr, "Error: failed to create body in physics_add_body\n");
+    return PHYSICS_NULL_HANDLE;
+  }
+  if (dynamic){
+    glm_vec3_copy(entity->velocity, body->velocity);
   }
 
   // Get position, rotation, and scale from world transform
@@ -109,492 +365,575 @@ struct PhysicsBody *body;
   // glm_vec3_copy(world_scale, body->scale);
 
   glm_vec3_copy(entity->position, body->position);
-  glm_vec3_copy(entity->rotation, body->rotation);
+  glm_quat_copy(entity->rotation, body->rotation);
   glm_vec3_copy(entity->scale, body->scale);
+  glm_vec3_copy(body->position, body->previous_position);
+  glm_quat_copy(body->rotation, body->previous_rotation);
   body->collider = collider;
   body->restitution = restitution;
   body->dynamic = dynamic;
-  body->entity = entity;
-  body->scene_node = scene_node;
+  physics_body_init_cold(physics_world, body, scene_node, entity);
+  physics_body_init_layer(physics_world, body, entity);
 
-  return body;
+  return body->handle;
 }
 
-struct PhysicsBody *physics_add_player(struct PhysicsWorld *physics_world, struct SceneNode *scene_node, struct Entity *entity, struct Collider collider){
+PhysicsBodyHandle physics_add_player(struct PhysicsWorld *physics_world, struct SceneNode *scene_node, struct Entity *entity, struct Collider collider){
   // Check type validity
-  if (collider.type < 0 || collider.type > COLLIDER_COUNT){
+  if (collider.type < 0 || collider.type > COLLIDER_COUNT || collider.type == COLLIDER_MESH){
     fprintf(stderr, "Error: collider type provided to physics_add_body is invalid\n");
-    return NULL;
+    return PHYSICS_NULL_HANDLE;
+  }
+  struct PhysicsBody *body = physics_body_create(physics_world, PHYSICS_BODY_PLAYER);
+  if (!body){
+    fprintf(stderr, "Error: failed to create body in physics_add_player\n");
+    return PHYSICS_NULL_HANDLE;
   }
-  struct PhysicsBody *body;
-  body = &physics_world->player_bodies[physics_world->num_player_bodies++];
 
   glm_vec3_copy(entity->position, body->position);
-  glm_vec3_copy(entity->rotation, body->rotation);
-  glm_vec3_copy(entity->scale, body->scale);
   glm_vec3_copy(entity->velocity, body->velocity);
+  glm_quat_copy(entity->rotation, body->rotation);
+  glm_vec3_copy(entity->scale, body->scale);
+  glm_vec3_copy(body->position, body->previous_position);
+  glm_quat_copy(body->rotation, body->previous_rotation);
   body->collider = collider;
   body->restitution = 0.0f;
-  body->entity = entity;
-  body->scene_node = scene_node;
+  physics_body_init_cold(physics_world, body, scene_node, entity);
+  physics_body_init_layer(physics_world, body, entity);
 
-  return body;
+  return body->handle;
 }
 
-// Swap and pop bodies in their arrays.
-// PhysicsWorld directly stores the bodies rather than an array of pointers,
-// so the associated Entity needs a new pointer to the location of its PhysicsBody
-void physics_remove_body(struct PhysicsWorld *physics_world, struct PhysicsBody *physics_body){
-  for (unsigned int i = 0; i < physics_world->num_player_bodies; i++){
-    if (uuid_compare(physics_world->player_bodies[i].entity->id, physics_body->entity->id) == 0){
-      physics_world->player_bodies[i] = physics_world->player_bodies[physics_world->num_player_bodies - 1];
-      physics_world->player_bodies[i].entity->physics_body = &physics_world->player_bodies[i];
-      physics_world->num_player_bodies--;
-      return;
-    }
+// Triggers only report overlaps with players, see physics/trigger.h.
+// They need a bounded convex collider for the overlap test
+PhysicsBodyHandle physics_add_trigger(struct PhysicsWorld *physics_world, struct SceneNode *scene_node, struct Entity *entity, struct Collider collider){
+  if (collider.type < 0 || collider.type >= COLLIDER_COUNT || collider.type == COLLIDER_PLANE || collider.type == COLLIDER_MESH){
+    fprintf(stderr, "Error: collider type provided to physics_add_trigger is invalid\n");
+    return PHYSICS_NULL_HANDLE;
+  }
+  struct PhysicsBody *body = physics_body_create(physics_world, PHYSICS_BODY_TRIGGER);
+  if (!body){
+    fprintf(stderr, "Error: failed to create body in physics_add_trigger\n");
+    return PHYSICS_NULL_HANDLE;
   }
-  for (unsigned int i = 0; i < physics_world->num_static_bodies; i++){
-    if (uuid_compare(physics_world->static_bodies[i].entity->id, physics_body->entity->id) == 0){
-      physics_world->static_bodies[i] = physics_world->static_bodies[physics_world->num_static_bodies - 1];
-      physics_world->static_bodies[i].entity->physics_body = &physics_world->static_bodies[i];
-      physics_world->num_static_bodies--;
-      return;
+
+  glm_vec3_copy(entity->position, body->position);
+  glm_quat_copy(entity->rotation, body->rotation);
+  glm_vec3_copy(entity->scale, body->scale);
+  glm_vec3_copy(body->position, body->previous_position);
+  glm_quat_copy(body->rotation, body->previous_rotation);
+  body->collider = collider;
+  physics_body_init_cold(physics_world, body, scene_node, entity);
+  physics_body_init_layer(physics_world, body, entity);
+  physics_world->triggers.pending = true;
+
+  return body->handle;
+}
+
+// Swap and pop the body out of its array, then retire its slot.
+// Bumping the generation makes every outstanding handle to it resolve to NULL
+void physics_remove_body(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle){
+  struct PhysicsBodySlot *slot = physics_get_body_slot(physics_world, handle);
+  if (!slot) return;
+  struct PhysicsBody *physics_body = physics_get_body(physics_world, handle);
+
+  if (physics_body->proxy_id != DYNAMIC_TREE_NULL_NODE){
+    struct DynamicTree *tree = slot->category == PHYSICS_BODY_TRIGGER ? &physics_world->triggers.tree : &physics_world->tree;
+    dynamic_tree_destroy_proxy(tree, physics_body->proxy_id);
+  }
+  if (physics_body->sap_proxy_id != SAP_NULL_PROXY){
+    sap_destroy_proxy(&physics_world->sap, physics_body->sap_proxy_id);
+  }
+
+  physics_body_array_remove(physics_world, slot->category, slot->index);
+
+  slot->active = false;
+  slot->generation = slot->generation == PHYSICS_HANDLE_MAX_GENERATION ? 1 : slot->generation + 1;
+  slot->next_free = physics_world->free_body_slot;
+  physics_world->free_body_slot = (int)PHYSICS_HANDLE_INDEX(handle);
+}
+
+// Move a body between the static and dynamic arrays. Its handle and broad phase
+// proxies stay the same, the pair stages just start or stop refitting them.
+// Players and triggers can't change category, and meshes and planes can't be dynamic
+bool physics_body_set_dynamic(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle, bool dynamic){
+  struct PhysicsBodySlot *slot = physics_get_body_slot(physics_world, handle);
+  if (!slot){
+    fprintf(stderr, "Error: invalid handle in physics_body_set_dynamic\n");
+    return false;
+  }
+  if (slot->category == PHYSICS_BODY_PLAYER || slot->category == PHYSICS_BODY_TRIGGER){
+    fprintf(stderr, "Error: can't change player or trigger body category in physics_body_set_dynamic\n");
+    return false;
+  }
+  PhysicsBodyCategory category = dynamic ? PHYSICS_BODY_DYNAMIC : PHYSICS_BODY_STATIC;
+  if (slot->category == category) return true;
+  ColliderType collider_type = physics_get_body(physics_world, handle)->collider.type;
+  if (dynamic && (collider_type == COLLIDER_MESH || collider_type == COLLIDER_PLANE)){
+    fprintf(stderr, "Error: mesh and plane colliders must be static in physics_body_set_dynamic\n");
+    return false;
+  }
+
+  // Push first so a failed grow leaves the body where it was
+  unsigned int index;
+  struct PhysicsBody *body = physics_body_array_push(physics_world, category, &index);
+  if (!body) return false;
+  *body = *physics_get_body(physics_world, handle);
+  (*physics_body_cold_array(physics_world, category))[index] = *physics_get_body_cold(physics_world, handle);
+  physics_body_array_remove(physics_world, slot->category, slot->index);
+  slot->category = category;
+  slot->index = index;
+
+  body->dynamic = dynamic;
+  body->sleeping = false;
+  body->sleep_counter = 0;
+  body->at_rest = false;
+  if (!dynamic){
+    glm_vec3_zero(body->velocity);
+  }
+  return true;
+}
+
+// Load a mesh for a mesh collider, or return the one already loaded from the same file
+struct TriangleMesh *physics_load_mesh(struct PhysicsWorld *physics_world, const char *path){
+  for (unsigned int i = 0; i < physics_world->num_meshes; i++){
+    if (strcmp(physics_world->meshes[i]->path, path) == 0){
+      return physics_world->meshes[i];
     }
   }
-  for (unsigned int i = 0; i < physics_world->num_dynamic_bodies; i++){
-    if (uuid_compare(physics_world->dynamic_bodies[i].entity->id, physics_body->entity->id) == 0){
-      physics_world->dynamic_bodies[i] = physics_world->dynamic_bodies[physics_world->num_dynamic_bodies - 1];
-      physics_world->dynamic_bodies[i].entity->physics_body = &physics_world->dynamic_bodies[i];
-      physics_world->num_dynamic_bodies--;
-      return;
+
+  if (physics_world->num_meshes == physics_world->max_meshes){
+    unsigned int new_max_meshes = physics_world->max_meshes ? physics_world->max_meshes * 2 : 4;
+    struct TriangleMesh **new_meshes = (struct TriangleMesh **)realloc(physics_world->meshes, new_max_meshes * sizeof(struct TriangleMesh *));
+    if (!new_meshes){
+      fprintf(stderr, "Error: failed to realloc meshes in physics_load_mesh\n");
+      return NULL;
     }
+    physics_world->meshes = new_meshes;
+    physics_world->max_meshes = new_max_meshes;
   }
+
+  struct TriangleMesh *mesh = triangle_mesh_load(path);
+  if (!mesh){
+    fprintf(stderr, "Error: failed to load mesh %s in physics_load_mesh\n", path);
+    return NULL;
+  }
+  physics_world->meshes[physics_world->num_meshes++] = mesh;
+  return mesh;
 }
 
-void physics_step(struct PhysicsWorld *physics_world, float delta_time){
-  if (delta_time > MAX_DELTA_TIME){
-    delta_time = MAX_DELTA_TIME;
+// COLLISION LAYERS
+//
+// Move a body onto a single layer, and pick up that layer's row of the matrix
+bool physics_body_set_layer(struct PhysicsWorld *physics_world, PhysicsBodyHandle handle, int layer){
+  struct PhysicsBody *body = physics_get_body(physics_world, handle);
+  if (!body){
+    fprintf(stderr, "Error: invalid handle in physics_body_set_layer\n");
+    return false;
+  }
+  if (layer < 0 || layer >= (int)physics_world->layers.num_layers){
+    fprintf(stderr, "Error: invalid layer %d in physics_body_set_layer\n", layer);
+    return false;
   }
+  body->collision_layer = 1u << layer;
+  body->collision_mask = physics_layers_mask(&physics_world->layers, body->collision_layer);
+  return true;
+}
 
-  // Player bodies vs static bodies
-  for (unsigned int i = 0; i < physics_world->num_player_bodies; i++){
-    struct PhysicsBody *body_A = &physics_world->player_bodies[i];
+static void physics_update_collision_masks(struct PhysicsWorld *physics_world, struct PhysicsBody *bodies, unsigned int num_bodies){
+  for (unsigned int i = 0; i < num_bodies; i++){
+    bodies[i].collision_mask = physics_layers_mask(&physics_world->layers, bodies[i].collision_layer);
+  }
+}
 
-    for (unsigned int j = 0; j < physics_world->num_static_bodies; j++){
-      struct PhysicsBody *body_B = &physics_world->static_bodies[j];
+// Change the matrix and rebuild every body's mask from it.
+// Pairs that stop colliding drop out at the next pair generation
+void physics_set_layer_collision(struct PhysicsWorld *physics_world, int layer_A, int layer_B, bool collides){
+  physics_layers_set_collision(&physics_world->layers, layer_A, layer_B, collides);
+  physics_update_collision_masks(physics_world, physics_world->static_bodies, physics_world->num_static_bodies);
+  physics_update_collision_masks(physics_world, physics_world->dynamic_bodies, physics_world->num_dynamic_bodies);
+  physics_update_collision_masks(physics_world, physics_world->player_bodies, physics_world->num_player_bodies);
+  physics_update_collision_masks(physics_world, physics_world->trigger_bodies, physics_world->num_trigger_bodies);
+}
 
-      // Order bodies by enum value for function tables
-      bool body_swap = false;
-      if (body_A->collider.type > body_B->collider.type){
-        struct PhysicsBody *temp = body_A;
-        body_A = body_B;
-        body_B = temp;
-        body_swap = true;
-      }
+// The matrix is symmetric, so one side's layer against the other's mask is enough
+bool physics_bodies_can_collide(struct PhysicsBody *body_A, struct PhysicsBody *body_B){
+  return (body_A->collision_layer & body_B->collision_mask) != 0;
+}
 
-      // BROAD PHASE: Create a hit_time float and perform interval halving
-      float hit_time;
-      struct CollisionResult result = {0};
-      if (interval_collision(body_A, body_B, 0, delta_time, &hit_time)){
-        // NARROW PHASE
-        NarrowPhaseFunction narrow_phase_function = narrow_phase_functions[body_A->collider.type][body_B->collider.type];
-        if (!narrow_phase_function){
-          fprintf(stderr, "Error: no narrow phase function found for collider types %d, %d\n", body_A->collider.type, body_B->collider.type);
-        }
-        else{
-          result = narrow_phase_function(body_A, body_B, delta_time);
-        }
+// WORLD COLLIDER CACHE
+//
+// Build the body's world space collider from its transforms.
+// AABBs, OBBs, meshes and spheres follow their scene node, capsules follow the body itself
+// (the player's node transform lags a step behind its body),
+// and planes store their normal and distance relative to their parent node.
+// Node transforms are read from the TRS the scene caches alongside world_transform, see struct SceneNode
+void physics_body_update_world_collider(struct PhysicsBody *body, struct SceneNode *scene_node){
+  struct Collider *collider = &body->collider;
+  union ColliderData *world = &body->world_collider.data;
+  glm_vec3_copy(body->position, body->world_collider.origin);
+
+  switch(collider->type){
+    case COLLIDER_AABB: {
+      if (scene_node){
+        mat3 rotation_mat3;
+        glm_quat_mat3(scene_node->world_rotation, rotation_mat3);
+        AABB_update(&collider->data.aabb, rotation_mat3, scene_node->world_position, scene_node->world_scale, &world->aabb);
       }
-
-      // COLLISION RESOLUTION
-      if (result.colliding && result.hit_time >= 0){
-        // Determine resolution strategy
-        EntityType type_A = body_A->entity->type;
-        EntityType type_B = body_B->entity->type;
-        CollisionBehavior behavior = get_collision_behavior(type_A, type_B);
-
-        // Get appropriate resolution function for the given CollisionBehavior
-        switch(behavior){
-          case COLLISION_BEHAVIOR_PHYSICS:
-            ResolutionFunction resolution_function = resolution_functions[body_A->collider.type][body_B->collider.type];
-            if (!resolution_function){
-              fprintf(stderr, "Error: no collision resolution function found for types %d, %d\n", body_A->collider.type, body_B->collider.type);
-            }
-            else{
-              resolution_function(body_A, body_B, result, delta_time);
-            }
-            break;
-          case COLLISION_BEHAVIOR_TRIGGER:
-            break;
-        }
-
-        // Generate Event
-        struct GameEvent event;
-        struct timespec timestamp;
-        if (clock_gettime(CLOCK_REALTIME, &timestamp) == -1){
-          perror("clock_gettime");
-          timestamp.tv_nsec = 0;
-        }
-        event.timestamp = timestamp;
-
-        // TODO refactor to a more robust soln that determines which is the item.
-        // This works in my case because a Player is always a capsule,
-        // and an item will always be an AABB.
-        // (We CAN still assume one of the bodies is a Player because we're looping over player_bodies here.)
-        event.type = get_event_type(type_A, type_B);
-        switch(event.type){
-          case EVENT_COLLISION:
-            memcpy(event.data.collision.entity_A_id, body_A->entity->id, 16);
-            memcpy(event.data.collision.entity_B_id, body_B->entity->id, 16);
-            break;
-          case EVENT_PLAYER_ITEM_PICKUP:
-            // TODO player ID, physicsbody/world has knowledge of it somehow
-            memcpy(event.data.item_pickup.player_entity_id, body_B->entity->id, 16);
-            event.data.item_pickup.item_id = body_A->entity->item->id;
-            event.data.item_pickup.item_count = body_A->entity->item->count;
-            memcpy(event.data.item_pickup.item_entity_id, body_A->entity->id, 16);
-            break;
-        }
-
-        game_event_queue_enqueue(event);
+      else{
+        glm_vec3_add(collider->data.aabb.center, body->position, world->aabb.center);
+        glm_vec3_mul(collider->data.aabb.extents, body->scale, world->aabb.extents);
       }
-
-      // Reorder bodies by enum value
-      if (body_swap){
-        struct PhysicsBody *temp = body_A;
-        body_A = body_B;
-        body_B = temp;
+      world->aabb.initialized = true;
+      break;
+    }
+    case COLLIDER_SPHERE: {
+      float *world_position = scene_node ? scene_node->world_position : body->position;
+      float *world_scale = scene_node ? scene_node->world_scale : body->scale;
+      glm_vec3_add(collider->data.sphere.center, world_position, world->sphere.center);
+      world->sphere.radius = collider->data.sphere.radius * fabsf(world_scale[0]);
+      break;
+    }
+    case COLLIDER_CAPSULE: {
+      struct Capsule *capsule = &collider->data.capsule;
+      glm_vec3_scale(capsule->segment_A, body->scale[0], world->capsule.segment_A);
+      glm_vec3_scale(capsule->segment_B, body->scale[0], world->capsule.segment_B);
+      glm_quat_rotatev(body->rotation, world->capsule.segment_A, world->capsule.segment_A);
+      glm_quat_rotatev(body->rotation, world->capsule.segment_B, world->capsule.segment_B);
+      glm_vec3_add(world->capsule.segment_A, body->position, world->capsule.segment_A);
+      glm_vec3_add(world->capsule.segment_B, body->position, world->capsule.segment_B);
+      world->capsule.radius = capsule->radius * body->scale[0];
+      break;
+    }
+    case COLLIDER_PLANE: {
+      struct Plane *plane = &collider->data.plane;
+      glm_vec3_copy(plane->normal, world->plane.normal);
+      world->plane.distance = plane->distance;
+      if (scene_node && scene_node->parent_node){
+        struct SceneNode *parent_node = scene_node->parent_node;
+        glm_quat_rotatev(parent_node->world_rotation, plane->normal, world->plane.normal);
+        glm_vec3_normalize(world->plane.normal);
+        world->plane.distance = plane->distance + glm_vec3_dot(parent_node->world_position, world->plane.normal);
       }
+      break;
     }
-    // if (!body_A->at_rest){
-    //   float gravity = 9.8f;
-    //   body_A->velocity[1] -= gravity * delta_time;
-    //   glm_vec3_muladds(body_A->velocity, delta_time, body_A->position);
-    // }
-  }
-
-  // Player bodies vs dynamic bodies
-  for (unsigned int i = 0; i < physics_world->num_player_bodies; i++){
-    struct PhysicsBody *body_A = &physics_world->player_bodies[i];
-
-    for (unsigned int j = 0; j < physics_world->num_dynamic_bodies; j++){
-      struct PhysicsBody *body_B = &physics_world->dynamic_bodies[j];
-
-      // Order bodies by enum value for function tables
-      bool body_swap = false;
-      if (body_A->collider.type > body_B->collider.type){
-        struct PhysicsBody *temp = body_A;
-        body_A = body_B;
-        body_B = temp;
-        body_swap = true;
+    case COLLIDER_OBB: {
+      // Same transforms as an AABB, but the rotation is kept in the box's axes
+      mat3 rotation_mat3;
+      float *world_position, *world_scale;
+      if (scene_node){
+        glm_quat_mat3(scene_node->world_rotation, rotation_mat3);
+        world_position = scene_node->world_position;
+        world_scale = scene_node->world_scale;
       }
-
-      // BROAD PHASE: Create a hit_time float and perform interval halving
-      float hit_time;
-      struct CollisionResult result = {0};
-      if (interval_collision(body_A, body_B, 0, delta_time, &hit_time)){
-        // NARROW PHASE
-        NarrowPhaseFunction narrow_phase_function = narrow_phase_functions[body_A->collider.type][body_B->collider.type];
-        if (!narrow_phase_function){
-          fprintf(stderr, "Error: no narrow phase function found for collider types %d, %d\n", body_A->collider.type, body_B->collider.type);
-        }
-        else{
-          result = narrow_phase_function(body_A, body_B, delta_time);
-        }
+      else{
+        glm_quat_mat3(body->rotation, rotation_mat3);
+        world_position = body->position;
+        world_scale = body->scale;
       }
-
-      // COLLISION RESOLUTION
-      if (result.colliding && result.hit_time >= 0){
-        // Determine resolution strategy
-        EntityType type_A = body_A->entity->type;
-        EntityType type_B = body_B->entity->type;
-        CollisionBehavior behavior = get_collision_behavior(type_A, type_B);
-
-        // Get appropriate resolution function for the given CollisionBehavior
-        switch(behavior){
-          case COLLISION_BEHAVIOR_PHYSICS:
-            ResolutionFunction resolution_function = resolution_functions[body_A->collider.type][body_B->collider.type];
-            if (!resolution_function){
-              fprintf(stderr, "Error: no collision resolution function found for types %d, %d\n", body_A->collider.type, body_B->collider.type);
-            }
-            else{
-              resolution_function(body_A, body_B, result, delta_time);
-            }
-            break;
-          case COLLISION_BEHAVIOR_TRIGGER:
-            break;
-        }
-
-        // Generate Event
-        struct GameEvent event;
-        struct timespec timestamp;
-        if (clock_gettime(CLOCK_REALTIME, &timestamp) == -1){
-          perror("clock_gettime");
-          timestamp.tv_nsec = 0;
-        }
-        event.timestamp = timestamp;
-
-        event.type = get_event_type(type_A, type_B);
-        switch(event.type){
-          case EVENT_COLLISION:
-            memcpy(event.data.collision.entity_A_id, body_A->entity->id, 16);
-            memcpy(event.data.collision.entity_B_id, body_B->entity->id, 16);
-            break;
-          case EVENT_PLAYER_ITEM_PICKUP:
-            // TODO player ID, physicsbody/world has knowledge of it somehow
-            memcpy(event.data.item_pickup.player_entity_id, body_B->entity->id, 16);
-            event.data.item_pickup.item_id = body_A->entity->item->id;
-            event.data.item_pickup.item_count = body_A->entity->item->count;
-            memcpy(event.data.item_pickup.item_entity_id, body_A->entity->id, 16);
-            break;
-        }
-
-        game_event_queue_enqueue(event);
+      OBB_update(&collider->data.obb, rotation_mat3, world_position, world_scale, &world->obb);
+      break;
+    }
+    case COLLIDER_MESH: {
+      // Level geometry: transformed by its node like an AABB, with uniform scale
+      struct MeshCollider *mesh = &world->mesh;
+      mesh->mesh = collider->data.mesh.mesh;
+      if (scene_node){
+        glm_vec3_copy(scene_node->world_position, mesh->translation);
+        glm_quat_mat3(scene_node->world_rotation, mesh->rotation);
+        mesh->scale = scene_node->world_scale[0];
       }
-
-      // Reorder bodies by enum value
-      if (body_swap){
-        struct PhysicsBody *temp = body_A;
-        body_A = body_B;
-        body_B = temp;
+      else{
+        glm_quat_mat3(body->rotation, mesh->rotation);
+        glm_vec3_copy(body->position, mesh->translation);
+        mesh->scale = body->scale[0];
       }
+      break;
     }
-    if (!body_A->at_rest){
-      float gravity = 9.8f;
-      body_A->velocity[1] -= gravity * delta_time;
-      glm_vec3_muladds(body_A->velocity, delta_time, body_A->position);
-    }
+    default:
+      fprintf(stderr, "Error: invalid collider type %d in physics_body_update_world_collider\n", collider->type);
+      break;
   }
+}
 
-  for(unsigned int i = 0; i < physics_world->num_dynamic_bodies; i++){
-    struct PhysicsBody *body_A = &physics_world->dynamic_bodies[i];
-
-    // Collision detection will be off sometimes with AABBs.
-    // I think this is because of angular velocity not being considered.
-    // This should work fine with spheres, though.
-    // body_A->rotation[0] += 100.0f * delta_time;
-    // body_A->rotation[0] = fmodf(body_A->rotation[0], 360);
-    // body_A->rotation[1] += 100.0f * delta_time;
-    // body_A->rotation[1] = fmodf(body_A->rotation[1], 360);
-    // body_A->rotation[2] += 100.0f * delta_time;
-    // body_A->rotation[2] = fmodf(body_A->rotation[2], 360);
-    // if (body_A->rotation[0] < 0.0f){
-    //   body_A->rotation[0] += 360;
-    // }
-    // if (body_A->rotation[1] < 0.0f){
-    //   body_A->rotation[1] += 360;
-    // }
-    // if (body_A->rotation[2] < 0.0f){
-    //   body_A->rotation[2] += 360;
-    // }
-
-    for (unsigned int j = 0; j < physics_world->num_static_bodies; j++){
-      struct PhysicsBody *body_B = &physics_world->static_bodies[j];
-
-      // Order bodies by enum value for function tables
-      bool body_swap = false;
-      if (body_A->collider.type > body_B->collider.type){
-        struct PhysicsBody *temp = body_A;
-        body_A = body_B;
-        body_B = temp;
-        body_swap = true;
-      }
+// Sleeping bodies keep the collider they fell asleep with
+static void physics_update_world_collider_array(struct PhysicsBody *bodies, struct PhysicsBodyCold *cold, unsigned int num_bodies){
+  for (unsigned int i = 0; i < num_bodies; i++){
+    if (bodies[i].sleeping) continue;
+    physics_body_update_world_collider(&bodies[i], cold[i].scene_node);
+  }
+}
 
-      // BROAD PHASE: Create a hit_time float and perform interval halving
-      float hit_time;
-      struct CollisionResult result = {0};
-      if (interval_collision(body_A, body_B, 0, delta_time, &hit_time)){
-        // NARROW PHASE
-        NarrowPhaseFunction narrow_phase_function = narrow_phase_functions[body_A->collider.type][body_B->collider.type];
-        if (!narrow_phase_function){
-          fprintf(stderr, "Error: no narrow phase function found for collider types %d, %d\n",
-                  body_A->collider.type, body_B->collider.type);
-        }
-        else{
-          result = narrow_phase_function(body_A, body_B, delta_time);
-        }
-      }
+// Rebuild every body's world collider. Called once at the start of physics_step,
+// so the distance, narrow phase and resolution functions never touch transforms.
+void physics_update_world_colliders(struct PhysicsWorld *physics_world){
+  physics_update_world_collider_array(physics_world->static_bodies, physics_world->static_cold, physics_world->num_static_bodies);
+  physics_update_world_collider_array(physics_world->dynamic_bodies, physics_world->dynamic_cold, physics_world->num_dynamic_bodies);
+  physics_update_world_collider_array(physics_world->player_bodies, physics_world->player_cold, physics_world->num_player_bodies);
+}
+
+// How far the body's cached collider has moved at the given time into the step:
+// any change to its position since the cache was built (e.g. by resolution),
+// plus its velocity over time
+void physics_body_world_offset(struct PhysicsBody *body, float time, vec3 dest){
+  glm_vec3_sub(body->position, body->world_collider.origin, dest);
+  glm_vec3_muladds(body->velocity, time, dest);
+}
+
+void physics_body_get_world_AABB(struct PhysicsBody *body, float time, struct AABB *dest){
+  vec3 offset;
+  physics_body_world_offset(body, time, offset);
+  *dest = body->world_collider.data.aabb;
+  glm_vec3_add(dest->center, offset, dest->center);
+}
+
+void physics_body_get_world_sphere(struct PhysicsBody *body, float time, struct Sphere *dest){
+  vec3 offset;
+  physics_body_world_offset(body, time, offset);
+  *dest = body->world_collider.data.sphere;
+  glm_vec3_add(dest->center, offset, dest->center);
+}
+
+void physics_body_get_world_capsule(struct PhysicsBody *body, float time, struct Capsule *dest){
+  vec3 offset;
+  physics_body_world_offset(body, time, offset);
+  *dest = body->world_collider.data.capsule;
+  glm_vec3_add(dest->segment_A, offset, dest->segment_A);
+  glm_vec3_add(dest->segment_B, offset, dest->segment_B);
+}
+
+void physics_body_get_world_plane(struct PhysicsBody *body, float time, struct Plane *dest){
+  vec3 offset;
+  physics_body_world_offset(body, time, offset);
+  *dest = body->world_collider.data.plane;
+  dest->distance += glm_vec3_dot(offset, dest->normal);
+}
+
+void physics_body_get_world_OBB(struct PhysicsBody *body, float time, struct OBB *dest){
+  vec3 offset;
+  physics_body_world_offset(body, time, offset);
+  *dest = body->world_collider.data.obb;
+  glm_vec3_add(dest->center, offset, dest->center);
+}
+
+void physics_body_get_world_mesh(struct PhysicsBody *body, float time, struct MeshCollider *dest){
+  vec3 offset;
+  physics_body_world_offset(body, time, offset);
+  *dest = body->world_collider.data.mesh;
+  glm_vec3_add(dest->translation, offset, dest->translation);
+}
 
-      // COLLISION RESOLUTION
-      if (result.colliding && result.hit_time >= 0){
-        // Determine resolution strategy
-        EntityType type_A = body_A->entity->type;
-        EntityType type_B = body_B->entity->type;
-        CollisionBehavior behavior = get_collision_behavior(type_A, type_B);
-
-        // Get appropriate resolution function for the given CollisionBehavior
-        switch(behavior){
-          case COLLISION_BEHAVIOR_PHYSICS:
-            ResolutionFunction resolution_function = resolution_functions[body_A->collider.type][body_B->collider.type];
-            if (!resolution_function){
-              fprintf(stderr, "Error: no collision resolution function found for types %d, %d\n", body_A->collider.type, body_B->collider.type);
-            }
-            else{
-              resolution_function(body_A, body_B, result, delta_time);
-            }
-            break;
-          case COLLISION_BEHAVIOR_TRIGGER:
-            break;
-        }
-
-        // Generate Event
-        struct GameEvent event;
-        struct timespec timestamp;
-        if (clock_gettime(CLOCK_REALTIME, &timestamp) == -1){
-          perror("clock_gettime");
-          timestamp.tv_nsec = 0;
-        }
-        event.timestamp = timestamp;
-        event.type = get_event_type(type_A, type_B);
-
-        switch(event.type){
-          case EVENT_COLLISION:
-            memcpy(event.data.collision.entity_A_id, body_A->entity->id, 16);
-            memcpy(event.data.collision.entity_B_id, body_B->entity->id, 16);
-            break;
-        }
-
-        game_event_queue_enqueue(event);
+// BROAD PHASE
+//
+// World space bounds of a body's collider at the given time into the step
+void physics_body_compute_AABB(struct PhysicsBody *body, float time, struct AABB *dest){
+  dest->initialized = true;
+
+  switch(body->collider.type){
+    case COLLIDER_AABB:
+      physics_body_get_world_AABB(body, time, dest);
+      break;
+    case COLLIDER_SPHERE: {
+      struct Sphere sphere;
+      physics_body_get_world_sphere(body, time, &sphere);
+      glm_vec3_copy(sphere.center, dest->center);
+      glm_vec3_fill(dest->extents, sphere.radius);
+      break;
+    }
+    case COLLIDER_CAPSULE: {
+      struct Capsule capsule;
+      physics_body_get_world_capsule(body, time, &capsule);
+      for (int i = 0; i < 3; i++){
+        dest->center[i] = (capsule.segment_A[i] + capsule.segment_B[i]) * 0.5f;
+        dest->extents[i] = fabsf(capsule.segment_B[i] - capsule.segment_A[i]) * 0.5f + capsule.radius;
       }
-      // Reorder bodies by enum value
-      if (body_swap){
-        struct PhysicsBody *temp = body_A;
-        body_A = body_B;
-        body_B = temp;
+      break;
+    }
+    case COLLIDER_PLANE: {
+      // Planes are infinite: bound a large disc around the point closest to the origin.
+      // A disc of radius R with normal n spans R * sqrt(1 - n_i^2) on each axis,
+      // so axis aligned floors and walls stay thin along their normal.
+      struct Plane plane;
+      physics_body_get_world_plane(body, time, &plane);
+      glm_vec3_scale(plane.normal, plane.distance, dest->center);
+      for (int i = 0; i < 3; i++){
+        float n = plane.normal[i];
+        dest->extents[i] = PLANE_BROAD_PHASE_EXTENT * sqrtf(glm_max(1.0f - n * n, 0.0f));
       }
+      break;
+    }
+    case COLLIDER_OBB: {
+      struct OBB obb;
+      physics_body_get_world_OBB(body, time, &obb);
+      OBB_to_AABB(&obb, dest);
+      break;
     }
-    // if (!body_A->at_rest){
-    //   float gravity = 9.8f;
-    //   body_A->velocity[1] -= gravity * delta_time;
-    //   glm_vec3_muladds(body_A->velocity, delta_time, body_A->position);
-    // }
+    case COLLIDER_MESH: {
+      struct MeshCollider mesh;
+      physics_body_get_world_mesh(body, time, &mesh);
+      mesh_collider_bounds(&mesh, dest);
+      break;
+    }
+    default:
+      fprintf(stderr, "Error: invalid collider type %d in physics_body_compute_AABB\n", body->collider.type);
+      glm_vec3_copy(body->position, dest->center);
+      glm_vec3_zero(dest->extents);
+      break;
   }
+}
 
-  for(unsigned int i = 0; i < physics_world->num_dynamic_bodies; i++){
-    struct PhysicsBody *body_A = &physics_world->dynamic_bodies[i];
+// Bounds covering the body over the whole step
+void physics_body_compute_swept_AABB(struct PhysicsBody *body, float delta_time, struct AABB *dest){
+  struct AABB start, end;
+  physics_body_compute_AABB(body, 0.0f, &start);
+  physics_body_compute_AABB(body, delta_time, &end);
+  AABB_union(&start, &end, dest);
+}
 
-    for(unsigned int j = 0; j < physics_world->num_dynamic_bodies; j++){
-      if (i == j) continue;
+void physics_set_broad_phase(struct PhysicsWorld *physics_world, BroadPhaseType broad_phase_type){
+  if (broad_phase_type < 0 || broad_phase_type >= BROAD_PHASE_COUNT){
+    fprintf(stderr, "Error: invalid broad phase type %d in physics_set_broad_phase\n", broad_phase_type);
+    return;
+  }
+  // Inactive broad phases keep their proxies.
+  // They are refit against each body's current bounds on their next step.
+  physics_world->broad_phase_type = broad_phase_type;
+  switch(broad_phase_type){
+    case BROAD_PHASE_BRUTE_FORCE:
+      physics_world->pipeline.generate_pairs = physics_generate_pairs_brute_force;
+      break;
+    case BROAD_PHASE_DYNAMIC_TREE:
+      physics_world->pipeline.generate_pairs = physics_generate_pairs_dynamic_tree;
+      break;
+    case BROAD_PHASE_SWEEP_AND_PRUNE:
+      physics_world->pipeline.generate_pairs = physics_generate_pairs_sweep_and_prune;
+      break;
+    default:
+      break;
+  }
+}
 
-      struct PhysicsBody *body_B = &physics_world->dynamic_bodies[j];
+void physics_set_solver_iterations(struct PhysicsWorld *physics_world, unsigned int iterations){
+  if (iterations == 0){
+    fprintf(stderr, "Error: solver needs at least one iteration in physics_set_solver_iterations\n");
+    return;
+  }
+  physics_world->solver.iterations = iterations;
+}
 
-      // Order bodies by enum value for function tables
-      bool body_swap = false;
-      if (body_A->collider.type > body_B->collider.type){
-        struct PhysicsBody *temp = body_A;
-        body_A = body_B;
-        body_B = temp;
-        body_swap = true;
-      }
+const char *physics_broad_phase_name(BroadPhaseType broad_phase_type){
+  switch(broad_phase_type){
+    case BROAD_PHASE_BRUTE_FORCE:
+      return "brute force";
+    case BROAD_PHASE_DYNAMIC_TREE:
+      return "dynamic tree";
+    case BROAD_PHASE_SWEEP_AND_PRUNE:
+      return "sweep and prune";
+    default:
+      return "unknown";
+  }
+}
 
-      float hit_time;
-      struct CollisionResult result = {0};
-      if (interval_collision(body_A, body_B, 0, delta_time, &hit_time)){
-        NarrowPhaseFunction narrow_phase_function = narrow_phase_functions[body_A->collider.type][body_B->collider.type];
-        if (!narrow_phase_function){
-        fprintf(stderr, "Error: no narrow phase function found for collider types %d, %d\n",
-                  body_A->collider.type, body_B->collider.type);
-        }
-        else{
-          result = narrow_phase_function(body_A, body_B, delta_time);
-        }
-      }
-      if (result.colliding && result.hit_time >= 0){
-        // Determine resolution strategy
-        EntityType type_A = body_A->entity->type;
-        EntityType type_B = body_B->entity->type;
-        CollisionBehavior behavior = get_collision_behavior(type_A, type_B);
-
-        // Get appropriate resolution function for the given CollisionBehavior
-        switch(behavior){
-          case COLLISION_BEHAVIOR_PHYSICS:
-            ResolutionFunction resolution_function = resolution_functions[body_A->collider.type][body_B->collider.type];
-            if (!resolution_function){
-              fprintf(stderr, "Error: no collision resolution function found for types %d, %d\n", body_A->collider.type, body_B->collider.type);
-            }
-            else{
-              resolution_function(body_A, body_B, result, delta_time);
-            }
-            break;
-          case COLLISION_BEHAVIOR_TRIGGER:
-            break;
-        }
-
-        // Generate Event
-        struct GameEvent event;
-        struct timespec timestamp;
-        if (clock_gettime(CLOCK_REALTIME, &timestamp) == -1){
-          perror("clock_gettime");
-          timestamp.tv_nsec = 0;
-        }
-        event.timestamp = timestamp;
-        event.type = get_event_type(type_A, type_B);
-
-        switch(event.type){
-          case EVENT_COLLISION:
-            memcpy(event.data.collision.entity_A_id, body_A->entity->id, 16);
-            memcpy(event.data.collision.entity_B_id, body_B->entity->id, 16);
-            break;
-        }
-
-        game_event_queue_enqueue(event);
-      }
-      // Reorder bodies by enum value
-      if (body_swap){
-        struct PhysicsBody *temp = body_A;
-        body_A = body_B;
-        body_B = temp;
+static double physics_elapsed_ms(struct timespec *start){
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double elapsed_ms = (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+  *start = now;
+  return elapsed_ms;
+}
+
+static void physics_save_previous_state(struct PhysicsBody *bodies, unsigned int num_bodies){
+  for (unsigned int i = 0; i < num_bodies; i++){
+    glm_vec3_copy(bodies[i].position, bodies[i].previous_position);
+    glm_quat_copy(bodies[i].rotation, bodies[i].previous_rotation);
+  }
+}
+
+// Position and rotation between the previous and current steps, alpha in [0, 1]
+void physics_body_interpolate(struct PhysicsBody *body, float alpha, vec3 position, versor rotation){
+  glm_vec3_lerp(body->previous_position, body->position, alpha, position);
+  glm_quat_nlerp(body->previous_rotation, body->rotation, alpha, rotation);
+}
+
+// Copy the state of bodies that moved this step to their nodes and entities, and mark the nodes dirty
+// for the next transform pass. A node whose body just stopped is marked once more, so its render
+// transform settles on the final state instead of the last interpolated one
+static void physics_sync_scene_node_array(struct PhysicsBody *bodies, struct PhysicsBodyCold *cold, unsigned int num_bodies){
+  for (unsigned int i = 0; i < num_bodies; i++){
+    struct PhysicsBody *body = &bodies[i];
+    struct SceneNode *scene_node = cold[i].scene_node;
+    if (!scene_node) continue;
+
+    bool moved = !glm_vec3_eqv(body->previous_position, body->position) || !glm_vec4_eqv(body->previous_rotation, body->rotation);
+    if (moved){
+      glm_vec3_copy(body->position, scene_node->position);
+      glm_quat_copy(body->rotation, scene_node->rotation);
+      if (scene_node->entity){
+        glm_vec3_copy(body->position, scene_node->entity->position);
+        glm_quat_copy(body->rotation, scene_node->entity->rotation);
       }
+      scene_node->dirty = true;
     }
-    if (!body_A->at_rest){
-      float gravity = 9.8f;
-      body_A->velocity[1] -= gravity * delta_time;
-      glm_vec3_muladds(body_A->velocity, delta_time, body_A->position);
+    else if (scene_node->interpolating){
+      scene_node->dirty = true;
     }
+    scene_node->interpolating = moved;
   }
 }
 
-bool interval_collision(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float start_time, float end_time, float *hit_time){
-  // Compute sum of maximum distances the two bodies move over the interval
-  float max_move_A = maximum_object_movement_over_time(body_A, start_time, end_time);
-  float max_move_B = maximum_object_movement_over_time(body_B, start_time, end_time);
-  float max_move_sum = max_move_A + max_move_B;
+// Advance the world by delta_time. Expects a fixed delta_time,
+// see scene_update for the clock that drives it
+void physics_step(struct PhysicsWorld *physics_world, float delta_time){
+  // Static bodies never move, so only movable bodies need their previous state saved
+  physics_save_previous_state(physics_world->dynamic_bodies, physics_world->num_dynamic_bodies);
+  physics_save_previous_state(physics_world->player_bodies, physics_world->num_player_bodies);
 
-  // If initial minimum distance is larger than max_move_sum, exit
-  float min_dist_start = minimum_object_distance_at_time(body_A, body_B, start_time);
-  if (min_dist_start > max_move_sum) return 0;
+  struct PhysicsPipeline *pipeline = &physics_world->pipeline;
+  struct PhysicsStepStats *stats = &physics_world->step_stats;
+  struct timespec stage_start;
+  clock_gettime(CLOCK_MONOTONIC, &stage_start);
 
-  // If end minimum distance is still larger than max_move_sum, exit (bodies are moving away)
-  float min_dist_end = minimum_object_distance_at_time(body_A, body_B, end_time);
-  if (min_dist_end > max_move_sum) return 0;
+  // World space colliders are derived from transforms once per step
+  physics_update_world_colliders(physics_world);
 
-  // If we recurse down to a small enough interval, assume collision at the start of the interval
-  if (end_time - start_time < INTERVAL_EPSILON){
-    *hit_time = start_time;
-    return 1;
-  }
+  // Stage 1: candidate pairs
+  physics_world->num_pairs = 0;
+  if (pipeline->generate_pairs) pipeline->generate_pairs(physics_world, delta_time);
+  stats->num_pairs = physics_world->num_pairs;
+  stats->generate_pairs_ms = physics_elapsed_ms(&stage_start);
 
-  // Collision may have happened: halve the interval and check each half
-  float mid_time = (start_time + end_time) * 0.5f;
-  if (interval_collision(body_A, body_B, start_time, mid_time, hit_time)) return 1;
+  // Stage 2: narrow phase over the whole pair buffer
+  if (pipeline->narrow_phase) pipeline->narrow_phase(physics_world, delta_time);
+  stats->narrow_phase_ms = physics_elapsed_ms(&stage_start);
 
-  return interval_collision(body_A, body_B, mid_time, end_time, hit_time);
-}
+  // Stage 3: resolution and events
+  if (pipeline->resolve) pipeline->resolve(physics_world, delta_time);
+  stats->resolve_ms = physics_elapsed_ms(&stage_start);
+
+  // Stage 4: islands and sleep
+  if (pipeline->islands) pipeline->islands(physics_world, delta_time);
+  stats->islands_ms = physics_elapsed_ms(&stage_start);
+
+  // Stage 5: integration
+  if (pipeline->integrate) pipeline->integrate(physics_world, delta_time);
+  stats->integrate_ms = physics_elapsed_ms(&stage_start);
+
+  // Stage 6: trigger overlaps and their enter/exit events
+  if (pipeline->triggers) pipeline->triggers(physics_world, delta_time);
+  stats->triggers_ms = physics_elapsed_ms(&stage_start);
+
+  // Only movable bodies can have moved, so scene_update_transforms never has to ask physics per node
+  physics_sync_scene_node_array(physics_world->dynamic_bodies, physics_world->dynamic_cold, physics_world->num_dynamic_bodies);
+  physics_sync_scene_node_array(physics_world->player_bodies, physics_world->player_cold, physics_world->num_player_bodies);
 
-float maximum_object_movement_over_time(struct PhysicsBody *body, float start_time, float end_time){
-  float delta_time = end_time - start_time;
-  // print_glm_vec3(body->velocity, "Body velocity");
-  // printf("glm_vec3_norm of body velocity: %f\n", glm_vec3_norm(body->velocity));
-  return glm_vec3_norm(body->velocity) * delta_time;
+  physics_world->step_count++;
 }
 
 float minimum_object_distance_at_time(struct PhysicsBody *body_A, struct PhysicsBody *body_B, float time){
   // Call the appropriate distance function from the table
   DistanceFunction distance_function = distance_functions[body_A->collider.type][body_B->collider.type];
   if (!distance_function){
-    fprintf(stderr, "Error: no minimum distance function found for types %d and %d\n",
-            body_A->collider.type, body_B->collider.type);
-    return 0;
+    return gjk_body_distance(body_A, body_B, time);
   }
   return distance_function(body_A, body_B, time);
 }
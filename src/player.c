@@ -8,79 +8,62 @@
 #include "audio_manager.h"
 #include "physics/world.h"
 
-void player_process_keyboard_input(struct Scene *scene, uuid_t entity_id, CameraDirection direction, float delta_time){
-  struct PlayerComponent *player = scene_get_player_by_entity_id(scene, entity_id);
+// Add this frame's movement to the player's character controller. forward and right are
+// -1 to 1 (e.g. W minus S), and the player walks at the camera's speed in any direction.
+// player_update resolves it all at once, instead of moving the body once per key
+void player_process_movement_input(struct Scene *scene, EntityIndex entity, float forward, float right, float delta_time){
+  if (forward == 0.0f && right == 0.0f) return;
+
+  struct PlayerComponent *player = scene_get_player(scene, entity);
   if (!player){
-    fprintf(stderr, "Error: failed to get PlayerComponent in player_process_keyboard_input\n");
+    fprintf(stderr, "Error: failed to get PlayerComponent in player_process_movement_input\n");
+    return;
+  }
+  struct CameraComponent *camera_component = scene_get_camera(scene, entity);
+  if (!camera_component){
+    fprintf(stderr, "Error: failed to get CameraComponent in player_process_movement_input\n");
     return;
   }
 
-  // TODO Some kind of physics API so that I can remove the direct reference to the PhysicsBody from Entity
-  struct Entity *player_entity = scene_get_entity_by_entity_id(scene, entity_id);
-  struct CameraComponent *camera_component = scene_get_camera_by_entity_id(scene, entity_id);
-
-  float velocity = (float)(camera_component->speed * delta_time);
-	if (direction == CAMERA_FORWARD){
-    vec3 forward = {camera_component->front[0], 0.0f, camera_component->front[2]};
-    glm_vec3_normalize(forward);
-		glm_vec3_scale(forward, velocity, forward);
-		glm_vec3_add(player_entity->physics_body->position, forward, player_entity->physics_body->position);
-	}
-	if (direction == CAMERA_BACKWARD){
-    vec3 backward = {camera_component->front[0], 0.0f, camera_component->front[2]};
-    glm_vec3_normalize(backward);
-		glm_vec3_scale(backward, velocity, backward);
-		glm_vec3_sub(player_entity->physics_body->position, backward, player_entity->physics_body->position);
-	}
-	if (direction == CAMERA_LEFT){
-    // I could just leave these since left and right don't affect pitch,
-    // but I might want to implement leaning in the future
-    vec3 left = {camera_component->right[0], 0.0f, camera_component->right[2]};
-    glm_vec3_scale(left, velocity, left);
-    glm_vec3_sub(player_entity->physics_body->position, left, player_entity->physics_body->position);
-	}
-	if (direction == CAMERA_RIGHT){
-    vec3 right = {camera_component->right[0], 0.0f, camera_component->right[2]};
-    glm_vec3_scale(right, velocity, right);
-    glm_vec3_add(player_entity->physics_body->position, right, player_entity->physics_body->position);
-	}
-  
-  // Update transform
-  struct SceneNode *player_node;
-  int child_index, final_child_index;
-  scene_get_node_by_entity_id(scene->root_node, player->entity_id, &child_index, &final_child_index, &player_node);
-  scene_node_update(scene, player_node);
-	// if (direction == CAMERA_DOWN){
-	// 	vec3 down;
-	// 	glm_vec3_copy(camera->up, down);
-	// 	glm_vec3_scale(down, velocity, down);
-	// 	glm_vec3_sub(camera->position, down, camera->position);
-	// }
-	// if (direction == CAMERA_UP){
-	// 	vec3 up;
-	// 	glm_vec3_copy(camera->up, up);
-	// 	glm_vec3_scale(up, velocity, up);
-	// 	glm_vec3_add(camera->position, up, camera->position);
-	//}
+  // Walk on the xz plane, whatever the camera's pitch
+  vec3 front = {camera_component->front[0], 0.0f, camera_component->front[2]};
+  vec3 side = {camera_component->right[0], 0.0f, camera_component->right[2]};
+  glm_vec3_normalize(front);
+  glm_vec3_normalize(side);
+  vec3 displacement = {0.0f, 0.0f, 0.0f};
+  glm_vec3_muladds(front, forward, displacement);
+  glm_vec3_muladds(side, right, displacement);
+
+  // Diagonals aren't faster
+  float length = glm_vec3_norm(displacement);
+  if (length == 0.0f) return;
+  float distance = (float)(camera_component->speed * delta_time);
+  glm_vec3_scale(displacement, distance / glm_max(length, 1.0f), displacement);
+  physics_character_add_displacement(&player->character, displacement);
 }
 
-void player_process_mouse_input(struct Scene *scene, uuid_t entity_id, float xoffset, float yoffset){
-  struct PlayerComponent *player = scene_get_player_by_entity_id(scene, entity_id);
+void player_process_mouse_input(struct Scene *scene, EntityIndex entity, float xoffset, float yoffset){
+  struct PlayerComponent *player = scene_get_player(scene, entity);
   if (!player){
     fprintf(stderr, "Error: failed to get PlayerComponent in player_process_mouse_input\n");
     return;
   }
-  struct CameraComponent *camera = scene_get_camera_by_entity_id(scene, entity_id);
+  struct CameraComponent *camera = scene_get_camera(scene, entity);
   if (!camera){
     fprintf(stderr, "Error: failed to get CameraComponent in player_process_mouse_input\n");
     return;
   }
 
-  struct Entity *player_entity = scene_get_entity_by_entity_id(scene, entity_id);
+  struct Entity *player_entity = scene_get_entity(scene, entity);
   if (!player_entity){
     fprintf(stderr, "Error: failed to get player Entity in player_process_mouse_input\n");
     return;
   }
+  struct PhysicsBody *body = physics_get_body(scene->physics_world, player_entity->physics_body);
+  if (!body){
+    fprintf(stderr, "Error: failed to get player PhysicsBody in player_process_mouse_input\n");
+    return;
+  }
 
   // Multiply offset by sensitivity
 	xoffset *= camera->sensitivity;
@@ -152,49 +135,64 @@ void player_process_mouse_input(struct Scene *scene, uuid_t entity_id, float xof
   // the positive z direction, and thus its rotation about the y axis must be adjusted
   // to face the same direction as the camera. I may also want to make an API for setting
   // physics body values instead of directly mutating them.)
-  player_entity->physics_body->rotation[0] = 0.0f;
-  player_entity->physics_body->rotation[1] = -camera->yaw + 90.0f;
-  player_entity->physics_body->rotation[2] = 0.0f;
+  glm_quatv(body->rotation, glm_rad(-camera->yaw + 90.0f), (vec3){0.0f, 1.0f, 0.0f});
 }
 
-void player_jump(struct Scene *scene, uuid_t entity_id){
-  struct Entity *player_entity = scene_get_entity_by_entity_id(scene, entity_id);
+void player_jump(struct Scene *scene, EntityIndex entity){
+  struct Entity *player_entity = scene_get_entity(scene, entity);
   if (!player_entity){
     fprintf(stderr, "Error: failed to get player Entity in player_jump\n");
     return;
   }
 
+  struct PhysicsBody *body = physics_get_body(scene->physics_world, player_entity->physics_body);
+  if (!body){
+    fprintf(stderr, "Error: failed to get player PhysicsBody in player_jump\n");
+    return;
+  }
+
   // Reset at_rest
-  struct PhysicsBody *body = player_entity->physics_body;
   body->at_rest = false;
 
   // Apply an impulse to player->physics_body->velocity
   body->velocity[1] = 3.0f;
 }
 
-void player_update(struct Scene *scene, uuid_t entity_id, float delta_time){
+void player_update(struct Scene *scene, EntityIndex entity, float delta_time){
   // Possibly remove this if in the future audio_listener_update is refactored
   // to not take a pointer to a PlayerComponent
-  struct PlayerComponent *player_component = scene_get_player_by_entity_id(scene, entity_id);
+  struct PlayerComponent *player_component = scene_get_player(scene, entity);
   if (!player_component){
     fprintf(stderr, "Error: failed to get PlayerComponent in player_update\n");
     return;
   }
-  struct Entity *player_entity = scene_get_entity_by_entity_id(scene, entity_id);
+  struct Entity *player_entity = scene_get_entity(scene, entity);
   if (!player_entity){
     fprintf(stderr, "Error: failed to get player Entity in player_update\n");
   }
-  struct CameraComponent *camera_component = scene_get_camera_by_entity_id(scene, entity_id);
+  struct CameraComponent *camera_component = scene_get_camera(scene, entity);
   if (!camera_component){
     fprintf(stderr, "Error: failed to get CameraComponent in player_update\n");
   }
-  struct AudioComponent *audio_component = scene_get_audio_component_by_entity_id(scene, entity_id);
+  struct AudioComponent *audio_component = scene_get_audio_component(scene, entity);
+
+  // Resolve this frame's movement with the world before syncing from the body
+  physics_character_move(scene->physics_world, &player_component->character);
+
+  struct PhysicsBody *body = physics_get_body(scene->physics_world, player_entity->physics_body);
+  if (!body){
+    fprintf(stderr, "Error: failed to get player PhysicsBody in player_update\n");
+    return;
+  }
 
-  glm_vec3_copy(player_entity->physics_body->position, player_entity->position);
-  glm_vec3_copy(player_entity->physics_body->rotation, player_entity->rotation);
-  glm_vec3_copy(player_entity->physics_body->velocity, player_entity->velocity);
-  // Add Camera offset
-  glm_vec3_add(player_entity->position, player_component->rotated_offset, camera_component->position);
+  glm_vec3_copy(body->position, player_entity->position);
+  glm_quat_copy(body->rotation, player_entity->rotation);
+  glm_vec3_copy(body->velocity, player_entity->velocity);
+  // Add Camera offset to the interpolated position, so the camera moves smoothly between physics steps
+  vec3 render_position;
+  versor render_rotation;
+  physics_body_interpolate(body, scene->physics_alpha, render_position, render_rotation);
+  glm_vec3_add(render_position, player_component->rotated_offset, camera_component->position);
   camera_component->position[1] += player_component->camera_height;
 
   // Update audio source position
@@ -205,5 +203,5 @@ void player_update(struct Scene *scene, uuid_t entity_id, float delta_time){
   }
 
   // Update listener position and orientation
-  audio_listener_update(scene, entity_id);
+  audio_listener_update(scene, entity);
 }
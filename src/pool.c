@@ -0,0 +1,49 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "pool.h"
+
+void pool_init(struct Pool *pool, struct Arena *arena, size_t item_size, unsigned int items_per_block){
+  // Freed items hold the free list's next pointer, and stay aligned like the arena's allocations
+  if (item_size < sizeof(void *)) item_size = sizeof(void *);
+  item_size = (item_size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+
+  pool->arena = arena;
+  pool->item_size = item_size;
+  pool->items_per_block = items_per_block ? items_per_block : 1;
+  pool->free_list = NULL;
+  pool->num_items = 0;
+}
+
+// Carve a new block out of the arena and put all of its items on the free list
+static bool pool_grow(struct Pool *pool){
+  unsigned char *block = (unsigned char *)arena_alloc_array(pool->arena, pool->items_per_block, pool->item_size);
+  if (!block){
+    fprintf(stderr, "Error: failed to allocate block in pool_grow\n");
+    return false;
+  }
+  // Thread back to front so items are handed out in address order
+  for (unsigned int i = pool->items_per_block; i-- > 0;){
+    void *item = block + (size_t)i * pool->item_size;
+    *(void **)item = pool->free_list;
+    pool->free_list = item;
+  }
+  return true;
+}
+
+void *pool_alloc(struct Pool *pool){
+  if (!pool->free_list && !pool_grow(pool)) return NULL;
+
+  void *item = pool->free_list;
+  pool->free_list = *(void **)item;
+  memset(item, 0, pool->item_size);
+  pool->num_items++;
+  return item;
+}
+
+void pool_free(struct Pool *pool, void *item){
+  if (!item) return;
+  *(void **)item = pool->free_list;
+  pool->free_list = item;
+  pool->num_items--;
+}
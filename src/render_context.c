@@ -166,10 +166,9 @@ void scene_get_render_items(
   struct RenderItem **transparent_items, unsigned int *num_transparent_items,
   struct RenderItem **additive_items, unsigned int *num_additive_items)
 {
-  for (unsigned int i = 0; i < scene->num_render_components; i++){
-    struct RenderComponent *render_component = &scene->render_components[i];
+  for (unsigned int i = 0; i < scene->render_components.num_components; i++){
+    struct RenderComponent *render_component = component_store_at(&scene->render_components, i);
   // Get this node's RenderItems
-    struct Entity *entity = scene_get_entity_by_entity_id(scene, render_component->entity_id);
     struct Model *model = render_component->model;
     // struct Model *model = entity->model;
 
@@ -229,22 +228,17 @@ int compare_render_item_depth(const void *a, const void *b){
   return 0;
 }
 
-void render_component_create(struct Scene *scene, uuid_t entity_id, struct Model *model, Shader *shader){
+void render_component_create(struct Scene *scene, EntityIndex entity, struct Model *model, Shader *shader){
   // Don't create a RenderComponent for entities of type ENTITY_GROUPING
   // scene_init doesn't call this for grouping entities, check model and shader here anyway
   if (!model || !shader) return;
 
-  if (scene->num_render_components >= scene->max_render_components){
-    scene->max_render_components *= 2;
-    scene->render_components = realloc(scene->render_components, scene->max_render_components * sizeof(struct RenderComponent));
-    if (!scene->render_components){
-      fprintf(stderr, "Error: failed to reallocate scene RenderComponents in render_component_create\n");
-      return;
-    }
+  struct RenderComponent *render_component = component_store_add(&scene->render_components, entity);
+  if (!render_component){
+    fprintf(stderr, "Error: failed to add RenderComponent in render_component_create\n");
+    return;
   }
-
-  struct RenderComponent *render_component = &scene->render_components[scene->num_render_components++];
-  memcpy(render_component->entity_id, entity_id, 16);
+  render_component->entity = entity;
   render_component->model = model;
   render_component->shader = shader;
 }
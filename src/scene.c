@@ -1,3 +1,4 @@
+#include <string.h>
 #include <cglm/euler.h>
 #include <cglm/mat4.h>
 #include <cglm/vec3.h>
@@ -63,6 +64,11 @@ struct Scene *scene_load(const char *scene_path){
     printf("Error: failed to allocate scene in scene_init\n");
     return NULL;
   }
+  arena_init(&scene->arena, ARENA_DEFAULT_BLOCK_SIZE);
+  pool_init(&scene->node_pool, &scene->arena, sizeof(struct SceneNode), 64);
+  pool_init(&scene->entity_pool, &scene->arena, sizeof(struct Entity), 64);
+  pool_init(&scene->item_pool, &scene->arena, sizeof(struct ItemComponent), 16);
+
   // Set options
   scene->physics_debug_mode = true;
 
@@ -220,6 +226,14 @@ struct Scene *scene_load(const char *scene_path){
   }
 
   scene->physics_world = physics_world_create();
+  scene_set_physics_rate(scene, PHYSICS_DEFAULT_HZ, PHYSICS_DEFAULT_MAX_SUBSTEPS);
+
+  // Collision layers are optional, every layer collides with every other by default.
+  // Read them before the nodes so bodies pick up the scene's matrix when they're added
+  cJSON *collision_layers_json = cJSON_GetObjectItemCaseSensitive(scene_json, "collision_layers");
+  if (collision_layers_json){
+    scene_process_collision_layers_json(collision_layers_json, scene->physics_world);
+  }
 
   // Allocate array of entities
   cJSON *entity_count_json = cJSON_GetObjectItemCaseSensitive(scene_json, "entity_count");
@@ -228,12 +242,18 @@ struct Scene *scene_load(const char *scene_path){
     return NULL;
   }
   int entity_count = cJSON_GetNumberValue(entity_count_json);
-  scene->entities = (struct Entity **)calloc(entity_count, sizeof(struct Entity *));
-  if (!scene->entities){
+  if (!component_store_init(&scene->entities, sizeof(struct Entity *), entity_count)){
     fprintf(stderr, "Error: failed to allocate scene->entities in scene_init\n");
     return NULL;
   }
-  scene->num_entities = 0;
+  scene->free_entity_indices = NULL;
+  scene->num_free_entity_indices = 0;
+  scene->max_free_entity_indices = 0;
+  scene->next_entity_index = 0;
+  if (!entity_command_buffer_init(&scene->commands, 64)){
+    fprintf(stderr, "Error: failed to initialize entity command buffer in scene_init\n");
+    return NULL;
+  }
 
   // Process nodes for scene graph
   cJSON *nodes_json = cJSON_GetObjectItemCaseSensitive(scene_json, "nodes");
@@ -241,63 +261,46 @@ struct Scene *scene_load(const char *scene_path){
     fprintf(stderr, "Error: failed to get nodes object in scene_init, invalid or does not exist\n");
     return NULL;
   }
-  scene->root_node = (struct SceneNode *)calloc(1, sizeof(struct SceneNode));
+  scene->root_node = (struct SceneNode *)pool_alloc(&scene->node_pool);
   if (!scene->root_node){
     fprintf(stderr, "Error: failed to allocate root SceneNode in scene_init\n");
     return NULL;
   }
+  // Flat node array, roughly one node per entity
+  scene->max_nodes = entity_count > 0 ? entity_count : 16;
+  scene->nodes = (struct SceneNode **)calloc(scene->max_nodes, sizeof(struct SceneNode *));
+  if (!scene->nodes){
+    fprintf(stderr, "Error: failed to allocate scene nodes in scene_init\n");
+    return NULL;
+  }
+  scene->num_nodes = 0;
 
   // Build scene graph and fill entities array
-  // scene_process_node_json(scene, nodes_json, scene->root_node, NULL, models, shaders, scene->physics_world);
-  // scene->max_entities = 64;
+  // scene_process_node_json(scene, nodes_json, scene->root_node, models, shaders, scene->physics_world);
 
   // Allocate Components
-  scene->max_render_components = 32;
-  scene->render_components = (struct RenderComponent *)calloc(scene->max_render_components, sizeof(struct RenderComponent));
-  if (!scene->render_components){
+  if (!component_store_init(&scene->render_components, sizeof(struct RenderComponent), 32)){
     fprintf(stderr, "Error: failed to allocate scene RenderComponents in scene_init\n");
     return NULL;
   }
-  scene->num_render_components = 0;
-
-  // - AudioComponents
-  scene->max_audio_components = 32;
-  scene->audio_components = (struct AudioComponent *)calloc(scene->max_audio_components, sizeof(struct AudioComponent));
-  if (!scene->audio_components){
+  if (!component_store_init(&scene->audio_components, sizeof(struct AudioComponent), 32)){
     fprintf(stderr, "Error: failed to allocate scene AudioComponents in scene_init\n");
     return NULL;
   }
-  scene->num_audio_components = 0;
-
-  // - CameraComponents
-  scene->max_camera_components = 8;
-  scene->camera_components = (struct CameraComponent *)calloc(scene->max_camera_components, sizeof(struct CameraComponent));
-  if (!scene->camera_components){
+  if (!component_store_init(&scene->camera_components, sizeof(struct CameraComponent), 8)){
     fprintf(stderr, "Error: failed to allocate scene CameraComponents in scene_init\n");
     return NULL;
   }
-  scene->num_camera_components = 0;
-
-  // - PlayerComponents
-  scene->max_player_components = 8;
-  scene->player_components = (struct PlayerComponent *)calloc(scene->max_player_components, sizeof(struct PlayerComponent));
-  if (!scene->player_components){
+  if (!component_store_init(&scene->player_components, sizeof(struct PlayerComponent), 8)){
     fprintf(stderr, "Error: failed to allocate scene PlayerComponents in scene_init\n");
     return NULL;
   }
-  scene->num_player_components = 0;
-
-  // InventoryComponents
-  scene->max_inventory_components = scene->max_player_components;
-  scene->inventory_components = (struct InventoryComponent *)calloc(scene->max_inventory_components, sizeof(struct InventoryComponent));
-  if (!scene->inventory_components){
+  if (!component_store_init(&scene->inventory_components, sizeof(struct InventoryComponent), 8)){
     fprintf(stderr, "Error: failed to allocate InventoryComponents in scene_init\n");
     return NULL;
   }
-  scene->num_inventory_components = 0;
 
-  scene_process_node_json(scene, nodes_json, scene->root_node, NULL, models, shaders, scene->physics_world);
-  scene->max_entities = 64;
+  scene_process_node_json(scene, nodes_json, scene->root_node, models, shaders, scene->physics_world);
 
   // Create player
   scene_player_create(scene, models[2], shaders[0],
@@ -318,27 +321,32 @@ struct Scene *scene_load(const char *scene_path){
   };
 
   // Add Player PhysicsBodies
-  for (unsigned int i = 0; i < scene->num_player_components; i++){
-    struct PlayerComponent *player_component = &scene->player_components[i];
-    struct Entity *entity = scene_get_entity_by_entity_id(scene, player_component->entity_id);
+  for (unsigned int i = 0; i < scene->player_components.num_components; i++){
+    struct PlayerComponent *player_component = component_store_at(&scene->player_components, i);
+    struct Entity *entity = scene_get_entity(scene, player_component->entity);
     // TODO figure out a better way to get a node by entity id when I don't need
     // any other information.
-    struct SceneNode *scene_node;
+    struct SceneNode *scene_node = NULL;
     int child_index, final_child_index;
-    scene_get_node_by_entity_id(scene->root_node, entity->id, &child_index, &final_child_index, &scene_node);
+    scene_get_node_by_entity(scene->root_node, entity->index, &child_index, &final_child_index, &scene_node);
     if (scene_node){
       entity->physics_body = physics_add_player(scene->physics_world, scene_node, entity, player_collider);
+      player_component->character.body = entity->physics_body;
     }
   }
 
   // Player inventory
-  for (unsigned int i = 0; i < scene->num_player_components; i++){
-    struct InventoryComponent *inventory_component = &scene->inventory_components[i];
-    memcpy(inventory_component->entity_id, scene->player_components[i].entity_id, 16);
+  for (unsigned int i = 0; i < scene->player_components.num_components; i++){
+    EntityIndex player_entity = component_store_entity_at(&scene->player_components, i);
+    struct InventoryComponent *inventory_component = component_store_add(&scene->inventory_components, player_entity);
+    if (!inventory_component){
+      fprintf(stderr, "Error: failed to add InventoryComponent in scene_init\n");
+      continue;
+    }
+    inventory_component->entity = player_entity;
     inventory_component->capacity = 5;
     inventory_component->items = (struct ItemComponent *)calloc(inventory_component->capacity, sizeof(struct ItemComponent));
     inventory_component->size = 0;
-    scene->num_inventory_components++;
   }
 
   // Lights
@@ -349,7 +357,7 @@ struct Scene *scene_load(const char *scene_path){
   }
 
   int num_lights = cJSON_GetArraySize(lights_json);
-  scene->lights = (struct Light *)calloc(num_lights, sizeof(struct Light));
+  scene->lights = (struct Light *)arena_alloc_array(&scene->arena, num_lights, sizeof(struct Light));
   if (!scene->lights){
     fprintf(stderr, "Error: failed to allocate scene lights\n");
     return NULL;
@@ -392,22 +400,46 @@ struct Scene *scene_load(const char *scene_path){
   return scene;
 }
 
+void scene_set_physics_rate(struct Scene *scene, float hz, unsigned int max_substeps){
+  if (hz <= 0.0f){
+    fprintf(stderr, "Error: invalid physics rate %f in scene_set_physics_rate\n", hz);
+    return;
+  }
+  scene->physics_timestep = 1.0f / hz;
+  scene->max_physics_substeps = max_substeps > 0 ? max_substeps : 1;
+  scene->physics_accumulator = 0.0f;
+  scene->physics_alpha = 0.0f;
+}
+
 void scene_update(struct Scene *scene, float delta_time){
   // Timing
   static float total_time = 0.0f;
   total_time += delta_time;
 
-  // Perform collision detection
-  physics_step(scene->physics_world, delta_time);
+  // Step physics at a fixed rate, as many times as the frame's time allows.
+  // Events are processed after each step, and anything they spawn or destroy is applied once all steps are done
+  scene->physics_accumulator += delta_time;
+  unsigned int num_substeps = 0;
+  while (scene->physics_accumulator >= scene->physics_timestep && num_substeps < scene->max_physics_substeps){
+    physics_step(scene->physics_world, scene->physics_timestep);
+    game_event_queue_process();
+    scene->physics_accumulator -= scene->physics_timestep;
+    num_substeps++;
+  }
+  // If the frame took too long to catch up, drop the whole steps we couldn't afford
+  // instead of falling further behind every frame
+  if (scene->physics_accumulator >= scene->physics_timestep){
+    scene->physics_accumulator = fmodf(scene->physics_accumulator, scene->physics_timestep);
+  }
+  scene->physics_alpha = scene->physics_accumulator / scene->physics_timestep;
 
-  // Process event queue
-  game_event_queue_process();
+  // Sync point for structural changes recorded by events and anything else this frame
+  entity_command_buffer_apply(&scene->commands, scene);
 
   // Update player
-  player_update(scene, scene->local_player_entity_id, delta_time);
-  scene_node_update(scene, scene->root_node);
-  // struct PlayerComponent *player = scene->player_components[0];
-  // inventory_print(&scene->item_registry, scene_get_inventory_by_entity_id(scene, player->entity_id));
+  player_update(scene, scene->local_player_entity, delta_time);
+  scene_update_transforms(scene);
+  // inventory_print(&scene->item_registry, scene_get_inventory(scene, scene->local_player_entity));
   // printf("Successfully printed inventory\n");
 
   // Update light
@@ -426,7 +458,11 @@ void scene_render(struct Scene *scene){
   // Get view and projection matrices
   mat4 view;
   mat4 projection;
-  struct CameraComponent *camera = scene_get_camera_by_entity_id(scene, scene->local_player_entity_id);
+  struct CameraComponent *camera = scene_get_camera(scene, scene->local_player_entity);
+  if (!camera){
+    fprintf(stderr, "Error: failed to get CameraComponent in scene_render\n");
+    return;
+  }
   camera_get_view_matrix(camera, view);
   glm_perspective(glm_rad(camera->fov), 1920.0f / 1080.0f, 0.1f, 100.0f, projection);
 
@@ -458,8 +494,9 @@ void scene_render(struct Scene *scene){
   // Allocate RenderItem arrays
   unsigned int num_render_items = 0;
   // scene_get_render_item_count(scene->root_node, &num_render_items);
-  for (unsigned int i = 0; i < scene->num_render_components; i++){
-    num_render_items += scene->render_components[i].model->num_meshes;
+  for (unsigned int i = 0; i < scene->render_components.num_components; i++){
+    struct RenderComponent *render_component = component_store_at(&scene->render_components, i);
+    num_render_items += render_component->model->num_meshes;
   }
   opaque_items = (struct RenderItem *)calloc(num_render_items, sizeof(struct RenderItem));
   if (!opaque_items){
@@ -518,7 +555,6 @@ void scene_render(struct Scene *scene){
   }
 }
 
-// TODO refactor to free scene graph
 void scene_free(struct Scene *scene){
   // Free models
   for (int i = 0; i < scene->num_models; i++){
@@ -530,45 +566,44 @@ void scene_free(struct Scene *scene){
     free(scene->shaders[i]);
   }
 
-  // Free scene graph
-  scene_remove_scene_node(scene->root_node);
+  // Scene graph nodes are freed with the arena
+  free(scene->nodes);
 
   // Free components
-  free(scene->render_components);
+  component_store_free(&scene->render_components);
 
   struct AudioManager *audio_manager = engine_get_audio_manager();
   if (!audio_manager){
     fprintf(stderr, "Error: failed to get AudioManager in scene_free\n");
     return;
   }
-  for (unsigned int i = 0; i < scene->num_audio_components; i++){
-    audio_component_destroy(audio_manager, &scene->audio_components[i]);
+  for (unsigned int i = 0; i < scene->audio_components.num_components; i++){
+    audio_component_destroy(audio_manager, component_store_at(&scene->audio_components, i));
   }
-  free(scene->audio_components);
-  free(scene->camera_components);
-  free(scene->player_components);
-  for (unsigned int i = 0; i < scene->num_inventory_components; i++){
-    free(scene->inventory_components[i].items);
+  component_store_free(&scene->audio_components);
+  component_store_free(&scene->camera_components);
+  component_store_free(&scene->player_components);
+  for (unsigned int i = 0; i < scene->inventory_components.num_components; i++){
+    struct InventoryComponent *inventory_component = component_store_at(&scene->inventory_components, i);
+    free(inventory_component->items);
   }
-  free(scene->inventory_components);
+  component_store_free(&scene->inventory_components);
 
-  // Free entities
-  for (unsigned int i = 0; i < scene->num_entities; i++){
-    free(scene->entities[i]);
-  }
-  free(scene->entities);
+  // Entities and their items are freed with the arena
+  component_store_free(&scene->entities);
+  free(scene->free_entity_indices);
+  entity_command_buffer_free(&scene->commands);
+  free(scene->removed_nodes);
 
   // Free skybox
   free(scene->skybox->shader);
   free(scene->skybox);
 
-  // Free lights
-  free(scene->lights);
-
   // Free physics_world
-  free(scene->physics_world->static_bodies);
-  free(scene->physics_world->dynamic_bodies);
-  free(scene->physics_world->player_bodies);
+  physics_world_destroy(scene->physics_world);
+
+  // Free nodes, entities, items, lights and everything else allocated at load
+  arena_free(&scene->arena);
 
   free(scene);
 }
@@ -593,6 +628,56 @@ void scene_process_light_json(cJSON *light_json, struct Light *light){
   glm_vec3_copy(specular, light->specular);
 }
 
+// Extra layers and the pairs of layers that shouldn't collide:
+// "collision_layers": {
+//   "layers": ["debris"],
+//   "ignore": [["item", "item"], ["debris", "player"]]
+// }
+// Entity type layers ("grouping", "world", "item", "player") always exist
+void scene_process_collision_layers_json(cJSON *collision_layers_json, struct PhysicsWorld *physics_world){
+  struct PhysicsLayers *layers = &physics_world->layers;
+
+  cJSON *layer_names_json = cJSON_GetObjectItemCaseSensitive(collision_layers_json, "layers");
+  if (layer_names_json){
+    if (!cJSON_IsArray(layer_names_json)){
+      fprintf(stderr, "Error: collision_layers layers is not an array in scene_process_collision_layers_json\n");
+      return;
+    }
+    cJSON *layer_name_json;
+    cJSON_ArrayForEach(layer_name_json, layer_names_json){
+      if (!cJSON_IsString(layer_name_json)){
+        fprintf(stderr, "Error: layer name is not a string in scene_process_collision_layers_json\n");
+        continue;
+      }
+      physics_layers_add(layers, cJSON_GetStringValue(layer_name_json));
+    }
+  }
+
+  cJSON *ignore_json = cJSON_GetObjectItemCaseSensitive(collision_layers_json, "ignore");
+  if (ignore_json){
+    if (!cJSON_IsArray(ignore_json)){
+      fprintf(stderr, "Error: collision_layers ignore is not an array in scene_process_collision_layers_json\n");
+      return;
+    }
+    cJSON *pair_json;
+    cJSON_ArrayForEach(pair_json, ignore_json){
+      cJSON *name_A = cJSON_GetArrayItem(pair_json, 0);
+      cJSON *name_B = cJSON_GetArrayItem(pair_json, 1);
+      if (!cJSON_IsArray(pair_json) || cJSON_GetArraySize(pair_json) != 2 || !cJSON_IsString(name_A) || !cJSON_IsString(name_B)){
+        fprintf(stderr, "Error: ignored layer pair is not two layer names in scene_process_collision_layers_json\n");
+        continue;
+      }
+      int layer_A = physics_layers_find(layers, cJSON_GetStringValue(name_A));
+      int layer_B = physics_layers_find(layers, cJSON_GetStringValue(name_B));
+      if (layer_A == PHYSICS_NULL_LAYER || layer_B == PHYSICS_NULL_LAYER){
+        fprintf(stderr, "Error: unknown layer in pair %s, %s in scene_process_collision_layers_json\n", cJSON_GetStringValue(name_A), cJSON_GetStringValue(name_B));
+        continue;
+      }
+      physics_set_layer_collision(physics_world, layer_A, layer_B, false);
+    }
+  }
+}
+
 void scene_process_vec3_json(cJSON *vec3_json, vec3 dest){
   if (!cJSON_IsArray(vec3_json) || cJSON_GetArraySize(vec3_json) != 3){
     fprintf(stderr, "Error: failed to get %s vector, either invalid or does not exist\n", cJSON_GetStringValue(vec3_json));
@@ -603,23 +688,94 @@ void scene_process_vec3_json(cJSON *vec3_json, vec3 dest){
   dest[2] = cJSON_GetNumberValue(cJSON_GetArrayItem(vec3_json, 2));
 }
 
+// Scene files store rotations as Euler angles in degrees, nodes and bodies keep them as quaternions
+void scene_process_rotation_json(cJSON *rotation_json, versor dest){
+  vec3 euler_degrees = {0.0f, 0.0f, 0.0f};
+  scene_process_vec3_json(rotation_json, euler_degrees);
+  scene_euler_to_quat(euler_degrees, dest);
+}
+
+// Euler angles in degrees to a quaternion, rotating about x, then y, then z like glm_euler_xyz
+void scene_euler_to_quat(vec3 euler_degrees, versor dest){
+  vec3 rotation_radians = {
+    glm_rad(euler_degrees[0]),
+    glm_rad(euler_degrees[1]),
+    glm_rad(euler_degrees[2])
+  };
+  mat4 rotation;
+  glm_euler_xyz(rotation_radians, rotation);
+  glm_mat4_quat(rotation, dest);
+}
+
+// Translate, rotate, then scale, written straight into dest rather than multiplied out
+static void scene_node_build_local_transform(vec3 position, versor rotation, vec3 scale, mat4 dest){
+  glm_quat_mat4(rotation, dest);
+  glm_vec3_scale(dest[0], scale[0], dest[0]);
+  glm_vec3_scale(dest[1], scale[1], dest[1]);
+  glm_vec3_scale(dest[2], scale[2], dest[2]);
+  glm_vec3_copy(position, dest[3]);
+}
+
+// Combine a node's local transform with its parent's world transform,
+// and compose its world position, rotation and scale from its parent's the same way
+static void scene_node_build_world_transform(struct SceneNode *scene_node){
+  struct SceneNode *parent_node = scene_node->parent_node;
+  if (!parent_node){
+    glm_mat4_copy(scene_node->local_transform, scene_node->world_transform);
+    glm_vec3_copy(scene_node->position, scene_node->world_position);
+    glm_quat_copy(scene_node->rotation, scene_node->world_rotation);
+    glm_vec3_copy(scene_node->scale, scene_node->world_scale);
+    return;
+  }
+
+  glm_mat4_mul(parent_node->world_transform, scene_node->local_transform, scene_node->world_transform);
+
+  vec3 offset;
+  glm_vec3_mul(parent_node->world_scale, scene_node->position, offset);
+  glm_quat_rotatev(parent_node->world_rotation, offset, offset);
+  glm_vec3_add(parent_node->world_position, offset, scene_node->world_position);
+  glm_quat_mul(parent_node->world_rotation, scene_node->rotation, scene_node->world_rotation);
+  glm_vec3_mul(parent_node->world_scale, scene_node->scale, scene_node->world_scale);
+}
+
+// Append a node to the scene's flat node array, after its parent.
+// New nodes start dirty so the next transform pass picks them up
+static bool scene_add_node(struct Scene *scene, struct SceneNode *scene_node){
+  if (scene->num_nodes >= scene->max_nodes){
+    unsigned int max_nodes = scene->max_nodes ? scene->max_nodes * 2 : 16;
+    struct SceneNode **nodes = realloc(scene->nodes, max_nodes * sizeof(struct SceneNode *));
+    if (!nodes){
+      fprintf(stderr, "Error: failed to reallocate scene nodes in scene_add_node\n");
+      return false;
+    }
+    scene->nodes = nodes;
+    scene->max_nodes = max_nodes;
+  }
+  scene_node->dirty = true;
+  scene->nodes[scene->num_nodes++] = scene_node;
+  return true;
+}
+
 void scene_process_node_json(
   struct Scene *scene,
   const cJSON *node_json,
   struct SceneNode *current_node,
-  struct SceneNode *parent_node,
   struct Model **models,
   Shader **shaders,
   struct PhysicsWorld *physics_world){
 
-  struct Entity *entity = (struct Entity *)calloc(1, sizeof(struct Entity));
+  // Nodes are processed parent first, so appending keeps the flat array in order
+  if (!scene_add_node(scene, current_node)){
+    return;
+  }
+
+  struct Entity *entity = scene_entity_create(scene);
   if (!entity){
-    fprintf(stderr, "Error: failed to allocate entity in scene_process_node_json\n");
+    fprintf(stderr, "Error: failed to create entity in scene_process_node_json\n");
     return;
   }
-  uuid_generate(entity->id);
   scene_process_vec3_json(cJSON_GetObjectItemCaseSensitive(node_json, "position"), entity->position);
-  scene_process_vec3_json(cJSON_GetObjectItemCaseSensitive(node_json, "rotation"), entity->rotation);
+  scene_process_rotation_json(cJSON_GetObjectItemCaseSensitive(node_json, "rotation"), entity->rotation);
   scene_process_vec3_json(cJSON_GetObjectItemCaseSensitive(node_json, "scale"), entity->scale);
 
   // Entity type
@@ -652,41 +808,18 @@ void scene_process_node_json(
   //     break;
   //   }
   // }
-  // Add reference to this entity to scene's entities array and node
+  // Add reference to this entity to its node
   current_node->entity = entity;
-  memcpy(current_node->entity_id, entity->id, 16);
-  scene->entities[scene->num_entities++] = entity;
 
   // Process transform
   // Figure out making it work with these only living in the SceneNode, copy to both SceneNode and Entity for now
   scene_process_vec3_json(cJSON_GetObjectItemCaseSensitive(node_json, "position"), current_node->position);
-  scene_process_vec3_json(cJSON_GetObjectItemCaseSensitive(node_json, "rotation"), current_node->rotation);
+  glm_quat_copy(entity->rotation, current_node->rotation);
   scene_process_vec3_json(cJSON_GetObjectItemCaseSensitive(node_json, "scale"), current_node->scale);
 
-  // Build local and world transforms
-  mat4 translation, rotation, scale;
-  glm_scale_make(scale, current_node->scale);
-
-  vec3 rotation_radians = {
-    glm_rad(current_node->rotation[0]),
-    glm_rad(current_node->rotation[1]),
-    glm_rad(current_node->rotation[2])
-  };
-  glm_euler_xyz(rotation_radians, rotation);
-
-  glm_translate_make(translation, current_node->position);
-
-  glm_mat4_identity(current_node->local_transform);
-  glm_mat4_mul(rotation, scale, current_node->local_transform);
-  glm_mat4_mul(translation, current_node->local_transform, current_node->local_transform);
-
-  // Combine parent transform
-  if (parent_node){
-    glm_mat4_mul(parent_node->world_transform, current_node->local_transform, current_node->world_transform);
-  }
-  else {
-    glm_mat4_copy(current_node->local_transform, current_node->world_transform);
-  }
+  // Build local and world transforms now, the physics body below is placed from them
+  scene_node_build_local_transform(current_node->position, current_node->rotation, current_node->scale, current_node->local_transform);
+  scene_node_build_world_transform(current_node);
 
   // Process PhysicsBody if collider is not null
   cJSON *collider_json = cJSON_GetObjectItemCaseSensitive(node_json, "collider");
@@ -766,6 +899,33 @@ void scene_process_node_json(
         collider.type = type;
         collider.data.plane = plane;
         break;
+      case COLLIDER_OBB:
+        struct AABB box;
+
+        // Same fields as an AABB, the box's rotation comes from its node
+        scene_process_vec3_json(cJSON_GetObjectItemCaseSensitive(collider_data_json, "center"), box.center);
+        scene_process_vec3_json(cJSON_GetObjectItemCaseSensitive(collider_data_json, "extents"), box.extents);
+
+        collider.type = type;
+        OBB_from_AABB(&box, &collider.data.obb);
+        break;
+      case COLLIDER_MESH:
+        // Level geometry, usually the same file as the node's model.
+        // Meshes are shared between nodes, and their BVH is cached next to the file
+        cJSON *path = cJSON_GetObjectItemCaseSensitive(collider_data_json, "path");
+        if (!cJSON_IsString(path)){
+          fprintf(stderr, "Error: failed to get path in collider object in scene_process_node_json, either invalid or does not exist\n");
+          return;
+        }
+        struct TriangleMesh *mesh = physics_load_mesh(physics_world, cJSON_GetStringValue(path));
+        if (!mesh){
+          fprintf(stderr, "Error: failed to load mesh collider in scene_process_node_json\n");
+          return;
+        }
+
+        collider.type = type;
+        mesh_collider_identity(mesh, &collider.data.mesh);
+        break;
       default:
         break;
     }
@@ -789,8 +949,27 @@ void scene_process_node_json(
       scene_process_vec3_json(cJSON_GetObjectItemCaseSensitive(node_json, "velocity"), current_node->entity->velocity);
     }
     
+    // Triggers (e.g. item pickups) skip the collision pipeline and only report players entering and leaving them
+    cJSON *trigger_json = cJSON_GetObjectItemCaseSensitive(collider_json, "trigger");
     // (Assumes every node with a collider also has an entity, maybe this shouldn't always be true?)
-    current_node->entity->physics_body = physics_add_body(physics_world, current_node, current_node->entity, collider, restitution, dynamic);
+    if (cJSON_IsTrue(trigger_json)){
+      current_node->entity->physics_body = physics_add_trigger(physics_world, current_node, current_node->entity, collider);
+    }
+    else{
+      current_node->entity->physics_body = physics_add_body(physics_world, current_node, current_node->entity, collider, restitution, dynamic);
+    }
+
+    // Optional layer, otherwise the body stays on its entity type's layer
+    cJSON *layer_json = cJSON_GetObjectItemCaseSensitive(collider_json, "layer");
+    if (cJSON_IsString(layer_json)){
+      int layer = physics_layers_find(&physics_world->layers, cJSON_GetStringValue(layer_json));
+      if (layer == PHYSICS_NULL_LAYER){
+        fprintf(stderr, "Error: unknown collision layer %s in scene_process_node_json\n", cJSON_GetStringValue(layer_json));
+      }
+      else{
+        physics_body_set_layer(physics_world, current_node->entity->physics_body, layer);
+      }
+    }
   }
 
   // Process components
@@ -827,7 +1006,7 @@ void scene_process_node_json(
         if (model_index >= 0 && shader_index >= 0){
           render_component_create(
             scene,
-            entity->id,
+            entity->index,
             models[model_index],
             shaders[shader_index]
           );
@@ -844,7 +1023,7 @@ void scene_process_node_json(
 
         int sound_index = cJSON_GetNumberValue(sound_index_json);
         if (sound_index >= 0){
-          audio_component_create(scene, entity->id, audio_manager, sound_index);
+          audio_component_create(scene, entity->index, audio_manager, sound_index);
         }
         break;
       }
@@ -860,7 +1039,7 @@ void scene_process_node_json(
           return;
         }
 
-        entity->item = (struct ItemComponent *)calloc(1, sizeof(struct ItemComponent));
+        entity->item = (struct ItemComponent *)pool_alloc(&scene->item_pool);
         if (!entity->item){
           fprintf(stderr, "Error: failed to allocate Item in scene_process_node_json\n");
           return;
@@ -882,26 +1061,31 @@ void scene_process_node_json(
     return;
   }
   int num_children = cJSON_GetArraySize(children_json);
-  current_node->num_children = num_children;
 
   if (num_children > 0){
-    current_node->children = (struct SceneNode **)calloc(num_children, sizeof(struct SceneNode *));
+    current_node->children = (struct SceneNode **)arena_alloc_array(&scene->arena, num_children, sizeof(struct SceneNode *));
+    if (!current_node->children){
+      fprintf(stderr, "Error: failed to allocate node children in scene_process_node_json\n");
+      return;
+    }
+    current_node->max_children = num_children;
 
     const cJSON *child_node_json;
     int index = 0;
     cJSON_ArrayForEach(child_node_json, children_json){
       // Allocate node
-      current_node->children[index] = (struct SceneNode *)calloc(1, sizeof(struct SceneNode));
+      current_node->children[index] = (struct SceneNode *)pool_alloc(&scene->node_pool);
       if (!current_node->children[index]){
         fprintf(stderr, "Error: failed to allocate child node in scene_process_node_json\n");
         return;
       }
+      current_node->num_children++;
       
       // Assign parent node
       current_node->children[index]->parent_node = current_node;
 
       // Recursively process each child node
-      scene_process_node_json(scene, child_node_json, current_node->children[index], current_node, models, shaders, physics_world);
+      scene_process_node_json(scene, child_node_json, current_node->children[index], models, shaders, physics_world);
       index++;
     }
   }
@@ -975,32 +1159,25 @@ void scene_player_create(
   bool render_entity,
   int inventory_capacity,
   bool is_local){
-  // Reallocate PlayerComponent array if full
-  if (scene->num_player_components >= scene->max_player_components){
-    scene->max_player_components *= 2;
-    scene->player_components = realloc(scene->player_components, scene->max_player_components * sizeof(struct PlayerComponent));
-    if (!scene->player_components){
-      fprintf(stderr, "Error: failed to reallocate scene PlayerComponents in scene_player_create\n");
-      return;
-    }
+  // Create Entity
+  struct Entity *entity = scene_entity_create(scene);
+  if (!entity){
+    fprintf(stderr, "Error: failed to create entity in scene_player_create\n");
+    return;
   }
-  struct PlayerComponent *player = &scene->player_components[scene->num_player_components++];
 
-  // Allocate Entity
-  struct Entity *entity = (struct Entity *)calloc(1, sizeof(struct Entity));
-  if (!entity){
-    fprintf(stderr, "Error: failed to allocate entity in player_init\n");
+  struct PlayerComponent *player = component_store_add(&scene->player_components, entity->index);
+  if (!player){
+    fprintf(stderr, "Error: failed to add PlayerComponent in scene_player_create\n");
     return;
   }
-  scene->entities[scene->num_entities++] = entity;
 
   // Assign values to Entity
-  uuid_generate(entity->id);
   entity->type = ENTITY_PLAYER;
   // entity->model = model;
   // entity->shader = shader;
   glm_vec3_copy(position, entity->position);
-  glm_vec3_copy(rotation, entity->rotation);
+  scene_euler_to_quat(rotation, entity->rotation);
   glm_vec3_copy(scale, entity->scale);
   glm_vec3_copy(velocity, entity->velocity);
 
@@ -1008,22 +1185,24 @@ void scene_player_create(
   scene_node_create(scene, entity, scene->root_node);
 
   // Assign values to PlayerComponent
-  memcpy(player->entity_id, entity->id, 16);
+  player->entity = entity->index;
   glm_vec3_copy(camera_offset, player->camera_offset);
   glm_vec3_copy(camera_offset, player->rotated_offset);
   player->camera_height = camera_height;
   player->render_entity = render_entity;
   player->is_local = is_local;
+  // The body is added once the scene graph is built, see scene_load
+  physics_character_init(&player->character, PHYSICS_NULL_HANDLE);
 
-  // Local player entity uuid
+  // Local player entity
   if (is_local){
-    memcpy(scene->local_player_entity_id, entity->id, 16);
+    scene->local_player_entity = entity->index;
   }
 
   // RenderComponent (could possibly only check model and shader, use render_entity
   // for determining whether to render later so it can be toggled)
   if (render_entity && model && shader){
-    render_component_create(scene, player->entity_id, model, shader);
+    render_component_create(scene, entity->index, model, shader);
   }
 
   // CameraComponent
@@ -1034,7 +1213,7 @@ void scene_player_create(
   float fov = 90.0f;
   float sensitivity = 0.1f;
   float speed = 2.5f;
-  camera_create(scene, entity->id, cameraPos, cameraUp, yaw, pitch, fov, sensitivity, speed);
+  camera_create(scene, entity->index, cameraPos, cameraUp, yaw, pitch, fov, sensitivity, speed);
 
   // AudioComponent
   struct AudioManager *audio_manager = engine_get_audio_manager();
@@ -1042,120 +1221,153 @@ void scene_player_create(
     fprintf(stderr, "Error: failed to get AudioManager in scene_player_create\n");
     return;
   }
-  audio_component_create(scene, player->entity_id, audio_manager, 0);
+  audio_component_create(scene, entity->index, audio_manager, 0);
 
   // Set listener position to camera position
-  audio_listener_update(scene, entity->id);
+  audio_listener_update(scene, entity->index);
 }
 
-void scene_node_update(struct Scene *scene, struct SceneNode *current_node){
-  // if (current_node->entity){
-    // Update position, rotation
-  if (current_node->entity->physics_body){
-    glm_vec3_copy(current_node->entity->physics_body->position, current_node->position);
-    glm_vec3_copy(current_node->entity->physics_body->position, current_node->entity->position);
-    glm_vec3_copy(current_node->entity->physics_body->rotation, current_node->rotation);
-    glm_vec3_copy(current_node->entity->physics_body->rotation, current_node->entity->rotation);
-  }
+// One pass over the flat node array, parents before children.
+// A node's world transform is rebuilt only if it's dirty or its parent's changed this pass,
+// and its render transform only if that changed too or its body is between physics steps.
+// Nodes with bodies are marked by physics_step when their body moves, so static level geometry,
+// which is most of the scene, costs a flag check
+void scene_update_transforms(struct Scene *scene){
+  for (unsigned int i = 0; i < scene->num_nodes; i++){
+    struct SceneNode *current_node = scene->nodes[i];
+    struct SceneNode *parent_node = current_node->parent_node;
+
+    // Build local and world transforms
+    current_node->world_changed = current_node->dirty || (parent_node && parent_node->world_changed);
+    if (current_node->dirty){
+      scene_node_build_local_transform(current_node->position, current_node->rotation, current_node->scale, current_node->local_transform);
+      current_node->dirty = false;
+    }
+    if (current_node->world_changed){
+      scene_node_build_world_transform(current_node);
+    }
 
-  // Build local and world transforms
-  glm_mat4_identity(current_node->local_transform);
-  glm_translate(current_node->local_transform, current_node->position);
-  vec3 rotation_radians = {
-    glm_rad(current_node->rotation[0]),
-    glm_rad(current_node->rotation[1]),
-    glm_rad(current_node->rotation[2])
-  };
-  mat4 rotation;
-  glm_euler_xyz(rotation_radians, rotation);
-  glm_mul(current_node->local_transform, rotation, current_node->local_transform);
-  glm_scale(current_node->local_transform, current_node->scale);
-  // Combine parent transform
-  if (current_node->parent_node){
-    glm_mat4_mul(current_node->parent_node->world_transform, current_node->local_transform, current_node->world_transform);
-  }
-  else {
-    glm_mat4_copy(current_node->local_transform, current_node->world_transform);
-  }
-
-  // Update RenderComponent
-  struct RenderComponent *render_component = scene_get_render_component_by_entity_id(scene, current_node->entity_id);
-  if (render_component){
-    // Copy node world transform to render component
-    glm_mat4_copy(current_node->world_transform, render_component->world_transform);
-  }
-
-  // Update AudioComponent
-  struct AudioComponent *audio_component = scene_get_audio_component_by_entity_id(scene, current_node->entity->id);
-  if (audio_component){
-    alSource3f(audio_component->source_id, AL_POSITION,
-               current_node->entity->position[0],
-               current_node->entity->position[1],
-               current_node->entity->position[2]);
-    ALenum position_error = alGetError();
-    if (position_error != AL_NO_ERROR){
-      fprintf(stderr, "Error matching Entity audio_source position with entity position in scene_update: %d\n", position_error);
+    // Build the render transform from the interpolated physics state
+    current_node->render_changed = current_node->world_changed || current_node->interpolating || (parent_node && parent_node->render_changed);
+    if (current_node->render_changed){
+      mat4 render_local_transform;
+      struct PhysicsBody *physics_body = current_node->interpolating && current_node->entity ? physics_get_body(scene->physics_world, current_node->entity->physics_body) : NULL;
+      if (physics_body){
+        vec3 render_position;
+        versor render_rotation;
+        physics_body_interpolate(physics_body, scene->physics_alpha, render_position, render_rotation);
+        scene_node_build_local_transform(render_position, render_rotation, current_node->scale, render_local_transform);
+      }
+      else {
+        glm_mat4_copy(current_node->local_transform, render_local_transform);
+      }
+      if (parent_node){
+        glm_mat4_mul(parent_node->render_transform, render_local_transform, current_node->render_transform);
+      }
+      else {
+        glm_mat4_copy(render_local_transform, current_node->render_transform);
+      }
+
+      // Update RenderComponent
+      struct RenderComponent *render_component = current_node->entity ? scene_get_render_component(scene, current_node->entity->index) : NULL;
+      if (render_component){
+        // Copy node render transform to render component
+        glm_mat4_copy(current_node->render_transform, render_component->world_transform);
+      }
     }
-  }
 
-  for (unsigned int i = 0; i < current_node->num_children; i++){
-    scene_node_update(scene, current_node->children[i]);
+    // Update AudioComponent
+    if (current_node->world_changed && current_node->entity){
+      struct AudioComponent *audio_component = scene_get_audio_component(scene, current_node->entity->index);
+      if (audio_component){
+        alSource3f(audio_component->source_id, AL_POSITION,
+                   current_node->entity->position[0],
+                   current_node->entity->position[1],
+                   current_node->entity->position[2]);
+        ALenum position_error = alGetError();
+        if (position_error != AL_NO_ERROR){
+          fprintf(stderr, "Error matching Entity audio_source position with entity position in scene_update_transforms: %d\n", position_error);
+        }
+      }
+    }
   }
 }
 
-void scene_node_create(struct Scene *scene, struct Entity *entity, struct SceneNode *parent_node)
+void scene_node_set_position(struct SceneNode *scene_node, vec3 position){
+  glm_vec3_copy(position, scene_node->position);
+  scene_node->dirty = true;
+}
+
+void scene_node_set_rotation(struct SceneNode *scene_node, versor rotation){
+  glm_quat_copy(rotation, scene_node->rotation);
+  scene_node->dirty = true;
+}
+
+// For editors and anything else that thinks in Euler angles (degrees)
+void scene_node_set_rotation_euler(struct SceneNode *scene_node, vec3 euler_degrees){
+  scene_euler_to_quat(euler_degrees, scene_node->rotation);
+  scene_node->dirty = true;
+}
+
+void scene_node_set_scale(struct SceneNode *scene_node, vec3 scale){
+  glm_vec3_copy(scale, scene_node->scale);
+  scene_node->dirty = true;
+}
+
+struct SceneNode *scene_node_create(struct Scene *scene, struct Entity *entity, struct SceneNode *parent_node)
 {
   // A node must be created as a child of a parent node
   if (!parent_node){
     fprintf(stderr, "Error: no parent node provided to scene_node_create\n");
-    return;
+    return NULL;
   }
 
-  // Reallocate parent node's children
-  // (refactor to include max_children, double size?)
-  parent_node->num_children += 1;
-  parent_node->children = realloc(parent_node->children, parent_node->num_children);
-  if (!parent_node->children){
-    fprintf(stderr, "Error: failed to reallocate parent node children in scene_node_create\n");
-    return;
+  // Grow parent node's children. The old array stays in the arena until the scene is unloaded,
+  // which doubling keeps to less than the size of the new one
+  if (parent_node->num_children >= parent_node->max_children){
+    unsigned int max_children = parent_node->max_children ? parent_node->max_children * 2 : 4;
+    struct SceneNode **children = (struct SceneNode **)arena_alloc_array(&scene->arena, max_children, sizeof(struct SceneNode *));
+    if (!children){
+      fprintf(stderr, "Error: failed to reallocate parent node children in scene_node_create\n");
+      return NULL;
+    }
+    if (parent_node->num_children > 0){
+      memcpy(children, parent_node->children, parent_node->num_children * sizeof(struct SceneNode *));
+    }
+    parent_node->children = children;
+    parent_node->max_children = max_children;
   }
 
   // Initialize SceneNode
-  parent_node->children[parent_node->num_children - 1] = (struct SceneNode *)calloc(1, sizeof(struct SceneNode));
-  if (!parent_node->children[parent_node->num_children - 1]){
+  struct SceneNode *scene_node = (struct SceneNode *)pool_alloc(&scene->node_pool);
+  if (!scene_node){
     fprintf(stderr, "Error: failed to allocate SceneNode in scene_node_create\n");
-    return;
+    return NULL;
   }
-  struct SceneNode *scene_node = parent_node->children[parent_node->num_children - 1];
-  memcpy(scene_node->entity_id, entity->id, 16);
+  parent_node->children[parent_node->num_children++] = scene_node;
   glm_vec3_copy(entity->position, scene_node->position);
-  glm_vec3_copy(entity->rotation, scene_node->rotation);
+  glm_quat_copy(entity->rotation, scene_node->rotation);
   glm_vec3_copy(entity->scale, scene_node->scale);
 
-  // Build local and world transforms
-  glm_mat4_identity(scene_node->local_transform);
-  glm_translate(scene_node->local_transform, scene_node->position);
-  vec3 rotation_radians = {
-    glm_rad(scene_node->rotation[0]),
-    glm_rad(scene_node->rotation[1]),
-    glm_rad(scene_node->rotation[2])
-  };
-  mat4 rotation;
-  glm_euler_xyz(rotation_radians, rotation);
-  glm_mul(scene_node->local_transform, rotation, scene_node->local_transform);
-  glm_scale(scene_node->local_transform, scene_node->scale);
-  glm_mat4_mul(parent_node->world_transform, scene_node->local_transform, scene_node->world_transform);
-
   scene_node->entity = entity;
   scene_node->parent_node = parent_node;
   scene_node->children = NULL;
   scene_node->num_children = 0;
+  scene_node->max_children = 0;
+
+  // Build local and world transforms
+  scene_node_build_local_transform(scene_node->position, scene_node->rotation, scene_node->scale, scene_node->local_transform);
+  scene_node_build_world_transform(scene_node);
+
+  // Its parent is already in the flat array, so appending keeps parents first
+  scene_add_node(scene, scene_node);
+  return scene_node;
 }
 
-// Recursive function to search the scene graph for the node with the entity with the given entity_id
-void scene_get_node_by_entity_id(struct SceneNode *current_node, uuid_t entity_id, int *child_index, int *final_child_index, struct SceneNode **dest){
+// Recursive function to search the scene graph for the node with the given entity
+void scene_get_node_by_entity(struct SceneNode *current_node, EntityIndex entity, int *child_index, int *final_child_index, struct SceneNode **dest){
   if (current_node->entity){
-    if (uuid_compare(current_node->entity->id, entity_id) == 0){
+    if (current_node->entity->index == entity){
       *dest = current_node;
       *final_child_index = *child_index;
     }
@@ -1163,144 +1375,229 @@ void scene_get_node_by_entity_id(struct SceneNode *current_node, uuid_t entity_i
 
   for (unsigned int i = 0; i < current_node->num_children; i++){
     *child_index = i;
-    scene_get_node_by_entity_id(current_node->children[i], entity_id, child_index, final_child_index, dest);
+    scene_get_node_by_entity(current_node->children[i], entity, child_index, final_child_index, dest);
   }
 }
 
-void scene_remove_scene_node(struct SceneNode *scene_node){
-  // Remove this node's children
-  if (scene_node->children){
-    for (unsigned int i = 0; i < scene_node->num_children; i++){
-      scene_remove_scene_node(scene_node->children[i]);
-    }
+// ENTITIES
+//
+// Allocate an entity from the entity pool with a fresh id, and give it the most recently freed index
+// (or the next new one) so indices, and the component stores' sparse arrays, stay dense
+struct Entity *scene_entity_create(struct Scene *scene){
+  struct Entity *entity = (struct Entity *)pool_alloc(&scene->entity_pool);
+  if (!entity){
+    fprintf(stderr, "Error: failed to allocate entity in scene_entity_create\n");
+    return NULL;
   }
+  uuid_generate(entity->id);
+  entity->physics_body = PHYSICS_NULL_HANDLE;
+  glm_quat_identity(entity->rotation);
 
-  // Remove this node
-  free(scene_node);
-}
+  if (scene->num_free_entity_indices > 0){
+    entity->index = scene->free_entity_indices[--scene->num_free_entity_indices];
+  }
+  else{
+    entity->index = scene->next_entity_index++;
+  }
 
-void scene_remove_entity(struct Scene *scene, uuid_t entity_id){
-  // Find and remove the correct SceneNode
-  struct SceneNode *node_to_remove = NULL;
-  int child_index, final_child_index;
-  scene_get_node_by_entity_id(scene->root_node, entity_id, &child_index, &final_child_index, &node_to_remove);
-  // printf("Address of node_to_remove: %p\n", node_to_remove);
-  if (node_to_remove){
-    // If the node we want to remove has a parent node,
-    // swap and pop its last child to the place of the node we removed
-    struct SceneNode *parent_node = node_to_remove->parent_node;
-    scene_remove_scene_node(node_to_remove);
-    if (parent_node){
-      parent_node->children[final_child_index] = parent_node->children[parent_node->num_children - 1];
-      parent_node->num_children--;
-    }
+  struct Entity **slot = component_store_add(&scene->entities, entity->index);
+  if (!slot){
+    fprintf(stderr, "Error: failed to add entity in scene_entity_create\n");
+    pool_free(&scene->entity_pool, entity);
+    return NULL;
   }
+  *slot = entity;
+  return entity;
+}
 
-  // Remove entity and its components
-  for(unsigned int i = 0; i < scene->num_entities; i++){
-    if (uuid_compare(scene->entities[i]->id, entity_id) == 0){
-      // PhysicsBody
-      physics_remove_body(scene->physics_world, scene->entities[i]->physics_body);
+void scene_remove_entity(struct Scene *scene, EntityIndex entity_index){
+  scene_remove_entities(scene, &entity_index, 1);
+}
 
-      // AudioComponent
-      scene_remove_audio_component_by_entity_id(scene, entity_id);
+// Drop a removed node from its parent's children, swapping the last child into its place
+static void scene_node_detach(struct SceneNode *scene_node){
+  struct SceneNode *parent_node = scene_node->parent_node;
+  if (!parent_node) return;
+  for (unsigned int i = 0; i < parent_node->num_children; i++){
+    if (parent_node->children[i] == scene_node){
+      parent_node->children[i] = parent_node->children[--parent_node->num_children];
+      return;
+    }
+  }
+}
 
-      // RenderComponent
-      scene_remove_render_component_by_entity_id(scene, entity_id);
+// Release an entity's body and components, return it to the pool and its index to the free list
+static void scene_release_entity(struct Scene *scene, struct Entity *entity){
+  EntityIndex entity_index = entity->index;
 
-      // ItemComponent
-      if (scene->entities[i]->item){
-        free(scene->entities[i]->item);
-      }
-      // printf("Successfully removed item component\n");
+  // PhysicsBody
+  physics_remove_body(scene->physics_world, entity->physics_body);
 
-      // Entity
-      free(scene->entities[i]);
-      scene->entities[i] = scene->entities[scene->num_entities - 1];
-      scene->num_entities--;
-      // printf("Successfully removed entity\n");
+  // AudioComponent
+  scene_remove_audio_component(scene, entity_index);
+
+  // RenderComponent
+  scene_remove_render_component(scene, entity_index);
+
+  // ItemComponent
+  pool_free(&scene->item_pool, entity->item);
+
+  // CameraComponent, PlayerComponent and InventoryComponent
+  scene_remove_camera_component(scene, entity_index);
+  scene_remove_player_component(scene, entity_index);
+  scene_remove_inventory_component(scene, entity_index);
+
+  // Entity, its index goes back on the free list
+  component_store_remove(&scene->entities, entity_index);
+  pool_free(&scene->entity_pool, entity);
+  if (scene->num_free_entity_indices >= scene->max_free_entity_indices){
+    unsigned int max_free_entity_indices = scene->max_free_entity_indices ? scene->max_free_entity_indices * 2 : 16;
+    EntityIndex *free_entity_indices = realloc(scene->free_entity_indices, max_free_entity_indices * sizeof(EntityIndex));
+    if (!free_entity_indices){
+      // The index just isn't reused
+      fprintf(stderr, "Error: failed to reallocate free entity indices in scene_release_entity\n");
+      return;
     }
+    scene->free_entity_indices = free_entity_indices;
+    scene->max_free_entity_indices = max_free_entity_indices;
   }
+  scene->free_entity_indices[scene->num_free_entity_indices++] = entity_index;
 }
 
-struct Entity *scene_get_entity_by_entity_id(struct Scene *scene, uuid_t entity_id){
-  for (unsigned int i = 0; i < scene->num_entities; i++){
-    if (uuid_compare(scene->entities[i]->id, entity_id) == 0){
-      return scene->entities[i];
+// Remove a batch of entities, along with everything under their nodes in the scene graph.
+// Entities are marked first, then one pass over the flat node array drops their subtrees
+// (parents come first, so a node goes if its entity is marked or its parent went)
+// and compacts it once, instead of searching the tree and compacting per entity
+void scene_remove_entities(struct Scene *scene, EntityIndex *entities, unsigned int num_entities){
+  unsigned int num_marked = 0;
+  for (unsigned int i = 0; i < num_entities; i++){
+    struct Entity *entity = scene_get_entity(scene, entities[i]);
+    if (entity){
+      entity->pending_removal = true;
+      num_marked++;
     }
   }
-  return NULL;
-}
+  if (num_marked == 0) return;
+
+  unsigned int num_nodes = 0;
+  unsigned int num_removed_nodes = 0;
+  for (unsigned int i = 0; i < scene->num_nodes; i++){
+    struct SceneNode *scene_node = scene->nodes[i];
+    struct SceneNode *parent_node = scene_node->parent_node;
+    bool removed = (scene_node->entity && scene_node->entity->pending_removal) || (parent_node && parent_node->removed);
+    scene_node->removed = removed;
+    if (!removed){
+      scene->nodes[num_nodes++] = scene_node;
+      continue;
+    }
 
-struct RenderComponent *scene_get_render_component_by_entity_id(struct Scene *scene, uuid_t entity_id){
-  for (unsigned int i = 0; i < scene->num_render_components; i++){
-    if (uuid_compare(scene->render_components[i].entity_id, entity_id) == 0){
-      return &scene->render_components[i];
+    if (scene_node->entity){
+      scene_node->entity->pending_removal = true;
+    }
+    if (parent_node && !parent_node->removed){
+      scene_node_detach(scene_node);
     }
-  }
-  return NULL;
-}
 
-struct PlayerComponent *scene_get_player_by_entity_id(struct Scene *scene, uuid_t entity_id){
-  for (unsigned int i = 0; i < scene->num_player_components; i++){
-    if (uuid_compare(scene->player_components[i].entity_id, entity_id) == 0){
-      return &scene->player_components[i];
+    // Nodes are only released once the pass is done, their children still read their removed flag
+    if (num_removed_nodes >= scene->max_removed_nodes){
+      unsigned int max_removed_nodes = scene->max_removed_nodes ? scene->max_removed_nodes * 2 : 16;
+      struct SceneNode **removed_nodes = realloc(scene->removed_nodes, max_removed_nodes * sizeof(struct SceneNode *));
+      if (!removed_nodes){
+        // The node just isn't returned to the pool until the scene is unloaded
+        fprintf(stderr, "Error: failed to reallocate removed nodes in scene_remove_entities\n");
+        if (scene_node->entity) scene_release_entity(scene, scene_node->entity);
+        continue;
+      }
+      scene->removed_nodes = removed_nodes;
+      scene->max_removed_nodes = max_removed_nodes;
     }
+    scene->removed_nodes[num_removed_nodes++] = scene_node;
   }
-  return NULL;
-}
+  scene->num_nodes = num_nodes;
 
-struct InventoryComponent *scene_get_inventory_by_entity_id(struct Scene *scene, uuid_t entity_id){
-  for (unsigned int i = 0; i < scene->num_inventory_components; i++){
-    if (uuid_compare(scene->inventory_components[i].entity_id, entity_id) == 0){
-      return &scene->inventory_components[i];
+  for (unsigned int i = 0; i < num_removed_nodes; i++){
+    struct SceneNode *scene_node = scene->removed_nodes[i];
+    if (scene_node->entity){
+      scene_release_entity(scene, scene_node->entity);
     }
+    pool_free(&scene->node_pool, scene_node);
   }
-  return NULL;
-}
 
-struct CameraComponent *scene_get_camera_by_entity_id(struct Scene *scene, uuid_t entity_id){
-  for (unsigned int i = 0; i < scene->num_camera_components; i++){
-    if (uuid_compare(scene->camera_components[i].entity_id, entity_id) == 0){
-      return &scene->camera_components[i];
+  // Entities without a node
+  for (unsigned int i = 0; i < num_entities; i++){
+    struct Entity *entity = scene_get_entity(scene, entities[i]);
+    if (entity && entity->pending_removal){
+      scene_release_entity(scene, entity);
     }
   }
-  return NULL;
 }
 
-struct AudioComponent *scene_get_audio_component_by_entity_id(struct Scene *scene, uuid_t entity_id){
-  for (unsigned int i = 0; i < scene->num_audio_components; i++){
-    if (uuid_compare(scene->audio_components[i].entity_id, entity_id) == 0){
-      return &scene->audio_components[i];
+struct Entity *scene_get_entity(struct Scene *scene, EntityIndex entity){
+  struct Entity **slot = component_store_get(&scene->entities, entity);
+  return slot ? *slot : NULL;
+}
+
+struct Entity *scene_find_entity_by_id(struct Scene *scene, uuid_t entity_id){
+  for (unsigned int i = 0; i < scene->entities.num_components; i++){
+    struct Entity **slot = component_store_at(&scene->entities, i);
+    if (uuid_compare((*slot)->id, entity_id) == 0){
+      return *slot;
     }
   }
   return NULL;
 }
 
-bool scene_remove_render_component_by_entity_id(struct Scene *scene, uuid_t entity_id){
-  for (unsigned int i = 0; i < scene->num_render_components; i++){
-    if (uuid_compare(scene->render_components[i].entity_id, entity_id) == 0){
-      scene->render_components[i] = scene->render_components[scene->num_render_components - 1];
-      scene->num_render_components--;
-      return true;
-    }
-  }
-  return false;
+// COMPONENTS
+//
+struct RenderComponent *scene_get_render_component(struct Scene *scene, EntityIndex entity){
+  return component_store_get(&scene->render_components, entity);
 }
 
-bool scene_remove_audio_component_by_entity_id(struct Scene *scene, uuid_t entity_id){
-  for (unsigned int i = 0; i < scene->num_audio_components; i++){
-    if (uuid_compare(scene->audio_components[i].entity_id, entity_id) == 0){
-      struct AudioManager *audio_manager = engine_get_audio_manager();
-      if (!audio_manager){
-        fprintf(stderr, "Error: failed to get AudioManager in scene_remove_audio_component_by_entity_id\n");
-        return false;
-      }
-      audio_component_destroy(audio_manager, &scene->audio_components[i]);
-      scene->audio_components[i] = scene->audio_components[scene->num_audio_components - 1];
-      scene->num_audio_components--;
-      return true;
-    }
+struct PlayerComponent *scene_get_player(struct Scene *scene, EntityIndex entity){
+  return component_store_get(&scene->player_components, entity);
+}
+
+struct InventoryComponent *scene_get_inventory(struct Scene *scene, EntityIndex entity){
+  return component_store_get(&scene->inventory_components, entity);
+}
+
+struct CameraComponent *scene_get_camera(struct Scene *scene, EntityIndex entity){
+  return component_store_get(&scene->camera_components, entity);
+}
+
+struct AudioComponent *scene_get_audio_component(struct Scene *scene, EntityIndex entity){
+  return component_store_get(&scene->audio_components, entity);
+}
+
+bool scene_remove_render_component(struct Scene *scene, EntityIndex entity){
+  return component_store_remove(&scene->render_components, entity);
+}
+
+bool scene_remove_camera_component(struct Scene *scene, EntityIndex entity){
+  return component_store_remove(&scene->camera_components, entity);
+}
+
+bool scene_remove_player_component(struct Scene *scene, EntityIndex entity){
+  return component_store_remove(&scene->player_components, entity);
+}
+
+bool scene_remove_inventory_component(struct Scene *scene, EntityIndex entity){
+  struct InventoryComponent *inventory_component = component_store_get(&scene->inventory_components, entity);
+  if (!inventory_component) return false;
+
+  free(inventory_component->items);
+  return component_store_remove(&scene->inventory_components, entity);
+}
+
+bool scene_remove_audio_component(struct Scene *scene, EntityIndex entity){
+  struct AudioComponent *audio_component = component_store_get(&scene->audio_components, entity);
+  if (!audio_component) return false;
+
+  struct AudioManager *audio_manager = engine_get_audio_manager();
+  if (!audio_manager){
+    fprintf(stderr, "Error: failed to get AudioManager in scene_remove_audio_component\n");
+    return false;
   }
-  return false;
+  audio_component_destroy(audio_manager, audio_component);
+  return component_store_remove(&scene->audio_components, entity);
 }
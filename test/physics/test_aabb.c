@@ -104,6 +104,34 @@ void test_aabb_intersect_plane_false(void){
   TEST_ASSERT_FALSE(AABB_intersect_plane(&box, &plane2));
 }
 
+void test_aabb_intersect_segment(void){
+  struct AABB box = {
+    .center = {4.0f, 0.0f, 0.0f},
+    .extents = {1.0f, 1.0f, 1.0f}
+  };
+  vec3 origin = {0.0f, 0.0f, 0.0f};
+  vec3 translation = {10.0f, 0.0f, 0.0f};
+  vec3 no_extents = {0.0f, 0.0f, 0.0f};
+  float entry;
+
+  TEST_ASSERT_TRUE(AABB_intersect_segment(&box, no_extents, origin, translation, 1.0f, &entry));
+  TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.3f, entry);
+  // Clipped before it gets there
+  TEST_ASSERT_FALSE(AABB_intersect_segment(&box, no_extents, origin, translation, 0.25f, &entry));
+  // A box with half size 0.5 swept along the segment reaches it sooner
+  vec3 extents = {0.5f, 0.5f, 0.5f};
+  TEST_ASSERT_TRUE(AABB_intersect_segment(&box, extents, origin, translation, 1.0f, &entry));
+  TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.25f, entry);
+  // Passing above it, but close enough for the swept box to clip it
+  vec3 above = {0.0f, 1.25f, 0.0f};
+  TEST_ASSERT_FALSE(AABB_intersect_segment(&box, no_extents, above, translation, 1.0f, &entry));
+  TEST_ASSERT_TRUE(AABB_intersect_segment(&box, extents, above, translation, 1.0f, &entry));
+  // Starting inside enters at 0
+  vec3 inside = {4.0f, 0.5f, 0.0f};
+  TEST_ASSERT_TRUE(AABB_intersect_segment(&box, no_extents, inside, translation, 1.0f, &entry));
+  TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.0f, entry);
+}
+
 
 // OTHER TESTS
 //
@@ -140,6 +168,37 @@ void test_aabb_update(void){
   assert_aabb_equal(&expected, &dest);
 }
 
+// Tests in the other files, run from main below, which owns setUp and tearDown for the whole runner
+
+// Batch kernel tests, see test_batch.c
+void test_AABB_intersect_AABB_batch_matches_scalar(void);
+void test_batch_empty(void);
+void test_motion_batch_integrate_matches_scalar(void);
+
+// Broad phase tests, see test_dynamic_tree.c and test_sweep_and_prune.c
+void test_dynamic_tree_matches_brute_force(void);
+void test_dynamic_tree_sorted_inserts_stay_balanced(void);
+void test_sweep_and_prune_matches_brute_force(void);
+void test_sweep_and_prune_remove_pairs_across_wrapped_cluster(void);
+
+// GJK, EPA and cache tests, see test_gjk.c
+void test_gjk_sphere_distance(void);
+void test_gjk_capsule_distance(void);
+void test_gjk_box_distance(void);
+void test_gjk_plane_without_support(void);
+void test_epa_box_penetration(void);
+void test_gjk_cached_matches_uncached(void);
+void test_gjk_cache_key_ignores_order(void);
+void test_gjk_cache_flip(void);
+void test_gjk_cache_table_insert_find(void);
+
+// Scene storage tests, see test/scene
+void test_component_store_add_get_remove(void);
+void test_component_store_remove_swaps_last(void);
+void test_pool_reuses_freed_items_zeroed(void);
+void test_arena_oversized_block_behind_head(void);
+void test_entity_commands_add_component_to_deferred_spawn(void);
+void test_entity_commands_destroy_removes_subtrees(void);
 
 int main(void){
   UNITY_BEGIN();
@@ -147,6 +206,29 @@ int main(void){
   RUN_TEST(test_non_intersecting_aabbs_false);
   RUN_TEST(test_aabb_intersect_plane_true);
   RUN_TEST(test_aabb_intersect_plane_false);
+  RUN_TEST(test_aabb_intersect_segment);
   RUN_TEST(test_aabb_update);
+  RUN_TEST(test_AABB_intersect_AABB_batch_matches_scalar);
+  RUN_TEST(test_batch_empty);
+  RUN_TEST(test_motion_batch_integrate_matches_scalar);
+  RUN_TEST(test_dynamic_tree_matches_brute_force);
+  RUN_TEST(test_dynamic_tree_sorted_inserts_stay_balanced);
+  RUN_TEST(test_sweep_and_prune_matches_brute_force);
+  RUN_TEST(test_sweep_and_prune_remove_pairs_across_wrapped_cluster);
+  RUN_TEST(test_gjk_sphere_distance);
+  RUN_TEST(test_gjk_capsule_distance);
+  RUN_TEST(test_gjk_box_distance);
+  RUN_TEST(test_gjk_plane_without_support);
+  RUN_TEST(test_epa_box_penetration);
+  RUN_TEST(test_gjk_cached_matches_uncached);
+  RUN_TEST(test_gjk_cache_key_ignores_order);
+  RUN_TEST(test_gjk_cache_flip);
+  RUN_TEST(test_gjk_cache_table_insert_find);
+  RUN_TEST(test_component_store_add_get_remove);
+  RUN_TEST(test_component_store_remove_swaps_last);
+  RUN_TEST(test_pool_reuses_freed_items_zeroed);
+  RUN_TEST(test_arena_oversized_block_behind_head);
+  RUN_TEST(test_entity_commands_add_component_to_deferred_spawn);
+  RUN_TEST(test_entity_commands_destroy_removes_subtrees);
   return UNITY_END();
 }
@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include "unity.h"
+#include "physics/batch.h"
+
+// Not a multiple of PHYSICS_BATCH_WIDTH, so the scalar tail is covered too
+#define BATCH_TEST_COUNT 103
+
+// Helpers
+static float batch_test_random(float min, float max){
+  return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+// BATCH TESTS
+//
+void test_AABB_intersect_AABB_batch_matches_scalar(void){
+  srand(1);
+  struct AABB query = {
+    .center = {0.5f, -0.25f, 1.0f},
+    .extents = {1.0f, 2.0f, 0.5f}
+  };
+  struct AABBBatch batch = {0};
+  for (int i = 0; i < BATCH_TEST_COUNT; i++){
+    struct AABB aabb;
+    for (int j = 0; j < 3; j++){
+      aabb.center[j] = batch_test_random(-5.0f, 5.0f);
+      aabb.extents[j] = batch_test_random(0.1f, 3.0f);
+    }
+    TEST_ASSERT_TRUE(AABB_batch_push(&batch, &aabb));
+  }
+  // Exactly touching on x, which counts as intersecting
+  struct AABB touching = {
+    .center = {2.5f, -0.25f, 1.0f},
+    .extents = {1.0f, 1.0f, 1.0f}
+  };
+  AABB_batch_push(&batch, &touching);
+
+  bool results[BATCH_TEST_COUNT + 1];
+  AABB_intersect_AABB_batch(&query, &batch, results);
+  int hits = 0;
+  for (unsigned int i = 0; i < batch.count; i++){
+    struct AABB candidate;
+    AABB_batch_get(&batch, i, &candidate);
+    TEST_ASSERT_EQUAL(AABB_intersect_AABB(&query, &candidate), results[i]);
+    hits += results[i];
+  }
+  TEST_ASSERT_TRUE(results[BATCH_TEST_COUNT]);
+  // Both outcomes should have come up
+  TEST_ASSERT_TRUE(hits > 0 && hits < (int)batch.count);
+  AABB_batch_free(&batch);
+}
+
+void test_batch_empty(void){
+  struct AABB query = {
+    .center = {0.0f, 0.0f, 0.0f},
+    .extents = {1.0f, 1.0f, 1.0f}
+  };
+  struct AABBBatch batch = {0};
+  bool result = true;
+  AABB_intersect_AABB_batch(&query, &batch, &result);
+  TEST_ASSERT_TRUE(result);
+  AABB_batch_free(&batch);
+}
+
+void test_motion_batch_integrate_matches_scalar(void){
+  srand(2);
+  const float gravity_step = 9.8f / 60.0f;
+  const float delta_time = 1.0f / 60.0f;
+  struct MotionBatch batch = {0};
+  vec3 positions[BATCH_TEST_COUNT];
+  vec3 velocities[BATCH_TEST_COUNT];
+  for (int i = 0; i < BATCH_TEST_COUNT; i++){
+    for (int j = 0; j < 3; j++){
+      positions[i][j] = batch_test_random(-5.0f, 5.0f);
+      velocities[i][j] = batch_test_random(-3.0f, 3.0f);
+    }
+    TEST_ASSERT_TRUE(motion_batch_push(&batch, positions[i], velocities[i]));
+  }
+
+  motion_batch_integrate(&batch, gravity_step, delta_time);
+  TEST_ASSERT_EQUAL_UINT(BATCH_TEST_COUNT, batch.count);
+  for (int i = 0; i < BATCH_TEST_COUNT; i++){
+    velocities[i][1] -= gravity_step;
+    glm_vec3_muladds(velocities[i], delta_time, positions[i]);
+    vec3 position, velocity;
+    motion_batch_get(&batch, i, position, velocity);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(positions[i], position, 3);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(velocities[i], velocity, 3);
+  }
+
+  // Cleared batches integrate nothing and keep their arrays for the next step
+  motion_batch_clear(&batch);
+  motion_batch_integrate(&batch, gravity_step, delta_time);
+  TEST_ASSERT_EQUAL_UINT(0, batch.count);
+  TEST_ASSERT_TRUE(batch.capacity >= BATCH_TEST_COUNT);
+  motion_batch_free(&batch);
+}
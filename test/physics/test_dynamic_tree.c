@@ -0,0 +1,173 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "physics/dynamic_tree.h"
+
+#define TREE_TEST_PROXIES 200
+#define TREE_TEST_STEPS 50
+#define TREE_TEST_QUERIES 20
+
+// Helpers
+static float tree_test_random(float min, float max){
+  return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static void random_AABB(struct AABB *aabb){
+  for (int i = 0; i < 3; i++){
+    aabb->center[i] = tree_test_random(-20.0f, 20.0f);
+    aabb->extents[i] = tree_test_random(0.1f, 2.0f);
+  }
+  aabb->initialized = true;
+}
+
+// AABB_contains, allowing for rounding in the center and extents of a union
+static bool tree_test_contains(struct AABB *a, struct AABB *b){
+  for (int i = 0; i < 3; i++){
+    if (b->center[i] - b->extents[i] < a->center[i] - a->extents[i] - 0.0001f) return false;
+    if (b->center[i] + b->extents[i] > a->center[i] + a->extents[i] + 0.0001f) return false;
+  }
+  return true;
+}
+
+static bool tree_test_collect(int proxy_id, void *user_data, void *context){
+  bool *hits = (bool *)context;
+  int index = (int)(intptr_t)user_data;
+  // Every leaf should be reported at most once
+  TEST_ASSERT_FALSE(hits[index]);
+  hits[index] = true;
+  (void)proxy_id;
+  return true;
+}
+
+// Check parent links, bounds and heights below index, returning the subtree's height
+static int tree_test_validate(struct DynamicTree *tree, int index, int parent, int *num_leaves){
+  struct DynamicTreeNode *node = &tree->nodes[index];
+  TEST_ASSERT_EQUAL_INT(parent, node->parent);
+  if (node->left == DYNAMIC_TREE_NULL_NODE){
+    TEST_ASSERT_EQUAL_INT(DYNAMIC_TREE_NULL_NODE, node->right);
+    TEST_ASSERT_EQUAL_INT(0, node->height);
+    (*num_leaves)++;
+    return 0;
+  }
+  TEST_ASSERT_TRUE(tree_test_contains(&node->aabb, &tree->nodes[node->left].aabb));
+  TEST_ASSERT_TRUE(tree_test_contains(&node->aabb, &tree->nodes[node->right].aabb));
+  int left_height = tree_test_validate(tree, node->left, index, num_leaves);
+  int right_height = tree_test_validate(tree, node->right, index, num_leaves);
+  TEST_ASSERT_EQUAL_INT(1 + (left_height > right_height ? left_height : right_height), node->height);
+  return node->height;
+}
+
+// Largest height difference between the two children of any internal node
+static int tree_test_max_imbalance(struct DynamicTree *tree, int index){
+  struct DynamicTreeNode *node = &tree->nodes[index];
+  if (node->left == DYNAMIC_TREE_NULL_NODE) return 0;
+  int imbalance = abs(tree->nodes[node->left].height - tree->nodes[node->right].height);
+  int left = tree_test_max_imbalance(tree, node->left);
+  int right = tree_test_max_imbalance(tree, node->right);
+  if (left > imbalance) imbalance = left;
+  if (right > imbalance) imbalance = right;
+  return imbalance;
+}
+
+// Query random boxes, comparing the leaves found against testing every live proxy's fat AABB
+static void tree_test_check_queries(struct DynamicTree *tree, int *proxy_ids){
+  for (int q = 0; q < TREE_TEST_QUERIES; q++){
+    struct AABB query;
+    random_AABB(&query);
+    glm_vec3_scale(query.extents, 3.0f, query.extents);
+
+    bool hits[TREE_TEST_PROXIES] = {0};
+    dynamic_tree_query(tree, &query, tree_test_collect, hits);
+    for (int i = 0; i < TREE_TEST_PROXIES; i++){
+      bool expected = proxy_ids[i] != DYNAMIC_TREE_NULL_NODE && AABB_intersect_AABB(dynamic_tree_get_fat_AABB(tree, proxy_ids[i]), &query);
+      TEST_ASSERT_EQUAL(expected, hits[i]);
+    }
+  }
+}
+
+// DYNAMIC TREE TESTS
+//
+void test_dynamic_tree_matches_brute_force(void){
+  srand(3);
+  struct DynamicTree tree;
+  TEST_ASSERT_TRUE(dynamic_tree_init(&tree));
+
+  int proxy_ids[TREE_TEST_PROXIES];
+  struct AABB aabbs[TREE_TEST_PROXIES];
+  for (int i = 0; i < TREE_TEST_PROXIES; i++){
+    random_AABB(&aabbs[i]);
+    proxy_ids[i] = dynamic_tree_create_proxy(&tree, &aabbs[i], (void *)(intptr_t)i);
+    TEST_ASSERT_NOT_EQUAL(DYNAMIC_TREE_NULL_NODE, proxy_ids[i]);
+  }
+  tree_test_check_queries(&tree, proxy_ids);
+
+  for (int step = 0; step < TREE_TEST_STEPS; step++){
+    for (int i = 0; i < TREE_TEST_PROXIES; i++){
+      if (proxy_ids[i] == DYNAMIC_TREE_NULL_NODE) continue;
+
+      // Destroy a few proxies as we go, and recreate them later
+      if (rand() % 50 == 0){
+        dynamic_tree_destroy_proxy(&tree, proxy_ids[i]);
+        proxy_ids[i] = DYNAMIC_TREE_NULL_NODE;
+        continue;
+      }
+
+      vec3 displacement;
+      for (int j = 0; j < 3; j++){
+        displacement[j] = tree_test_random(-0.5f, 0.5f);
+      }
+      glm_vec3_add(aabbs[i].center, displacement, aabbs[i].center);
+      dynamic_tree_move_proxy(&tree, proxy_ids[i], &aabbs[i], displacement);
+      // The fat AABB always covers the real one
+      TEST_ASSERT_TRUE(tree_test_contains(dynamic_tree_get_fat_AABB(&tree, proxy_ids[i]), &aabbs[i]));
+    }
+    for (int i = 0; i < TREE_TEST_PROXIES; i++){
+      if (proxy_ids[i] == DYNAMIC_TREE_NULL_NODE && rand() % 4 == 0){
+        random_AABB(&aabbs[i]);
+        proxy_ids[i] = dynamic_tree_create_proxy(&tree, &aabbs[i], (void *)(intptr_t)i);
+      }
+    }
+    tree_test_check_queries(&tree, proxy_ids);
+  }
+
+  int num_live = 0;
+  for (int i = 0; i < TREE_TEST_PROXIES; i++){
+    num_live += proxy_ids[i] != DYNAMIC_TREE_NULL_NODE;
+  }
+  int num_leaves = 0;
+  tree_test_validate(&tree, tree.root, DYNAMIC_TREE_NULL_NODE, &num_leaves);
+  TEST_ASSERT_EQUAL_INT(num_live, num_leaves);
+  // A binary tree with n leaves has n - 1 internal nodes
+  TEST_ASSERT_EQUAL_INT(2 * num_live - 1, tree.num_nodes);
+
+  for (int i = 0; i < TREE_TEST_PROXIES; i++){
+    if (proxy_ids[i] != DYNAMIC_TREE_NULL_NODE) dynamic_tree_destroy_proxy(&tree, proxy_ids[i]);
+  }
+  TEST_ASSERT_EQUAL_INT(DYNAMIC_TREE_NULL_NODE, tree.root);
+  TEST_ASSERT_EQUAL_INT(0, tree.num_nodes);
+  dynamic_tree_free(&tree);
+}
+
+void test_dynamic_tree_sorted_inserts_stay_balanced(void){
+  struct DynamicTree tree;
+  TEST_ASSERT_TRUE(dynamic_tree_init(&tree));
+
+  // Boxes in a row along x, inserted in order, which degenerates into a list without rotations
+  int num_proxies = 256;
+  for (int i = 0; i < num_proxies; i++){
+    struct AABB aabb = {
+      .center = {2.0f * i, 0.0f, 0.0f},
+      .extents = {0.5f, 0.5f, 0.5f},
+      .initialized = true
+    };
+    TEST_ASSERT_NOT_EQUAL(DYNAMIC_TREE_NULL_NODE, dynamic_tree_create_proxy(&tree, &aabb, NULL));
+  }
+
+  int num_leaves = 0;
+  int height = tree_test_validate(&tree, tree.root, DYNAMIC_TREE_NULL_NODE, &num_leaves);
+  TEST_ASSERT_EQUAL_INT(num_proxies, num_leaves);
+  TEST_ASSERT_TRUE(tree_test_max_imbalance(&tree, tree.root) <= 1);
+  // An AVL tree's height is under 1.45 log2(n + 2), about 11.6 for 256 leaves
+  TEST_ASSERT_TRUE(height <= 11);
+  dynamic_tree_free(&tree);
+}
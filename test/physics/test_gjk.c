@@ -0,0 +1,249 @@
+#include <float.h>
+#include <string.h>
+#include "unity.h"
+#include "physics/gjk.h"
+
+#define GJK_TEST_DELTA 0.001f
+
+// Helpers
+static void sphere_shape(struct ConvexShape *shape, vec3 center, float radius){
+  memset(shape, 0, sizeof(struct ConvexShape));
+  shape->type = COLLIDER_SPHERE;
+  glm_vec3_copy(center, shape->data.sphere.center);
+  shape->data.sphere.radius = radius;
+  shape->radius = radius;
+}
+
+// Upright capsule with its segment running from y = 0 to y = height at (x, z)
+static void capsule_shape(struct ConvexShape *shape, float x, float z, float height, float radius){
+  memset(shape, 0, sizeof(struct ConvexShape));
+  shape->type = COLLIDER_CAPSULE;
+  glm_vec3_copy((vec3){x, 0.0f, z}, shape->data.capsule.segment_A);
+  glm_vec3_copy((vec3){x, height, z}, shape->data.capsule.segment_B);
+  shape->data.capsule.radius = radius;
+  shape->radius = radius;
+}
+
+static void box_shape(struct ConvexShape *shape, vec3 center, vec3 extents){
+  memset(shape, 0, sizeof(struct ConvexShape));
+  shape->type = COLLIDER_AABB;
+  glm_vec3_copy(center, shape->data.aabb.center);
+  glm_vec3_copy(extents, shape->data.aabb.extents);
+  shape->data.aabb.initialized = true;
+}
+
+static void assert_gjk_vec3(vec3 expected, vec3 actual){
+  for (int i = 0; i < 3; i++){
+    TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, expected[i], actual[i]);
+  }
+}
+
+static void assert_gjk_result_equal(struct GJKResult *expected, struct GJKResult *actual){
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, expected->distance, actual->distance);
+  assert_gjk_vec3(expected->normal, actual->normal);
+}
+
+// GJK TESTS
+//
+void test_gjk_sphere_distance(void){
+  struct ConvexShape a, b;
+  sphere_shape(&a, (vec3){0.0f, 0.0f, 0.0f}, 1.0f);
+
+  // Separated
+  sphere_shape(&b, (vec3){3.0f, 0.0f, 0.0f}, 0.5f);
+  struct GJKResult result = gjk_distance(&a, &b, NULL);
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, 1.5f, result.distance);
+  assert_gjk_vec3((vec3){1.0f, 0.0f, 0.0f}, result.normal);
+  assert_gjk_vec3((vec3){1.0f, 0.0f, 0.0f}, result.point_A);
+  assert_gjk_vec3((vec3){2.5f, 0.0f, 0.0f}, result.point_B);
+
+  // Overlapping, the centers are still apart so it's just the radii
+  sphere_shape(&b, (vec3){0.0f, 1.5f, 0.0f}, 1.0f);
+  result = gjk_distance(&a, &b, NULL);
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, -0.5f, result.distance);
+  assert_gjk_vec3((vec3){0.0f, 1.0f, 0.0f}, result.normal);
+}
+
+void test_gjk_capsule_distance(void){
+  struct ConvexShape a, b;
+  capsule_shape(&a, 0.0f, 0.0f, 2.0f, 0.5f);
+
+  // Side by side
+  capsule_shape(&b, 0.0f, 3.0f, 2.0f, 0.5f);
+  struct GJKResult result = gjk_distance(&a, &b, NULL);
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, 2.0f, result.distance);
+  assert_gjk_vec3((vec3){0.0f, 0.0f, 1.0f}, result.normal);
+
+  // Overlapping by 0.2
+  capsule_shape(&b, 0.8f, 0.0f, 2.0f, 0.5f);
+  result = gjk_distance(&a, &b, NULL);
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, -0.2f, result.distance);
+  assert_gjk_vec3((vec3){1.0f, 0.0f, 0.0f}, result.normal);
+}
+
+void test_gjk_box_distance(void){
+  struct ConvexShape a, b;
+  box_shape(&a, (vec3){0.0f, 0.0f, 0.0f}, (vec3){1.0f, 1.0f, 1.0f});
+
+  // Separated along x
+  box_shape(&b, (vec3){3.0f, 0.5f, 0.0f}, (vec3){1.0f, 1.0f, 1.0f});
+  struct GJKResult result = gjk_distance(&a, &b, NULL);
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, 1.0f, result.distance);
+  assert_gjk_vec3((vec3){1.0f, 0.0f, 0.0f}, result.normal);
+
+  // Sphere against a box face
+  struct ConvexShape sphere;
+  sphere_shape(&sphere, (vec3){0.0f, 0.0f, -2.5f}, 1.0f);
+  result = gjk_distance(&a, &sphere, NULL);
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, 0.5f, result.distance);
+  assert_gjk_vec3((vec3){0.0f, 0.0f, -1.0f}, result.normal);
+}
+
+// A plane against a shape with no support function (a mesh) is reported as far apart, not followed
+void test_gjk_plane_without_support(void){
+  struct ConvexShape plane, mesh;
+  memset(&plane, 0, sizeof(struct ConvexShape));
+  plane.type = COLLIDER_PLANE;
+  glm_vec3_copy((vec3){0.0f, 1.0f, 0.0f}, plane.data.plane.normal);
+  memset(&mesh, 0, sizeof(struct ConvexShape));
+  mesh.type = COLLIDER_MESH;
+
+  TEST_ASSERT_EQUAL_FLOAT(FLT_MAX, gjk_distance(&plane, &mesh, NULL).distance);
+  TEST_ASSERT_EQUAL_FLOAT(FLT_MAX, gjk_distance(&mesh, &plane, NULL).distance);
+}
+
+// Boxes have no radius, so any overlap goes through EPA
+void test_epa_box_penetration(void){
+  struct ConvexShape a, b;
+  box_shape(&a, (vec3){0.0f, 0.0f, 0.0f}, (vec3){2.0f, 2.0f, 2.0f});
+  box_shape(&b, (vec3){0.5f, 3.5f, -0.25f}, (vec3){2.0f, 2.0f, 2.0f});
+
+  struct GJKResult result = gjk_distance(&a, &b, NULL);
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, -0.5f, result.distance);
+  assert_gjk_vec3((vec3){0.0f, 1.0f, 0.0f}, result.normal);
+  // The deepest points are 0.5 apart along the normal
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, 2.0f, result.point_A[1]);
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, 1.5f, result.point_B[1]);
+
+  // And the other way around
+  result = gjk_distance(&b, &a, NULL);
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, -0.5f, result.distance);
+  assert_gjk_vec3((vec3){0.0f, -1.0f, 0.0f}, result.normal);
+}
+
+void test_gjk_cached_matches_uncached(void){
+  struct ConvexShape a, b;
+  box_shape(&a, (vec3){0.0f, 0.0f, 0.0f}, (vec3){1.0f, 1.0f, 1.0f});
+  capsule_shape(&b, 2.0f, 0.5f, 1.0f, 0.5f);
+
+  // Step the capsule in towards the box, through touching and into an overlap,
+  // carrying the cache between steps like the pipeline does
+  struct GJKCache cache = {0};
+  unsigned int cached_iterations = 0;
+  unsigned int uncached_iterations = 0;
+  for (int step = 0; step < 20; step++){
+    struct GJKResult cached = gjk_distance(&a, &b, &cache);
+    struct GJKResult uncached = gjk_distance(&a, &b, NULL);
+    TEST_ASSERT_TRUE(cache.valid);
+    assert_gjk_result_equal(&uncached, &cached);
+    cached_iterations += cached.iterations;
+    uncached_iterations += uncached.iterations;
+
+    b.data.capsule.segment_A[0] -= 0.05f;
+    b.data.capsule.segment_B[0] -= 0.05f;
+  }
+  // Ended overlapping
+  TEST_ASSERT_TRUE(gjk_distance(&a, &b, NULL).distance < 0.0f);
+  TEST_ASSERT_TRUE(cached_iterations <= uncached_iterations);
+}
+
+// CACHE TABLE TESTS
+//
+void test_gjk_cache_key_ignores_order(void){
+  PhysicsBodyHandle low = 3;
+  PhysicsBodyHandle high = 7;
+  TEST_ASSERT_EQUAL_UINT64(gjk_cache_key(low, high), gjk_cache_key(high, low));
+  // The lower handle goes in the high bits
+  TEST_ASSERT_EQUAL_UINT64(((uint64_t)low << 32) | high, gjk_cache_key(high, low));
+}
+
+void test_gjk_cache_flip(void){
+  struct ConvexShape a, b;
+  box_shape(&a, (vec3){0.0f, 0.0f, 0.0f}, (vec3){1.0f, 1.0f, 1.0f});
+  sphere_shape(&b, (vec3){2.0f, 2.5f, 0.0f}, 0.5f);
+  struct GJKCache cache = {0};
+  gjk_distance(&a, &b, &cache);
+  TEST_ASSERT_TRUE(cache.num_directions > 0);
+
+  // The flipped cache is the same pair seen from B, so it gives the same answer with the normal reversed
+  struct GJKCache flipped = cache;
+  gjk_cache_flip(&flipped);
+  vec3 negated;
+  glm_vec3_negate_to(cache.axis, negated);
+  assert_gjk_vec3(negated, flipped.axis);
+  struct GJKResult forward = gjk_distance(&a, &b, NULL);
+  struct GJKResult backward = gjk_distance(&b, &a, &flipped);
+  TEST_ASSERT_FLOAT_WITHIN(GJK_TEST_DELTA, forward.distance, backward.distance);
+  glm_vec3_negate(backward.normal);
+  assert_gjk_vec3(forward.normal, backward.normal);
+
+  // Flipping twice gets the original back
+  gjk_cache_flip(&flipped);
+  assert_gjk_vec3(cache.axis, flipped.axis);
+  for (unsigned int i = 0; i < cache.num_directions; i++){
+    assert_gjk_vec3(cache.directions[i], flipped.directions[i]);
+  }
+}
+
+void test_gjk_cache_table_insert_find(void){
+  struct GJKCacheTable table = {0};
+  struct GJKCache found;
+  TEST_ASSERT_FALSE(gjk_cache_table_find(&table, gjk_cache_key(1, 2), &found));
+
+  // A collision between bodies whose pair has the higher handle as A,
+  // stored with the lower handle as A like physics_store_gjk_caches does
+  PhysicsBodyHandle handle_A = 9;
+  PhysicsBodyHandle handle_B = 4;
+  struct ConvexShape a, b;
+  box_shape(&a, (vec3){0.0f, 0.0f, 0.0f}, (vec3){1.0f, 1.0f, 1.0f});
+  capsule_shape(&b, 0.0f, 1.75f, 1.0f, 0.5f);
+  struct GJKCache cache = {0};
+  struct GJKResult result = gjk_distance(&a, &b, &cache);
+  TEST_ASSERT_TRUE(result.distance > 0.0f);
+
+  struct GJKCache stored = cache;
+  gjk_cache_flip(&stored);
+  TEST_ASSERT_TRUE(gjk_cache_table_insert(&table, gjk_cache_key(handle_A, handle_B), &stored));
+
+  // Fill the table past a few grows
+  for (PhysicsBodyHandle i = 100; i < 300; i++){
+    struct GJKCache other = {.axis = {(float)i, 0.0f, 0.0f}, .valid = true};
+    TEST_ASSERT_TRUE(gjk_cache_table_insert(&table, gjk_cache_key(i, i + 1), &other));
+  }
+  TEST_ASSERT_EQUAL_UINT(201, table.num_entries);
+
+  // Loaded back from either order, then flipped for the pair's order like physics_load_gjk_caches does
+  TEST_ASSERT_TRUE(gjk_cache_table_find(&table, gjk_cache_key(handle_B, handle_A), &found));
+  gjk_cache_flip(&found);
+  assert_gjk_vec3(cache.axis, found.axis);
+  TEST_ASSERT_EQUAL_UINT(cache.num_directions, found.num_directions);
+  struct GJKResult reloaded = gjk_distance(&a, &b, &found);
+  assert_gjk_result_equal(&result, &reloaded);
+  TEST_ASSERT_TRUE(reloaded.iterations <= result.iterations);
+
+  for (PhysicsBodyHandle i = 100; i < 300; i++){
+    TEST_ASSERT_TRUE(gjk_cache_table_find(&table, gjk_cache_key(i + 1, i), &found));
+    TEST_ASSERT_EQUAL_FLOAT((float)i, found.axis[0]);
+  }
+
+  // Inserting an existing key replaces it
+  struct GJKCache replacement = {.axis = {0.0f, -1.0f, 0.0f}, .valid = true};
+  TEST_ASSERT_TRUE(gjk_cache_table_insert(&table, gjk_cache_key(handle_A, handle_B), &replacement));
+  TEST_ASSERT_EQUAL_UINT(201, table.num_entries);
+  TEST_ASSERT_TRUE(gjk_cache_table_find(&table, gjk_cache_key(handle_A, handle_B), &found));
+  assert_gjk_vec3(replacement.axis, found.axis);
+
+  gjk_cache_table_clear(&table);
+  TEST_ASSERT_FALSE(gjk_cache_table_find(&table, gjk_cache_key(handle_A, handle_B), &found));
+  gjk_cache_table_free(&table);
+}
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include "unity.h"
+#include "physics/sweep_and_prune.h"
+
+#define SAP_TEST_PROXIES 100
+#define SAP_TEST_STEPS 30
+// All overlapping, 496 pairs nearly fill a 1024 slot table, with a probe chain wrapping its end
+#define SAP_TEST_CLUSTER_PROXIES 32
+
+// Helpers
+static float sap_test_random(float min, float max){
+  return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static void random_AABB(struct AABB *aabb){
+  for (int i = 0; i < 3; i++){
+    aabb->center[i] = sap_test_random(-10.0f, 10.0f);
+    aabb->extents[i] = sap_test_random(0.1f, 2.0f);
+  }
+  aabb->initialized = true;
+}
+
+// Compare the persistent pair set against testing every pair of live proxies
+static void sap_test_check_pairs(struct SweepAndPrune *sap, int *proxy_ids, struct AABB *aabbs, int num_proxies){
+  unsigned int expected_pairs = 0;
+  for (int i = 0; i < num_proxies; i++){
+    if (proxy_ids[i] == SAP_NULL_PROXY) continue;
+    for (int j = i + 1; j < num_proxies; j++){
+      if (proxy_ids[j] == SAP_NULL_PROXY) continue;
+      bool expected = AABB_intersect_AABB(&aabbs[i], &aabbs[j]);
+      TEST_ASSERT_EQUAL(expected, sap_has_pair(sap, proxy_ids[i], proxy_ids[j]));
+      expected_pairs += expected;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT(expected_pairs, sap->num_pairs);
+
+  // Every dense pair has exactly one table slot pointing at it
+  unsigned int occupied = 0;
+  for (unsigned int slot = 0; slot < sap->pair_table_capacity; slot++){
+    if (sap->pair_table[slot] == -1) continue;
+    TEST_ASSERT_TRUE((unsigned int)sap->pair_table[slot] < sap->num_pairs);
+    occupied++;
+  }
+  TEST_ASSERT_EQUAL_UINT(sap->num_pairs, occupied);
+}
+
+// SWEEP AND PRUNE TESTS
+//
+void test_sweep_and_prune_matches_brute_force(void){
+  srand(4);
+  struct SweepAndPrune sap;
+  TEST_ASSERT_TRUE(sap_init(&sap));
+
+  int proxy_ids[SAP_TEST_PROXIES];
+  struct AABB aabbs[SAP_TEST_PROXIES];
+  for (int i = 0; i < SAP_TEST_PROXIES; i++){
+    random_AABB(&aabbs[i]);
+    proxy_ids[i] = sap_create_proxy(&sap, &aabbs[i], NULL);
+    TEST_ASSERT_NOT_EQUAL(SAP_NULL_PROXY, proxy_ids[i]);
+  }
+  sap_update_pairs(&sap);
+  sap_test_check_pairs(&sap, proxy_ids, aabbs, SAP_TEST_PROXIES);
+
+  for (int step = 0; step < SAP_TEST_STEPS; step++){
+    for (int i = 0; i < SAP_TEST_PROXIES; i++){
+      if (proxy_ids[i] == SAP_NULL_PROXY){
+        if (rand() % 4 == 0){
+          random_AABB(&aabbs[i]);
+          proxy_ids[i] = sap_create_proxy(&sap, &aabbs[i], NULL);
+        }
+        continue;
+      }
+      if (rand() % 30 == 0){
+        sap_destroy_proxy(&sap, proxy_ids[i]);
+        proxy_ids[i] = SAP_NULL_PROXY;
+        continue;
+      }
+      for (int j = 0; j < 3; j++){
+        aabbs[i].center[j] += sap_test_random(-0.5f, 0.5f);
+      }
+      sap_move_proxy(&sap, proxy_ids[i], &aabbs[i]);
+    }
+    sap_update_pairs(&sap);
+    sap_test_check_pairs(&sap, proxy_ids, aabbs, SAP_TEST_PROXIES);
+  }
+  sap_free(&sap);
+}
+
+void test_sweep_and_prune_remove_pairs_across_wrapped_cluster(void){
+  struct SweepAndPrune sap;
+  TEST_ASSERT_TRUE(sap_init(&sap));
+
+  // Every proxy overlaps every other one
+  int proxy_ids[SAP_TEST_CLUSTER_PROXIES];
+  struct AABB aabbs[SAP_TEST_CLUSTER_PROXIES];
+  for (int i = 0; i < SAP_TEST_CLUSTER_PROXIES; i++){
+    aabbs[i] = (struct AABB){
+      .center = {0.01f * i, 0.0f, 0.0f},
+      .extents = {1.0f, 1.0f, 1.0f},
+      .initialized = true
+    };
+    proxy_ids[i] = sap_create_proxy(&sap, &aabbs[i], NULL);
+  }
+  sap_update_pairs(&sap);
+  sap_test_check_pairs(&sap, proxy_ids, aabbs, SAP_TEST_CLUSTER_PROXIES);
+  TEST_ASSERT_EQUAL_UINT(SAP_TEST_CLUSTER_PROXIES * (SAP_TEST_CLUSTER_PROXIES - 1) / 2, sap.num_pairs);
+
+  // A probe chain running off the end of the table and continuing from slot 0
+  TEST_ASSERT_NOT_EQUAL(-1, sap.pair_table[sap.pair_table_capacity - 1]);
+  TEST_ASSERT_NOT_EQUAL(-1, sap.pair_table[0]);
+
+  // Move proxies out of the cluster one at a time, removing all of their pairs
+  for (int i = 0; i < SAP_TEST_CLUSTER_PROXIES; i++){
+    aabbs[i].center[1] = 10.0f * (i + 1);
+    sap_move_proxy(&sap, proxy_ids[i], &aabbs[i]);
+    sap_update_pairs(&sap);
+    sap_test_check_pairs(&sap, proxy_ids, aabbs, SAP_TEST_CLUSTER_PROXIES);
+  }
+  TEST_ASSERT_EQUAL_UINT(0, sap.num_pairs);
+  sap_free(&sap);
+}
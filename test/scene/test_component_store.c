@@ -0,0 +1,97 @@
+#include "unity.h"
+#include "component_store.h"
+
+// Helpers
+struct ComponentStoreTestComponent {
+  EntityIndex owner;
+  float value;
+};
+
+static void component_store_test_add(struct ComponentStore *store, EntityIndex entity){
+  struct ComponentStoreTestComponent *component = component_store_add(store, entity);
+  TEST_ASSERT_NOT_NULL(component);
+  TEST_ASSERT_EQUAL_UINT32(0, component->owner);
+  component->owner = entity;
+  component->value = entity * 0.5f;
+}
+
+// Every component is where sparse says, and owned by the entity dense_entities says
+static void component_store_test_check(struct ComponentStore *store){
+  for (unsigned int i = 0; i < store->num_components; i++){
+    EntityIndex entity = component_store_entity_at(store, i);
+    struct ComponentStoreTestComponent *component = component_store_at(store, i);
+    TEST_ASSERT_EQUAL_UINT32(entity, component->owner);
+    TEST_ASSERT_EQUAL_UINT32(i, store->sparse[entity]);
+    TEST_ASSERT_EQUAL_PTR(component, component_store_get(store, entity));
+    TEST_ASSERT_EQUAL_FLOAT(entity * 0.5f, component->value);
+  }
+}
+
+// COMPONENT STORE TESTS
+//
+void test_component_store_add_get_remove(void){
+  struct ComponentStore store;
+  TEST_ASSERT_TRUE(component_store_init(&store, sizeof(struct ComponentStoreTestComponent), 2));
+
+  // Past the initial dense capacity and the initial 16 sparse entries
+  EntityIndex entities[] = {3, 10, 40, 7, 100};
+  unsigned int num_entities = sizeof(entities) / sizeof(entities[0]);
+  for (unsigned int i = 0; i < num_entities; i++){
+    component_store_test_add(&store, entities[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT(num_entities, store.num_components);
+  component_store_test_check(&store);
+
+  // One component per entity, and nothing for entities without one, in or past sparse
+  TEST_ASSERT_NULL(component_store_add(&store, 10));
+  TEST_ASSERT_NULL(component_store_add(&store, ENTITY_NULL_INDEX));
+  TEST_ASSERT_NULL(component_store_get(&store, 4));
+  TEST_ASSERT_NULL(component_store_get(&store, 1000));
+  TEST_ASSERT_FALSE(component_store_remove(&store, 4));
+  TEST_ASSERT_FALSE(component_store_remove(&store, 1000));
+  TEST_ASSERT_EQUAL_UINT(num_entities, store.num_components);
+
+  component_store_free(&store);
+}
+
+void test_component_store_remove_swaps_last(void){
+  struct ComponentStore store;
+  TEST_ASSERT_TRUE(component_store_init(&store, sizeof(struct ComponentStoreTestComponent), 4));
+  EntityIndex entities[] = {5, 2, 9, 31};
+  for (unsigned int i = 0; i < 4; i++){
+    component_store_test_add(&store, entities[i]);
+  }
+
+  // Removing the first moves the last (31) into its slot, and sparse has to follow it
+  TEST_ASSERT_TRUE(component_store_remove(&store, 5));
+  TEST_ASSERT_EQUAL_UINT(3, store.num_components);
+  TEST_ASSERT_EQUAL_UINT32(31, component_store_entity_at(&store, 0));
+  TEST_ASSERT_EQUAL_UINT32(0, store.sparse[31]);
+  TEST_ASSERT_EQUAL_UINT32(COMPONENT_STORE_NULL, store.sparse[5]);
+  TEST_ASSERT_NULL(component_store_get(&store, 5));
+  component_store_test_check(&store);
+
+  // Removing the last one has nothing to swap
+  TEST_ASSERT_TRUE(component_store_remove(&store, 9));
+  TEST_ASSERT_EQUAL_UINT(2, store.num_components);
+  TEST_ASSERT_EQUAL_UINT32(31, component_store_entity_at(&store, 0));
+  TEST_ASSERT_EQUAL_UINT32(2, component_store_entity_at(&store, 1));
+  component_store_test_check(&store);
+
+  // Removed entities can be added again, and come back zeroed
+  TEST_ASSERT_FALSE(component_store_remove(&store, 5));
+  component_store_test_add(&store, 5);
+  TEST_ASSERT_EQUAL_UINT32(2, store.sparse[5]);
+  component_store_test_check(&store);
+
+  // Down to empty, in an order that swaps every time
+  TEST_ASSERT_TRUE(component_store_remove(&store, 31));
+  TEST_ASSERT_TRUE(component_store_remove(&store, 5));
+  TEST_ASSERT_TRUE(component_store_remove(&store, 2));
+  TEST_ASSERT_EQUAL_UINT(0, store.num_components);
+  for (unsigned int i = 0; i < 4; i++){
+    TEST_ASSERT_NULL(component_store_get(&store, entities[i]));
+  }
+
+  component_store_free(&store);
+}
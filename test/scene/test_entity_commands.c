@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include "unity.h"
+#include "scene.h"
+#include "item.h"
+#include "entity_commands.h"
+#include "physics/world.h"
+
+// Helpers
+// Just what applying commands touches, set up the way scene_load does it
+static struct Scene *entity_commands_test_scene_create(void){
+  struct Scene *scene = (struct Scene *)calloc(1, sizeof(struct Scene));
+  TEST_ASSERT_NOT_NULL(scene);
+  arena_init(&scene->arena, ARENA_DEFAULT_BLOCK_SIZE);
+  pool_init(&scene->node_pool, &scene->arena, sizeof(struct SceneNode), 64);
+  pool_init(&scene->entity_pool, &scene->arena, sizeof(struct Entity), 64);
+  pool_init(&scene->item_pool, &scene->arena, sizeof(struct ItemComponent), 16);
+  scene->physics_world = physics_world_create();
+  TEST_ASSERT_NOT_NULL(scene->physics_world);
+  TEST_ASSERT_TRUE(component_store_init(&scene->entities, sizeof(struct Entity *), 4));
+  TEST_ASSERT_TRUE(entity_command_buffer_init(&scene->commands, 4));
+
+  scene->root_node = (struct SceneNode *)pool_alloc(&scene->node_pool);
+  TEST_ASSERT_NOT_NULL(scene->root_node);
+  glm_quat_identity(scene->root_node->rotation);
+  glm_vec3_one(scene->root_node->scale);
+  glm_mat4_identity(scene->root_node->local_transform);
+  glm_mat4_identity(scene->root_node->world_transform);
+  glm_quat_identity(scene->root_node->world_rotation);
+  glm_vec3_one(scene->root_node->world_scale);
+  scene->max_nodes = 16;
+  scene->nodes = (struct SceneNode **)calloc(scene->max_nodes, sizeof(struct SceneNode *));
+  TEST_ASSERT_NOT_NULL(scene->nodes);
+  scene->nodes[scene->num_nodes++] = scene->root_node;
+  return scene;
+}
+
+static void entity_commands_test_scene_free(struct Scene *scene){
+  entity_command_buffer_free(&scene->commands);
+  component_store_free(&scene->entities);
+  free(scene->free_entity_indices);
+  free(scene->removed_nodes);
+  free(scene->nodes);
+  physics_world_destroy(scene->physics_world);
+  arena_free(&scene->arena);
+  free(scene);
+}
+
+static struct EntitySpawnDesc entity_commands_test_spawn_desc(EntityType type, float x){
+  struct EntitySpawnDesc desc = {0};
+  desc.type = type;
+  desc.position[0] = x;
+  glm_quat_identity(desc.rotation);
+  glm_vec3_one(desc.scale);
+  return desc;
+}
+
+// ENTITY COMMAND TESTS
+//
+void test_entity_commands_add_component_to_deferred_spawn(void){
+  struct Scene *scene = entity_commands_test_scene_create();
+
+  // Two spawns, each followed by components added through its deferred index
+  struct EntitySpawnDesc spawn_desc = entity_commands_test_spawn_desc(ENTITY_ITEM, 1.0f);
+  EntityIndex item_entity = entity_commands_spawn(&scene->commands, &spawn_desc);
+  struct EntityComponentDesc item_desc = {.type = ENTITY_COMPONENT_ITEM, .data.item = {.id = 7, .count = 3}};
+  TEST_ASSERT_TRUE(entity_commands_add_component(&scene->commands, item_entity, &item_desc));
+
+  spawn_desc = entity_commands_test_spawn_desc(ENTITY_WORLD, 4.0f);
+  EntityIndex body_entity = entity_commands_spawn(&scene->commands, &spawn_desc);
+  struct EntityComponentDesc body_desc = {.type = ENTITY_COMPONENT_PHYSICS_BODY};
+  body_desc.data.physics_body.collider.type = COLLIDER_SPHERE;
+  body_desc.data.physics_body.collider.data.sphere.radius = 0.5f;
+  body_desc.data.physics_body.dynamic = true;
+  TEST_ASSERT_TRUE(entity_commands_add_component(&scene->commands, body_entity, &body_desc));
+
+  TEST_ASSERT_TRUE(ENTITY_IS_DEFERRED_INDEX(item_entity));
+  TEST_ASSERT_TRUE(ENTITY_IS_DEFERRED_INDEX(body_entity));
+  TEST_ASSERT_NOT_EQUAL(item_entity, body_entity);
+  // Nothing happens until the apply
+  TEST_ASSERT_EQUAL_UINT(0, scene->entities.num_components);
+  TEST_ASSERT_EQUAL_UINT(1, scene->num_nodes);
+
+  entity_command_buffer_apply(&scene->commands, scene);
+  TEST_ASSERT_EQUAL_UINT(2, scene->entities.num_components);
+  TEST_ASSERT_EQUAL_UINT(3, scene->num_nodes);
+  TEST_ASSERT_EQUAL_UINT(2, scene->root_node->num_children);
+
+  // A fresh scene hands out indices in spawn order
+  struct Entity *item = scene_get_entity(scene, 0);
+  TEST_ASSERT_NOT_NULL(item);
+  TEST_ASSERT_EQUAL_INT(ENTITY_ITEM, item->type);
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, item->position[0]);
+  TEST_ASSERT_NOT_NULL(item->item);
+  TEST_ASSERT_EQUAL_INT(7, item->item->id);
+  TEST_ASSERT_EQUAL_INT(3, item->item->count);
+  TEST_ASSERT_EQUAL_PTR(item, scene->nodes[1]->entity);
+
+  // The body went on the node spawned for it, not one looked up by index
+  struct Entity *body = scene_get_entity(scene, 1);
+  TEST_ASSERT_NOT_NULL(body);
+  TEST_ASSERT_NULL(body->item);
+  TEST_ASSERT_NOT_NULL(physics_get_body(scene->physics_world, body->physics_body));
+  struct PhysicsBodyCold *cold = physics_get_body_cold(scene->physics_world, body->physics_body);
+  TEST_ASSERT_NOT_NULL(cold);
+  TEST_ASSERT_EQUAL_PTR(body, cold->entity);
+  TEST_ASSERT_EQUAL_PTR(scene->nodes[2], cold->scene_node);
+  TEST_ASSERT_EQUAL_PTR(body, scene->nodes[2]->entity);
+
+  // Deferred indices start over each apply, so the same one now means the new spawn
+  spawn_desc = entity_commands_test_spawn_desc(ENTITY_ITEM, 9.0f);
+  EntityIndex next_entity = entity_commands_spawn(&scene->commands, &spawn_desc);
+  TEST_ASSERT_EQUAL_UINT32(item_entity, next_entity);
+  item_desc.data.item.id = 8;
+  TEST_ASSERT_TRUE(entity_commands_add_component(&scene->commands, next_entity, &item_desc));
+  entity_command_buffer_apply(&scene->commands, scene);
+
+  struct Entity *next = scene_get_entity(scene, 2);
+  TEST_ASSERT_NOT_NULL(next);
+  TEST_ASSERT_NOT_NULL(next->item);
+  TEST_ASSERT_EQUAL_INT(8, next->item->id);
+  TEST_ASSERT_EQUAL_INT(7, item->item->id);
+  TEST_ASSERT_EQUAL_UINT(2, scene->item_pool.num_items);
+
+  entity_commands_test_scene_free(scene);
+}
+
+void test_entity_commands_destroy_removes_subtrees(void){
+  struct Scene *scene = entity_commands_test_scene_create();
+  struct Collider sphere = {.type = COLLIDER_SPHERE, .data.sphere.radius = 0.5f};
+
+  // A parent with a body and a sibling with an item, spawned under the root
+  struct EntitySpawnDesc spawn_desc = entity_commands_test_spawn_desc(ENTITY_WORLD, 1.0f);
+  EntityIndex parent_spawn = entity_commands_spawn(&scene->commands, &spawn_desc);
+  struct EntityComponentDesc body_desc = {.type = ENTITY_COMPONENT_PHYSICS_BODY};
+  body_desc.data.physics_body.collider = sphere;
+  body_desc.data.physics_body.dynamic = true;
+  TEST_ASSERT_TRUE(entity_commands_add_component(&scene->commands, parent_spawn, &body_desc));
+  spawn_desc = entity_commands_test_spawn_desc(ENTITY_ITEM, 2.0f);
+  EntityIndex sibling_spawn = entity_commands_spawn(&scene->commands, &spawn_desc);
+  struct EntityComponentDesc item_desc = {.type = ENTITY_COMPONENT_ITEM, .data.item = {.id = 1, .count = 1}};
+  TEST_ASSERT_TRUE(entity_commands_add_component(&scene->commands, sibling_spawn, &item_desc));
+  entity_command_buffer_apply(&scene->commands, scene);
+
+  struct Entity *parent = scene_get_entity(scene, 0);
+  struct Entity *sibling = scene_get_entity(scene, 1);
+  TEST_ASSERT_NOT_NULL(parent);
+  TEST_ASSERT_NOT_NULL(sibling);
+  struct SceneNode *parent_node = scene->nodes[1];
+  struct SceneNode *sibling_node = scene->nodes[2];
+  PhysicsBodyHandle parent_body = parent->physics_body;
+
+  // Below the parent: a child with a body, and a child with a grandchild holding an item
+  struct Entity *child = scene_entity_create(scene);
+  struct SceneNode *child_node = scene_node_create(scene, child, parent_node);
+  TEST_ASSERT_NOT_NULL(child_node);
+  child->physics_body = physics_add_body(scene->physics_world, child_node, child, sphere, 0.0f, true);
+  PhysicsBodyHandle child_body = child->physics_body;
+  struct Entity *other_child = scene_entity_create(scene);
+  struct SceneNode *other_child_node = scene_node_create(scene, other_child, parent_node);
+  TEST_ASSERT_NOT_NULL(other_child_node);
+  struct Entity *grandchild = scene_entity_create(scene);
+  TEST_ASSERT_NOT_NULL(scene_node_create(scene, grandchild, other_child_node));
+  grandchild->item = (struct ItemComponent *)pool_alloc(&scene->item_pool);
+
+  // And an entity without a node
+  struct Entity *loose = scene_entity_create(scene);
+  EntityIndex loose_index = loose->index;
+  TEST_ASSERT_EQUAL_UINT(6, scene->num_nodes);
+  TEST_ASSERT_EQUAL_UINT(2, scene->physics_world->num_dynamic_bodies);
+
+  // The parent twice, the loose entity, and an entity spawned in the same frame
+  TEST_ASSERT_TRUE(entity_commands_destroy(&scene->commands, parent->index));
+  TEST_ASSERT_TRUE(entity_commands_destroy(&scene->commands, parent->index));
+  TEST_ASSERT_TRUE(entity_commands_destroy(&scene->commands, loose_index));
+  spawn_desc = entity_commands_test_spawn_desc(ENTITY_WORLD, 3.0f);
+  EntityIndex doomed_spawn = entity_commands_spawn(&scene->commands, &spawn_desc);
+  TEST_ASSERT_TRUE(entity_commands_destroy(&scene->commands, doomed_spawn));
+  TEST_ASSERT_TRUE(entity_commands_is_destroy_pending(&scene->commands, loose_index));
+  entity_command_buffer_apply(&scene->commands, scene);
+
+  // Only the root and the sibling are left, in the flat array and the graph
+  TEST_ASSERT_EQUAL_UINT(2, scene->num_nodes);
+  TEST_ASSERT_EQUAL_PTR(scene->root_node, scene->nodes[0]);
+  TEST_ASSERT_EQUAL_PTR(sibling_node, scene->nodes[1]);
+  TEST_ASSERT_EQUAL_UINT(1, scene->root_node->num_children);
+  TEST_ASSERT_EQUAL_PTR(sibling_node, scene->root_node->children[0]);
+  TEST_ASSERT_EQUAL_PTR(sibling, sibling_node->entity);
+
+  // Everything else went back to its pool, and the bodies out of the world
+  TEST_ASSERT_EQUAL_UINT(1, scene->entities.num_components);
+  TEST_ASSERT_EQUAL_PTR(sibling, scene_get_entity(scene, 1));
+  TEST_ASSERT_EQUAL_UINT(1, scene->entity_pool.num_items);
+  TEST_ASSERT_EQUAL_UINT(2, scene->node_pool.num_items);
+  TEST_ASSERT_EQUAL_UINT(1, scene->item_pool.num_items);
+  TEST_ASSERT_NULL(physics_get_body(scene->physics_world, parent_body));
+  TEST_ASSERT_NULL(physics_get_body(scene->physics_world, child_body));
+  TEST_ASSERT_EQUAL_UINT(0, scene->physics_world->num_dynamic_bodies);
+  // Parent, child, other child, grandchild, the spawn and the loose entity, each once
+  TEST_ASSERT_EQUAL_UINT(6, scene->num_free_entity_indices);
+
+  // The next spawn takes the last index freed, and starts out clean
+  spawn_desc = entity_commands_test_spawn_desc(ENTITY_ITEM, 4.0f);
+  entity_commands_spawn(&scene->commands, &spawn_desc);
+  entity_command_buffer_apply(&scene->commands, scene);
+  struct Entity *reused = scene_get_entity(scene, loose_index);
+  TEST_ASSERT_NOT_NULL(reused);
+  TEST_ASSERT_EQUAL_INT(ENTITY_ITEM, reused->type);
+  TEST_ASSERT_EQUAL_FLOAT(4.0f, reused->position[0]);
+  TEST_ASSERT_FALSE(reused->pending_removal);
+  TEST_ASSERT_NULL(reused->item);
+  TEST_ASSERT_EQUAL_UINT32(PHYSICS_NULL_HANDLE, reused->physics_body);
+  TEST_ASSERT_EQUAL_UINT(5, scene->num_free_entity_indices);
+  TEST_ASSERT_EQUAL_UINT(3, scene->num_nodes);
+  TEST_ASSERT_EQUAL_PTR(reused, scene->nodes[2]->entity);
+  TEST_ASSERT_EQUAL_UINT(2, scene->root_node->num_children);
+
+  entity_commands_test_scene_free(scene);
+}
@@ -0,0 +1,111 @@
+#include <stdbool.h>
+#include <string.h>
+#include "unity.h"
+#include "pool.h"
+
+#define POOL_TEST_BLOCK_SIZE 1024
+
+// Helpers
+struct PoolTestItem {
+  unsigned char bytes[40];
+};
+
+static bool pool_test_all_zero(void *memory, size_t size){
+  unsigned char *bytes = (unsigned char *)memory;
+  for (size_t i = 0; i < size; i++){
+    if (bytes[i] != 0) return false;
+  }
+  return true;
+}
+
+// POOL TESTS
+//
+void test_pool_reuses_freed_items_zeroed(void){
+  struct Arena arena;
+  arena_init(&arena, POOL_TEST_BLOCK_SIZE);
+  struct Pool pool;
+  pool_init(&pool, &arena, sizeof(struct PoolTestItem), 4);
+
+  struct PoolTestItem *items[4];
+  for (int i = 0; i < 4; i++){
+    items[i] = pool_alloc(&pool);
+    TEST_ASSERT_NOT_NULL(items[i]);
+    TEST_ASSERT_TRUE(pool_test_all_zero(items[i], sizeof(struct PoolTestItem)));
+    memset(items[i], 0xAB, sizeof(struct PoolTestItem));
+  }
+  TEST_ASSERT_EQUAL_UINT(4, pool.num_items);
+  // The first block comes out in address order
+  for (int i = 1; i < 4; i++){
+    TEST_ASSERT_EQUAL_PTR((unsigned char *)items[0] + i * pool.item_size, items[i]);
+  }
+
+  // A freed item is the next one handed out, zeroed over both the free list link and the old contents
+  pool_free(&pool, items[2]);
+  TEST_ASSERT_EQUAL_UINT(3, pool.num_items);
+  struct PoolTestItem *reused = pool_alloc(&pool);
+  TEST_ASSERT_EQUAL_PTR(items[2], reused);
+  TEST_ASSERT_TRUE(pool_test_all_zero(reused, pool.item_size));
+  TEST_ASSERT_EQUAL_UINT(4, pool.num_items);
+
+  // Freed items come back last in, first out
+  pool_free(&pool, items[0]);
+  pool_free(&pool, items[3]);
+  TEST_ASSERT_EQUAL_PTR(items[3], pool_alloc(&pool));
+  TEST_ASSERT_EQUAL_PTR(items[0], pool_alloc(&pool));
+
+  // With the block used up the pool grows, and the new item isn't one that's out already
+  struct PoolTestItem *grown = pool_alloc(&pool);
+  TEST_ASSERT_NOT_NULL(grown);
+  for (int i = 0; i < 4; i++){
+    TEST_ASSERT_TRUE(grown != items[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT(5, pool.num_items);
+
+  // Freeing NULL does nothing
+  pool_free(&pool, NULL);
+  TEST_ASSERT_EQUAL_UINT(5, pool.num_items);
+  arena_free(&arena);
+}
+
+// ARENA TESTS
+//
+void test_arena_oversized_block_behind_head(void){
+  struct Arena arena;
+  arena_init(&arena, POOL_TEST_BLOCK_SIZE);
+
+  unsigned char *first = arena_alloc(&arena, 100);
+  TEST_ASSERT_NOT_NULL(first);
+  struct ArenaBlock *head = arena.blocks;
+  size_t head_used = head->used;
+
+  // Bigger than a block, so it gets one of its own, behind the head
+  unsigned char *oversized = arena_alloc(&arena, 4 * POOL_TEST_BLOCK_SIZE);
+  TEST_ASSERT_NOT_NULL(oversized);
+  TEST_ASSERT_TRUE(pool_test_all_zero(oversized, 4 * POOL_TEST_BLOCK_SIZE));
+  TEST_ASSERT_EQUAL_PTR(head, arena.blocks);
+  TEST_ASSERT_NOT_NULL(head->next);
+  TEST_ASSERT_EQUAL_PTR(head->next->data, oversized);
+  TEST_ASSERT_EQUAL_size_t(4 * POOL_TEST_BLOCK_SIZE, head->next->size);
+  TEST_ASSERT_EQUAL_size_t(head_used, head->used);
+
+  // So the next small allocation still comes out of the head, right after the first
+  unsigned char *second = arena_alloc(&arena, 100);
+  TEST_ASSERT_EQUAL_PTR(head, arena.blocks);
+  TEST_ASSERT_EQUAL_PTR(first + head_used, second);
+
+  // Running out of the head starts a normal block in front of it
+  unsigned char *large = arena_alloc(&arena, POOL_TEST_BLOCK_SIZE);
+  TEST_ASSERT_NOT_NULL(large);
+  TEST_ASSERT_TRUE(arena.blocks != head);
+  TEST_ASSERT_EQUAL_PTR(head, arena.blocks->next);
+  TEST_ASSERT_EQUAL_PTR(arena.blocks->data, large);
+
+  // An oversized allocation into an empty arena just becomes the head
+  arena_free(&arena);
+  TEST_ASSERT_NULL(arena.blocks);
+  oversized = arena_alloc(&arena, 2 * POOL_TEST_BLOCK_SIZE);
+  TEST_ASSERT_NOT_NULL(oversized);
+  TEST_ASSERT_EQUAL_PTR(arena.blocks->data, oversized);
+  TEST_ASSERT_NULL(arena.blocks->next);
+  arena_free(&arena);
+}